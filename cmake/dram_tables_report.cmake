@@ -0,0 +1,108 @@
+# cmake/dram_tables_report.cmake
+# Post-build report of the internal DRAM taken by the OPUS_DRAM_TABLES_* groups
+#
+# Run with cmake -P after the component library is archived. Reads the groups and their entries
+# from the [mapping:micro_opus_tables] fragment in linker.lf, then sums the .rodata sections those
+# entries move out of flash, as listed by objdump for the built archive. The sizes therefore follow
+# the tables actually compiled (fixed or float, Xtensa kernels or not) and any edit to linker.lf.
+#
+# Arguments (-D):
+#   OPUS_OBJDUMP     - objdump from the target toolchain
+#   OPUS_ARCHIVE     - The component library archive
+#   OPUS_LINKER_LF   - The component's linker.lf
+#   OPUS_DRAM_GROUPS - Enabled groups, comma-separated, e.g. "PVQ,CELT" for
+#                      OPUS_DRAM_TABLES_PVQ and OPUS_DRAM_TABLES_CELT
+
+# ------------------------------------------------------------------------------
+# Entries of the enabled groups: "object" (all of its .rodata) or "object:symbol"
+# ------------------------------------------------------------------------------
+string(REPLACE "," ";" OPUS_DRAM_GROUPS "${OPUS_DRAM_GROUPS}")
+file(STRINGS "${OPUS_LINKER_LF}" _lf_lines)
+set(_entry_regex "^[ ]+([A-Za-z0-9_]+)(:([A-Za-z0-9_]+))? \\(noflash_data\\)")
+set(_in_tables FALSE)
+set(_group "")
+foreach(_line IN LISTS _lf_lines)
+    if(_line MATCHES "^\\[mapping:([A-Za-z0-9_]+)\\]")
+        if(CMAKE_MATCH_1 STREQUAL "micro_opus_tables")
+            set(_in_tables TRUE)
+        else()
+            set(_in_tables FALSE)
+        endif()
+        set(_group "")
+    elseif(_in_tables AND _line MATCHES "^[ ]+if OPUS_DRAM_TABLES_([A-Z0-9_]+) = y:")
+        set(_group "${CMAKE_MATCH_1}")
+    elseif(_in_tables AND _group AND _line MATCHES "${_entry_regex}")
+        list(FIND OPUS_DRAM_GROUPS "${_group}" _enabled)
+        if(_enabled GREATER -1)
+            if(CMAKE_MATCH_3)
+                list(APPEND _entries_${_group} "${CMAKE_MATCH_1}:${CMAKE_MATCH_3}")
+            else()
+                list(APPEND _entries_${_group} "${CMAKE_MATCH_1}")
+            endif()
+        endif()
+    endif()
+endforeach()
+
+# ------------------------------------------------------------------------------
+# .rodata section sizes per archive member
+# ------------------------------------------------------------------------------
+execute_process(
+    COMMAND "${OPUS_OBJDUMP}" -h "${OPUS_ARCHIVE}"
+    OUTPUT_VARIABLE _objdump_out
+    RESULT_VARIABLE _objdump_result
+    ERROR_QUIET
+)
+if(NOT _objdump_result EQUAL 0)
+    message(STATUS "Opus: Could not read ${OPUS_ARCHIVE} to size the DRAM tables")
+    return()
+endif()
+
+# Each member starts with "<object>.c.obj:     file format ..."; sections follow as
+# "  <idx> <name> <size hex> ...". Record "object|section|size" triples.
+string(REPLACE ";" "," _objdump_out "${_objdump_out}")
+string(REPLACE "\n" ";" _objdump_lines "${_objdump_out}")
+set(_object "")
+set(_sections "")
+foreach(_line IN LISTS _objdump_lines)
+    if(_line MATCHES "^([A-Za-z0-9_]+)\\.[A-Za-z0-9_.]*:[ ]+file format")
+        set(_object "${CMAKE_MATCH_1}")
+    elseif(_object AND _line MATCHES "^[ ]+[0-9]+ (\\.rodata[A-Za-z0-9_.]*)[ ]+([0-9a-fA-F]+) ")
+        math(EXPR _size "0x${CMAKE_MATCH_2}")
+        list(APPEND _sections "${_object}|${CMAKE_MATCH_1}|${_size}")
+    endif()
+endforeach()
+
+# ------------------------------------------------------------------------------
+# Sum and report each enabled group
+# ------------------------------------------------------------------------------
+set(_total 0)
+foreach(_group IN LISTS OPUS_DRAM_GROUPS)
+    set(_group_bytes 0)
+    foreach(_entry IN LISTS _entries_${_group})
+        string(REPLACE ":" ";" _parts "${_entry}")
+        list(GET _parts 0 _entry_object)
+        list(LENGTH _parts _parts_count)
+        foreach(_section IN LISTS _sections)
+            string(REPLACE "|" ";" _fields "${_section}")
+            list(GET _fields 0 _section_object)
+            list(GET _fields 1 _section_name)
+            list(GET _fields 2 _section_size)
+            if(NOT _section_object STREQUAL _entry_object)
+                continue()
+            endif()
+            if(_parts_count GREATER 1)
+                # A symbol entry moves only that symbol's section (-fdata-sections)
+                list(GET _parts 1 _entry_symbol)
+                if(NOT _section_name STREQUAL ".rodata.${_entry_symbol}")
+                    continue()
+                endif()
+            endif()
+            math(EXPR _group_bytes "${_group_bytes} + ${_section_size}")
+        endforeach()
+    endforeach()
+    message(STATUS "Opus: OPUS_DRAM_TABLES_${_group}: ${_group_bytes} bytes of internal DRAM")
+    math(EXPR _total "${_total} + ${_group_bytes}")
+endforeach()
+
+math(EXPR _total_kb "(${_total} + 1023) / 1024")
+message(STATUS "Opus: Constant tables in internal DRAM: ~${_total_kb}KB (${_total} bytes)")
@@ -7,6 +7,35 @@ if(__opus_esp_idf_defined)
 endif()
 set(__opus_esp_idf_defined TRUE)
 
+# ==============================================================================
+# opus_get_linker_fragment
+# ==============================================================================
+# The linker fragment to register for this component. linker.lf scopes its mappings to
+# libmicro-opus.a so they cannot match another component's objects; when the component is pulled
+# in under another name (esphome__micro-opus from the component registry, ...), this writes a copy
+# naming that archive instead. Call this before idf_component_register().
+#
+# Arguments:
+#   COMPONENT_DIR - The component directory path
+#   OUT_VAR       - Set to the fragment path
+# ==============================================================================
+function(opus_get_linker_fragment COMPONENT_DIR OUT_VAR)
+    if(COMPONENT_NAME STREQUAL "micro-opus")
+        set(${OUT_VAR} "${COMPONENT_DIR}/linker.lf" PARENT_SCOPE)
+        return()
+    endif()
+
+    file(READ "${COMPONENT_DIR}/linker.lf" _fragment)
+    string(REPLACE "archive: libmicro-opus.a" "archive: lib${COMPONENT_NAME}.a"
+        _fragment "${_fragment}")
+    # Written through configure_file so an unchanged fragment keeps its timestamp
+    file(WRITE "${CMAKE_CURRENT_BINARY_DIR}/linker.lf.tmp" "${_fragment}")
+    configure_file("${CMAKE_CURRENT_BINARY_DIR}/linker.lf.tmp"
+        "${CMAKE_CURRENT_BINARY_DIR}/linker.lf" COPYONLY)
+    set_property(DIRECTORY APPEND PROPERTY CMAKE_CONFIGURE_DEPENDS "${COMPONENT_DIR}/linker.lf")
+    set(${OUT_VAR} "${CMAKE_CURRENT_BINARY_DIR}/linker.lf" PARENT_SCOPE)
+endfunction()
+
 # ==============================================================================
 # opus_configure_esp_idf
 # ==============================================================================
@@ -39,7 +68,7 @@ function(opus_configure_esp_idf COMPONENT_LIB COMPONENT_DIR OPUS_STAGED_DIR)
     target_link_libraries(${COMPONENT_LIB} PUBLIC micro_ogg_demuxer)
 
     # Add patches directory to include path for custom headers
-    # (custom_support.h, thread_local_stack.h, timing headers)
+    # (custom_support.h, thread_local_stack.h, profiling and timing headers)
     target_include_directories(${COMPONENT_LIB} BEFORE PRIVATE
         "${COMPONENT_DIR}/patches"
         "${COMPONENT_DIR}/src"
@@ -51,8 +80,23 @@ function(opus_configure_esp_idf COMPONENT_LIB COMPONENT_DIR OPUS_STAGED_DIR)
     # Configure memory allocation mode
     _opus_configure_allocation_mode(${COMPONENT_LIB})
 
-    # Configure timing instrumentation if enabled
-    _opus_configure_timing(${COMPONENT_LIB})
+    # Configure the profiling API and stage timing instrumentation if enabled
+    opus_configure_profiling(${COMPONENT_LIB} ${COMPONENT_DIR})
+
+    # Configure pseudostack high-water tracking if enabled
+    opus_configure_pseudostack_tracking(${COMPONENT_LIB} ${COMPONENT_DIR})
+
+    # Configure the shared pseudostack pool if enabled
+    opus_configure_pseudostack_pool(${COMPONENT_LIB} ${COMPONENT_DIR})
+
+    # Fix the wrappers' output format if configured
+    opus_configure_fixed_format(${COMPONENT_LIB})
+
+    # Report the internal RAM cost of constant tables moved out of flash (linker.lf)
+    _opus_report_dram_tables(${COMPONENT_LIB} ${COMPONENT_DIR})
+
+    # Report the IRAM cost of the decode functions moved out of flash (linker.lf)
+    _opus_report_iram(${COMPONENT_LIB} ${COMPONENT_DIR})
 
     # Configure fixed-point vs floating-point
     _opus_configure_float_mode(${COMPONENT_LIB} ${target} ${OPUS_STAGED_DIR})
@@ -65,6 +109,7 @@ function(opus_configure_esp_idf COMPONENT_LIB COMPONENT_DIR OPUS_STAGED_DIR)
         target_compile_definitions(${COMPONENT_LIB} PRIVATE OPUS_XTENSA_LX7)
         target_sources(${COMPONENT_LIB} PRIVATE
             "${OPUS_STAGED_DIR}/celt/xtensa/mathops_lx7.c"
+            "${OPUS_STAGED_DIR}/celt/xtensa/pitch_lx7.c"
         )
         message(STATUS "Opus: Xtensa optimizations enabled")
     endif()
@@ -105,22 +150,65 @@ function(_opus_configure_allocation_mode TARGET)
     endif()
 endfunction()
 
-# Configure timing instrumentation
-function(_opus_configure_timing TARGET)
-    if(CONFIG_OPUS_ENABLE_CELT_TIMING)
-        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_CELT_TIMING)
-        message(STATUS "Opus: CELT timing instrumentation enabled")
+# Report the internal DRAM used by the OPUS_DRAM_TABLES_* groups. The placement itself is done by
+# linker.lf; after the library is archived, dram_tables_report.cmake sums the .rodata sections its
+# entries move, so the reported sizes match the tables built for this configuration.
+function(_opus_report_dram_tables TARGET COMPONENT_DIR)
+    set(_groups "")
+    foreach(_group PVQ CELT SILK)
+        if(CONFIG_OPUS_DRAM_TABLES_${_group})
+            list(APPEND _groups ${_group})
+        endif()
+    endforeach()
+    if(NOT _groups)
+        return()
     endif()
-
-    if(CONFIG_OPUS_ENABLE_PVQ_TIMING)
-        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_PVQ_TIMING)
-        message(STATUS "Opus: PVQ timing instrumentation enabled")
+    if(NOT CMAKE_OBJDUMP)
+        message(STATUS "Opus: objdump not found; DRAM table sizes will not be reported")
+        return()
     endif()
 
-    if(CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING)
-        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING)
-        message(STATUS "Opus: quant_all_bands timing instrumentation enabled")
+    string(REPLACE ";" "," _groups_arg "${_groups}")
+    add_custom_command(TARGET ${TARGET} POST_BUILD
+        COMMAND ${CMAKE_COMMAND}
+            -DOPUS_OBJDUMP=${CMAKE_OBJDUMP}
+            -DOPUS_ARCHIVE=$<TARGET_FILE:${TARGET}>
+            -DOPUS_LINKER_LF=${COMPONENT_DIR}/linker.lf
+            -DOPUS_DRAM_GROUPS=${_groups_arg}
+            -P ${COMPONENT_DIR}/cmake/dram_tables_report.cmake
+        VERBATIM
+    )
+    message(STATUS "Opus: Constant tables in internal DRAM: ${_groups} (sizes reported after build)")
+endfunction()
+
+# Report the IRAM used by the OPUS_IRAM_PLACEMENT tier. As with the DRAM tables, linker.lf does the
+# placement and iram_report.cmake sums the code sections its entries move from the built archive.
+function(_opus_report_iram TARGET COMPONENT_DIR)
+    set(_tiers "")
+    foreach(_tier 1 2 3)
+        if(CONFIG_OPUS_IRAM_TIER_${_tier})
+            list(APPEND _tiers ${_tier})
+        endif()
+    endforeach()
+    if(NOT _tiers)
+        return()
+    endif()
+    if(NOT CMAKE_OBJDUMP)
+        message(STATUS "Opus: objdump not found; IRAM placement size will not be reported")
+        return()
     endif()
+
+    string(REPLACE ";" "," _tiers_arg "${_tiers}")
+    add_custom_command(TARGET ${TARGET} POST_BUILD
+        COMMAND ${CMAKE_COMMAND}
+            -DOPUS_OBJDUMP=${CMAKE_OBJDUMP}
+            -DOPUS_ARCHIVE=$<TARGET_FILE:${TARGET}>
+            -DOPUS_LINKER_LF=${COMPONENT_DIR}/linker.lf
+            -DOPUS_IRAM_TIERS=${_tiers_arg}
+            -P ${COMPONENT_DIR}/cmake/iram_report.cmake
+        VERBATIM
+    )
+    message(STATUS "Opus: Decode functions in IRAM: tiers ${_tiers} (size reported after build)")
 endfunction()
 
 # Configure floating-point vs fixed-point mode
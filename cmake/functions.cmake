@@ -50,3 +50,143 @@ function(opus_set_optimization_flags TARGET)
         target_compile_options(${TARGET} PRIVATE -Wno-error=maybe-uninitialized)
     endif()
 endfunction()
+
+# ==============================================================================
+# opus_configure_profiling
+# ==============================================================================
+# Enables the per-decoder profiling API (MICRO_OPUS_ENABLE_PROFILING) and the stage timing
+# instrumentation selected by the CONFIG_OPUS_ENABLE_*_TIMING variables. These come from Kconfig on
+# ESP-IDF and from the OPUS_ENABLE_PROFILING option on host. The matching source patches are
+# applied by opus_setup_staged_build().
+#
+# The define is PUBLIC because it adds members to the wrapper classes.
+#
+# Arguments:
+#   TARGET     - The target to configure
+#   SOURCE_DIR - The component/source directory path
+# ==============================================================================
+function(opus_configure_profiling TARGET SOURCE_DIR)
+    if(NOT CONFIG_OPUS_ENABLE_PROFILING)
+        return()
+    endif()
+
+    target_compile_definitions(${TARGET} PUBLIC MICRO_OPUS_ENABLE_PROFILING)
+    target_sources(${TARGET} PRIVATE "${SOURCE_DIR}/patches/profile_timing.c")
+    message(STATUS "Opus: Profiling API enabled")
+
+    if(CONFIG_OPUS_ENABLE_CELT_TIMING)
+        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_CELT_TIMING)
+        message(STATUS "Opus: CELT timing instrumentation enabled")
+    endif()
+
+    if(CONFIG_OPUS_ENABLE_PVQ_TIMING)
+        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_PVQ_TIMING)
+        message(STATUS "Opus: PVQ timing instrumentation enabled")
+    endif()
+
+    if(CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING)
+        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING)
+        message(STATUS "Opus: quant_all_bands timing instrumentation enabled")
+    endif()
+
+    if(CONFIG_OPUS_ENABLE_SILK_TIMING)
+        target_compile_definitions(${TARGET} PRIVATE CONFIG_OPUS_ENABLE_SILK_TIMING)
+        message(STATUS "Opus: SILK timing instrumentation enabled")
+    endif()
+endfunction()
+
+# ==============================================================================
+# opus_configure_pseudostack_tracking
+# ==============================================================================
+# Enables the pseudostack high-water mark (MICRO_OPUS_PSEUDOSTACK_TRACKING) when
+# CONFIG_OPUS_PSEUDOSTACK_TRACKING is set, from Kconfig on ESP-IDF and from the
+# OPUS_PSEUDOSTACK_TRACKING option on host. The RESTORE_STACK hook itself is part of the always-on
+# celt_stack_alloc patch and compiles to nothing without the define.
+#
+# The define is PUBLIC because it exposes the API in micro_opus/pseudostack.h.
+#
+# Arguments:
+#   TARGET     - The target to configure
+#   SOURCE_DIR - The component/source directory path
+# ==============================================================================
+function(opus_configure_pseudostack_tracking TARGET SOURCE_DIR)
+    if(NOT CONFIG_OPUS_PSEUDOSTACK_TRACKING)
+        return()
+    endif()
+
+    if(CONFIG_OPUS_USE_ALLOCA OR OPUS_ALLOCATION_MODE STREQUAL "USE_ALLOCA")
+        message(WARNING "Opus: pseudostack tracking needs a pseudostack allocation mode, ignoring")
+        return()
+    endif()
+
+    target_compile_definitions(${TARGET} PUBLIC MICRO_OPUS_PSEUDOSTACK_TRACKING)
+    target_sources(${TARGET} PRIVATE "${SOURCE_DIR}/patches/pseudostack_usage.c")
+    message(STATUS "Opus: Pseudostack high-water tracking enabled")
+endfunction()
+
+# ==============================================================================
+# opus_configure_pseudostack_pool
+# ==============================================================================
+# Replaces the per-thread pseudostacks with a pool of CONFIG_OPUS_PSEUDOSTACK_POOL_COUNT buffers
+# that the wrappers lease for each decode call (MICRO_OPUS_PSEUDOSTACK_POOL), when
+# CONFIG_OPUS_PSEUDOSTACK_POOL is set, from Kconfig on ESP-IDF and from the OPUS_PSEUDOSTACK_POOL
+# cache variable on host. Builds on THREADSAFE_PSEUDOSTACK's thread-local pointers.
+#
+# The define is PUBLIC because it exposes the lease API in micro_opus/pseudostack.h.
+#
+# Arguments:
+#   TARGET     - The target to configure
+#   SOURCE_DIR - The component/source directory path
+# ==============================================================================
+function(opus_configure_pseudostack_pool TARGET SOURCE_DIR)
+    if(NOT CONFIG_OPUS_PSEUDOSTACK_POOL)
+        return()
+    endif()
+
+    if(NOT CONFIG_OPUS_THREADSAFE_PSEUDOSTACK AND
+       NOT OPUS_ALLOCATION_MODE STREQUAL "THREADSAFE_PSEUDOSTACK")
+        message(WARNING "Opus: the pseudostack pool needs THREADSAFE_PSEUDOSTACK, ignoring")
+        return()
+    endif()
+
+    target_compile_definitions(${TARGET}
+        PUBLIC MICRO_OPUS_PSEUDOSTACK_POOL=${CONFIG_OPUS_PSEUDOSTACK_POOL_COUNT})
+    target_sources(${TARGET} PRIVATE "${SOURCE_DIR}/patches/pseudostack_pool.c")
+    message(STATUS "Opus: Pseudostack pool with ${CONFIG_OPUS_PSEUDOSTACK_POOL_COUNT} buffer(s)")
+endfunction()
+
+# ==============================================================================
+# opus_configure_fixed_format
+# ==============================================================================
+# Builds the decoder wrappers for one output format (MICRO_OPUS_FIXED_SAMPLE_RATE and
+# MICRO_OPUS_FIXED_CHANNELS) when CONFIG_OPUS_FIXED_OUTPUT_FORMAT is set, from Kconfig on ESP-IDF
+# and from the OPUS_FIXED_SAMPLE_RATE/OPUS_FIXED_CHANNELS cache variables on host. The wrappers
+# size their output from the constants and refuse any other format; libopus stays generic.
+#
+# The defines are PUBLIC because OpusPacketDecoderT checks its template arguments against them.
+#
+# Arguments:
+#   TARGET - The target to configure
+# ==============================================================================
+function(opus_configure_fixed_format TARGET)
+    if(NOT CONFIG_OPUS_FIXED_OUTPUT_FORMAT)
+        return()
+    endif()
+
+    set(_rates 8000 12000 16000 24000 48000)
+    if(NOT CONFIG_OPUS_FIXED_SAMPLE_RATE IN_LIST _rates)
+        message(FATAL_ERROR
+            "Invalid fixed output sample rate: ${CONFIG_OPUS_FIXED_SAMPLE_RATE} "
+            "(8000, 12000, 16000, 24000 or 48000)")
+    endif()
+    if(NOT CONFIG_OPUS_FIXED_CHANNELS EQUAL 1 AND NOT CONFIG_OPUS_FIXED_CHANNELS EQUAL 2)
+        message(FATAL_ERROR "Invalid fixed output channel count: ${CONFIG_OPUS_FIXED_CHANNELS}")
+    endif()
+
+    target_compile_definitions(${TARGET} PUBLIC
+        MICRO_OPUS_FIXED_SAMPLE_RATE=${CONFIG_OPUS_FIXED_SAMPLE_RATE}
+        MICRO_OPUS_FIXED_CHANNELS=${CONFIG_OPUS_FIXED_CHANNELS}
+    )
+    message(STATUS "Opus: Output format fixed at ${CONFIG_OPUS_FIXED_SAMPLE_RATE} Hz, "
+                   "${CONFIG_OPUS_FIXED_CHANNELS} channel(s)")
+endfunction()
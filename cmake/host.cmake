@@ -59,10 +59,22 @@ function(opus_configure_host TARGET SOURCE_DIR OPUS_STAGED_DIR)
     # Configure memory allocation mode
     _opus_configure_host_allocation(${TARGET})
 
+    # Configure the profiling API if enabled (OPUS_ENABLE_PROFILING)
+    opus_configure_profiling(${TARGET} ${SOURCE_DIR})
+
+    # Configure pseudostack high-water tracking if enabled (OPUS_PSEUDOSTACK_TRACKING)
+    opus_configure_pseudostack_tracking(${TARGET} ${SOURCE_DIR})
+
+    # Configure the shared pseudostack pool if enabled (OPUS_PSEUDOSTACK_POOL)
+    opus_configure_pseudostack_pool(${TARGET} ${SOURCE_DIR})
+
+    # Fix the wrappers' output format if configured (OPUS_FIXED_SAMPLE_RATE)
+    opus_configure_fixed_format(${TARGET})
+
     # Set optimization flags
     opus_set_optimization_flags(${TARGET})
 
-    # Link pthread for thread-local storage
+    # Link pthread for thread-local storage and the pipelined decoder's decode thread
     find_package(Threads REQUIRED)
     target_link_libraries(${TARGET} PRIVATE Threads::Threads)
 
@@ -0,0 +1,112 @@
+# cmake/iram_report.cmake
+# Post-build report of the IRAM taken by the selected OPUS_IRAM_PLACEMENT tier
+#
+# Run with cmake -P after the component library is archived. Reads the tiers and their entries
+# from the [mapping:micro_opus] fragment in linker.lf, then sums the code sections (.text and
+# .literal) those entries move out of flash, as listed by objdump for the built archive. Like
+# dram_tables_report.cmake, the sizes follow the code actually compiled for the target,
+# configuration and compiler rather than a fixed estimate. `idf.py size-components` shows the same
+# cost in the linked firmware's IRAM total.
+#
+# Arguments (-D):
+#   OPUS_OBJDUMP    - objdump from the target toolchain
+#   OPUS_ARCHIVE    - The component library archive
+#   OPUS_LINKER_LF  - The component's linker.lf
+#   OPUS_IRAM_TIERS - Enabled tiers, comma-separated, e.g. "1,2" for OPUS_IRAM_TIER_1 and
+#                     OPUS_IRAM_TIER_2
+
+# ------------------------------------------------------------------------------
+# Entries of the enabled tiers: "object" (all of its code) or "object:symbol"
+# ------------------------------------------------------------------------------
+string(REPLACE "," ";" OPUS_IRAM_TIERS "${OPUS_IRAM_TIERS}")
+file(STRINGS "${OPUS_LINKER_LF}" _lf_lines)
+set(_entry_regex "^[ ]+([A-Za-z0-9_]+)(:([A-Za-z0-9_]+))? \\(noflash\\)")
+set(_in_code FALSE)
+set(_tier "")
+foreach(_line IN LISTS _lf_lines)
+    if(_line MATCHES "^\\[mapping:([A-Za-z0-9_]+)\\]")
+        if(CMAKE_MATCH_1 STREQUAL "micro_opus")
+            set(_in_code TRUE)
+        else()
+            set(_in_code FALSE)
+        endif()
+        set(_tier "")
+    elseif(_in_code AND _line MATCHES "^[ ]+if OPUS_IRAM_TIER_([0-9]+) = y:")
+        set(_tier "${CMAKE_MATCH_1}")
+    elseif(_in_code AND _tier AND _line MATCHES "${_entry_regex}")
+        list(FIND OPUS_IRAM_TIERS "${_tier}" _enabled)
+        if(_enabled GREATER -1)
+            if(CMAKE_MATCH_3)
+                list(APPEND _entries_${_tier} "${CMAKE_MATCH_1}:${CMAKE_MATCH_3}")
+            else()
+                list(APPEND _entries_${_tier} "${CMAKE_MATCH_1}")
+            endif()
+        endif()
+    endif()
+endforeach()
+
+# ------------------------------------------------------------------------------
+# Code section sizes per archive member
+# ------------------------------------------------------------------------------
+execute_process(
+    COMMAND "${OPUS_OBJDUMP}" -h "${OPUS_ARCHIVE}"
+    OUTPUT_VARIABLE _objdump_out
+    RESULT_VARIABLE _objdump_result
+    ERROR_QUIET
+)
+if(NOT _objdump_result EQUAL 0)
+    message(STATUS "Opus: Could not read ${OPUS_ARCHIVE} to size the IRAM placement")
+    return()
+endif()
+
+# Each member starts with "<object>.c.obj:     file format ..."; sections follow as
+# "  <idx> <name> <size hex> ...". Record "object|section|size" triples.
+string(REPLACE ";" "," _objdump_out "${_objdump_out}")
+string(REPLACE "\n" ";" _objdump_lines "${_objdump_out}")
+set(_object "")
+set(_sections "")
+set(_section_regex "^[ ]+[0-9]+ (\\.(text|literal)[A-Za-z0-9_.]*)[ ]+([0-9a-fA-F]+) ")
+foreach(_line IN LISTS _objdump_lines)
+    if(_line MATCHES "^([A-Za-z0-9_]+)\\.[A-Za-z0-9_.]*:[ ]+file format")
+        set(_object "${CMAKE_MATCH_1}")
+    elseif(_object AND _line MATCHES "${_section_regex}")
+        math(EXPR _size "0x${CMAKE_MATCH_3}")
+        list(APPEND _sections "${_object}|${CMAKE_MATCH_1}|${_size}")
+    endif()
+endforeach()
+
+# ------------------------------------------------------------------------------
+# Sum and report each enabled tier
+# ------------------------------------------------------------------------------
+set(_total 0)
+foreach(_tier IN LISTS OPUS_IRAM_TIERS)
+    set(_tier_bytes 0)
+    foreach(_entry IN LISTS _entries_${_tier})
+        string(REPLACE ":" ";" _parts "${_entry}")
+        list(GET _parts 0 _entry_object)
+        list(LENGTH _parts _parts_count)
+        foreach(_section IN LISTS _sections)
+            string(REPLACE "|" ";" _fields "${_section}")
+            list(GET _fields 0 _section_object)
+            list(GET _fields 1 _section_name)
+            list(GET _fields 2 _section_size)
+            if(NOT _section_object STREQUAL _entry_object)
+                continue()
+            endif()
+            if(_parts_count GREATER 1)
+                # A symbol entry moves only that function's sections (-ffunction-sections)
+                list(GET _parts 1 _entry_symbol)
+                if(NOT _section_name STREQUAL ".text.${_entry_symbol}"
+                        AND NOT _section_name STREQUAL ".literal.${_entry_symbol}")
+                    continue()
+                endif()
+            endif()
+            math(EXPR _tier_bytes "${_tier_bytes} + ${_section_size}")
+        endforeach()
+    endforeach()
+    message(STATUS "Opus: OPUS_IRAM_TIER_${_tier}: ${_tier_bytes} bytes of IRAM")
+    math(EXPR _total "${_total} + ${_tier_bytes}")
+endforeach()
+
+math(EXPR _total_kb "(${_total} + 1023) / 1024")
+message(STATUS "Opus: Decode functions in IRAM: ~${_total_kb}KB (${_total} bytes)")
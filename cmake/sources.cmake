@@ -231,6 +231,7 @@ function(opus_get_sources OPUS_DIR)
     # --------------------------------------------------------------------------
     set(XTENSA_LX7_SOURCES
         ${OPUS_DIR}/celt/xtensa/mathops_lx7.c
+        ${OPUS_DIR}/celt/xtensa/pitch_lx7.c
         PARENT_SCOPE
     )
 endfunction()
@@ -241,9 +242,20 @@ endfunction()
 
 # Opus decoder C++ wrappers - in our src/ directory
 set(OGG_OPUS_SOURCES
+    src/decoder_pool.cpp
     src/opus_header.cpp
     src/ogg_opus_decoder.cpp
+    src/ogg_opus_reader.cpp
     src/opus_packet_decoder.cpp
+    src/opus_packet_info.cpp
+    src/parallel_multistream_decoder.cpp
+    src/pipelined_ogg_opus_decoder.cpp
+    src/segmented_ogg_opus_decoder.cpp
+)
+
+# CELT-only decoder for OPUS_STREAM_CELT_ONLY (built against the staged CELT headers)
+set(CELT_ONLY_SOURCES
+    patches/celt_only_decoder.c
 )
 
 # Thread-local storage sources (for THREADSAFE_PSEUDOSTACK mode)
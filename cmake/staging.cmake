@@ -34,20 +34,32 @@ set(OPUS_CORE_PATCHES
 set(OPUS_XTENSA_PATCHES
     celt_arch.patch
     celt_celt.patch
+    celt_celt_decoder.patch
+    celt_kiss_fft_guts.patch
     celt_mathops.patch
     celt_pitch.patch
     silk_SigProc_FLP.patch
+    silk_macros.patch
+    silk_resampler_IIR_FIR.patch
+    silk_resampler_down_FIR.patch
 )
 
 # Additional files to copy (not patches, just new files)
 set(OPUS_XTENSA_ADDITIONS
     # CELT Xtensa headers
+    celt/xtensa/celt_decoder_lx7.h
     celt/xtensa/fixed_lx7.h
+    celt/xtensa/kiss_fft_lx7.h
     celt/xtensa/mathops_lx7.h
     celt/xtensa/mathops_lx7.c
     celt/xtensa/pitch_lx7.h
+    celt/xtensa/pitch_lx7.c
     # SILK Xtensa headers (floating-point only - fixed-point now in upstream)
     silk/xtensa/SigProc_FLP_lx7.h
+    # SILK 32x16 multiply macros (both builds; SILK decoding is integer code)
+    silk/xtensa/macros_lx7.h
+    # SILK resampler kernels (both fixed and floating-point builds)
+    silk/xtensa/resampler_lx7.h
 )
 
 # ==============================================================================
@@ -99,6 +111,7 @@ function(opus_create_staging_directory SOURCE_DIR STAGED_DIR APPLY_XTENSA)
     set(CONFIG_STRING "${CONFIG_STRING}_celt_timing=${CONFIG_OPUS_ENABLE_CELT_TIMING}")
     set(CONFIG_STRING "${CONFIG_STRING}_pvq_timing=${CONFIG_OPUS_ENABLE_PVQ_TIMING}")
     set(CONFIG_STRING "${CONFIG_STRING}_quant_timing=${CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING}")
+    set(CONFIG_STRING "${CONFIG_STRING}_silk_timing=${CONFIG_OPUS_ENABLE_SILK_TIMING}")
 
     # Check if we need to re-stage
     set(NEED_STAGING TRUE)
@@ -249,8 +262,9 @@ endfunction()
 #   CELT_TIMING        - TRUE to enable CELT decoder timing
 #   PVQ_TIMING         - TRUE to enable PVQ timing
 #   QUANT_BANDS_TIMING - TRUE to enable quant_all_bands timing
+#   SILK_TIMING        - TRUE to enable SILK decoder timing
 # ==============================================================================
-function(opus_apply_timing_patches STAGED_DIR CELT_TIMING PVQ_TIMING QUANT_BANDS_TIMING)
+function(opus_apply_timing_patches STAGED_DIR CELT_TIMING PVQ_TIMING QUANT_BANDS_TIMING SILK_TIMING)
     # CELT decoder timing - patches celt_decoder.c
     if(CELT_TIMING)
         opus_apply_patch("${STAGED_DIR}" "celt_timing.patch")
@@ -268,6 +282,12 @@ function(opus_apply_timing_patches STAGED_DIR CELT_TIMING PVQ_TIMING QUANT_BANDS
     if(QUANT_BANDS_TIMING)
         opus_apply_patch("${STAGED_DIR}" "bands_timing.patch")
     endif()
+
+    # SILK decoder timing - patches decode_frame.c, decode_parameters.c, dec_API.c and
+    # opus_decoder.c (CELT high band of hybrid frames)
+    if(SILK_TIMING)
+        opus_apply_patch("${STAGED_DIR}" "silk_timing.patch")
+    endif()
 endfunction()
 
 # ==============================================================================
@@ -313,13 +333,16 @@ function(opus_setup_staged_build COMPONENT_DIR APPLY_XTENSA)
         opus_apply_xtensa_patches("${STAGED_DIR}")
     endif()
 
-    # Apply timing instrumentation patches if enabled (ESP-IDF only, uses CONFIG_ variables)
-    if(CONFIG_OPUS_ENABLE_CELT_TIMING OR CONFIG_OPUS_ENABLE_PVQ_TIMING OR CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING)
+    # Apply timing instrumentation patches if enabled (Kconfig on ESP-IDF, OPUS_ENABLE_PROFILING
+    # on host)
+    if(CONFIG_OPUS_ENABLE_CELT_TIMING OR CONFIG_OPUS_ENABLE_PVQ_TIMING
+       OR CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING OR CONFIG_OPUS_ENABLE_SILK_TIMING)
         opus_apply_timing_patches(
             "${STAGED_DIR}"
             "${CONFIG_OPUS_ENABLE_CELT_TIMING}"
             "${CONFIG_OPUS_ENABLE_PVQ_TIMING}"
             "${CONFIG_OPUS_ENABLE_QUANT_BANDS_TIMING}"
+            "${CONFIG_OPUS_ENABLE_SILK_TIMING}"
         )
     endif()
 
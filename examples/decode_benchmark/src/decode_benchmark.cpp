@@ -25,6 +25,9 @@
  * the DECODE_BENCH_MAX_CONCURRENT_TASKS define)
  *
  * Each task uses its own OggOpusDecoder instance with the thread-safe pseudostack.
+ *
+ * With CONFIG_OPUS_ENABLE_PROFILING, also reports the decoder's per-packet latency percentiles
+ * (CPU cycle accurate) and how many packets missed the DECODE_BENCH_DEADLINE_US deadline.
  */
 
 #include "esp_heap_caps.h"
@@ -51,6 +54,11 @@ static const char* const TAG = "DECODE_BENCH";
 
 static const int MAX_CONCURRENT_TASKS = DECODE_BENCH_MAX_CONCURRENT_TASKS;
 
+// Per-packet decode deadline for the profiling latency report (one 20 ms Opus frame)
+#ifndef DECODE_BENCH_DEADLINE_US
+#define DECODE_BENCH_DEADLINE_US 20000
+#endif
+
 // Audio test configurations
 enum class AudioType : uint8_t {
     MUSIC,  // CELT codec (high-bitrate stereo)
@@ -87,6 +95,9 @@ struct DecodeResult {
     uint32_t sample_rate;
     int core_id;
     bool success;
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    OpusProfileStats profile;  // Per-packet latency histogram from the decoder
+#endif
 };
 
 // Task parameters
@@ -148,6 +159,9 @@ static DecodeResult decode_full_file(const uint8_t* audio_data, size_t audio_siz
 
     // Create decoder
     micro_opus::OggOpusDecoder decoder;
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    decoder.set_profile_deadline_us(DECODE_BENCH_DEADLINE_US);
+#endif
 
     // PCM output buffer - allocated once headers are parsed and we know the format
     std::vector<int16_t> pcm_buffer;
@@ -216,6 +230,9 @@ static DecodeResult decode_full_file(const uint8_t* audio_data, size_t audio_siz
 
     result.total_time_us = esp_timer_get_time() - iteration_start;
     result.sample_rate = decoder.get_sample_rate();
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    result.profile = decoder.get_profile_stats();
+#endif
 
     return result;
 }
@@ -237,6 +254,37 @@ static void log_decode_result(const char* prefix, DecodeResult* result) {
     ESP_LOGI(TAG, "%sTotal: %" PRId64 " ms (%.1fs audio), RTF: %.3f (%.1fx real-time), core %d",
              prefix, result->total_time_us / 1000, audio_duration_us / 1000000.0, rtf, 1.0 / rtf,
              result->core_id);
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    const OpusProfileLatencyStats& latency = result->profile.latency;
+    double us_per_tick = 1000000.0 / result->profile.tick_rate_hz;
+    ESP_LOGI(TAG,
+             "%sPacket latency (us): p50=%.0f p99=%.0f p99.9=%.0f max=%.0f, "
+             "%" PRIu32 "/%" PRIu32 " over %d us",
+             prefix, latency.p50 * us_per_tick, latency.p99 * us_per_tick,
+             latency.p999 * us_per_tick, latency.max * us_per_tick, latency.deadline_misses,
+             result->profile.decode_calls, DECODE_BENCH_DEADLINE_US);
+
+    // Per-frame cost of the stages with Xtensa kernels, to compare builds with and without
+    // CONFIG_OPUS_ENABLE_XTENSA_OPTIMIZATIONS
+    const OpusProfileCeltStats& celt = result->profile.celt;
+    if (celt.frames > 0) {
+        ESP_LOGI(TAG,
+                 "%sCELT per frame (us): synthesis=%.1f postfilter=%.1f deemphasis=%.1f "
+                 "total=%.1f",
+                 prefix, celt.synthesis * us_per_tick / celt.frames,
+                 celt.postfilter * us_per_tick / celt.frames,
+                 celt.deemphasis * us_per_tick / celt.frames,
+                 celt.total * us_per_tick / celt.frames);
+    }
+    const OpusProfileSilkStats& silk = result->profile.silk;
+    if (silk.frames > 0) {
+        ESP_LOGI(TAG, "%sSILK per frame (us): synthesis=%.1f resample=%.1f total=%.1f", prefix,
+                 silk.synthesis * us_per_tick / silk.frames,
+                 silk.resample * us_per_tick / silk.frames,
+                 silk.total * us_per_tick / silk.frames);
+    }
+#endif
 }
 
 // FreeRTOS task function for concurrent decoding
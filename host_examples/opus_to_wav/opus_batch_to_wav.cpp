@@ -0,0 +1,389 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Batch Ogg Opus to WAV Converter
+ * Converts a directory or list of .opus files to .wav on a pool of worker threads. Each input is
+ * memory-mapped and handed to OggOpusDecoder whole; each worker reuses one decoder (and its
+ * demuxer buffers and libopus states) for all of its files. POSIX only.
+ */
+
+#include "micro_opus/decoder_pool.h"
+#include "micro_opus/ogg_opus_decoder.h"
+#include "wav_writer.h"
+
+#include <dirent.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace {
+
+// Write buffering per output file: a few hundred 20 ms stereo frames per write() call
+constexpr size_t WAV_WRITE_BUFFER_SIZE = 1 << 20;
+
+// Longest Opus packet: 120 ms at 48kHz, per channel
+constexpr size_t MAX_PACKET_SAMPLES = 5760;
+
+struct Job {
+    std::string input;
+    std::string output;
+    size_t input_size{0};
+};
+
+struct JobResult {
+    bool ok{false};
+    uint64_t samples{0};
+    uint32_t sample_rate{0};
+    std::string error;
+};
+
+// One deque of job indices per worker. A worker takes from the front of its own deque, and once
+// that is empty steals from the back of the others', so large files dealt to one worker early on
+// are picked up by whichever workers run out of work first.
+class WorkStealingQueues {
+public:
+    explicit WorkStealingQueues(size_t workers)
+        : queues_(new Queue[workers]), worker_count_(workers) {}
+
+    void push(size_t worker, size_t job) {
+        std::lock_guard<std::mutex> lock(this->queues_[worker].mutex);
+        this->queues_[worker].jobs.push_back(job);
+    }
+
+    // False once every deque is empty (no jobs are added after the workers start)
+    bool pop(size_t worker, size_t& job) {
+        {
+            Queue& own = this->queues_[worker];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.jobs.empty()) {
+                job = own.jobs.front();
+                own.jobs.pop_front();
+                return true;
+            }
+        }
+        for (size_t i = 1; i < this->worker_count_; ++i) {
+            Queue& victim = this->queues_[(worker + i) % this->worker_count_];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.jobs.empty()) {
+                job = victim.jobs.back();
+                victim.jobs.pop_back();
+                return true;
+            }
+        }
+        return false;
+    }
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<size_t> jobs;
+    };
+
+    std::unique_ptr<Queue[]> queues_;
+    size_t worker_count_;
+};
+
+// Read-only mapping of a whole file, unmapped on destruction
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            return;
+        }
+        struct stat st {};
+        if (fstat(fd, &st) == 0 && st.st_size > 0) {
+            size_t size = static_cast<size_t>(st.st_size);
+            void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (data != MAP_FAILED) {
+                // The decoder reads front to back exactly once
+                madvise(data, size, MADV_SEQUENTIAL);
+                this->data_ = static_cast<const uint8_t*>(data);
+                this->size_ = size;
+            }
+        }
+        close(fd);  // The mapping stays valid after the descriptor is closed
+    }
+
+    ~MappedFile() {
+        if (this->data_ != nullptr) {
+            munmap(const_cast<uint8_t*>(this->data_), this->size_);
+        }
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const uint8_t* data() const {
+        return this->data_;
+    }
+    size_t size() const {
+        return this->size_;
+    }
+
+private:
+    const uint8_t* data_{nullptr};
+    size_t size_{0};
+};
+
+// Per-worker state kept across files
+struct Worker {
+    micro_opus::DecoderPool pool;
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm;
+
+    Worker() : pcm(MAX_PACKET_SAMPLES * 2) {
+        this->decoder.set_decoder_pool(&this->pool);
+    }
+};
+
+void convert_file(Worker& worker, const Job& job, JobResult& result) {
+    MappedFile input(job.input);
+    if (input.data() == nullptr) {
+        result.error = "could not map input file";
+        return;
+    }
+
+    micro_opus::OggOpusDecoder& decoder = worker.decoder;
+    decoder.reset();  // Keeps the demuxer buffers; the libopus state returns to the pool
+
+    std::unique_ptr<WavWriter> wav_writer;
+    const uint8_t* data = input.data();
+    size_t remaining = input.size();
+    while (remaining > 0) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult decode_result =
+            decoder.decode(data, remaining, reinterpret_cast<uint8_t*>(worker.pcm.data()),
+                           worker.pcm.size() * sizeof(int16_t), consumed, samples);
+        data += consumed;
+        remaining -= consumed;
+
+        if (decode_result != micro_opus::OGG_OPUS_OK) {
+            result.error = "decode error " + std::to_string(static_cast<int>(decode_result));
+            return;
+        }
+
+        if (!wav_writer && decoder.is_initialized()) {
+            // decode() drops a packet that does not fit, so size the buffer for the longest one
+            // from OpusHead, before the first audio packet
+            const size_t max_samples = MAX_PACKET_SAMPLES * decoder.get_channels();
+            if (worker.pcm.size() < max_samples) {
+                worker.pcm.resize(max_samples);
+            }
+            wav_writer.reset(new WavWriter(job.output, decoder.get_sample_rate(),
+                                           decoder.get_channels(), 16, WAV_WRITE_BUFFER_SIZE));
+            if (!wav_writer->is_open()) {
+                result.error = "could not create output file";
+                return;
+            }
+        }
+
+        if (samples > 0 && !wav_writer->write_samples(worker.pcm.data(), samples)) {
+            result.error = "could not write output file";
+            return;
+        }
+
+        // The whole file is mapped, so a call that makes no progress means a truncated stream
+        if (consumed == 0 && samples == 0) {
+            break;
+        }
+    }
+
+    if (!wav_writer) {
+        result.error = "no Opus stream found";
+        return;
+    }
+    result.ok = true;
+    result.samples = wav_writer->get_samples_written();
+    result.sample_rate = decoder.get_sample_rate();
+}
+
+bool has_opus_extension(const std::string& name) {
+    const std::string ext = ".opus";
+    return name.size() > ext.size() && name.compare(name.size() - ext.size(), ext.size(), ext) == 0;
+}
+
+std::string base_name(const std::string& path) {
+    size_t slash = path.find_last_of('/');
+    std::string name = (slash == std::string::npos) ? path : path.substr(slash + 1);
+    if (has_opus_extension(name)) {
+        name.resize(name.size() - 5);
+    }
+    return name;
+}
+
+// The *.opus files in a directory (not recursive), or the paths listed one per line in a file
+bool collect_inputs(const std::string& source, std::vector<std::string>& inputs) {
+    struct stat st {};
+    if (stat(source.c_str(), &st) != 0) {
+        return false;
+    }
+
+    if (S_ISDIR(st.st_mode)) {
+        DIR* dir = opendir(source.c_str());
+        if (dir == nullptr) {
+            return false;
+        }
+        while (struct dirent* entry = readdir(dir)) {
+            std::string name = entry->d_name;
+            if (has_opus_extension(name)) {
+                inputs.push_back(source + "/" + name);
+            }
+        }
+        closedir(dir);
+        std::sort(inputs.begin(), inputs.end());
+        return true;
+    }
+
+    std::ifstream list(source);
+    std::string line;
+    while (std::getline(list, line)) {
+        if (!line.empty() && line.back() == '\r') {
+            line.pop_back();
+        }
+        if (!line.empty()) {
+            inputs.push_back(line);
+        }
+    }
+    return true;
+}
+
+void print_usage(const char* program_name) {
+    std::cerr << "Usage: " << program_name
+              << " [--jobs N] <input_dir | file_list.txt> <output_dir>\n";
+    std::cerr << "\nConverts every .opus file in a directory (or every path listed in a text\n";
+    std::cerr << "file, one per line) to <output_dir>/<name>.wav, on N worker threads\n";
+    std::cerr << "(default: one per core).\n";
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+    try {
+        int arg = 1;
+        // hardware_concurrency() is 0 when the core count is unknown
+        long jobs = std::max(1L, static_cast<long>(std::thread::hardware_concurrency()));
+        if (argc == 5 && std::strcmp(argv[1], "--jobs") == 0) {
+            jobs = std::strtol(argv[2], nullptr, 10);
+            arg = 3;
+        }
+        if (argc - arg != 2 || jobs < 1) {
+            print_usage(argv[0]);
+            return 1;
+        }
+        const std::string source = argv[arg];
+        const std::string output_dir = argv[arg + 1];
+
+        std::vector<std::string> inputs;
+        if (!collect_inputs(source, inputs)) {
+            std::cerr << "Error: Could not read input directory or list: " << source << "\n";
+            return 1;
+        }
+        if (inputs.empty()) {
+            std::cerr << "Error: No input files found in " << source << "\n";
+            return 1;
+        }
+
+        std::vector<Job> job_list(inputs.size());
+        for (size_t i = 0; i < inputs.size(); ++i) {
+            struct stat st {};
+            job_list[i].input = inputs[i];
+            job_list[i].output = output_dir + "/" + base_name(inputs[i]) + ".wav";
+            job_list[i].input_size =
+                (stat(inputs[i].c_str(), &st) == 0) ? static_cast<size_t>(st.st_size) : 0;
+        }
+
+        // Deal the largest files first, round-robin, so the long tail is small files
+        std::vector<size_t> order(job_list.size());
+        for (size_t i = 0; i < order.size(); ++i) {
+            order[i] = i;
+        }
+        std::stable_sort(order.begin(), order.end(), [&job_list](size_t a, size_t b) {
+            return job_list[a].input_size > job_list[b].input_size;
+        });
+
+        const size_t worker_count = std::min(static_cast<size_t>(jobs), job_list.size());
+        WorkStealingQueues queues(worker_count);
+        for (size_t i = 0; i < order.size(); ++i) {
+            queues.push(i % worker_count, order[i]);
+        }
+
+        std::vector<JobResult> results(job_list.size());
+        std::atomic<size_t> completed{0};
+        std::mutex print_mutex;
+
+        auto start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (size_t w = 0; w < worker_count; ++w) {
+            threads.emplace_back([&, w] {
+                Worker worker;
+                size_t job = 0;
+                while (queues.pop(w, job)) {
+                    convert_file(worker, job_list[job], results[job]);
+                    size_t done = completed.fetch_add(1) + 1;
+                    std::lock_guard<std::mutex> lock(print_mutex);
+                    std::cout << "[" << done << "/" << job_list.size() << "] "
+                              << job_list[job].input;
+                    if (results[job].ok) {
+                        std::cout << " -> " << job_list[job].output << "\n";
+                    } else {
+                        std::cout << ": " << results[job].error << "\n";
+                    }
+                }
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        size_t failed = 0;
+        double audio_seconds = 0.0;
+        for (const JobResult& result : results) {
+            if (!result.ok) {
+                ++failed;
+            } else if (result.sample_rate > 0) {
+                audio_seconds +=
+                    static_cast<double>(result.samples) / static_cast<double>(result.sample_rate);
+            }
+        }
+
+        std::cout << "\nConverted " << (results.size() - failed) << " of " << results.size()
+                  << " files on " << worker_count << " workers in " << seconds << " s\n";
+        std::cout << "Audio decoded: " << audio_seconds << " s ("
+                  << (seconds > 0.0 ? audio_seconds / seconds : 0.0) << "x real time)\n";
+        return (failed == 0) ? 0 : 1;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << "\n";
+        return 1;
+    }
+}
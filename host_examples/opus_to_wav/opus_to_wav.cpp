@@ -17,17 +17,21 @@
  */
 
 #include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/segmented_ogg_opus_decoder.h"
 #include "wav_writer.h"
 
+#include <cstdlib>
 #include <cstring>
 #include <exception>
 #include <fstream>
 #include <iostream>
+#include <iterator>
 #include <vector>
 
 void print_usage(const char* program_name) {
-    std::cerr << "Usage: " << program_name << " <input.opus> <output.wav>\n";
+    std::cerr << "Usage: " << program_name << " [--threads N] <input.opus> <output.wav>\n";
     std::cerr << "\nConverts an Ogg Opus file to WAV format.\n";
+    std::cerr << "With --threads, reads the whole file and decodes it on N threads.\n";
 }
 
 void print_error_description(micro_opus::OggOpusResult result) {
@@ -46,15 +50,78 @@ void print_error_description(micro_opus::OggOpusResult result) {
     }
 }
 
+// Decode the whole file at once with SegmentedOggOpusDecoder, split over threads
+int convert_segmented(const char* input_file, const char* output_file, uint8_t threads) {
+    std::ifstream input(input_file, std::ios::binary);
+    if (!input) {
+        std::cerr << "Error: Could not open input file: " << input_file << "\n";
+        return 1;
+    }
+    std::vector<uint8_t> file_data((std::istreambuf_iterator<char>(input)),
+                                   std::istreambuf_iterator<char>());
+
+    micro_opus::SegmentedOggOpusDecoder decoder(threads);
+    micro_opus::OggOpusResult result = decoder.open(file_data.data(), file_data.size());
+    if (result != 0) {
+        std::cerr << "Error: Could not index input file, error code: " << static_cast<int>(result);
+        print_error_description(result);
+        std::cerr << "\n";
+        return 1;
+    }
+
+    std::cout << "Opus stream info:\n";
+    std::cout << "  Sample rate: " << decoder.get_sample_rate() << " Hz\n";
+    std::cout << "  Channels: " << static_cast<int>(decoder.get_channels()) << "\n";
+    std::cout << "  Pre-skip: " << decoder.get_pre_skip() << " samples\n";
+
+    std::vector<int16_t> pcm(decoder.get_required_output_buffer_size() / sizeof(int16_t));
+    size_t samples = 0;
+    result = decoder.decode(reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t),
+                            samples);
+    if (result != 0) {
+        std::cerr << "Error: Decoding failed with error code: " << static_cast<int>(result);
+        print_error_description(result);
+        std::cerr << "\n";
+        return 1;
+    }
+
+    WavWriter wav_writer(output_file, decoder.get_sample_rate(), decoder.get_channels(), 16);
+    if (!wav_writer.is_open()) {
+        std::cerr << "Error: Could not create output file: " << output_file << "\n";
+        return 1;
+    }
+    if (samples > 0 && !wav_writer.write_samples(pcm.data(), samples)) {
+        std::cerr << "Error: Failed to write samples to WAV file\n";
+        return 1;
+    }
+
+    std::cout << "\nConversion complete!\n";
+    std::cout << "Audio packets: " << decoder.get_packet_count() << " in "
+              << decoder.get_segment_count() << " segments\n";
+    std::cout << "Total samples written: " << wav_writer.get_samples_written() << "\n";
+    std::cout << "Output file: " << output_file << "\n";
+    return 0;
+}
+
 int main(int argc, char* argv[]) {
     try {
-        if (argc != 3) {
+        int arg = 1;
+        long threads = 0;
+        if (argc == 5 && std::strcmp(argv[1], "--threads") == 0) {
+            threads = std::strtol(argv[2], nullptr, 10);
+            arg = 3;
+        }
+        if (argc - arg != 2 || (arg == 3 && (threads < 1 || threads > 255))) {
             print_usage(argv[0]);
             return 1;
         }
 
-        const char* input_file = argv[1];
-        const char* output_file = argv[2];
+        const char* input_file = argv[arg];
+        const char* output_file = argv[arg + 1];
+
+        if (threads > 0) {
+            return convert_segmented(input_file, output_file, static_cast<uint8_t>(threads));
+        }
 
         // Open input file
         std::ifstream input(input_file, std::ios::binary);
@@ -47,12 +47,17 @@ struct DataChunk {
 #pragma pack(pop)
 
 WavWriter::WavWriter(const std::string& filename, uint32_t sample_rate, uint16_t num_channels,
-                     uint16_t bits_per_sample)
+                     uint16_t bits_per_sample, size_t buffer_size)
     : file_(fopen(filename.c_str(), "wb")),
       sample_rate_(sample_rate),
       num_channels_(num_channels),
       bits_per_sample_(bits_per_sample) {
     if (file_) {
+        // setvbuf() must come before the first write
+        if (buffer_size > 0) {
+            buffer_.reset(new char[buffer_size]);
+            setvbuf(file_, buffer_.get(), _IOFBF, buffer_size);
+        }
         write_header();
     }
 }
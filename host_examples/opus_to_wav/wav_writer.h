@@ -21,6 +21,7 @@
 
 #include <cstdint>
 #include <cstdio>
+#include <memory>
 #include <string>
 
 class WavWriter {
@@ -32,9 +33,11 @@ public:
      * @param sample_rate Sample rate in Hz
      * @param num_channels Number of channels (1=mono, 2=stereo)
      * @param bits_per_sample Bits per sample (typically 16)
+     * @param buffer_size Bytes of write buffering (0 = the stdio default). Larger buffers turn
+     *                    many small frame writes into a few large ones.
      */
     WavWriter(const std::string& filename, uint32_t sample_rate, uint16_t num_channels,
-              uint16_t bits_per_sample = 16);
+              uint16_t bits_per_sample = 16, size_t buffer_size = 0);
 
     /**
      * @brief Destroy the WAV Writer and finalize the file
@@ -76,6 +79,8 @@ private:
     void write_header();
     void update_header();
 
+    // Stream buffer given to setvbuf(), if any; the destructor closes file_ before freeing it
+    std::unique_ptr<char[]> buffer_;
     FILE* file_;
     uint32_t sample_rate_;
     uint16_t num_channels_;
@@ -0,0 +1,194 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file decoder_pool.h
+/// @brief Pool of idle libopus decoder states for fast stream switching
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Forward declarations of the libopus C decoder handles to avoid exposing opus.h.
+struct OpusDecoder;
+struct OpusMSDecoder;
+
+namespace micro_opus {
+
+/**
+ * @brief Bounded pool of pre-initialized libopus decoder states
+ *
+ * Creating a libopus decoder allocates and initializes tens of kilobytes of state, which dominates
+ * the start-up cost of a short stream. A DecoderPool keeps decoder states that finished streams
+ * have returned, keyed by output format, and hands a matching one to the next stream instead of
+ * creating a new one. Returned states are cleared with OPUS_RESET_STATE and set back to unity
+ * gain, so a pooled state decodes exactly like a freshly created one.
+ *
+ * Attach a pool with OpusPacketDecoder::set_decoder_pool() or OggOpusDecoder::set_decoder_pool().
+ * The decoder then takes its libopus state from the pool when it starts decoding and gives it back
+ * when it is destroyed (and, for OggOpusDecoder, on reset()). Formats are matched on sample rate
+ * and channel count, plus the stream counts and channel mapping table for multistream (channel
+ * mapping family 1) streams of up to MAX_MAPPING_CHANNELS channels. Larger multistream layouts
+ * bypass the pool.
+ *
+ * The pool holds at most capacity() idle states. When a state comes back to a full pool, the
+ * least recently returned idle state is destroyed to make room, so the pool follows the formats
+ * in current use. preload() fills it up front so even the first stream of a format starts without
+ * allocating.
+ *
+ * For the lowest start-up cost, also reuse one OggOpusDecoder across streams with reset(): that
+ * keeps its Ogg demuxer buffers, and the pool then supplies the libopus state.
+ *
+ * @note Thread Safety: The pool itself is thread-safe, so decoders on different tasks can share
+ *       one. The pool must outlive every decoder attached to it.
+ *
+ * Example:
+ * @code
+ * micro_opus::DecoderPool pool(2);
+ * pool.preload(48000, 2);
+ *
+ * micro_opus::OggOpusDecoder decoder;
+ * decoder.set_decoder_pool(&pool);
+ * for (const Clip& clip : clips) {
+ *     play(decoder, clip);  // decode() until the clip ends
+ *     decoder.reset();      // state goes back to the pool for the next clip
+ * }
+ * @endcode
+ */
+class DecoderPool {
+public:
+    /// @brief Default number of idle states kept
+    static constexpr size_t DEFAULT_CAPACITY = 4;
+
+    /// @brief Largest multistream channel count the pool keys on (channel mapping family 1 limit)
+    static constexpr uint8_t MAX_MAPPING_CHANNELS = 8;
+
+    /// @brief Construct an empty pool
+    ///
+    /// Allocates the bookkeeping for @p capacity entries; no decoder state is created until
+    /// preload() or a decoder returns one.
+    ///
+    /// @param capacity Maximum number of idle decoder states kept (at least 1)
+    explicit DecoderPool(size_t capacity = DEFAULT_CAPACITY);
+
+    /// @brief Destroy all idle decoder states
+    ~DecoderPool();
+
+    // Non-copyable, non-movable: decoders hold a pointer to the pool.
+    DecoderPool(const DecoderPool&) = delete;
+    DecoderPool& operator=(const DecoderPool&) = delete;
+    DecoderPool(DecoderPool&&) = delete;
+    DecoderPool& operator=(DecoderPool&&) = delete;
+
+    /// @brief Create an idle mono/stereo decoder state ahead of time
+    ///
+    /// @param sample_rate Output sample rate in Hz (8000, 12000, 16000, 24000, or 48000)
+    /// @param channels Output channel count (1 or 2)
+    /// @return true if the state was created and pooled; false on invalid arguments or allocation
+    ///         failure
+    bool preload(uint32_t sample_rate, uint8_t channels);
+
+    /// @brief Create an idle multistream decoder state ahead of time
+    ///
+    /// Arguments match the OpusHead of the streams to be decoded (with @p channels the output
+    /// channel count).
+    ///
+    /// @param sample_rate Output sample rate in Hz
+    /// @param channels Output channel count (at most MAX_MAPPING_CHANNELS)
+    /// @param stream_count Number of Opus streams
+    /// @param coupled_count Number of coupled (stereo) streams
+    /// @param mapping Channel mapping table, @p channels entries
+    /// @return true if the state was created and pooled; false on invalid arguments, a layout too
+    ///         large to pool, or allocation failure
+    bool preload_multistream(uint32_t sample_rate, uint8_t channels, uint8_t stream_count,
+                             uint8_t coupled_count, const uint8_t* mapping);
+
+    /// @brief Destroy all idle decoder states (states in use are unaffected)
+    void clear();
+
+    /// @brief Maximum number of idle states kept
+    /// @return Capacity given to the constructor
+    size_t capacity() const {
+        return this->capacity_;
+    }
+
+    /// @brief Number of idle states currently pooled
+    /// @return Idle state count
+    size_t idle_count() const;
+
+private:
+    friend class OpusPacketDecoder;
+    friend class OggOpusDecoder;
+
+    // Output format a decoder state was created for
+    struct Key {
+        uint32_t sample_rate;
+        uint8_t channels;
+        uint8_t stream_count;   // 0 for a mono/stereo (OpusDecoder) state
+        uint8_t coupled_count;
+        uint8_t mapping[MAX_MAPPING_CHANNELS];
+
+        bool operator==(const Key& other) const;
+    };
+
+    struct Entry {
+        Key key;
+        OpusDecoder* decoder;       // Set for mono/stereo states
+        OpusMSDecoder* ms_decoder;  // Set for multistream states
+        uint32_t returned;          // release_sequence_ when pooled, for eviction
+    };
+
+    // Key for a mono/stereo state
+    static Key make_key(uint32_t sample_rate, uint8_t channels);
+
+    // Key for a multistream state; returns false if the layout is too large to pool
+    static bool make_multistream_key(uint32_t sample_rate, uint8_t channels, uint8_t stream_count,
+                                     uint8_t coupled_count, const uint8_t* mapping, Key& key);
+
+    // Take a matching idle state, or create one. Returns nullptr with a libopus error code in
+    // error if creation fails.
+    OpusDecoder* acquire(uint32_t sample_rate, uint8_t channels, int& error);
+    OpusMSDecoder* acquire_multistream(uint32_t sample_rate, uint8_t channels,
+                                       uint8_t stream_count, uint8_t coupled_count,
+                                       const uint8_t* mapping, int& error);
+
+    // Reset a state and keep it idle, evicting the least recently returned one if full
+    void release(OpusDecoder* decoder, uint32_t sample_rate, uint8_t channels);
+    void release_multistream(OpusMSDecoder* decoder, uint32_t sample_rate, uint8_t channels,
+                             uint8_t stream_count, uint8_t coupled_count, const uint8_t* mapping);
+
+    // Remove and return the idle entry matching key. Caller holds mutex_.
+    bool take(const Key& key, Entry& entry);
+
+    // Store a reset state, evicting if full. Caller holds mutex_.
+    void put(const Key& key, OpusDecoder* decoder, OpusMSDecoder* ms_decoder);
+
+    // Destroy the libopus state held by an entry
+    static void destroy(Entry& entry);
+
+    mutable std::mutex mutex_;
+
+    // Idle entries, entries_[0..idle_count_)
+    std::unique_ptr<Entry[]> entries_;
+
+    size_t capacity_;
+    size_t idle_count_{0};
+
+    // Incremented every time a state is pooled, to find the one idle longest
+    uint32_t release_sequence_{0};
+};
+
+}  // namespace micro_opus
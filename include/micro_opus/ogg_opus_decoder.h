@@ -25,6 +25,10 @@
 
 #include <memory>
 
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+#include "micro_opus/profile_stats.h"
+#endif
+
 // Forward declarations to avoid exposing implementation details
 struct OpusMSDecoder;
 
@@ -42,7 +46,10 @@ constexpr uint32_t OPUS_DEFAULT_SAMPLE_RATE = 48000;  // Opus always decodes at
 
 // Forward declarations
 struct OpusHead;
+class DecoderPool;
+class OggOpusReader;
 class OpusPacketDecoder;
+class ParallelMultistreamDecoder;
 
 /**
  * @brief Result codes for OggOpusDecoder operations
@@ -159,6 +166,9 @@ public:
      *                    Lower rates reduce CPU usage but lose high-frequency content.
      * @param channels Output channel count. 0 = use file's channel count (default).
      *                 1 = mono, 2 = stereo. The Opus decoder handles mixing/duplication.
+     *                 In fixed-format builds (OPUS_FIXED_OUTPUT_FORMAT), 0 selects the
+     *                 fixed count, and streams needing any other format or a multistream
+     *                 decoder are rejected with OGG_OPUS_INPUT_INVALID.
      *
      * @note This constructor is guaranteed not to fail. Resource allocation is
      *       deferred to decode(), where any of the early calls can return
@@ -220,10 +230,77 @@ public:
      *       output_size >= samples_per_frame * 2 channels * 2 bytes.
      * @note Can handle arbitrarily small input chunks (even 1 byte at a time)
      *       thanks to internal header staging buffer.
+     * @note A packet held back by decode_many() is decoded first, consuming no
+     *       input.
      */
     OggOpusResult decode(const uint8_t* input, size_t input_len, uint8_t* output,
                          size_t output_size, size_t& bytes_consumed, size_t& samples_decoded);
 
+    /**
+     * @brief Decode as many audio packets as fit in the output buffer in one call
+     *
+     * Batch form of decode() for streams of short packets (2.5-10 ms), where the per-call
+     * overhead of decode() and the caller's loop is comparable to the decode itself. Demuxes
+     * and decodes packets from @p input back to back into @p output until the input runs out,
+     * the next packet does not fit in the rest of the output, @p max_packets is reached or the
+     * stream ends.
+     *
+     * A packet that was demuxed but did not fit is held (copied) by the decoder and decoded
+     * first by the next decode() or decode_many() call, so unlike with decode() nothing is lost
+     * to OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL: call again with a buffer of at least
+     * get_required_output_buffer_size().
+     *
+     * @param input Pointer to input Ogg Opus data (must not be nullptr)
+     * @param input_len Number of bytes available in input
+     * @param output Output buffer for interleaved 16-bit PCM (see decode())
+     * @param output_size Number of bytes available in output buffer
+     * @param bytes_consumed [OUT] Number of input bytes consumed
+     * @param samples_decoded [OUT] Total PCM samples decoded per channel, across all packets
+     * @param packets_decoded [OUT] Number of audio packets decoded
+     * @param packet_samples [OUT] Optional: samples per channel of each decoded packet, in
+     *                       order, i.e. the packet boundaries within output
+     * @param max_packets Stop after this many packets; 0 = no limit. Required (the capacity of
+     *                    packet_samples) when packet_samples is given.
+     *
+     * @return OggOpusResult result code
+     *         - OGG_OPUS_OK: Success; samples_decoded == 0 means more input is needed
+     *         - OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL: Not even the first packet fit; it is held
+     *         - Other errors as for decode(). The packets decoded before the error are still
+     *           reported in samples_decoded, packets_decoded and packet_samples.
+     */
+    OggOpusResult decode_many(const uint8_t* input, size_t input_len, uint8_t* output,
+                              size_t output_size, size_t& bytes_consumed, size_t& samples_decoded,
+                              size_t& packets_decoded, size_t* packet_samples = nullptr,
+                              size_t max_packets = 0);
+
+    /**
+     * @brief Decode Ogg Opus data pulled from a reader
+     *
+     * Pull-model alternative to the decode() above: rather than the caller passing in chunks
+     * and advancing by bytes_consumed, the decoder asks @p reader for what it needs. It peeks
+     * the 27-byte page header, then the lacing table, then the whole rest of the page, and
+     * demuxes the page from the memory the reader returns. When the reader can hand out each
+     * page contiguously, packets that do not span pages are decoded without ever being copied.
+     * Bytes are skipped in the reader as they are consumed.
+     *
+     * Like decode(), returns after at most one audio packet, running through header packets
+     * and empty pages on the way.
+     *
+     * @param reader Source of the stream (see OggOpusReader)
+     * @param output Pointer to output buffer for PCM samples (see decode())
+     * @param output_size Number of bytes available in output buffer
+     * @param samples_decoded [OUT] Number of PCM samples decoded (per channel)
+     *
+     * @return OggOpusResult result code, as for decode(). OGG_OPUS_OK with samples_decoded of
+     *         0 means the reader ran out of data: the end of the stream, or call again once
+     *         more has arrived.
+     *
+     * @note Use one model per stream: switching between this and the push decode() is only
+     *       safe after reset().
+     */
+    OggOpusResult decode(OggOpusReader& reader, uint8_t* output, size_t output_size,
+                         size_t& samples_decoded);
+
     /**
      * @brief Get the sample rate of the decoded audio
      *
@@ -309,7 +386,8 @@ public:
      *
      * Resets all internal state, allowing the decoder to be reused for a new
      * stream. The OggDemuxer and its buffers are preserved for reuse, but the
-     * Opus decoder state is dropped and rebuilt from the next stream's OpusHead.
+     * Opus decoder state is dropped (or returned to the decoder pool, see
+     * set_decoder_pool()) and rebuilt from the next stream's OpusHead.
      * Because of that rebuild, a subsequent decode() can still return
      * OGG_OPUS_ALLOCATION_FAILED (for mono/stereo, on the first audio packet).
      *
@@ -318,6 +396,152 @@ public:
      */
     void reset();
 
+    /**
+     * @brief Take the Opus decoder state from a pool instead of creating it
+     *
+     * With a pool attached, each stream takes a pre-initialized libopus state
+     * matching its output format from @p pool, and reset() or the destructor
+     * returns it there. Combined with reusing this decoder through reset(),
+     * which keeps the demuxer buffers, a new stream starts without allocating.
+     *
+     * Takes effect from the next stream's OpusHead; call it before the first
+     * decode() or right after reset().
+     *
+     * @param pool Pool to use, or nullptr to create and free the state directly
+     *             (the default). Must outlive this decoder.
+     */
+    void set_decoder_pool(DecoderPool* pool);
+
+    /**
+     * @brief Decode multistream elementary streams on several cores
+     *
+     * A channel mapping family 1 or 255 packet carries one elementary Opus
+     * stream per mono or coupled stereo pair, which libopus decodes one after
+     * another. With @p workers above 1, the packet is split into its streams
+     * instead, and they are decoded on @p workers tasks at once: the calling
+     * task and workers - 1 helper tasks pinned to the following cores (on
+     * ESP-IDF), started with the first such stream. The output is identical
+     * to the serial decode.
+     *
+     * Takes effect from the next stream's OpusHead; mono/stereo streams
+     * (family 0) are unaffected. The parallel path creates its own per-stream
+     * decoder states rather than taking them from the decoder pool, and the
+     * profiling counters only cover streams decoded on the calling task.
+     *
+     * @param workers Number of tasks to decode on; 0 or 1 decodes serially
+     *                with libopus (the default). Ignored in the
+     *                NONTHREADSAFE_PSEUDOSTACK allocation mode, where libopus
+     *                may only run on one task. With the shared pseudostack
+     *                pool, capped at its size (OPUS_PSEUDOSTACK_POOL_COUNT);
+     *                a helper that finds the pool taken decodes on its own
+     *                pseudostack instead of waiting.
+     */
+    void set_multistream_workers(uint8_t workers);
+
+    /**
+     * @brief Zero-fill silent packets instead of decoding them
+     *
+     * Voice streams with DTX carry long runs of 1-byte packets that libopus
+     * turns into comfort noise at the cost of a full decode. With @p enable,
+     * such packets, and CELT frames coded as silence, are written as zeros
+     * once 20 ms of them has been decoded normally; see
+     * OpusPacketDecoder::set_silence_mode() with OPUS_SILENCE_ZERO_FILL.
+     * Sample counts, pre-skip and granule positions are unaffected.
+     *
+     * Multistream streams (family 1 and 255) apply this per elementary
+     * stream, so a silent channel pair is skipped while the others decode;
+     * they are then decoded by the per-stream decoder of
+     * set_multistream_workers(), serially with fewer than 2 workers, and
+     * the silent channels are reported by get_silent_channel_mask().
+     *
+     * Takes effect immediately for mono/stereo streams, and from the next
+     * stream's OpusHead for multistream streams.
+     *
+     * @param enable true to zero-fill silent packets, false to decode them
+     *               with libopus (the default, bit-exact)
+     */
+    void set_skip_silence(bool enable);
+
+    /**
+     * @brief Leave silent channels unwritten instead of zero-filling them
+     *
+     * With set_skip_silence() enabled, a channel whose packet was skipped is
+     * normally written as zeros. With @p enable false those channels are
+     * left untouched in the output buffer instead, saving the writes; the
+     * caller must then consult get_silent_channel_mask() and treat the
+     * flagged channels as silence (e.g. skip them when mixing). Unmapped
+     * multistream channels (mapping 255) are left untouched as well.
+     *
+     * Takes effect from the next stream's OpusHead.
+     *
+     * @param enable true to write zeros for silent channels (the default)
+     */
+    void set_write_silent_channels(bool enable);
+
+    /**
+     * @brief Whether the last audio packet decoded was silent
+     *
+     * Only tracked while set_skip_silence() is enabled, and for mono/stereo
+     * streams. Unlike get_silent_channel_mask(), this includes the first
+     * 20 ms of a silent run, which is still decoded normally.
+     *
+     * @return true if every frame of the last audio packet was DTX or
+     *         silence
+     */
+    bool is_last_packet_silent() const;
+
+    /**
+     * @brief Output channels that are digital silence in the last audio
+     *        packet
+     *
+     * Bit c is set when output channel c of the last decoded audio packet
+     * was skipped by set_skip_silence(), or is an unmapped multistream
+     * channel (mapping 255, with set_skip_silence() or
+     * set_multistream_workers() in use). Flagged channels are all zeros, or
+     * untouched with set_write_silent_channels(false), so downstream stages
+     * can skip them. Channels from 64 on are never flagged.
+     *
+     * @return Silent channel bitmask, 0 before the first audio packet
+     */
+    uint64_t get_silent_channel_mask() const;
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    /**
+     * @brief Get the profiling counters recorded by this decoder
+     *
+     * Covers every audio packet decoded since construction or the last
+     * reset_profile_stats(), for both mono/stereo and multistream streams.
+     * Demuxing and header parsing are not included. Stage groups are filled
+     * only for the instrumentation compiled in (see OPUS_ENABLE_*_TIMING in
+     * Kconfig); the others stay zero.
+     *
+     * @return Snapshot of the counters, with tick_rate_hz and the latency
+     *         percentiles filled in
+     *
+     * @note Only available when built with MICRO_OPUS_ENABLE_PROFILING
+     */
+    OpusProfileStats get_profile_stats() const;
+
+    /**
+     * @brief Zero the profiling counters
+     *
+     * reset() leaves the counters alone, so a measurement can span several
+     * streams. The latency deadline is kept.
+     */
+    void reset_profile_stats();
+
+    /**
+     * @brief Set the per-packet latency deadline
+     *
+     * Audio packets that take longer to decode are counted in
+     * latency.deadline_misses. Converted to ticks at the current timer rate
+     * (the CPU clock on ESP-IDF).
+     *
+     * @param deadline_us Deadline in microseconds, or 0 to stop counting misses
+     */
+    void set_profile_deadline_us(uint32_t deadline_us);
+#endif  // MICRO_OPUS_ENABLE_PROFILING
+
 #ifdef MICRO_OGG_DEMUXER_DEBUG
     /**
      * @brief Get debug state from demuxer (for debugging only)
@@ -350,9 +574,20 @@ private:
     OggOpusDecoder(const OggOpusDecoder&) = delete;
     OggOpusDecoder& operator=(const OggOpusDecoder&) = delete;
 
-    // Internal packet processing
-    OggOpusResult process_packet(const micro_ogg::OggPacket& packet, uint8_t* output,
-                                 size_t output_size, size_t& samples_decoded);
+    // PipelinedOggOpusDecoder runs demux_packet() and handle_audio_packet() on separate tasks
+    friend class PipelinedOggOpusDecoder;
+
+    // SegmentedOggOpusDecoder indexes a whole file with demux_packet() and the page checks
+    friend class SegmentedOggOpusDecoder;
+
+    // Demux the next packet, handling OpusHead/OpusTags internally. An audio packet is returned
+    // in audio_packet (valid until the next call) with has_audio_packet set, for
+    // handle_audio_packet().
+    OggOpusResult demux_packet(const uint8_t* input, size_t input_len, size_t& bytes_consumed,
+                               micro_ogg::OggPacket& audio_packet, bool& has_audio_packet);
+
+    // Header packet processing (OpusHead; OpusTags is streamed separately)
+    OggOpusResult process_header_packet(const micro_ogg::OggPacket& packet);
 
     // Page boundary tracking for RFC 7845 packet isolation validation
     void update_page_tracking(bool is_last_on_page);
@@ -365,8 +600,26 @@ private:
     OggOpusResult apply_pre_skip(uint8_t* output, size_t decoded_samples, uint8_t output_channels,
                                  size_t& samples_decoded);
 
-    // Opus decoder creation helper
+    // Copy an audio packet that did not fit into decode_many()'s output, for the next call
+    OggOpusResult hold_pending_packet(const micro_ogg::OggPacket& packet);
+
+    // Decode the held packet; it stays held while it does not fit
+    OggOpusResult decode_pending_packet(uint8_t* output, size_t output_size,
+                                        size_t& samples_decoded);
+
+    // Opus decoder creation and teardown helpers
     OggOpusResult create_opus_decoder(uint8_t output_channels);
+    void destroy_opus_decoder();
+
+    // Bytes of one output frame (one 16-bit sample per output channel). A constant in fixed-format
+    // builds (MICRO_OPUS_FIXED_CHANNELS), where handle_opus_head_packet() refuses other counts.
+    size_t bytes_per_frame() const {
+#ifdef MICRO_OPUS_FIXED_CHANNELS
+        return MICRO_OPUS_FIXED_CHANNELS * sizeof(int16_t);
+#else
+        return output_channels_ * sizeof(int16_t);
+#endif
+    }
 
     // Stream through OpusTags using get_next_data() to avoid internal buffering
     OggOpusResult stream_opus_tags(const uint8_t* input, size_t input_len, size_t& bytes_consumed);
@@ -404,11 +657,31 @@ private:
     // Opus decode backends. Only one is active at a time, selected by channel mapping family:
     // - packet_decoder_ for channel_mapping == 0 (mono/stereo), via the raw-packet decoder
     // - opus_ms_decoder_ for channel_mapping != 0 (multistream with a channel mapping table)
+    // - parallel_ms_decoder_ instead of opus_ms_decoder_ with set_multistream_workers() above 1;
+    //   kept across streams (with its worker tasks) and only re-initialized
     std::unique_ptr<OpusPacketDecoder> packet_decoder_;
     OpusMSDecoder* opus_ms_decoder_{nullptr};
+    std::unique_ptr<ParallelMultistreamDecoder> parallel_ms_decoder_;
+
+    // Pool the Opus decoder state comes from and returns to (nullptr = create/destroy directly)
+    DecoderPool* decoder_pool_{nullptr};
+
+    // decode_many(): copy of an audio packet demuxed but not yet decoded (grown as needed)
+    uint8_t* pending_packet_{nullptr};
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    // --- Struct members ---
+
+    // Profiling counters, bound to the thread around each audio packet decode. Owned here rather
+    // than by packet_decoder_, which is rebuilt for every stream.
+    OpusProfileStats profile_stats_{};
+#endif
 
     // --- 64-bit members ---
 
+    // Output channels of the last audio packet that are digital silence
+    uint64_t silent_channel_mask_{0};
+
     // Pre-skip tracking
     uint64_t samples_decoded_total_{0};
 
@@ -427,6 +700,15 @@ private:
     // Required output buffer size for the last audio packet (in bytes)
     size_t last_required_buffer_bytes_{0};
 
+    // decode_many(): held packet length (0 = none held), buffer capacity and Ogg metadata
+    size_t pending_packet_len_{0};
+    size_t pending_packet_capacity_{0};
+    int64_t pending_granule_position_{0};
+
+    // Pull decode: bytes of the current Ogg page not yet taken from the reader (0 = at a page
+    // boundary, next read is a page header)
+    size_t reader_page_remaining_{0};
+
     // RFC 7845 Section 4: First audio data page granule position validation
     // Tracks total samples that complete on the first audio data page
     // -1 = not yet on first audio page, 0+ = accumulating samples, validated after first page
@@ -451,6 +733,14 @@ private:
     // Resolved output channel count (set after OpusHead parsing)
     uint8_t output_channels_{0};
 
+    // Tasks multistream packets are decoded on (0/1 = serial libopus decode)
+    uint8_t multistream_workers_{0};
+
+    // Zero-fill silent packets, and write zeros for silent channels (from set_skip_silence() and
+    // set_write_silent_channels())
+    bool skip_silence_{false};
+    bool write_silent_channels_{true};
+
     // Pre-skip tracking
     bool pre_skip_applied_{false};
 
@@ -466,6 +756,10 @@ private:
     // RFC 7845 Section 4: Track packets per page for isolation validation
     uint8_t packets_on_current_page_{0};
 
+    // decode_many(): Ogg flags of the held packet
+    bool pending_is_eos_{false};
+    bool pending_is_last_on_page_{false};
+
     // RFC 7845 Section 3: End of stream validation
     // "There MUST NOT be any more pages in an Opus logical bitstream after a page marked 'end of
     // stream'."
@@ -0,0 +1,140 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file ogg_opus_reader.h
+/// @brief Pull-model input sources for OggOpusDecoder
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+namespace micro_opus {
+
+/// @brief Largest possible Ogg page: 27-byte header, 255 lacing values, 255 * 255 body bytes
+constexpr size_t OGG_MAX_PAGE_SIZE = 27 + 255 + 255 * 255;
+
+/**
+ * @brief Source of Ogg Opus bytes that OggOpusDecoder pulls from
+ *
+ * With decode(OggOpusReader&, ...), the decoder asks the reader for exactly the bytes it needs
+ * next: a page header, then the lacing table, then the rest of the page. A reader that already
+ * holds the data (a memory-mapped file, a DMA or cache buffer, an HTTP receive buffer) returns a
+ * pointer into it, and the decoder demuxes straight from that memory. Packets that lie within
+ * one page are then never copied.
+ *
+ * Implement peek() and skip() directly to hand out your own buffers, or derive from
+ * OggOpusBufferedReader and implement only read().
+ */
+class OggOpusReader {
+public:
+    virtual ~OggOpusReader() = default;
+
+    /**
+     * @brief Look at the next bytes without consuming them
+     *
+     * @param bytes Bytes the decoder wants, contiguous from the current position
+     * @param available [OUT] Bytes readable at the returned pointer. More than @p bytes is fine;
+     *                  fewer means the source has no more for now (end of stream, or data still
+     *                  in flight) or cannot hold that many contiguously. The decoder then works
+     *                  with what it got and buffers any partial packet internally.
+     *
+     * @return Pointer to the bytes, valid until the next peek() or skip(); nullptr when
+     *         available is 0
+     */
+    virtual const uint8_t* peek(size_t bytes, size_t& available) = 0;
+
+    /**
+     * @brief Consume bytes from the front
+     *
+     * @param bytes Never more than the last peek() made available. A file reader can back this
+     *              with a seek when the bytes were never loaded.
+     */
+    virtual void skip(size_t bytes) = 0;
+};
+
+/**
+ * @brief Reader over a buffer that already holds the whole stream (or all of it received so far)
+ *
+ * Never copies: every peek() returns a pointer into the buffer.
+ */
+class OggOpusMemoryReader : public OggOpusReader {
+public:
+    OggOpusMemoryReader(const uint8_t* data, size_t size) : data_(data), size_(size) {}
+
+    const uint8_t* peek(size_t /*bytes*/, size_t& available) override {
+        available = this->size_ - this->position_;
+        return (available > 0) ? this->data_ + this->position_ : nullptr;
+    }
+
+    void skip(size_t bytes) override {
+        this->position_ += bytes;
+    }
+
+    /// @brief Bytes consumed so far
+    size_t get_position() const {
+        return this->position_;
+    }
+
+private:
+    const uint8_t* data_;
+    size_t size_;
+    size_t position_{0};
+};
+
+/**
+ * @brief Reader for sources that can only copy data out (files, sockets)
+ *
+ * Keeps one buffer, grown on demand up to the largest peek() (at most max_buffer_size), and
+ * fills it with read(). Bytes are copied once, from the source into the buffer; the decoder then
+ * demuxes from the buffer without re-presenting unconsumed tails.
+ *
+ * @note Memory: the buffer is allocated on the first peek(), preferring PSRAM on ESP-IDF like the
+ *       decoder's own buffers. It usually settles at the largest page in the stream.
+ */
+class OggOpusBufferedReader : public OggOpusReader {
+public:
+    /**
+     * @param max_buffer_size Largest buffer to grow to. Pages larger than this still decode, with
+     *                        the decoder buffering the pieces; the default fits any page.
+     */
+    explicit OggOpusBufferedReader(size_t max_buffer_size = OGG_MAX_PAGE_SIZE);
+    ~OggOpusBufferedReader() override;
+
+    const uint8_t* peek(size_t bytes, size_t& available) override;
+    void skip(size_t bytes) override;
+
+protected:
+    /**
+     * @brief Copy up to @p len bytes from the source into @p dst
+     *
+     * @return Bytes copied; 0 at end of stream or when nothing is available yet
+     */
+    virtual size_t read(uint8_t* dst, size_t len) = 0;
+
+private:
+    // Disable copy and assignment
+    OggOpusBufferedReader(const OggOpusBufferedReader&) = delete;
+    OggOpusBufferedReader& operator=(const OggOpusBufferedReader&) = delete;
+
+    uint8_t* buffer_{nullptr};
+    size_t capacity_{0};
+    size_t max_buffer_size_;
+
+    // Unconsumed bytes are buffer_[start_, end_)
+    size_t start_{0};
+    size_t end_{0};
+};
+
+}  // namespace micro_opus
@@ -20,11 +20,20 @@
 #include <cstddef>
 #include <cstdint>
 
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+#include "micro_opus/profile_stats.h"
+#endif
+
 // Forward declaration of the libopus C decoder handle to avoid exposing opus.h.
 struct OpusDecoder;
+// CELT-only decoder state (OPUS_STREAM_CELT_ONLY), built with libopus' CELT sources
+struct MicroOpusCeltDecoder;
 
 namespace micro_opus {
 
+class DecoderPool;
+struct OpusPacketInfo;
+
 // ============================================================================
 // Public Types
 // ============================================================================
@@ -39,8 +48,8 @@ namespace micro_opus {
 /// This is a pre-framed decoder: the output format is supplied at construction (so there is no
 /// "format ready" event), each call consumes exactly one complete packet (so input is never
 /// "incomplete"), and there is no container to signal end-of-stream. It therefore returns only
-/// OPUS_PACKET_DECODER_SUCCESS or an error; the canonical streaming/informational codes do not
-/// apply.
+/// OPUS_PACKET_DECODER_SUCCESS, OPUS_PACKET_DECODER_SILENCE (only with OPUS_SILENCE_REPORT, see
+/// set_silence_mode()) or an error; the canonical streaming/informational codes do not apply.
 ///
 /// Error checking pattern:
 /// - Use `result < 0` to check for errors
@@ -48,6 +57,7 @@ namespace micro_opus {
 enum OpusPacketResult : int8_t {
     // Success / informational (>= 0)
     OPUS_PACKET_DECODER_SUCCESS = 0,  // Packet decoded (check bytes_written output parameter)
+    OPUS_PACKET_DECODER_SILENCE = 1,  // Silent packet, no PCM written; see get_silent_samples()
 
     // Errors (< 0)
     OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL =
@@ -58,6 +68,38 @@ enum OpusPacketResult : int8_t {
     OPUS_PACKET_DECODER_ERROR_DECODE_FAILED = -4  // libopus rejected the packet (corrupt/invalid)
 };
 
+/// @brief How OpusPacketDecoder::decode() handles packets that carry no audio
+///
+/// A packet is silent when every frame in it is a DTX frame (0 or 1 bytes) or a CELT frame with
+/// its silence flag set; see OpusPacketInfo::is_silent().
+enum OpusSilenceMode : uint8_t {
+    OPUS_SILENCE_DECODE = 0,     // Decode silent packets like any other (default)
+    OPUS_SILENCE_ZERO_FILL = 1,  // Write zeros for silent packets without running libopus
+    OPUS_SILENCE_REPORT = 2,     // Write nothing; return OPUS_PACKET_DECODER_SILENCE instead
+};
+
+/// @brief Which Opus coding modes a stream uses, fixed at construction
+///
+/// Encoders running OPUS_APPLICATION_RESTRICTED_LOWDELAY only ever emit CELT packets. For such
+/// streams OPUS_STREAM_CELT_ONLY decodes with a bare CELT decoder state: no SILK decoder, no
+/// SILK resampler and no SILK/hybrid/CELT mode-switching bookkeeping, so the state is smaller and
+/// each frame skips the mode-transition checks. The output is bit-exact with the default decoder
+/// for CELT-only streams.
+enum OpusStreamModes : uint8_t {
+    OPUS_STREAM_ANY_MODE = 0,   // SILK, hybrid and CELT packets (default)
+    OPUS_STREAM_CELT_ONLY = 1,  // CELT packets only; SILK and hybrid packets fail to decode
+};
+
+/// @brief One packet of a decode_batch() call
+///
+/// A lost packet (a gap the jitter buffer or transport detected) is concealed instead of decoded;
+/// its data and length are ignored.
+struct OpusPacketSpan {
+    const uint8_t* data{nullptr};  // Complete Opus packet
+    size_t length{0};              // Packet size in bytes
+    bool lost{false};              // Synthesize packet-loss concealment audio in its place
+};
+
 /// @brief Format of the PCM that decode() produces
 ///
 /// Describes the decoder's output, not a source file: a raw Opus stream carries no OpusHead, so the
@@ -193,7 +235,12 @@ public:
     ///                    48000 (the rates Opus can decode to); other values are rejected on the
     ///                    first decode() call. Default 48000 (native Opus rate).
     /// @param channels Output channel count: 1 (mono) or 2 (stereo). Default 2.
-    explicit OpusPacketDecoder(uint32_t sample_rate = DEFAULT_SAMPLE_RATE, uint8_t channels = 2);
+    /// @param stream_modes Coding modes the stream uses. OPUS_STREAM_CELT_ONLY allocates only a
+    ///                     CELT decoder state, for restricted-lowdelay streams; a SILK or hybrid
+    ///                     packet then returns OPUS_PACKET_DECODER_ERROR_DECODE_FAILED, and
+    ///                     set_decoder_pool() is ignored (pools hold full libopus states).
+    explicit OpusPacketDecoder(uint32_t sample_rate = DEFAULT_SAMPLE_RATE, uint8_t channels = 2,
+                               OpusStreamModes stream_modes = OPUS_STREAM_ANY_MODE);
 
     /// @brief Destroy the decoder and free the libopus decoder state
     ~OpusPacketDecoder();
@@ -230,6 +277,60 @@ public:
     /// @param output_gain Output gain in Q7.8 dB units (0 = unity gain)
     void set_output_gain(int16_t output_gain);
 
+    /// @brief Take the libopus decoder state from a pool instead of creating it
+    ///
+    /// With a pool attached, the first decode() takes a pre-initialized state matching this
+    /// decoder's sample rate and channel count from @p pool (creating one only if none is idle),
+    /// and the destructor returns it there instead of freeing it. Attach the pool before the first
+    /// decode(); a state that already exists is returned to whichever pool is attached when the
+    /// decoder is destroyed.
+    ///
+    /// @param pool Pool to use, or nullptr to create and free the state directly (the default).
+    ///             Must outlive this decoder.
+    void set_decoder_pool(DecoderPool* pool) {
+        this->decoder_pool_ = pool;
+    }
+
+    /// @brief Skip libopus for silent packets (DTX and CELT silence)
+    ///
+    /// Voice streams with DTX send long runs of 1-byte packets, which libopus decodes into
+    /// concealment or comfort noise at full cost. With a mode other than OPUS_SILENCE_DECODE,
+    /// decode() inspects each packet with parse_opus_packet_info() (about 0.5 KB of stack) and,
+    /// once 20 ms of consecutive silent packets has been decoded normally to let the previous
+    /// audio fade out, handles further silent packets without libopus:
+    /// - OPUS_SILENCE_ZERO_FILL writes zeros and returns OPUS_PACKET_DECODER_SUCCESS
+    /// - OPUS_SILENCE_REPORT writes nothing and returns OPUS_PACKET_DECODER_SILENCE; the packet's
+    ///   duration is get_silent_samples(), and the output buffer may be any size
+    ///
+    /// The libopus state is reset when skipping starts, so the audio that follows decodes as if
+    /// after digital silence. The output is therefore not bit-exact with OPUS_SILENCE_DECODE:
+    /// comfort noise becomes true silence. decode_batch() always decodes with libopus.
+    ///
+    /// @param mode Silence handling; takes effect from the next decode()
+    void set_silence_mode(OpusSilenceMode mode) {
+        this->silence_mode_ = mode;
+    }
+
+    /// @brief Whether the last decode() call's packet was silent
+    ///
+    /// Set for every packet decode() handles while a silence mode other than OPUS_SILENCE_DECODE
+    /// is selected, whether or not libopus was skipped for it; always false otherwise.
+    bool is_last_packet_silent() const {
+        return this->last_packet_silent_;
+    }
+
+    /// @brief Whether the last decode() call skipped libopus for a silent packet
+    ///
+    /// Its output (if any, see set_silence_mode()) is then exact digital silence.
+    bool is_last_packet_skipped() const {
+        return this->last_packet_silent_ && this->silence_skipping_;
+    }
+
+    /// @brief Samples per channel of the silent packet behind the last OPUS_PACKET_DECODER_SILENCE
+    size_t get_silent_samples() const {
+        return this->last_packet_silent_ ? this->last_frame_samples_ : 0;
+    }
+
     // ========================================
     // Core Decoding API
     // ========================================
@@ -259,6 +360,23 @@ public:
     OpusPacketResult decode(const uint8_t* input, size_t input_len, uint8_t* output,
                             size_t output_size_bytes, size_t& bytes_written);
 
+    /// @brief Decode a packet already inspected with parse_opus_packet_info()
+    ///
+    /// Same as decode(info.packet, info.packet_len, ...), but the packet's duration is taken from
+    /// @p info instead of querying the TOC again. For routing layers that parse each packet first
+    /// (to pick a decoder, drop silence, or account for duration) and then decode it.
+    ///
+    /// @param info Packet description from a successful parse_opus_packet_info() call; the packet
+    ///             it points at must still be valid
+    /// @param output Pointer to the output buffer (must not be nullptr), aligned for int16_t access
+    /// @param output_size_bytes Number of bytes available in the output buffer
+    /// @param[out] bytes_written Number of PCM bytes written (total across all channels). Set to 0
+    ///                           on any error.
+    ///
+    /// @return OPUS_PACKET_DECODER_SUCCESS, or a negative error code; see OpusPacketResult
+    OpusPacketResult decode(const OpusPacketInfo& info, uint8_t* output, size_t output_size_bytes,
+                            size_t& bytes_written);
+
     /// @brief Synthesize concealment audio for a lost packet (packet-loss concealment)
     ///
     /// When a packet is known to be lost, call this in its place to let libopus extrapolate one
@@ -279,6 +397,38 @@ public:
     OpusPacketResult conceal_loss(uint8_t* output, size_t output_size_bytes,
                                   size_t frame_size_samples, size_t& bytes_written);
 
+    /// @brief Decode a run of packets back to back into one contiguous output buffer
+    ///
+    /// For bursts of packets, e.g. released together by a jitter buffer or read from a file of
+    /// length-prefixed frames. Equivalent to calling decode() (or conceal_loss() for lost
+    /// packets) once per packet with the output pointer advanced each time, but the arguments,
+    /// decoder state and pseudostack are set up once for the whole batch, and each packet's size
+    /// is checked by libopus as it decodes rather than by a separate TOC query.
+    ///
+    /// A lost packet is concealed with the duration of the packet decoded before it (in this
+    /// batch or an earlier call), or 20 ms if there is none yet.
+    ///
+    /// Decoding stops early at the first packet that does not fit in the rest of the output, or
+    /// at the first error; resubmit from packets[packets_decoded] to continue.
+    ///
+    /// @param packets Packets to decode, in order (must not be nullptr)
+    /// @param packet_count Number of entries in packets (must not be 0)
+    /// @param output Pointer to the output buffer (must not be nullptr), aligned for int16_t
+    /// @param output_size_bytes Number of bytes available in the output buffer
+    /// @param[out] packets_decoded Number of packets decoded (or concealed) into output
+    /// @param[out] bytes_written Number of PCM bytes written across all of those packets
+    /// @param[out] packet_samples Optional: samples per channel written for each decoded packet,
+    ///                            in order (room for packet_count entries)
+    ///
+    /// @return OPUS_PACKET_DECODER_SUCCESS if at least one packet was decoded and decoding stopped
+    ///         only because the batch or the output ran out (check packets_decoded), otherwise
+    ///         the error for packets[packets_decoded]. OUTPUT_BUFFER_TOO_SMALL means not even the
+    ///         first packet fit; get_required_output_bytes() then gives its size.
+    OpusPacketResult decode_batch(const OpusPacketSpan* packets, size_t packet_count,
+                                  uint8_t* output, size_t output_size_bytes,
+                                  size_t& packets_decoded, size_t& bytes_written,
+                                  size_t* packet_samples = nullptr);
+
     // ========================================
     // PCM Format
     // ========================================
@@ -292,6 +442,11 @@ public:
         return this->pcm_format_;
     }
 
+    /// @brief Coding modes the decoder was constructed for (see OpusStreamModes)
+    OpusStreamModes get_stream_modes() const {
+        return this->stream_modes_;
+    }
+
     // ========================================
     // Output Buffer Helpers
     // ========================================
@@ -309,6 +464,36 @@ public:
         return this->required_output_bytes_;
     }
 
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    // ========================================
+    // Profiling
+    // ========================================
+
+    /// @brief Get the profiling counters recorded by this decoder
+    ///
+    /// Counts every decode() and conceal_loss() call since construction or the last
+    /// reset_profile_stats(). Stage groups are filled only for the instrumentation compiled in (see
+    /// OPUS_ENABLE_*_TIMING in Kconfig); the others stay zero. Only available when built with
+    /// MICRO_OPUS_ENABLE_PROFILING.
+    ///
+    /// @return Snapshot of the counters, with tick_rate_hz and the latency percentiles filled in
+    OpusProfileStats get_profile_stats() const;
+
+    /// @brief Zero the profiling counters
+    ///
+    /// reset() leaves the counters alone, so a measurement can span several streams. The latency
+    /// deadline is kept.
+    void reset_profile_stats();
+
+    /// @brief Set the per-call latency deadline
+    ///
+    /// decode() and conceal_loss() calls that take longer are counted in latency.deadline_misses.
+    /// Converted to ticks at the current timer rate (the CPU clock on ESP-IDF).
+    ///
+    /// @param deadline_us Deadline in microseconds, or 0 to stop counting misses
+    void set_profile_deadline_us(uint32_t deadline_us);
+#endif  // MICRO_OPUS_ENABLE_PROFILING
+
 private:
     // ========================================
     // Decode Pipeline
@@ -317,6 +502,58 @@ private:
     /// @brief Create the libopus decoder state on first use (lazy allocation)
     OpusPacketResult ensure_decoder();
 
+    /// @brief Check the output size against @p nb_samples (skipped if <= 0) and decode the packet
+    OpusPacketResult decode_sized(const uint8_t* input, size_t input_len, int nb_samples,
+                                  const OpusPacketInfo* info, uint8_t* output,
+                                  size_t output_size_bytes, size_t& bytes_written);
+
+    /// @brief Decode one packet, or conceal @p max_samples if @p input is nullptr, with the
+    ///        libopus or CELT-only state
+    /// @param info The packet already parsed, or nullptr (CELT-only parses it if needed)
+    /// @return Samples per channel written, or a libopus error code
+    int run_decoder(const uint8_t* input, size_t input_len, const OpusPacketInfo* info,
+                    int16_t* pcm, int max_samples);
+
+    /// @brief Decode a parsed packet frame by frame with the CELT-only state
+    int run_celt_decoder(const OpusPacketInfo& info, int16_t* pcm, int max_samples);
+
+    /// @brief Bytes of one output frame (one 16-bit sample per channel)
+    ///
+    /// A constant in fixed-format builds (MICRO_OPUS_FIXED_CHANNELS), where ensure_decoder()
+    /// refuses any other channel count.
+    size_t bytes_per_frame() const {
+#ifdef MICRO_OPUS_FIXED_CHANNELS
+        return MICRO_OPUS_FIXED_CHANNELS * sizeof(int16_t);
+#else
+        return this->pcm_format_.num_channels_ * sizeof(int16_t);
+#endif
+    }
+
+    /// @brief Output sample rate in Hz, a constant in fixed-format builds
+    ///        (MICRO_OPUS_FIXED_SAMPLE_RATE)
+    uint32_t output_sample_rate() const {
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+        return MICRO_OPUS_FIXED_SAMPLE_RATE;
+#else
+        return this->pcm_format_.sample_rate_;
+#endif
+    }
+
+    /// @brief Whole output frames (samples per channel) that @p bytes of output can hold
+    ///
+    /// A frame is 2 bytes mono or 4 bytes stereo, so this shifts by the channel count instead of
+    /// dividing. Only valid once ensure_decoder() has accepted the channel count.
+    size_t bytes_to_frames(size_t bytes) const {
+        return bytes >> (this->bytes_per_frame() / sizeof(int16_t));
+    }
+
+    /// @brief Clear the decoder state's inter-packet history (OPUS_RESET_STATE)
+    void reset_decoder_state();
+
+    /// @brief Produce a silent packet's output without libopus (see set_silence_mode())
+    OpusPacketResult skip_silence(size_t nb_samples, uint8_t* output, size_t output_size_bytes,
+                                  size_t& bytes_written);
+
     // ========================================
     // Member Variables
     // ========================================
@@ -326,20 +563,50 @@ private:
     // Output PCM format (populated by the constructor)
     PcmFormat pcm_format_{};
 
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    // Profiling counters, bound to the thread around each libopus decode call
+    OpusProfileStats profile_stats_{};
+#endif
+
     // Pointer fields
 
     // libopus decoder handle (created lazily on first decode; nullptr until then)
     OpusDecoder* opus_decoder_{nullptr};
 
+    // CELT-only decoder state, used instead of opus_decoder_ with OPUS_STREAM_CELT_ONLY
+    MicroOpusCeltDecoder* celt_decoder_{nullptr};
+
+    // Pool the decoder state comes from and returns to (nullptr = create/destroy directly)
+    DecoderPool* decoder_pool_{nullptr};
+
     // size_t fields
 
     // Output byte count (all channels) the last packet needs
     size_t required_output_bytes_{0};
 
+    // Samples per channel of the last packet decoded or concealed; decode_batch() conceals lost
+    // packets with this duration (0 = none yet)
+    size_t last_frame_samples_{0};
+
+    // Samples per channel of consecutive silent packets decoded with libopus before skipping
+    size_t silence_run_samples_{0};
+
     // 16-bit fields
 
     // Fixed output gain (Q7.8 dB) applied via OPUS_SET_GAIN; 0 = unity. From set_output_gain().
     int16_t output_gain_{0};
+
+    // 8-bit fields
+
+    // Coding modes the stream uses (from the constructor)
+    OpusStreamModes stream_modes_{OPUS_STREAM_ANY_MODE};
+
+    // Silent packet handling (from set_silence_mode())
+    OpusSilenceMode silence_mode_{OPUS_SILENCE_DECODE};
+
+    // The last decode() packet was silent; the libopus state was reset for the current silent run
+    bool last_packet_silent_{false};
+    bool silence_skipping_{false};
 };
 
 }  // namespace micro_opus
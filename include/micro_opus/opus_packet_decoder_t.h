@@ -0,0 +1,153 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file opus_packet_decoder_t.h
+/// @brief Raw Opus packet decoder with its output format fixed at compile time
+
+#pragma once
+
+#include "micro_opus/opus_packet_decoder.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace micro_opus {
+
+/**
+ * @brief OpusPacketDecoder for one output format known at compile time
+ *
+ * Products that only ever decode one format (e.g. 48 kHz stereo or 16 kHz mono) can name it in the
+ * type instead of passing it to the constructor:
+ * - An unsupported rate or channel count is a compile error rather than a first-decode failure.
+ * - Buffer sizes are constants (MAX_OUTPUT_SAMPLES, PcmBuffer), so output buffers can be static or
+ *   members instead of being sized from get_pcm_format() at runtime.
+ * - decode_frames(), decode_frames(info) and conceal_frames() take and return sizes in samples per
+ *   channel against an int16_t buffer; the conversions to and from the byte-oriented base API use
+ *   the constant BYTES_PER_FRAME and fold to shifts.
+ *
+ * Everything else (configuration, decode_batch(), profiling, the byte-oriented decode()) is
+ * inherited unchanged, and the output is identical to OpusPacketDecoder(SampleRate, Channels,
+ * StreamModes).
+ *
+ * libopus itself stays generic: the CELT and SILK decoders still branch on each packet's coded
+ * channel count, which a stereo stream may switch per packet. A build whose output format is
+ * fixed (OPUS_FIXED_OUTPUT_FORMAT in Kconfig, OPUS_FIXED_SAMPLE_RATE and OPUS_FIXED_CHANNELS on
+ * host) only accepts that format here.
+ *
+ * Example:
+ * @code
+ * using VoiceDecoder = micro_opus::OpusPacketDecoderT<16000, 1>;
+ *
+ * VoiceDecoder decoder;
+ * static VoiceDecoder::PcmBuffer pcm;  // Holds any packet; BUFFER_TOO_SMALL never fires
+ *
+ * size_t frames = 0;
+ * if (decoder.decode_frames(packet, packet_len, pcm.data(), VoiceDecoder::MAX_PACKET_FRAMES,
+ *                           frames) == micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+ *     process_audio(pcm.data(), frames);
+ * }
+ * @endcode
+ *
+ * @tparam SampleRate Output sample rate in Hz: 8000, 12000, 16000, 24000 or 48000
+ * @tparam Channels Output channel count: 1 (mono) or 2 (stereo)
+ * @tparam StreamModes Coding modes the stream uses (see OpusStreamModes)
+ */
+template <uint32_t SampleRate, uint8_t Channels,
+          OpusStreamModes StreamModes = OPUS_STREAM_ANY_MODE>
+class OpusPacketDecoderT : public OpusPacketDecoder {
+    static_assert(SampleRate == 8000 || SampleRate == 12000 || SampleRate == 16000 ||
+                      SampleRate == 24000 || SampleRate == 48000,
+                  "Opus decodes to 8000, 12000, 16000, 24000 or 48000 Hz");
+    static_assert(Channels == 1 || Channels == 2,
+                  "OpusPacketDecoder outputs mono or stereo (channel mapping family 0)");
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+    static_assert(SampleRate == MICRO_OPUS_FIXED_SAMPLE_RATE &&
+                      Channels == MICRO_OPUS_FIXED_CHANNELS,
+                  "this build decodes only its fixed output format (OPUS_FIXED_OUTPUT_FORMAT)");
+#endif
+
+public:
+    /// @brief Output sample rate in Hz
+    static constexpr uint32_t SAMPLE_RATE = SampleRate;
+    /// @brief Output channel count
+    static constexpr uint8_t CHANNELS = Channels;
+    /// @brief Bytes of one output frame (one 16-bit sample per channel)
+    static constexpr size_t BYTES_PER_FRAME = Channels * sizeof(int16_t);
+    /// @brief Samples per channel of the longest Opus packet (120 ms)
+    static constexpr size_t MAX_PACKET_FRAMES = SampleRate / 1000 * 120;
+    /// @brief Samples (all channels) of the longest packet
+    static constexpr size_t MAX_OUTPUT_SAMPLES = MAX_PACKET_FRAMES * Channels;
+    /// @brief Bytes of the longest packet; equals get_pcm_format().max_output_bytes()
+    static constexpr size_t MAX_OUTPUT_BYTES = MAX_OUTPUT_SAMPLES * sizeof(int16_t);
+
+    /// @brief Output buffer that holds any single packet
+    using PcmBuffer = std::array<int16_t, MAX_OUTPUT_SAMPLES>;
+
+    /// @brief Construct the decoder (always succeeds, allocates nothing; see OpusPacketDecoder)
+    OpusPacketDecoderT() : OpusPacketDecoder(SampleRate, Channels, StreamModes) {}
+
+    /// @brief Decode one complete Opus packet into interleaved 16-bit PCM
+    ///
+    /// decode() with the sizes in samples per channel.
+    ///
+    /// @param input Pointer to the Opus packet (must not be nullptr)
+    /// @param input_len Number of bytes in the packet (must not be 0)
+    /// @param pcm Output buffer (must not be nullptr)
+    /// @param pcm_frames Samples per channel that fit in @p pcm
+    /// @param[out] frames_written Samples per channel written. Set to 0 on any error.
+    /// @return OPUS_PACKET_DECODER_SUCCESS, OPUS_PACKET_DECODER_SILENCE or a negative error code
+    OpusPacketResult decode_frames(const uint8_t* input, size_t input_len, int16_t* pcm,
+                                   size_t pcm_frames, size_t& frames_written) {
+        size_t bytes_written = 0;
+        const OpusPacketResult result =
+            this->decode(input, input_len, reinterpret_cast<uint8_t*>(pcm),
+                         pcm_frames * BYTES_PER_FRAME, bytes_written);
+        frames_written = bytes_written / BYTES_PER_FRAME;
+        return result;
+    }
+
+    /// @brief Decode a packet already inspected with parse_opus_packet_info()
+    ///
+    /// decode(info, ...) with the sizes in samples per channel.
+    OpusPacketResult decode_frames(const OpusPacketInfo& info, int16_t* pcm, size_t pcm_frames,
+                                   size_t& frames_written) {
+        size_t bytes_written = 0;
+        const OpusPacketResult result = this->decode(info, reinterpret_cast<uint8_t*>(pcm),
+                                                     pcm_frames * BYTES_PER_FRAME, bytes_written);
+        frames_written = bytes_written / BYTES_PER_FRAME;
+        return result;
+    }
+
+    /// @brief Synthesize concealment audio for a lost packet
+    ///
+    /// conceal_loss() with the sizes in samples per channel.
+    ///
+    /// @param pcm Output buffer (must not be nullptr)
+    /// @param pcm_frames Samples per channel that fit in @p pcm
+    /// @param frame_size_samples Samples per channel to synthesize (a multiple of 2.5 ms)
+    /// @param[out] frames_written Samples per channel written. Set to 0 on any error.
+    /// @return OPUS_PACKET_DECODER_SUCCESS, or a negative error code
+    OpusPacketResult conceal_frames(int16_t* pcm, size_t pcm_frames, size_t frame_size_samples,
+                                    size_t& frames_written) {
+        size_t bytes_written = 0;
+        const OpusPacketResult result =
+            this->conceal_loss(reinterpret_cast<uint8_t*>(pcm), pcm_frames * BYTES_PER_FRAME,
+                               frame_size_samples, bytes_written);
+        frames_written = bytes_written / BYTES_PER_FRAME;
+        return result;
+    }
+};
+
+}  // namespace micro_opus
@@ -0,0 +1,109 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file opus_packet_info.h
+/// @brief Opus packet inspection (TOC and frame lengths) without decoding
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace micro_opus {
+
+/// @brief Coding mode of an Opus packet (RFC 6716 Section 3.1)
+enum OpusPacketMode : uint8_t {
+    OPUS_PACKET_MODE_SILK = 0,    // SILK only (speech, up to wideband)
+    OPUS_PACKET_MODE_HYBRID = 1,  // SILK low band plus CELT high band
+    OPUS_PACKET_MODE_CELT = 2     // CELT only (music, low delay)
+};
+
+/// @brief Audio bandwidth of an Opus packet (RFC 6716 Section 3.1)
+enum OpusPacketBandwidth : uint8_t {
+    OPUS_PACKET_BANDWIDTH_NARROWBAND = 0,     // 4 kHz
+    OPUS_PACKET_BANDWIDTH_MEDIUMBAND = 1,     // 6 kHz
+    OPUS_PACKET_BANDWIDTH_WIDEBAND = 2,       // 8 kHz
+    OPUS_PACKET_BANDWIDTH_SUPERWIDEBAND = 3,  // 12 kHz
+    OPUS_PACKET_BANDWIDTH_FULLBAND = 4        // 20 kHz
+};
+
+/// @brief Result codes for parse_opus_packet_info()
+enum OpusPacketInfoResult : int8_t {
+    OPUS_PACKET_INFO_OK = 0,
+    OPUS_PACKET_INFO_EMPTY = -1,    // Null or zero-length packet
+    OPUS_PACKET_INFO_INVALID = -2,  // Frame-length coding violates RFC 6716 Section 3.4
+};
+
+/**
+ * @brief Everything the TOC byte and frame-length coding of an Opus packet say about it
+ *
+ * Filled by parse_opus_packet_info() in a single pass over the packet header, without decoding
+ * and without allocating. The frame table points into the packet, which must outlive this struct.
+ * OpusPacketDecoder::decode() accepts a parsed packet directly, so a routing layer that inspects
+ * packets before deciding what to decode does not pay for the TOC parse twice.
+ */
+struct OpusPacketInfo {
+    /// @brief Most frames one packet can hold (120 ms of 2.5 ms frames)
+    static constexpr uint8_t MAX_FRAMES = 48;
+
+    const uint8_t* packet;  // The parsed packet
+    size_t packet_len;      // Its length in bytes
+
+    OpusPacketMode mode;
+    OpusPacketBandwidth bandwidth;
+    uint8_t config;          // TOC configuration number (0-31)
+    bool stereo;             // Coded as stereo
+    uint8_t frame_count;     // Frames in the packet (1-48)
+    uint16_t frame_samples;  // Samples per channel per frame, at 48 kHz (120-2880)
+    uint32_t padding_len;    // Padding bytes after the frames (code 3 packets only)
+    uint64_t silent_frames;  // Bit i set: frame i is DTX or coded silence (see is_silent())
+
+    const uint8_t* frames[MAX_FRAMES];  // Start of each frame's data
+    uint16_t frame_sizes[MAX_FRAMES];   // Size of each frame in bytes (0 = DTX)
+
+    /// @brief Samples per channel in the whole packet at @p sample_rate (one of the Opus rates)
+    uint32_t get_samples(uint32_t sample_rate = 48000) const {
+        return static_cast<uint32_t>(this->frame_count) * this->frame_samples /
+               (48000 / sample_rate);
+    }
+
+    /// @brief Whether frame @p index carries no audio: a DTX frame (0 or 1 bytes, which the
+    ///        decoder conceals or fills with comfort noise), or a CELT frame with its silence flag
+    bool is_frame_silent(uint8_t index) const {
+        return (this->silent_frames >> index) & 1U;
+    }
+
+    /// @brief Whether every frame in the packet is silent (see is_frame_silent())
+    bool is_silent() const {
+        return this->silent_frames == (UINT64_MAX >> (64 - this->frame_count));
+    }
+};
+
+/**
+ * @brief Parse the TOC byte and frame-length coding of an Opus packet
+ *
+ * Validates the framing exactly as libopus does before decoding (RFC 6716 Section 3.4: frame
+ * sizes at most 1275 bytes, at most 120 ms per packet, consistent lengths), so a packet that
+ * parses here is not rejected by the decoder for its framing. Self-delimited packets (RFC 6716
+ * Appendix B) are not supported.
+ *
+ * @param packet Packet data
+ * @param packet_len Packet length in bytes
+ * @param info Output packet description; only valid when OPUS_PACKET_INFO_OK is returned
+ * @return OpusPacketInfoResult result code
+ */
+OpusPacketInfoResult parse_opus_packet_info(const uint8_t* packet, size_t packet_len,
+                                            OpusPacketInfo& info);
+
+}  // namespace micro_opus
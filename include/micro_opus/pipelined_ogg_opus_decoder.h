@@ -0,0 +1,253 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file pipelined_ogg_opus_decoder.h
+/// @brief Ogg Opus decoder that demuxes and decodes on two tasks
+
+#pragma once
+
+#include "micro_opus/ogg_opus_decoder.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+namespace micro_opus {
+
+/**
+ * @brief Ogg Opus decoder with demuxing and Opus decoding pipelined across two tasks
+ *
+ * Drop-in alternative to OggOpusDecoder for dual-core targets. The calling task runs the Ogg
+ * demuxer, CRC checks and header validation, and a decode task started by this class runs libopus
+ * on the other core. Audio packets pass between them through a fixed ring of queue_depth slots
+ * indexed by two atomic counters, so handing off a packet or a decoded frame never takes a lock;
+ * a mutex is only used to let an idle task sleep. While the decode task works on one packet, the
+ * caller is already demuxing the next, so a long CELT packet no longer has to share one core with
+ * page parsing.
+ *
+ * Each slot holds one packet (copied out of the demuxer, which may reuse its buffer) and the PCM
+ * decoded from it, sized for the longest Opus packet (120 ms). Memory stays bounded: queue_depth
+ * slots on top of what OggOpusDecoder uses. The decode task is created on the first audio packet
+ * and stopped by the destructor.
+ *
+ * decode() takes the same arguments as OggOpusDecoder::decode(). A call either consumes input and
+ * queues the packet it completes, or returns the next decoded frame with bytes_consumed = 0, so
+ * the usual decode loop works unchanged. Frames come out in stream order, each with the result
+ * OggOpusDecoder would have returned for that packet, up to queue_depth packets behind. At the end
+ * of the input, keep calling decode() with input_len = 0 until get_packets_in_flight() is 0; those
+ * calls wait for the decode task instead of returning early.
+ *
+ * Unlike OggOpusDecoder, an OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL result does not lose the packet:
+ * the frame stays queued and the next decode() with a large enough buffer returns it.
+ *
+ * @note Task placement: On ESP-IDF the decode task is pinned to the core the first audio packet
+ *       is demuxed on plus one (the other core on dual-core targets) unless set_decode_task()
+ *       picks one. On single-core targets and host builds it is an ordinary thread.
+ *
+ * @note Thread Safety: Like OggOpusDecoder, each instance must be driven from one task. With
+ *       other decoders running on further tasks, build with the thread-safe pseudostack.
+ *
+ * Example:
+ * @code
+ * PipelinedOggOpusDecoder decoder;
+ * int16_t pcm_buffer[5760 * 2];  // 120ms stereo @ 48kHz, the longest packet
+ *
+ * for (;;) {
+ *     size_t consumed, samples;
+ *     OggOpusResult result = decoder.decode(input_ptr, input_len,
+ *                                           reinterpret_cast<uint8_t*>(pcm_buffer),
+ *                                           sizeof(pcm_buffer), consumed, samples);
+ *     if (result != 0) {
+ *         break;
+ *     }
+ *     if (samples > 0) {
+ *         process_audio(pcm_buffer, samples);
+ *     } else if (input_len == 0 && decoder.get_packets_in_flight() == 0) {
+ *         break;  // Input exhausted and the pipeline drained
+ *     }
+ *     input_ptr += consumed;
+ *     input_len -= consumed;
+ * }
+ * @endcode
+ */
+class PipelinedOggOpusDecoder {
+public:
+    /// @brief Default number of packets in flight between the two tasks
+    static constexpr size_t DEFAULT_QUEUE_DEPTH = 3;
+
+    /// @brief set_decode_task() core_id that pins to the other core (ESP-IDF only)
+    static constexpr int DECODE_CORE_OTHER = -1;
+
+    /**
+     * @brief Construct a pipelined decoder
+     *
+     * Like OggOpusDecoder, the constructor does not allocate or start the decode task.
+     *
+     * @param enable_crc Enable CRC32 validation of Ogg pages (see OggOpusDecoder)
+     * @param sample_rate Output sample rate in Hz: 8000, 12000, 16000, 24000 or 48000
+     * @param channels Output channel count, 0 = use the file's channel count
+     * @param queue_depth Packets in flight between the tasks (at least 2 to overlap them)
+     */
+    PipelinedOggOpusDecoder(bool enable_crc = false,
+                            uint32_t sample_rate = OPUS_DEFAULT_SAMPLE_RATE, uint8_t channels = 0,
+                            size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+
+    /**
+     * @brief Stop the decode task and free resources
+     *
+     * Packets still queued are discarded.
+     */
+    ~PipelinedOggOpusDecoder();
+
+    /**
+     * @brief Decode Ogg Opus data and output PCM samples
+     *
+     * Same contract as OggOpusDecoder::decode(), except that audio comes out queue_depth packets
+     * after its input and input_len = 0 drains the pipeline (see the class description).
+     *
+     * Errors found while demuxing are returned at once; errors from decoding a packet are
+     * returned in place of that packet's audio. Either way the frames still queued remain
+     * available to later calls.
+     *
+     * @return OggOpusResult result code (see OggOpusDecoder::decode())
+     *         - OGG_OPUS_ALLOCATION_FAILED: also returned if the slots cannot be allocated. The
+     *           PCM buffers are allocated before any input is consumed, so that call can be
+     *           retried; a packet too large for its slot's buffer that cannot grow it is dropped.
+     */
+    OggOpusResult decode(const uint8_t* input, size_t input_len, uint8_t* output,
+                         size_t output_size, size_t& bytes_consumed, size_t& samples_decoded);
+
+    /**
+     * @brief Choose where the decode task runs
+     *
+     * Takes effect when the task is created, on the first audio packet. Only the core, stack size
+     * and priority of ESP-IDF tasks are configurable; host builds ignore this.
+     *
+     * @param core_id Core to pin to, or DECODE_CORE_OTHER (default)
+     * @param stack_size Task stack in bytes (default 8192; 16384 with OPUS_USE_ALLOCA)
+     * @param priority FreeRTOS priority (default 5)
+     */
+    void set_decode_task(int core_id, size_t stack_size, size_t priority);
+
+    /**
+     * @brief Take the Opus decoder state from a pool (see OggOpusDecoder::set_decoder_pool())
+     */
+    void set_decoder_pool(DecoderPool* pool);
+
+    /**
+     * @brief Discard queued packets and prepare for a new stream
+     *
+     * Waits for the packet being decoded, if any, then resets like OggOpusDecoder::reset(). The
+     * decode task and the packet slots are kept for the next stream.
+     */
+    void reset();
+
+    /// @brief Sample rate in Hz, or 0 if the header is not parsed yet
+    uint32_t get_sample_rate() const;
+
+    /// @brief Output channel count, or 0 if the header is not parsed yet
+    uint8_t get_channels() const;
+
+    /// @brief Bit depth of decoded samples (always 16)
+    uint8_t get_bit_depth() const;
+
+    /// @brief Bytes per sample (always 2)
+    uint8_t get_bytes_per_sample() const;
+
+    /// @brief Pre-skip in samples at 48kHz, or 0 if the header is not parsed yet
+    uint16_t get_pre_skip() const;
+
+    /// @brief Output gain in Q7.8 dB, or 0 if the header is not parsed yet
+    int16_t get_output_gain() const;
+
+    /// @brief Buffer size in bytes needed for the frame last returned or refused
+    size_t get_required_output_buffer_size() const;
+
+    /// @brief Check if the OpusHead header has been parsed
+    bool is_initialized() const;
+
+    /// @brief Packets queued or being decoded, not yet returned by decode()
+    size_t get_packets_in_flight() const;
+
+private:
+    // Disable copy and assignment
+    PipelinedOggOpusDecoder(const PipelinedOggOpusDecoder&) = delete;
+    PipelinedOggOpusDecoder& operator=(const PipelinedOggOpusDecoder&) = delete;
+
+    // One packet and the audio decoded from it
+    struct Slot {
+        uint8_t* packet{nullptr};
+        size_t packet_capacity{0};
+        size_t packet_len{0};
+        int64_t granule_position{0};
+        bool is_eos{false};
+        bool is_last_on_page{false};
+
+        uint8_t* pcm{nullptr};
+        size_t samples{0};
+        OggOpusResult result{OGG_OPUS_OK};
+    };
+
+    // Size the slots for the stream's output format and start the decode task
+    OggOpusResult prepare_pipeline();
+    void stop_pipeline();
+    void free_slots();
+
+    // Copy a demuxed packet into the next free slot and hand it to the decode task
+    OggOpusResult queue_packet(const micro_ogg::OggPacket& packet);
+
+    // Return the oldest decoded frame, waiting for the decode task to finish it
+    OggOpusResult take_frame(uint8_t* output, size_t output_size, size_t& samples_decoded);
+    void wait_for_frame();
+
+    // Decode task body
+    void decode_loop();
+
+    // Wake the other task after publishing a slot
+    void notify();
+
+    // Demuxing, header validation and the per-packet decode state. The calling task uses the
+    // demux half, the decode task the audio half; see OggOpusDecoder::demux_packet().
+    OggOpusDecoder decoder_;
+
+    std::unique_ptr<Slot[]> slots_;
+    size_t queue_depth_;
+    size_t pcm_capacity_{0};  // Bytes of PCM per slot
+
+    // Ring counters: slots [drained_, decoded_) hold frames for the caller and [decoded_, filled_)
+    // packets for the decode task. filled_ and drained_ are only written by the calling task,
+    // decoded_ only by the decode task.
+    std::atomic<size_t> filled_{0};
+    std::atomic<size_t> decoded_{0};
+    size_t drained_{0};
+
+    // Sleeping and waking only; the counters carry the data
+    std::mutex mutex_;
+    std::condition_variable cond_;
+    bool stop_{false};
+    std::thread decode_thread_;
+
+    size_t last_required_buffer_bytes_{0};
+
+    // Decode task settings
+    size_t task_stack_size_;  // 8192, or 16384 when libopus allocates on the stack (USE_ALLOCA)
+    size_t task_priority_{5};
+    int task_core_id_{DECODE_CORE_OTHER};
+};
+
+}  // namespace micro_opus
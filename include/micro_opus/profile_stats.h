@@ -0,0 +1,144 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file profile_stats.h
+/// @brief Per-decoder profiling counters (MICRO_OPUS_ENABLE_PROFILING builds only)
+///
+/// Plain C so the instrumented Opus sources and the C++ wrappers share one definition. All times
+/// are in ticks of the profiling timer: CPU cycles on ESP-IDF, nanoseconds on host builds. Divide
+/// by tick_rate_hz to convert to seconds.
+///
+/// Stage groups are only filled in when the matching instrumentation is compiled in (Kconfig
+/// OPUS_ENABLE_*_TIMING, or OPUS_ENABLE_PROFILING on host); the others stay zero.
+
+#ifndef MICRO_OPUS_PROFILE_STATS_H
+#define MICRO_OPUS_PROFILE_STATS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Histogram resolution: buckets 0-3 hold exact tick counts, then each power of two is split into 4
+ * log-spaced buckets, covering the full 32-bit tick range */
+#define OPUS_PROFILE_LATENCY_SUB_BUCKETS 4
+#define OPUS_PROFILE_LATENCY_BUCKETS 124
+
+/* CELT decoder stages (celt_decode_with_ec), one sample per decoded CELT frame */
+typedef struct OpusProfileCeltStats {
+    uint64_t entropy_decode;   /* Bitstream parsing up to and including fine energy */
+    uint64_t pvq_decode;       /* quant_all_bands() */
+    uint64_t energy_finalize;  /* Energy finalization and anti-collapse */
+    uint64_t synthesis;        /* IMDCT (celt_synthesis) */
+    uint64_t postfilter;       /* Pitch post-filter */
+    uint64_t deemphasis;       /* De-emphasis and PCM conversion */
+    uint64_t total;            /* Whole frame */
+    uint32_t frames;           /* Frames timed */
+} OpusProfileCeltStats;
+
+/* PVQ decoding (alg_unquant), one sample per decoded band partition */
+typedef struct OpusProfilePvqStats {
+    uint64_t decode_pulses;
+    uint64_t normalise_residual;
+    uint64_t exp_rotation;           /* Includes exp_rotation1 */
+    uint64_t exp_rotation1;
+    uint64_t extract_collapse_mask;
+    uint64_t total;
+    uint32_t calls;
+} OpusProfilePvqStats;
+
+/* Band unquantization (quant_all_bands) broken down through the partition recursion */
+typedef struct OpusProfileQuantBandsStats {
+    uint64_t total;
+    uint64_t setup;
+    uint64_t loop;
+    uint64_t quant_band;
+    uint64_t quant_band_stereo;
+    uint64_t opus_copy;
+    /* quant_band breakdown */
+    uint64_t deinterleave_hadamard;
+    uint64_t quant_partition;
+    uint64_t interleave_hadamard;
+    uint64_t resynth;
+    /* quant_partition breakdown */
+    uint64_t compute_theta;
+    uint64_t alg_unquant;
+    uint64_t fill_operations;
+    /* alg_unquant breakdown */
+    uint64_t decode_pulses;
+    uint64_t normalise_residual;
+    uint64_t exp_rotation;
+    /* exp_rotation breakdown */
+    uint64_t exp_rotation_setup;
+    uint64_t exp_rotation_cos;
+    uint64_t exp_rotation_rounding;
+    uint64_t exp_rotation_loop;
+    /* quant_partition counters */
+    uint32_t split_path_count;
+    uint32_t base_path_count;
+    uint32_t max_recursion_depth;
+    uint32_t calls; /* quant_all_bands() calls (one per CELT frame) */
+} OpusProfileQuantBandsStats;
+
+/* SILK decoder stages (silk_decode_frame), one sample per decoded SILK frame, plus the sections
+ * around it that only SILK and hybrid packets pay for */
+typedef struct OpusProfileSilkStats {
+    uint64_t indices;        /* Range decoding of the side-information indices */
+    uint64_t pulses;         /* Excitation pulse decoding */
+    uint64_t parameters;     /* Gains, NLSF/LPC and LTP parameter reconstruction */
+    uint64_t nlsf_to_lpc;    /* NLSF decode and conversion to LPC, part of parameters */
+    uint64_t synthesis;      /* LTP/LPC synthesis (silk_decode_core) */
+    uint64_t total;          /* Whole frame */
+    uint64_t resample;       /* Resampling to the output rate, all channels */
+    uint64_t hybrid_celt;    /* CELT high band decoded on top of SILK in hybrid packets */
+    uint32_t frames;         /* Frames timed (PLC frames are not included) */
+    uint32_t hybrid_frames;  /* Hybrid frames timed */
+} OpusProfileSilkStats;
+
+/* Per-call decode latency, one sample per decode_calls increment. Fixed size, no allocation. */
+typedef struct OpusProfileLatencyStats {
+    uint32_t buckets[OPUS_PROFILE_LATENCY_BUCKETS]; /* Call counts per latency bucket */
+    uint32_t min;             /* Fastest call */
+    uint32_t max;             /* Slowest call */
+    uint32_t deadline;        /* Calls slower than this count as misses; 0 disables */
+    uint32_t deadline_misses; /* Calls slower than deadline */
+    /* Percentiles, filled in by get_profile_stats(). Each is the upper edge of the bucket the
+     * percentile falls into, capped at max, so it overstates the true value by less than 25%. */
+    uint32_t p50;
+    uint32_t p99;
+    uint32_t p999;
+} OpusProfileLatencyStats;
+
+/* Everything recorded for one decoder since construction or the last reset_profile_stats() */
+typedef struct OpusProfileStats {
+    uint64_t decode_total;  /* Ticks spent decoding packets, libopus and wrapper */
+    uint32_t decode_calls;  /* Packets decoded plus concealment frames synthesized */
+    uint32_t tick_rate_hz;  /* Profiling timer rate, filled in by get_profile_stats() */
+    OpusProfileLatencyStats latency;
+    OpusProfileCeltStats celt;
+    OpusProfilePvqStats pvq;
+    OpusProfileQuantBandsStats quant_bands;
+    OpusProfileSilkStats silk;
+} OpusProfileStats;
+
+/* Latency (in ticks) that the given percentage (0-100) of recorded calls stayed at or below, at
+ * bucket resolution. Returns 0 if nothing was recorded. */
+uint32_t opus_profile_latency_percentile(const OpusProfileLatencyStats* latency, double percent);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MICRO_OPUS_PROFILE_STATS_H */
@@ -0,0 +1,84 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file pseudostack.h
+/// @brief Pseudostack high-water mark and shared pool (optional, see the build flags below)
+///
+/// With the THREADSAFE_PSEUDOSTACK and NONTHREADSAFE_PSEUDOSTACK allocation modes, libopus takes
+/// its temporary buffers from a fixed-size pseudostack (CONFIG_OPUS_PSEUDOSTACK_SIZE).
+///
+/// High-water mark (MICRO_OPUS_PSEUDOSTACK_TRACKING builds only): records how deep the pseudostack
+/// has been used, so the size can be set from measurements instead of guesses. Run the workload
+/// you want to size for, read opus_pseudostack_high_water(), and add a margin. In
+/// THREADSAFE_PSEUDOSTACK mode each thread has its own pseudostack and its own mark, and these
+/// functions act on the calling thread's. In NONTHREADSAFE_PSEUDOSTACK mode there is one of each.
+/// The mark is sampled whenever a libopus function releases its temporary buffers, so it is exact
+/// at function granularity. It is not updated in ENABLE_VALGRIND builds.
+///
+/// Shared pool (MICRO_OPUS_PSEUDOSTACK_POOL builds only, THREADSAFE_PSEUDOSTACK mode): instead of
+/// one pseudostack per thread, a fixed number of pseudostacks (normally one per core) is leased for
+/// the duration of each libopus call. The decoder wrappers lease automatically. Code that calls
+/// opus_encode()/opus_decode() directly should wrap each call in opus_pseudostack_lease() and
+/// opus_pseudostack_release(); unleased calls still work but give the thread a private pseudostack.
+
+#ifndef MICRO_OPUS_PSEUDOSTACK_H
+#define MICRO_OPUS_PSEUDOSTACK_H
+
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_TRACKING
+
+/* Size of each pseudostack buffer in bytes (GLOBAL_STACK_SIZE) */
+size_t opus_pseudostack_size(void);
+
+/* Deepest pseudostack use in bytes since startup, thread creation or the last reset */
+size_t opus_pseudostack_high_water(void);
+
+/* Restart high-water tracking, e.g. before running a workload to measure */
+void opus_pseudostack_reset_high_water(void);
+
+#endif /* MICRO_OPUS_PSEUDOSTACK_TRACKING */
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+
+/* Lease a pooled pseudostack for the calling thread, waiting if all are in use. Nested calls on
+ * a thread that already holds a lease only count the nesting. Returns OPUS_OK, or OPUS_ALLOC_FAIL
+ * if the buffer could not be allocated on first use (the thread then holds no lease). */
+int opus_pseudostack_lease(void);
+
+/* Like opus_pseudostack_lease(), but returns OPUS_ALLOC_FAIL instead of waiting when every
+ * pseudostack is leased. libopus calls on the thread then use its private pseudostack. */
+int opus_pseudostack_try_lease(void);
+
+/* Give back the lease taken by the matching opus_pseudostack_lease() or
+ * opus_pseudostack_try_lease() */
+void opus_pseudostack_release(void);
+
+/* Number of pseudostacks in the pool (MICRO_OPUS_PSEUDOSTACK_POOL) */
+size_t opus_pseudostack_pool_size(void);
+
+/* Pseudostacks currently leased */
+size_t opus_pseudostack_pool_in_use(void);
+
+#endif /* MICRO_OPUS_PSEUDOSTACK_POOL */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* MICRO_OPUS_PSEUDOSTACK_H */
@@ -0,0 +1,194 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/// @file segmented_ogg_opus_decoder.h
+/// @brief Whole-file Ogg Opus decoder that decodes page-aligned segments in parallel
+
+#pragma once
+
+#include "micro_opus/ogg_opus_decoder.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace micro_opus {
+
+/**
+ * @brief Ogg Opus decoder for complete files that splits the audio across threads
+ *
+ * Meant for host tooling that converts files already in memory (read or mapped whole). open()
+ * demuxes the file once on the calling thread, with the same header, packet and granule position
+ * checks as OggOpusDecoder, and indexes every audio packet. decode() then splits the packets at
+ * Ogg page boundaries into one segment per thread, of roughly equal duration, and decodes each
+ * segment with its own libopus state. The calling thread takes the first segment.
+ *
+ * A segment other than the first starts from a fresh decoder state, so its decoder first runs
+ * through a pre-roll of the packets just before the segment (80 ms by default, as RFC 7845
+ * Section 4.6 recommends for seeking) and discards that audio. Every segment writes its audio
+ * straight into its place in the caller's buffer, with pre-skip and end trimming applied as
+ * OggOpusDecoder applies them, so the result has exactly the serial length.
+ *
+ * With one thread the output is bit-exact with OggOpusDecoder. With more, the first segment is
+ * still bit-exact; the others start from a pre-rolled rather than continuous decoder state, so
+ * the first milliseconds after each split can differ slightly from the serial decode. With the
+ * default pre-roll the difference is within what the conformance tests accept.
+ *
+ * @note Memory: open() keeps a copy of every audio packet (about the size of the file) plus a
+ *       small index entry per packet. Each thread allocates its own decoder state and a 120 ms
+ *       PCM scratch buffer for the pre-roll.
+ *
+ * @note Threads: The extra threads are started by decode() and joined before it returns, placed
+ *       like ParallelMultistreamDecoder's workers on ESP-IDF. NONTHREADSAFE_PSEUDOSTACK builds
+ *       decode every segment on the calling thread, where libopus may only run on one task.
+ *
+ * Example:
+ * @code
+ * SegmentedOggOpusDecoder decoder(std::thread::hardware_concurrency());
+ * if (decoder.open(file_data, file_size) == OGG_OPUS_OK) {
+ *     std::vector<uint8_t> pcm(decoder.get_required_output_buffer_size());
+ *     size_t samples = 0;
+ *     if (decoder.decode(pcm.data(), pcm.size(), samples) == OGG_OPUS_OK) {
+ *         write_wav(pcm.data(), samples, decoder.get_sample_rate(), decoder.get_channels());
+ *     }
+ * }
+ * @endcode
+ */
+class SegmentedOggOpusDecoder {
+public:
+    /// @brief Default pre-roll before each segment, in milliseconds (RFC 7845 Section 4.6)
+    static constexpr uint32_t DEFAULT_PRE_ROLL_MS = 80;
+
+    /**
+     * @brief Construct a segmented decoder
+     *
+     * The constructor does not allocate.
+     *
+     * @param threads Threads to decode on, including the calling thread; 0 is treated as 1
+     * @param enable_crc Enable CRC32 validation of Ogg pages (see OggOpusDecoder)
+     * @param sample_rate Output sample rate in Hz: 8000, 12000, 16000, 24000 or 48000
+     * @param channels Output channel count, 0 = use the file's channel count
+     */
+    SegmentedOggOpusDecoder(uint8_t threads, bool enable_crc = false,
+                            uint32_t sample_rate = OPUS_DEFAULT_SAMPLE_RATE, uint8_t channels = 0);
+
+    ~SegmentedOggOpusDecoder();
+
+    /**
+     * @brief Demux a complete Ogg Opus file and index its audio packets
+     *
+     * Demuxing stops at the end-of-stream page; anything after it is ignored. A file without one
+     * is indexed up to the last complete packet. Replaces any file opened before.
+     *
+     * @param input The whole file (only read during this call)
+     * @param input_len Size of the file in bytes
+     *
+     * @return OggOpusResult result code
+     *         - OGG_OPUS_OK: The file was indexed; get_total_samples() is valid
+     *         - OGG_OPUS_INPUT_INVALID: Invalid stream, or no complete OpusHead and OpusTags
+     *         - OGG_OPUS_DECODE_ERROR: A packet with an invalid TOC
+     *         - OGG_OPUS_ALLOCATION_FAILED: Memory allocation failed
+     */
+    OggOpusResult open(const uint8_t* input, size_t input_len);
+
+    /**
+     * @brief Decode the opened file on the configured number of threads
+     *
+     * @param output Buffer for the interleaved 16-bit PCM of the whole file
+     * @param output_size Size of output in bytes, at least get_required_output_buffer_size()
+     * @param samples_decoded [OUT] Samples written per channel (get_total_samples())
+     *
+     * @return OggOpusResult result code
+     *         - OGG_OPUS_NOT_INITIALIZED: open() has not succeeded
+     *         - OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL: output_size is below the required size
+     *         - OGG_OPUS_DECODE_ERROR, OGG_OPUS_ALLOCATION_FAILED: from any segment; the
+     *           contents of output are then unspecified
+     */
+    OggOpusResult decode(uint8_t* output, size_t output_size, size_t& samples_decoded);
+
+    /**
+     * @brief Set the pre-roll decoded and discarded before each segment but the first
+     *
+     * Shorter pre-rolls save work at every split, at the cost of larger differences from the
+     * serial decode right after it.
+     */
+    void set_pre_roll_ms(uint32_t pre_roll_ms);
+
+    /// @brief Samples per channel decode() produces, or 0 before open()
+    size_t get_total_samples() const;
+
+    /// @brief Output buffer size in bytes decode() needs, or 0 before open()
+    size_t get_required_output_buffer_size() const;
+
+    /// @brief Sample rate in Hz, or 0 before open()
+    uint32_t get_sample_rate() const;
+
+    /// @brief Output channel count, or 0 before open()
+    uint8_t get_channels() const;
+
+    /// @brief Pre-skip in samples at 48kHz, or 0 before open()
+    uint16_t get_pre_skip() const;
+
+    /// @brief Audio packets indexed by open()
+    size_t get_packet_count() const;
+
+    /// @brief Segments the last decode() split the file into
+    size_t get_segment_count() const;
+
+private:
+    // Disable copy and assignment
+    SegmentedOggOpusDecoder(const SegmentedOggOpusDecoder&) = delete;
+    SegmentedOggOpusDecoder& operator=(const SegmentedOggOpusDecoder&) = delete;
+
+    // One audio packet: its bytes in packet_data_ and where its audio lands in the untrimmed
+    // output (all decoded samples back to back, before pre-skip and end trimming)
+    struct PacketEntry {
+        size_t offset;
+        size_t length;
+        uint64_t start_sample;
+        uint32_t samples;
+        bool starts_page;  // First packet completed on its page: a segment may start here
+    };
+
+    // Packets [first, end) written to the output, decoded after [pre_roll_first, first)
+    struct Segment {
+        size_t pre_roll_first;
+        size_t first;
+        size_t end;
+        OggOpusResult result;
+    };
+
+    // Split the packet index into up to threads_ segments
+    void plan_segments();
+
+    // Decode one segment into output with a decoder state of its own
+    OggOpusResult decode_segment(const Segment& segment, uint8_t* output) const;
+
+    // Demuxing, header validation and per-page checks; only the demux half is used
+    OggOpusDecoder decoder_;
+
+    std::vector<uint8_t> packet_data_;
+    std::vector<PacketEntry> packets_;
+    std::vector<Segment> segments_;
+
+    // Untrimmed samples [skip_samples_, skip_samples_ + total_samples_) are the output
+    uint64_t skip_samples_{0};
+    size_t total_samples_{0};
+
+    uint32_t pre_roll_ms_{DEFAULT_PRE_ROLL_MS};
+    uint8_t threads_;
+    bool opened_{false};
+};
+
+}  // namespace micro_opus
@@ -0,0 +1,184 @@
+/***********************************************************************
+Copyright (C) 2026 Xiph.Org Foundation and contributors.
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifndef CELT_DECODER_LX7_H
+#define CELT_DECODER_LX7_H
+
+// Included from celt_decoder.c (celt_celt_decoder.patch) in place of deemphasis_stereo_simple(),
+// the de-emphasis used for stereo output without downsampling. Both channels run in one
+// zero-overhead loop so the two IIR dependency chains overlap.
+
+#if defined(FIXED_POINT) && !defined(ENABLE_RES24)
+
+#if SIG_SHIFT < 9 || SIG_SHIFT > 15
+#error "deemphasis_stereo_simple: the rounding constant must fit an addmi immediate"
+#endif
+
+#define OVERRIDE_DEEMPHASIS_STEREO_SIMPLE
+
+// Bit-exact with the generic loop under fixed_lx7.h: SATURATE() as min/max, the MULT16_32_Q15
+// feedback as a MULSH against the pre-shifted coefficient, and SIG2RES() as the rounding shift
+// and 16-bit CLAMPS of SIG2WORD16_lx7().
+static void deemphasis_stereo_simple(celt_sig* in[], opus_res* pcm, int N, const opus_val16 coef0,
+                                     celt_sig* mem) {
+    const celt_sig* px0 = in[0];
+    const celt_sig* px1 = in[1];
+    opus_res* py = pcm;
+    const opus_int32 coef_Q16 = SHL32((opus_int32)coef0, 16);
+    const opus_int32 sat = SIG_SAT;
+    const opus_int32 neg_sat = -SIG_SAT;
+    celt_sig m0 = mem[0];
+    celt_sig m1 = mem[1];
+    opus_int32 t0, t1;
+
+    __asm__ volatile(
+        "loopnez    %[cnt], .Lloop_end%=        \n"
+
+        // tmp = SATURATE(x[j] + m, SIG_SAT)
+        "l32i       %[t0], %[px0], 0            \n"
+        "l32i       %[t1], %[px1], 0            \n"
+        "add        %[t0], %[t0], %[m0]         \n"
+        "add        %[t1], %[t1], %[m1]         \n"
+        "min        %[t0], %[t0], %[sat]        \n"
+        "min        %[t1], %[t1], %[sat]        \n"
+        "max        %[t0], %[t0], %[nsat]       \n"
+        "max        %[t1], %[t1], %[nsat]       \n"
+
+        // m = MULT16_32_Q15(coef0, tmp), issued before the output conversion reuses tmp
+        "mulsh      %[m0], %[coef], %[t0]       \n"
+        "mulsh      %[m1], %[coef], %[t1]       \n"
+
+        // pcm = SAT16(PSHR32(tmp, SIG_SHIFT))
+        "addmi      %[t0], %[t0], %[rnd]        \n"
+        "addmi      %[t1], %[t1], %[rnd]        \n"
+        "slli       %[m0], %[m0], 1             \n"
+        "slli       %[m1], %[m1], 1             \n"
+        "srai       %[t0], %[t0], %[shift]      \n"
+        "srai       %[t1], %[t1], %[shift]      \n"
+        "clamps     %[t0], %[t0], 15            \n"
+        "clamps     %[t1], %[t1], 15            \n"
+        "s16i       %[t0], %[py], 0             \n"
+        "s16i       %[t1], %[py], 2             \n"
+
+        "addi       %[px0], %[px0], 4           \n"
+        "addi       %[px1], %[px1], 4           \n"
+        "addi       %[py], %[py], 4             \n"
+        ".Lloop_end%=:                          \n"
+        : [t0] "=&r"(t0), [t1] "=&r"(t1), [m0] "+r"(m0), [m1] "+r"(m1), [px0] "+r"(px0),
+          [px1] "+r"(px1), [py] "+r"(py)
+        : [cnt] "r"(N), [coef] "r"(coef_Q16), [sat] "r"(sat), [nsat] "r"(neg_sat),
+          [rnd] "i"(1 << (SIG_SHIFT - 1)), [shift] "i"(SIG_SHIFT)
+        : "memory");
+
+    mem[0] = m0;
+    mem[1] = m1;
+}
+
+#elif !defined(FIXED_POINT)
+
+#define OVERRIDE_DEEMPHASIS_STEREO_SIMPLE
+
+// The generic loop's dependency chain per sample is an add (x + m) followed by the multiply for
+// the next m. Here the previous output's multiply is folded into that add as a madd.s, leaving one
+// instruction on the chain, and the loop is unrolled by two so the chains alternate registers.
+// The product is no longer rounded on its own, so the output can differ in the last bit.
+static void deemphasis_stereo_simple(celt_sig* in[], opus_res* pcm, int N, const opus_val16 coef0,
+                                     celt_sig* mem) {
+    const float* px0 = in[0];
+    const float* px1 = in[1];
+    opus_res* py = pcm;
+    const float scale = SIG2RES(1.0f);
+    const float very_small = VERY_SMALL;
+    float t0, t1, u0, u1, o0, o1;
+    int pair_cnt;
+    int j;
+
+    // The stored memory is already coef0 times the last output, so the first sample is a plain
+    // add; every later one feeds back its predecessor's output.
+    t0 = px0[0] + very_small + mem[0];
+    t1 = px1[0] + very_small + mem[1];
+    py[0] = SIG2RES(t0);
+    py[1] = SIG2RES(t1);
+    px0++;
+    px1++;
+    py += 2;
+    pair_cnt = (N - 1) >> 1;
+
+    __asm__ volatile(
+        "loopnez    %[cnt], .Lloop_end%=        \n"
+
+        // u = x[j] + VERY_SMALL + coef0*t
+        "lsi        %[u0], %[px0], 0            \n"
+        "lsi        %[u1], %[px1], 0            \n"
+        "add.s      %[u0], %[u0], %[vs]         \n"
+        "add.s      %[u1], %[u1], %[vs]         \n"
+        "madd.s     %[u0], %[coef], %[t0]       \n"
+        "madd.s     %[u1], %[coef], %[t1]       \n"
+
+        // t = x[j+1] + VERY_SMALL + coef0*u
+        "lsi        %[t0], %[px0], 4            \n"
+        "lsi        %[t1], %[px1], 4            \n"
+        "add.s      %[t0], %[t0], %[vs]         \n"
+        "add.s      %[t1], %[t1], %[vs]         \n"
+        "mul.s      %[o0], %[u0], %[scale]      \n"
+        "mul.s      %[o1], %[u1], %[scale]      \n"
+        "madd.s     %[t0], %[coef], %[u0]       \n"
+        "madd.s     %[t1], %[coef], %[u1]       \n"
+        "ssi        %[o0], %[py], 0             \n"
+        "ssi        %[o1], %[py], 4             \n"
+        "mul.s      %[o0], %[t0], %[scale]      \n"
+        "mul.s      %[o1], %[t1], %[scale]      \n"
+        "ssi        %[o0], %[py], 8             \n"
+        "ssi        %[o1], %[py], 12            \n"
+
+        "addi       %[px0], %[px0], 8           \n"
+        "addi       %[px1], %[px1], 8           \n"
+        "addi       %[py], %[py], 16            \n"
+        ".Lloop_end%=:                          \n"
+        : [t0] "+f"(t0), [t1] "+f"(t1), [u0] "=&f"(u0), [u1] "=&f"(u1), [o0] "=&f"(o0),
+          [o1] "=&f"(o1), [px0] "+r"(px0), [px1] "+r"(px1), [py] "+r"(py)
+        : [cnt] "r"(pair_cnt), [coef] "f"(coef0), [vs] "f"(very_small), [scale] "f"(scale)
+        : "memory");
+
+    // N is even for every CELT frame size, which leaves one sample after the pairs
+    for (j = 1 + 2 * pair_cnt; j < N; j++) {
+        t0 = px0[0] + very_small + coef0 * t0;
+        t1 = px1[0] + very_small + coef0 * t1;
+        py[0] = SIG2RES(t0);
+        py[1] = SIG2RES(t1);
+        px0++;
+        px1++;
+        py += 2;
+    }
+
+    mem[0] = coef0 * t0;
+    mem[1] = coef0 * t1;
+}
+
+#endif
+
+#endif /* CELT_DECODER_LX7_H */
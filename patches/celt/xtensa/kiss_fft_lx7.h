@@ -0,0 +1,290 @@
+/* Copyright (C) 2026 Xiph.Org Foundation and contributors */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef KISS_FFT_LX7_H
+#define KISS_FFT_LX7_H
+
+/* Complex multiplies for the fixed-point kiss_fft butterflies and the MDCT pre/post twiddles.
+ *
+ * The generic macros build each complex multiply out of four S_MUL() calls, each of which is a
+ * separate volatile mulsh plus a shift. These versions keep the twiddle pre-shifted into the
+ * upper half-word, issue the four mulsh back to back so the multiplier pipeline stays full, and
+ * apply the Q15 shift once per output instead of once per product. The result is bit-exact with
+ * the MULT16_32_Q15 override in fixed_lx7.h, which also drops the LSB.
+ *
+ * ENABLE_QEXT switches the twiddles to 32 bits, so these only apply to the 16-bit twiddle build. */
+#if !defined(ENABLE_QEXT)
+
+#undef S_MUL
+static OPUS_INLINE opus_int32 S_MUL_lx7(opus_int32 a, opus_int16 b) {
+    opus_int32 res;
+    __asm__("mulsh %0, %1, %2\n\t" : "=r"(res) : "r"(a), "r"(SHL32((opus_int32)b, 16)));
+    return SHL32(res, 1);
+}
+#define S_MUL(a, b) S_MUL_lx7(a, b)
+
+/* m = a * b */
+#undef C_MUL
+static OPUS_INLINE void C_MUL_lx7(kiss_fft_cpx* m, opus_int32 ar, opus_int32 ai, opus_int16 br,
+                                  opus_int16 bi) {
+    opus_int32 rr, ii, ri, ir;
+    const opus_int32 br16 = SHL32((opus_int32)br, 16);
+    const opus_int32 bi16 = SHL32((opus_int32)bi, 16);
+
+    __asm__(
+        "mulsh      %[rr], %[ar], %[br]     \n"
+        "mulsh      %[ii], %[ai], %[bi]     \n"
+        "mulsh      %[ri], %[ar], %[bi]     \n"
+        "mulsh      %[ir], %[ai], %[br]     \n"
+        : [rr] "=&r"(rr), [ii] "=&r"(ii), [ri] "=&r"(ri), [ir] "=r"(ir)
+        : [ar] "r"(ar), [ai] "r"(ai), [br] "r"(br16), [bi] "r"(bi16));
+
+    m->r = SHL32(SUB32_ovflw(rr, ii), 1);
+    m->i = SHL32(ADD32_ovflw(ri, ir), 1);
+}
+#define C_MUL(m, a, b) C_MUL_lx7(&(m), (a).r, (a).i, (b).r, (b).i)
+
+/* m = a * conj(b) */
+#undef C_MULC
+static OPUS_INLINE void C_MULC_lx7(kiss_fft_cpx* m, opus_int32 ar, opus_int32 ai, opus_int16 br,
+                                   opus_int16 bi) {
+    opus_int32 rr, ii, ir, ri;
+    const opus_int32 br16 = SHL32((opus_int32)br, 16);
+    const opus_int32 bi16 = SHL32((opus_int32)bi, 16);
+
+    __asm__(
+        "mulsh      %[rr], %[ar], %[br]     \n"
+        "mulsh      %[ii], %[ai], %[bi]     \n"
+        "mulsh      %[ir], %[ai], %[br]     \n"
+        "mulsh      %[ri], %[ar], %[bi]     \n"
+        : [rr] "=&r"(rr), [ii] "=&r"(ii), [ir] "=&r"(ir), [ri] "=r"(ri)
+        : [ar] "r"(ar), [ai] "r"(ai), [br] "r"(br16), [bi] "r"(bi16));
+
+    m->r = SHL32(ADD32_ovflw(rr, ii), 1);
+    m->i = SHL32(SUB32_ovflw(ir, ri), 1);
+}
+#define C_MULC(m, a, b) C_MULC_lx7(&(m), (a).r, (a).i, (b).r, (b).i)
+
+/* c *= s */
+#undef C_MULBYSCALAR
+#define C_MULBYSCALAR(c, s)              \
+    do {                                 \
+        const opus_int16 _s = (s);       \
+        (c).r = S_MUL_lx7((c).r, _s);    \
+        (c).i = S_MUL_lx7((c).i, _s);    \
+    } while (0)
+
+/* Radix-4 and radix-5 butterflies. Same arithmetic as the generic kf_bfly4()/kf_bfly5() with the
+ * macros above, so the output is bit-exact with them, but the Q15 shift is applied to sums of
+ * products rather than to each product: wrapping adds commute with the shift, so
+ * (x << 1) + (y << 1) and (x + y) << 1 are the same 32-bit value. */
+
+/* m = a * b without the final Q15 shift */
+static OPUS_INLINE void C_MUL_Q16_lx7(kiss_fft_cpx* m, opus_int32 ar, opus_int32 ai, opus_int16 br,
+                                      opus_int16 bi) {
+    opus_int32 rr, ii, ri, ir;
+    const opus_int32 br16 = SHL32((opus_int32)br, 16);
+    const opus_int32 bi16 = SHL32((opus_int32)bi, 16);
+
+    __asm__(
+        "mulsh      %[rr], %[ar], %[br]     \n"
+        "mulsh      %[ii], %[ai], %[bi]     \n"
+        "mulsh      %[ri], %[ar], %[bi]     \n"
+        "mulsh      %[ir], %[ai], %[br]     \n"
+        : [rr] "=&r"(rr), [ii] "=&r"(ii), [ri] "=&r"(ri), [ir] "=r"(ir)
+        : [ar] "r"(ar), [ai] "r"(ai), [br] "r"(br16), [bi] "r"(bi16));
+
+    m->r = SUB32_ovflw(rr, ii);
+    m->i = ADD32_ovflw(ri, ir);
+}
+
+/* S_MUL(a, x) + S_MUL(b, y) with x and y already shifted into the upper half-word */
+static OPUS_INLINE opus_int32 S_MUL_ADD2_lx7(opus_int32 a, opus_int32 x16, opus_int32 b,
+                                             opus_int32 y16) {
+    opus_int32 ax, by;
+    __asm__(
+        "mulsh      %[ax], %[a], %[x]       \n"
+        "mulsh      %[by], %[b], %[y]       \n"
+        : [ax] "=&r"(ax), [by] "=r"(by)
+        : [a] "r"(a), [x] "r"(x16), [b] "r"(b), [y] "r"(y16));
+    return SHL32(ADD32_ovflw(ax, by), 1);
+}
+
+/* S_MUL(a, x) - S_MUL(b, y) with x and y already shifted into the upper half-word */
+static OPUS_INLINE opus_int32 S_MUL_SUB2_lx7(opus_int32 a, opus_int32 x16, opus_int32 b,
+                                             opus_int32 y16) {
+    opus_int32 ax, by;
+    __asm__(
+        "mulsh      %[ax], %[a], %[x]       \n"
+        "mulsh      %[by], %[b], %[y]       \n"
+        : [ax] "=&r"(ax), [by] "=r"(by)
+        : [a] "r"(a), [x] "r"(x16), [b] "r"(b), [y] "r"(y16));
+    return SHL32(SUB32_ovflw(ax, by), 1);
+}
+
+#define OVERRIDE_kf_bfly4
+static OPUS_INLINE void kf_bfly4(kiss_fft_cpx* Fout, const size_t fstride,
+                                 const kiss_fft_state* st, int m, int N, int mm) {
+    int i;
+
+    if (m == 1) {
+        /* Degenerate case where all the twiddles are 1. */
+        for (i = 0; i < N; i++) {
+            kiss_fft_cpx scratch0, scratch1;
+
+            C_SUB(scratch0, *Fout, Fout[2]);
+            C_ADDTO(*Fout, Fout[2]);
+            C_ADD(scratch1, Fout[1], Fout[3]);
+            C_SUB(Fout[2], *Fout, scratch1);
+            C_ADDTO(*Fout, scratch1);
+            C_SUB(scratch1, Fout[1], Fout[3]);
+
+            Fout[1].r = ADD32_ovflw(scratch0.r, scratch1.i);
+            Fout[1].i = SUB32_ovflw(scratch0.i, scratch1.r);
+            Fout[3].r = SUB32_ovflw(scratch0.r, scratch1.i);
+            Fout[3].i = ADD32_ovflw(scratch0.i, scratch1.r);
+            Fout += 4;
+        }
+    } else {
+        int j;
+        kiss_fft_cpx scratch[6];
+        const kiss_twiddle_cpx *tw1, *tw2, *tw3;
+        const int m2 = 2 * m;
+        const int m3 = 3 * m;
+        kiss_fft_cpx* Fout_beg = Fout;
+        for (i = 0; i < N; i++) {
+            Fout = Fout_beg + i * mm;
+            tw3 = tw2 = tw1 = st->twiddles;
+            for (j = 0; j < m; j++) {
+                /* Products stay unshifted; scratch[3..5] are shifted once after the sums */
+                C_MUL_Q16_lx7(&scratch[0], Fout[m].r, Fout[m].i, tw1->r, tw1->i);
+                C_MUL_Q16_lx7(&scratch[1], Fout[m2].r, Fout[m2].i, tw2->r, tw2->i);
+                C_MUL_Q16_lx7(&scratch[2], Fout[m3].r, Fout[m3].i, tw3->r, tw3->i);
+                tw1 += fstride;
+                tw2 += fstride * 2;
+                tw3 += fstride * 3;
+
+                scratch[1].r = SHL32(scratch[1].r, 1);
+                scratch[1].i = SHL32(scratch[1].i, 1);
+                C_SUB(scratch[5], *Fout, scratch[1]);
+                C_ADDTO(*Fout, scratch[1]);
+                scratch[3].r = SHL32(ADD32_ovflw(scratch[0].r, scratch[2].r), 1);
+                scratch[3].i = SHL32(ADD32_ovflw(scratch[0].i, scratch[2].i), 1);
+                scratch[4].r = SHL32(SUB32_ovflw(scratch[0].r, scratch[2].r), 1);
+                scratch[4].i = SHL32(SUB32_ovflw(scratch[0].i, scratch[2].i), 1);
+                C_SUB(Fout[m2], *Fout, scratch[3]);
+                C_ADDTO(*Fout, scratch[3]);
+
+                Fout[m].r = ADD32_ovflw(scratch[5].r, scratch[4].i);
+                Fout[m].i = SUB32_ovflw(scratch[5].i, scratch[4].r);
+                Fout[m3].r = SUB32_ovflw(scratch[5].r, scratch[4].i);
+                Fout[m3].i = ADD32_ovflw(scratch[5].i, scratch[4].r);
+                ++Fout;
+            }
+        }
+    }
+}
+
+#define OVERRIDE_kf_bfly5
+static OPUS_INLINE void kf_bfly5(kiss_fft_cpx* Fout, const size_t fstride,
+                                 const kiss_fft_state* st, int m, int N, int mm) {
+    kiss_fft_cpx *Fout0, *Fout1, *Fout2, *Fout3, *Fout4;
+    int i, u;
+    kiss_fft_cpx scratch[13];
+    const kiss_twiddle_cpx *tw1, *tw2, *tw3, *tw4;
+    kiss_fft_cpx* Fout_beg = Fout;
+    /* exp(-2i*pi/5) and exp(-4i*pi/5) in Q15, as in the generic fixed-point kf_bfly5() */
+    const opus_int32 ya_r = SHL32((opus_int32)10126, 16);
+    const opus_int32 ya_i = SHL32((opus_int32)-31164, 16);
+    const opus_int32 yb_r = SHL32((opus_int32)-26510, 16);
+    const opus_int32 yb_i = SHL32((opus_int32)-19261, 16);
+
+    for (i = 0; i < N; i++) {
+        Fout = Fout_beg + i * mm;
+        Fout0 = Fout;
+        Fout1 = Fout0 + m;
+        Fout2 = Fout0 + 2 * m;
+        Fout3 = Fout0 + 3 * m;
+        Fout4 = Fout0 + 4 * m;
+        tw1 = tw2 = tw3 = tw4 = st->twiddles;
+
+        for (u = 0; u < m; ++u) {
+            scratch[0] = *Fout0;
+
+            C_MUL_Q16_lx7(&scratch[1], Fout1->r, Fout1->i, tw1->r, tw1->i);
+            C_MUL_Q16_lx7(&scratch[2], Fout2->r, Fout2->i, tw2->r, tw2->i);
+            C_MUL_Q16_lx7(&scratch[3], Fout3->r, Fout3->i, tw3->r, tw3->i);
+            C_MUL_Q16_lx7(&scratch[4], Fout4->r, Fout4->i, tw4->r, tw4->i);
+            tw1 += fstride;
+            tw2 += fstride * 2;
+            tw3 += fstride * 3;
+            tw4 += fstride * 4;
+
+            scratch[7].r = SHL32(ADD32_ovflw(scratch[1].r, scratch[4].r), 1);
+            scratch[7].i = SHL32(ADD32_ovflw(scratch[1].i, scratch[4].i), 1);
+            scratch[10].r = SHL32(SUB32_ovflw(scratch[1].r, scratch[4].r), 1);
+            scratch[10].i = SHL32(SUB32_ovflw(scratch[1].i, scratch[4].i), 1);
+            scratch[8].r = SHL32(ADD32_ovflw(scratch[2].r, scratch[3].r), 1);
+            scratch[8].i = SHL32(ADD32_ovflw(scratch[2].i, scratch[3].i), 1);
+            scratch[9].r = SHL32(SUB32_ovflw(scratch[2].r, scratch[3].r), 1);
+            scratch[9].i = SHL32(SUB32_ovflw(scratch[2].i, scratch[3].i), 1);
+
+            Fout0->r = ADD32_ovflw(Fout0->r, ADD32_ovflw(scratch[7].r, scratch[8].r));
+            Fout0->i = ADD32_ovflw(Fout0->i, ADD32_ovflw(scratch[7].i, scratch[8].i));
+
+            scratch[5].r = ADD32_ovflw(scratch[0].r,
+                                       S_MUL_ADD2_lx7(scratch[7].r, ya_r, scratch[8].r, yb_r));
+            scratch[5].i = ADD32_ovflw(scratch[0].i,
+                                       S_MUL_ADD2_lx7(scratch[7].i, ya_r, scratch[8].i, yb_r));
+
+            scratch[6].r = S_MUL_ADD2_lx7(scratch[10].i, ya_i, scratch[9].i, yb_i);
+            scratch[6].i = NEG32_ovflw(S_MUL_ADD2_lx7(scratch[10].r, ya_i, scratch[9].r, yb_i));
+
+            C_SUB(*Fout1, scratch[5], scratch[6]);
+            C_ADD(*Fout4, scratch[5], scratch[6]);
+
+            scratch[11].r = ADD32_ovflw(scratch[0].r,
+                                        S_MUL_ADD2_lx7(scratch[7].r, yb_r, scratch[8].r, ya_r));
+            scratch[11].i = ADD32_ovflw(scratch[0].i,
+                                        S_MUL_ADD2_lx7(scratch[7].i, yb_r, scratch[8].i, ya_r));
+            scratch[12].r = S_MUL_SUB2_lx7(scratch[9].i, ya_i, scratch[10].i, yb_i);
+            scratch[12].i = S_MUL_SUB2_lx7(scratch[10].r, yb_i, scratch[9].r, ya_i);
+
+            C_ADD(*Fout2, scratch[11], scratch[12]);
+            C_SUB(*Fout3, scratch[11], scratch[12]);
+
+            ++Fout0;
+            ++Fout1;
+            ++Fout2;
+            ++Fout3;
+            ++Fout4;
+        }
+    }
+}
+
+#endif /* !ENABLE_QEXT */
+
+#endif /* KISS_FFT_LX7_H */
@@ -0,0 +1,130 @@
+/***********************************************************************
+Copyright (C) 2026 Xiph.Org Foundation and contributors.
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifdef HAVE_CONFIG_H
+#include "config.h"
+#endif
+
+#include "pitch.h"
+
+#if !defined(FIXED_POINT) && defined(OPUS_XTENSA_LX7)
+
+// Constant-gain section of the pitch post-filter. Same 5x unrolled register rotation as the
+// ARM C version in celt.c, but in a zero-overhead loop with every tap as a madd.s. The decoder
+// runs this in place (y == x), which is safe because T >= COMBFILTER_MINPERIOD, so every
+// x[i-T+2] read inside an iteration was already written by an earlier one.
+void comb_filter_const_lx7(opus_val32* y, opus_val32* x, int T, int N, opus_val16 g10,
+                           opus_val16 g11, opus_val16 g12) {
+    float x0, x1, x2, x3, x4;
+    float ta, sa, tb, sb;
+    const float* xt = &x[-T + 2];
+    const float* px = x;
+    float* py = y;
+    int loop_cnt = N / 5;
+    int i;
+
+    x4 = x[-T - 2];
+    x3 = x[-T - 1];
+    x2 = x[-T];
+    x1 = x[-T + 1];
+
+    __asm__ volatile(
+        "loopnez    %[cnt], .Lloop_end%=        \n"
+
+        // y[i] = x[i] + g10*x2 + g11*(x1+x3) + g12*(x0+x4)
+        "lsi        %[x0], %[xt], 0             \n"
+        "lsi        %[ta], %[px], 0             \n"
+        "add.s      %[sa], %[x1], %[x3]         \n"
+        "madd.s     %[ta], %[g10], %[x2]        \n"
+        "madd.s     %[ta], %[g11], %[sa]        \n"
+        "add.s      %[sa], %[x0], %[x4]         \n"
+        "madd.s     %[ta], %[g12], %[sa]        \n"
+
+        // y[i+1] = x[i+1] + g10*x1 + g11*(x0+x2) + g12*(x4'+x3)
+        "lsi        %[x4], %[xt], 4             \n"
+        "lsi        %[tb], %[px], 4             \n"
+        "add.s      %[sb], %[x0], %[x2]         \n"
+        "madd.s     %[tb], %[g10], %[x1]        \n"
+        "ssi        %[ta], %[py], 0             \n"
+        "madd.s     %[tb], %[g11], %[sb]        \n"
+        "add.s      %[sb], %[x4], %[x3]         \n"
+        "madd.s     %[tb], %[g12], %[sb]        \n"
+
+        // y[i+2] = x[i+2] + g10*x0 + g11*(x4'+x1) + g12*(x3'+x2)
+        "lsi        %[x3], %[xt], 8             \n"
+        "lsi        %[ta], %[px], 8             \n"
+        "add.s      %[sa], %[x4], %[x1]         \n"
+        "madd.s     %[ta], %[g10], %[x0]        \n"
+        "ssi        %[tb], %[py], 4             \n"
+        "madd.s     %[ta], %[g11], %[sa]        \n"
+        "add.s      %[sa], %[x3], %[x2]         \n"
+        "madd.s     %[ta], %[g12], %[sa]        \n"
+
+        // y[i+3] = x[i+3] + g10*x4' + g11*(x3'+x0) + g12*(x2'+x1)
+        "lsi        %[x2], %[xt], 12            \n"
+        "lsi        %[tb], %[px], 12            \n"
+        "add.s      %[sb], %[x3], %[x0]         \n"
+        "madd.s     %[tb], %[g10], %[x4]        \n"
+        "ssi        %[ta], %[py], 8             \n"
+        "madd.s     %[tb], %[g11], %[sb]        \n"
+        "add.s      %[sb], %[x2], %[x1]         \n"
+        "madd.s     %[tb], %[g12], %[sb]        \n"
+
+        // y[i+4] = x[i+4] + g10*x3' + g11*(x2'+x4') + g12*(x1'+x0)
+        "lsi        %[x1], %[xt], 16            \n"
+        "lsi        %[ta], %[px], 16            \n"
+        "add.s      %[sa], %[x2], %[x4]         \n"
+        "madd.s     %[ta], %[g10], %[x3]        \n"
+        "ssi        %[tb], %[py], 12            \n"
+        "madd.s     %[ta], %[g11], %[sa]        \n"
+        "add.s      %[sa], %[x1], %[x0]         \n"
+        "madd.s     %[ta], %[g12], %[sa]        \n"
+        "ssi        %[ta], %[py], 16            \n"
+
+        "addi       %[xt], %[xt], 20            \n"
+        "addi       %[px], %[px], 20            \n"
+        "addi       %[py], %[py], 20            \n"
+        ".Lloop_end%=:                          \n"
+        : [x0] "=&f"(x0), [x1] "+f"(x1), [x2] "+f"(x2), [x3] "+f"(x3), [x4] "+f"(x4),
+          [ta] "=&f"(ta), [sa] "=&f"(sa), [tb] "=&f"(tb), [sb] "=&f"(sb), [xt] "+r"(xt),
+          [px] "+r"(px), [py] "+r"(py)
+        : [cnt] "r"(loop_cnt), [g10] "f"(g10), [g11] "f"(g11), [g12] "f"(g12)
+        : "memory");
+
+    // After each group of five the rotation is back where it started, so the tail continues
+    // with the plain per-sample form.
+    for (i = loop_cnt * 5; i < N; i++) {
+        x0 = x[i - T + 2];
+        y[i] = x[i] + g10 * x2 + g11 * (x1 + x3) + g12 * (x0 + x4);
+        x4 = x3;
+        x3 = x2;
+        x2 = x1;
+        x1 = x0;
+    }
+}
+
+#endif
@@ -108,5 +108,20 @@ static OPUS_INLINE void dual_inner_prod(const opus_val16* x, const opus_val16* y
     *xy2 = dot_prod_lx7(x, y02, N);
 }
 
+#endif
+
+#ifndef FIXED_POINT
+
+// The fixed-point build already gets the unrolled ARM-style comb_filter_const_c (celt_celt.patch)
+// with the MULSH multiply overrides, so only the float build needs its own kernel.
+#define OVERRIDE_COMB_FILTER_CONST
+
+void comb_filter_const_lx7(opus_val32* y, opus_val32* x, int T, int N, opus_val16 g10,
+                           opus_val16 g11, opus_val16 g12);
+
+#undef comb_filter_const
+#define comb_filter_const(y, x, T, N, g10, g11, g12, arch) \
+    ((void)(arch), comb_filter_const_lx7(y, x, T, N, g10, g11, g12))
+
 #endif
 #endif
@@ -0,0 +1,287 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* CELT-only decoder (OPUS_STREAM_CELT_ONLY)
+ *
+ * The CELT-only subset of src/opus_decoder.c: opus_decoder_init() for the CELT state,
+ * opus_decode_frame() for a CELT frame after a CELT frame (no SILK, no redundancy, no transition
+ * crossfade) with its packet-loss concealment sizes and OPUS_SET_GAIN scaling, and opus_decode()'s
+ * conversion to 16-bit PCM (soft clipping each packet in floating-point builds). Keeping the same
+ * steps keeps the output bit-exact with opus_decode().
+ */
+#include "celt_only_decoder.h"
+
+#include "arch.h"
+#include "celt.h"
+#include "float_cast.h"
+#include "mathops.h"
+#include "opus.h"
+#include "opus_defines.h"
+#include "os_support.h"
+#include "stack_alloc.h"
+
+#include <stddef.h>
+
+/* Whether CELT writes opus_int16 directly (opus_res is opus_int16) */
+#if defined(FIXED_POINT) && !defined(ENABLE_RES24)
+#define CELT_ONLY_INT16_OUTPUT
+#endif
+
+struct MicroOpusCeltDecoder {
+    opus_int32 sample_rate;
+    int channels;
+    int stream_channels; /* Coded channels of the last packet (CELT_SET_CHANNELS) */
+    int decoded;         /* A frame has been decoded since init/reset (OpusDecoder prev_mode) */
+    int decode_gain;     /* Q7.8 dB (OPUS_SET_GAIN) */
+    int celt_dec_offset; /* The CELT state follows this struct */
+#ifndef FIXED_POINT
+    float softclip_mem[2]; /* opus_pcm_soft_clip() state, cleared by OPUS_RESET_STATE */
+#endif
+};
+
+/* Same rounding as align() in src/opus_private.h */
+static int celt_only_align(int i) {
+    struct foo {
+        char c;
+        union {
+            void* p;
+            opus_int32 i;
+            opus_val32 v;
+        } u;
+    };
+    const int alignment = (int)offsetof(struct foo, u);
+    return ((i + alignment - 1) / alignment) * alignment;
+}
+
+static CELTDecoder* celt_state(MicroOpusCeltDecoder* st) {
+    return (CELTDecoder*)((char*)st + st->celt_dec_offset);
+}
+
+/* opus_decode_frame(): scale by the OPUS_SET_GAIN gain */
+static void apply_gain(const MicroOpusCeltDecoder* st, opus_res* pcm, int frame_size) {
+    opus_val32 gain;
+    int i;
+    if (st->decode_gain == 0) {
+        return;
+    }
+    gain = celt_exp2(MULT16_16_P15(QCONST16(6.48814081e-4f, 25), st->decode_gain));
+    for (i = 0; i < frame_size * st->channels; i++) {
+        opus_val32 x = MULT16_32_P16(pcm[i], gain);
+        pcm[i] = (opus_res)SATURATE(x, 32767);
+    }
+}
+
+/* opus_decode_frame() without a packet: CELT PLC in the sizes libopus uses */
+static int conceal(MicroOpusCeltDecoder* st, opus_res* pcm, int frame_size) {
+    const int f20 = st->sample_rate / 50;
+    const int f10 = f20 >> 1;
+    const int f5 = f10 >> 1;
+    int done = 0;
+
+    if (!st->decoded) {
+        /* Nothing to extrapolate from yet */
+        OPUS_CLEAR(pcm, frame_size * st->channels);
+        return frame_size;
+    }
+    while (done < frame_size) {
+        int chunk = frame_size - done;
+        int ret;
+        if (chunk > f20) {
+            chunk = f20;
+        } else if (chunk < f20) {
+            if (chunk > f10) {
+                chunk = f10;
+            } else if (chunk > f5 && chunk < f10) {
+                chunk = f5;
+            }
+        }
+        ret = celt_decode_with_ec(celt_state(st), NULL, 0, pcm + done * st->channels, chunk, NULL,
+                                  0);
+        if (ret < 0) {
+            return ret;
+        }
+        apply_gain(st, pcm + done * st->channels, chunk);
+        done += chunk;
+    }
+    return frame_size;
+}
+
+/* opus_decode_frame() for one CELT frame */
+static int decode_frame(MicroOpusCeltDecoder* st, const unsigned char* frame, int len,
+                        int end_band, opus_res* pcm, int frame_size) {
+    int ret;
+    if (frame == NULL || len <= 1) {
+        /* DTX: libopus conceals the frame */
+        return conceal(st, pcm, frame_size);
+    }
+    celt_decoder_ctl(celt_state(st), CELT_SET_END_BAND(end_band));
+    ret = celt_decode_with_ec(celt_state(st), frame, len, pcm, frame_size, NULL, 0);
+    if (ret < 0) {
+        return ret;
+    }
+    st->decoded = 1;
+    apply_gain(st, pcm, frame_size);
+    return frame_size;
+}
+
+/* opus_decode(): convert to 16-bit PCM */
+static void to_int16(const opus_res* in, opus_int16* pcm, int count) {
+#ifndef CELT_ONLY_INT16_OUTPUT
+    int i;
+    for (i = 0; i < count; i++) {
+        pcm[i] = RES2INT16(in[i]);
+    }
+#else
+    (void)in;
+    (void)pcm;
+    (void)count;
+#endif
+}
+
+int micro_opus_celt_decoder_get_size(int channels) {
+    if (channels < 1 || channels > 2) {
+        return 0;
+    }
+    return celt_only_align((int)sizeof(MicroOpusCeltDecoder)) + celt_decoder_get_size(channels);
+}
+
+MicroOpusCeltDecoder* micro_opus_celt_decoder_create(opus_int32 sample_rate, int channels,
+                                                     int* error) {
+    MicroOpusCeltDecoder* st;
+    int ret;
+
+    if ((sample_rate != 48000 && sample_rate != 24000 && sample_rate != 16000 &&
+         sample_rate != 12000 && sample_rate != 8000) ||
+        (channels != 1 && channels != 2)) {
+        *error = OPUS_BAD_ARG;
+        return NULL;
+    }
+    st = (MicroOpusCeltDecoder*)opus_alloc((size_t)micro_opus_celt_decoder_get_size(channels));
+    if (st == NULL) {
+        *error = OPUS_ALLOC_FAIL;
+        return NULL;
+    }
+
+    OPUS_CLEAR((char*)st, sizeof(MicroOpusCeltDecoder));
+    st->sample_rate = sample_rate;
+    st->channels = channels;
+    st->stream_channels = channels;
+    st->celt_dec_offset = celt_only_align((int)sizeof(MicroOpusCeltDecoder));
+
+    ret = celt_decoder_init(celt_state(st), sample_rate, channels);
+    if (ret != OPUS_OK) {
+        opus_free(st);
+        *error = ret;
+        return NULL;
+    }
+    /* Opus frames carry no CELT custom-mode signalling (opus_decoder_init()) */
+    celt_decoder_ctl(celt_state(st), CELT_SET_SIGNALLING(0));
+
+    *error = OPUS_OK;
+    return st;
+}
+
+void micro_opus_celt_decoder_destroy(MicroOpusCeltDecoder* st) {
+    opus_free(st);
+}
+
+void micro_opus_celt_decoder_reset(MicroOpusCeltDecoder* st) {
+    celt_decoder_ctl(celt_state(st), OPUS_RESET_STATE);
+    st->stream_channels = st->channels;
+    st->decoded = 0;
+#ifndef FIXED_POINT
+    st->softclip_mem[0] = st->softclip_mem[1] = 0;
+#endif
+}
+
+void micro_opus_celt_decoder_set_gain(MicroOpusCeltDecoder* st, int gain) {
+    st->decode_gain = gain;
+}
+
+int micro_opus_celt_decode_packet(MicroOpusCeltDecoder* st, const unsigned char* const* frames,
+                                  const opus_uint16* frame_sizes, int frame_count, int bandwidth,
+                                  int stream_channels, opus_int16* pcm, int frame_size) {
+    /* Last coded band for narrowband, mediumband, wideband, superwideband and fullband */
+    static const int END_BANDS[5] = {13, 17, 17, 19, 21};
+    const int total = frame_count * frame_size;
+    int i;
+    VARDECL(opus_res, out);
+    ALLOC_STACK;
+
+    if (frame_count < 1 || bandwidth < 0 || bandwidth > 4 || stream_channels < 1 ||
+        stream_channels > 2) {
+        RESTORE_STACK;
+        return OPUS_BAD_ARG;
+    }
+#ifdef CELT_ONLY_INT16_OUTPUT
+    out = pcm;
+#else
+    ALLOC(out, total * st->channels, opus_res);
+#endif
+
+    st->stream_channels = stream_channels;
+    celt_decoder_ctl(celt_state(st), CELT_SET_CHANNELS(stream_channels));
+    for (i = 0; i < frame_count; i++) {
+        const int ret = decode_frame(st, frames[i], frame_sizes[i], END_BANDS[bandwidth],
+                                     out + i * frame_size * st->channels, frame_size);
+        if (ret < 0) {
+            RESTORE_STACK;
+            return ret;
+        }
+    }
+#ifndef FIXED_POINT
+    /* opus_decode() soft-clips each packet's floating-point output */
+    opus_pcm_soft_clip(out, total, st->channels, st->softclip_mem);
+#endif
+    to_int16(out, pcm, total * st->channels);
+    RESTORE_STACK;
+    return total;
+}
+
+int micro_opus_celt_conceal(MicroOpusCeltDecoder* st, opus_int16* pcm, int frame_size) {
+    int ret;
+    VARDECL(opus_res, out);
+    ALLOC_STACK;
+
+    if (frame_size <= 0 || frame_size % (st->sample_rate / 400) != 0) {
+        RESTORE_STACK;
+        return OPUS_BAD_ARG;
+    }
+#ifdef CELT_ONLY_INT16_OUTPUT
+    out = pcm;
+#else
+    ALLOC(out, frame_size * st->channels, opus_res);
+#endif
+
+    celt_decoder_ctl(celt_state(st), CELT_SET_CHANNELS(st->stream_channels));
+    /* opus_decode_native() does not soft-clip concealment */
+    ret = conceal(st, out, frame_size);
+    if (ret >= 0) {
+        to_int16(out, pcm, frame_size * st->channels);
+    }
+    RESTORE_STACK;
+    return ret;
+}
@@ -0,0 +1,79 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* CELT-only decoder for OPUS_STREAM_CELT_ONLY (see micro_opus/opus_packet_decoder.h)
+ *
+ * A CELT decoder state without the SILK decoder, resampler and mode-switching state that
+ * OpusDecoder carries. Decodes each CELT frame as opus_decode_frame() does for a CELT-only
+ * stream, and each packet as opus_decode() does (including the soft clipping of floating-point
+ * builds), so the output is bit-exact with opus_decode() for such streams. Packet parsing (and
+ * rejecting SILK and hybrid packets) is left to the caller.
+ */
+#ifndef CELT_ONLY_DECODER_H
+#define CELT_ONLY_DECODER_H
+
+#include "opus_types.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct MicroOpusCeltDecoder MicroOpusCeltDecoder;
+
+/* Bytes a decoder for the given channel count occupies, or 0 for an unsupported count */
+int micro_opus_celt_decoder_get_size(int channels);
+
+/* Allocate and initialize a decoder with opus_alloc(). Sets *error to OPUS_OK, OPUS_BAD_ARG for an
+ * unsupported rate or channel count, or OPUS_ALLOC_FAIL, and returns NULL on failure. */
+MicroOpusCeltDecoder* micro_opus_celt_decoder_create(opus_int32 sample_rate, int channels,
+                                                     int* error);
+
+/* Free a decoder from micro_opus_celt_decoder_create() */
+void micro_opus_celt_decoder_destroy(MicroOpusCeltDecoder* st);
+
+/* Clear the inter-frame state, as OPUS_RESET_STATE does for OpusDecoder */
+void micro_opus_celt_decoder_reset(MicroOpusCeltDecoder* st);
+
+/* Output gain in Q7.8 dB, as OPUS_SET_GAIN */
+void micro_opus_celt_decoder_set_gain(MicroOpusCeltDecoder* st, int gain);
+
+/* Decode the frame_count CELT frames of one packet, frame_size samples per channel each (at the
+ * decoder's rate), into pcm. bandwidth is the packet's TOC bandwidth (0 = narrowband ... 4 =
+ * fullband) and stream_channels its coded channel count. A frame of at most one byte is concealed,
+ * as libopus does for DTX. Returns the samples per channel written or an OPUS_* error. */
+int micro_opus_celt_decode_packet(MicroOpusCeltDecoder* st, const unsigned char* const* frames,
+                                  const opus_uint16* frame_sizes, int frame_count, int bandwidth,
+                                  int stream_channels, opus_int16* pcm, int frame_size);
+
+/* Synthesize frame_size samples per channel of loss concealment (a multiple of 2.5 ms) into pcm.
+ * Returns frame_size or an OPUS_* error. */
+int micro_opus_celt_conceal(MicroOpusCeltDecoder* st, opus_int16* pcm, int frame_size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CELT_ONLY_DECODER_H */
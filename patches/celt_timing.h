@@ -27,76 +27,41 @@
 #ifndef CELT_TIMING_H
 #define CELT_TIMING_H
 
+/* CELT decoder stage timing (CONFIG_OPUS_ENABLE_CELT_TIMING)
+ *
+ * Splits celt_decode_with_ec() into consecutive stages. Each CELT_TIMING_STAGE() charges the time
+ * since the previous mark to one OpusProfileCeltStats field of the bound stats (profile_timing.h).
+ */
 #ifdef CONFIG_OPUS_ENABLE_CELT_TIMING
 
-#include <stdio.h>
+#include "profile_timing.h"
 
-#ifdef ESP_PLATFORM
-#include "esp_timer.h"
-#else
-#include <time.h>
-#endif
+/* Declare the frame and stage marks at the top of the frame */
+#define CELT_TIMING_START()                                    \
+    profile_ticks_t _celt_timing_start = profile_timing_now(); \
+    profile_ticks_t _celt_timing_stage_start = _celt_timing_start
 
-/* Timing statistics structure */
-typedef struct {
-    int64_t entropy_decode_time;
-    int64_t pvq_decode_time;
-    int64_t energy_finalize_time;
-    int64_t synthesis_time;
-    int64_t postfilter_time;
-    int64_t deemphasis_time;
-    int64_t total_time;
-    int call_count;
-} celt_timing_stats_t;
-
-/* Global timing statistics */
-static celt_timing_stats_t g_celt_timing = {0};
-
-/* Get current time in microseconds */
-static inline int64_t celt_timing_get_time(void) {
-#ifdef ESP_PLATFORM
-    return esp_timer_get_time();
-#else
-    struct timespec ts;
-    clock_gettime(CLOCK_MONOTONIC, &ts);
-    return (int64_t)ts.tv_sec * 1000000LL + ts.tv_nsec / 1000LL;
-#endif
-}
-
-/* Start timing a section */
-#define CELT_TIMING_START() int64_t _timing_start = celt_timing_get_time()
+/* Start a stage without charging the time since the last mark */
+#define CELT_TIMING_MARK()                               \
+    do {                                                 \
+        _celt_timing_stage_start = profile_timing_now(); \
+    } while (0)
 
-/* End timing and accumulate to a specific counter */
-#define CELT_TIMING_END(counter)                                \
-    do {                                                        \
-        int64_t _timing_end = celt_timing_get_time();           \
-        g_celt_timing.counter += (_timing_end - _timing_start); \
+/* Charge the time since the last mark to a stage and start the next one */
+#define CELT_TIMING_STAGE(counter)                                                     \
+    do {                                                                               \
+        profile_ticks_t _celt_timing_now = profile_timing_now();                       \
+        PROFILE_TIMING_ADD(celt.counter, _celt_timing_now - _celt_timing_stage_start); \
+        _celt_timing_stage_start = _celt_timing_now;                                   \
     } while (0)
 
-/* Print timing statistics every N calls */
-#define CELT_TIMING_PRINT(N)                                                                   \
-    do {                                                                                       \
-        g_celt_timing.call_count++;                                                            \
-        if (g_celt_timing.call_count >= (N)) {                                                 \
-            printf("\n=== CELT Decoder Timing (averaged over %d frames) ===\n", (N));          \
-            printf("Entropy Decoding:  %6lld us\n", g_celt_timing.entropy_decode_time / (N));  \
-            printf("PVQ Decoding:      %6lld us\n", g_celt_timing.pvq_decode_time / (N));      \
-            printf("Energy Finalize:   %6lld us\n", g_celt_timing.energy_finalize_time / (N)); \
-            printf("Synthesis (IMDCT): %6lld us\n", g_celt_timing.synthesis_time / (N));       \
-            printf("Post-filtering:    %6lld us\n", g_celt_timing.postfilter_time / (N));      \
-            printf("Deemphasis:        %6lld us\n", g_celt_timing.deemphasis_time / (N));      \
-            printf("----------------------------------------\n");                              \
-            printf("TOTAL:             %6lld us\n", g_celt_timing.total_time / (N));           \
-            printf("========================================\n\n");                            \
-            g_celt_timing.entropy_decode_time = 0;                                             \
-            g_celt_timing.pvq_decode_time = 0;                                                 \
-            g_celt_timing.energy_finalize_time = 0;                                            \
-            g_celt_timing.synthesis_time = 0;                                                  \
-            g_celt_timing.postfilter_time = 0;                                                 \
-            g_celt_timing.deemphasis_time = 0;                                                 \
-            g_celt_timing.total_time = 0;                                                      \
-            g_celt_timing.call_count = 0;                                                      \
-        }                                                                                      \
+/* Charge the last stage and the whole frame */
+#define CELT_TIMING_END(counter)                                                       \
+    do {                                                                               \
+        profile_ticks_t _celt_timing_now = profile_timing_now();                       \
+        PROFILE_TIMING_ADD(celt.counter, _celt_timing_now - _celt_timing_stage_start); \
+        PROFILE_TIMING_ADD(celt.total, _celt_timing_now - _celt_timing_start);         \
+        PROFILE_TIMING_ADD(celt.frames, 1);                                            \
     } while (0)
 
 #else /* CONFIG_OPUS_ENABLE_CELT_TIMING */
@@ -105,12 +70,15 @@ static inline int64_t celt_timing_get_time(void) {
 #define CELT_TIMING_START() \
     do {                    \
     } while (0)
+#define CELT_TIMING_MARK() \
+    do {                   \
+    } while (0)
+#define CELT_TIMING_STAGE(counter) \
+    do {                           \
+    } while (0)
 #define CELT_TIMING_END(counter) \
     do {                         \
     } while (0)
-#define CELT_TIMING_PRINT(N) \
-    do {                     \
-    } while (0)
 
 #endif /* CONFIG_OPUS_ENABLE_CELT_TIMING */
 
@@ -0,0 +1,146 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Per-thread stats binding for the profiling instrumentation (MICRO_OPUS_ENABLE_PROFILING) */
+#include "profile_timing.h"
+
+#include <string.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_rom_sys.h"
+#endif
+
+_Thread_local OpusProfileStats* profile_timing_sink = NULL;
+_Thread_local uint32_t profile_timing_depth = 0;
+
+uint32_t profile_timing_tick_rate_hz(void) {
+#ifdef ESP_PLATFORM
+    return esp_rom_get_cpu_ticks_per_us() * 1000000U;
+#else
+    return 1000000000U;
+#endif
+}
+
+OpusProfileStats* profile_timing_current(void) {
+    return profile_timing_sink;
+}
+
+void profile_timing_bind(OpusProfileStats* stats) {
+    profile_timing_sink = stats;
+    profile_timing_depth = 0;
+}
+
+/* Bucket index for a latency: exact below 4 ticks, then OPUS_PROFILE_LATENCY_SUB_BUCKETS buckets
+ * per power of two, selected by the two bits below the leading one */
+static uint32_t latency_bucket(uint32_t ticks) {
+    if (ticks < OPUS_PROFILE_LATENCY_SUB_BUCKETS) {
+        return ticks;
+    }
+    uint32_t exponent = 31U - (uint32_t)__builtin_clz(ticks);
+    return (exponent - 1U) * OPUS_PROFILE_LATENCY_SUB_BUCKETS + ((ticks >> (exponent - 2U)) & 3U);
+}
+
+/* Largest latency that falls into a bucket */
+static uint32_t latency_bucket_upper(uint32_t bucket) {
+    if (bucket < OPUS_PROFILE_LATENCY_SUB_BUCKETS) {
+        return bucket;
+    }
+    uint32_t exponent = bucket / OPUS_PROFILE_LATENCY_SUB_BUCKETS + 1U;
+    uint64_t width = (uint64_t)1 << (exponent - 2U);
+    uint64_t lower = (uint64_t)(OPUS_PROFILE_LATENCY_SUB_BUCKETS +
+                                bucket % OPUS_PROFILE_LATENCY_SUB_BUCKETS) *
+                     width;
+    return (uint32_t)(lower + width - 1U);
+}
+
+void profile_timing_record_call(OpusProfileStats* stats, profile_ticks_t ticks) {
+    OpusProfileLatencyStats* latency = &stats->latency;
+
+    stats->decode_total += ticks;
+    if (stats->decode_calls == 0 || ticks < latency->min) {
+        latency->min = ticks;
+    }
+    if (ticks > latency->max) {
+        latency->max = ticks;
+    }
+    ++stats->decode_calls;
+
+    uint32_t* bucket = &latency->buckets[latency_bucket(ticks)];
+    if (*bucket != UINT32_MAX) {
+        ++*bucket;
+    }
+    if (latency->deadline != 0 && ticks > latency->deadline) {
+        ++latency->deadline_misses;
+    }
+}
+
+uint32_t opus_profile_latency_percentile(const OpusProfileLatencyStats* latency, double percent) {
+    uint64_t count = 0;
+    for (uint32_t i = 0; i < OPUS_PROFILE_LATENCY_BUCKETS; ++i) {
+        count += latency->buckets[i];
+    }
+    if (count == 0) {
+        return 0;
+    }
+
+    /* Rank of the sample the percentile lands on, 1-based and rounded up */
+    double exact_rank = (double)count * percent / 100.0;
+    uint64_t rank = (uint64_t)exact_rank;
+    if ((double)rank < exact_rank) {
+        ++rank;
+    }
+    if (rank == 0) {
+        rank = 1;
+    }
+
+    uint64_t seen = 0;
+    for (uint32_t i = 0; i < OPUS_PROFILE_LATENCY_BUCKETS; ++i) {
+        seen += latency->buckets[i];
+        if (seen >= rank) {
+            uint32_t upper = latency_bucket_upper(i);
+            return upper < latency->max ? upper : latency->max;
+        }
+    }
+    return latency->max;
+}
+
+void profile_timing_finish_snapshot(OpusProfileStats* stats) {
+    stats->tick_rate_hz = profile_timing_tick_rate_hz();
+    stats->latency.p50 = opus_profile_latency_percentile(&stats->latency, 50.0);
+    stats->latency.p99 = opus_profile_latency_percentile(&stats->latency, 99.0);
+    stats->latency.p999 = opus_profile_latency_percentile(&stats->latency, 99.9);
+}
+
+void profile_timing_reset(OpusProfileStats* stats) {
+    uint32_t deadline = stats->latency.deadline;
+    memset(stats, 0, sizeof(*stats));
+    stats->latency.deadline = deadline;
+}
+
+uint32_t profile_timing_us_to_ticks(uint32_t us) {
+    uint64_t ticks = (uint64_t)us * profile_timing_tick_rate_hz() / 1000000U;
+    return ticks > UINT32_MAX ? UINT32_MAX : (uint32_t)ticks;
+}
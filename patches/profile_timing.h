@@ -0,0 +1,121 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Shared timer and stats sink for the profiling instrumentation
+ *
+ * The stage timing headers (celt_timing.h, pvq_timing.h, quant_bands_timing.h, silk_timing.h)
+ * accumulate into whichever OpusProfileStats is bound to the calling thread. The C++ wrappers bind
+ * their own stats around each libopus decode call, so counters are per decoder even when several
+ * decoders run on different threads. With nothing bound (e.g. opus_decode() called directly) the
+ * instrumentation only reads the timer and discards the result.
+ *
+ * Ticks are CPU cycles on ESP-IDF and nanoseconds on host. They are 32 bits wide; every measured
+ * interval is a single decode call, far below the wrap period on either platform. The cycle
+ * counter is per core, so on dual-core targets pin the decoding task to get clean numbers.
+ */
+#ifndef PROFILE_TIMING_H
+#define PROFILE_TIMING_H
+
+#include "micro_opus/profile_stats.h"
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_idf_version.h"
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+#include "esp_cpu.h"
+#else
+#include "hal/cpu_hal.h"
+#endif
+#else
+#include <time.h>
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t profile_ticks_t;
+
+/* Read the profiling timer */
+static inline profile_ticks_t profile_timing_now(void) {
+#ifdef ESP_PLATFORM
+#if ESP_IDF_VERSION >= ESP_IDF_VERSION_VAL(5, 0, 0)
+    return (profile_ticks_t)esp_cpu_get_cycle_count();
+#else
+    return (profile_ticks_t)cpu_hal_get_cycle_count();
+#endif
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (profile_ticks_t)((uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec);
+#endif
+}
+
+/* Timer rate in Hz (current CPU clock on ESP-IDF, 1 GHz on host) */
+uint32_t profile_timing_tick_rate_hz(void);
+
+/* Stats the calling thread is currently recording into, or NULL */
+OpusProfileStats* profile_timing_current(void);
+
+/* Bind stats to the calling thread (NULL to unbind) */
+void profile_timing_bind(OpusProfileStats* stats);
+
+/* Charge one wrapper decode call: decode_total, decode_calls and the latency histogram */
+void profile_timing_record_call(OpusProfileStats* stats, profile_ticks_t ticks);
+
+/* Fill in the derived fields (tick_rate_hz, latency percentiles) of a snapshot */
+void profile_timing_finish_snapshot(OpusProfileStats* stats);
+
+/* Zero the counters, keeping the configured latency deadline */
+void profile_timing_reset(OpusProfileStats* stats);
+
+/* Convert microseconds to ticks at the current timer rate, saturating at UINT32_MAX */
+uint32_t profile_timing_us_to_ticks(uint32_t us);
+
+#ifndef __cplusplus
+/* Direct access for the instrumentation macros; the wrappers use the functions above */
+extern _Thread_local OpusProfileStats* profile_timing_sink;
+
+/* quant_partition() recursion depth of the calling thread */
+extern _Thread_local uint32_t profile_timing_depth;
+
+/* Add to a field of the bound stats, e.g. PROFILE_TIMING_ADD(celt.synthesis, ticks) */
+#define PROFILE_TIMING_ADD(field, value)                       \
+    do {                                                       \
+        OpusProfileStats* _profile_sink = profile_timing_sink; \
+        if (_profile_sink != NULL) {                           \
+            _profile_sink->field += (value);                   \
+        }                                                      \
+    } while (0)
+#endif /* !__cplusplus */
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* PROFILE_TIMING_H */
@@ -0,0 +1,173 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Shared pseudostack pool (MICRO_OPUS_PSEUDOSTACK_POOL, THREADSAFE_PSEUDOSTACK mode)
+ *
+ * Only one task per core can be inside libopus at a time, so instead of every task keeping its own
+ * pseudostack, a caller leases one of MICRO_OPUS_PSEUDOSTACK_POOL buffers for the duration of an
+ * encode/decode call. The lease points the calling thread's scratch_ptr/global_stack (see
+ * thread_local_stack.c) at the pool buffer and restores the previous values on release, so the
+ * ALLOC_STACK/PUSH macros in stack_alloc.h are unchanged.
+ *
+ * On ESP-IDF a caller first tries the buffer matching its core, so tasks pinned to a core keep
+ * reusing the same (cache-warm) buffer. If every buffer is taken, e.g. because a codec task was
+ * preempted mid-call by another codec task on the same core, the caller waits for a release.
+ * opus_pseudostack_try_lease() returns instead of waiting, for callers that must not block on
+ * other leaseholders.
+ *
+ * libopus calls made without a lease still fall back to the thread's own lazily allocated buffer.
+ */
+#include "micro_opus/pseudostack.h"
+
+#include "arch.h" /* For GLOBAL_STACK_SIZE */
+#include "opus_defines.h"
+#include "os_support.h"
+
+#include <pthread.h>
+#include <stddef.h>
+
+#ifdef ESP_PLATFORM
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+#ifndef THREADSAFE_PSEUDOSTACK
+#error "The pseudostack pool requires THREADSAFE_PSEUDOSTACK"
+#endif
+
+#if MICRO_OPUS_PSEUDOSTACK_POOL < 1
+#error "MICRO_OPUS_PSEUDOSTACK_POOL must be the number of pooled pseudostacks"
+#endif
+
+/* The calling thread's pseudostack pointers, defined in thread_local_stack.c */
+extern _Thread_local char* scratch_ptr;
+extern _Thread_local char* global_stack;
+
+static char* pool_buffers[MICRO_OPUS_PSEUDOSTACK_POOL];
+static int pool_leased[MICRO_OPUS_PSEUDOSTACK_POOL];
+static size_t pool_in_use = 0;
+static pthread_mutex_t pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t pool_released = PTHREAD_COND_INITIALIZER;
+
+/* Nesting depth of the calling thread's lease; only the outermost lease takes a buffer */
+static _Thread_local int lease_depth = 0;
+static _Thread_local int lease_slot = -1;
+static _Thread_local char* saved_scratch_ptr = NULL;
+static _Thread_local char* saved_global_stack = NULL;
+
+/* Index of a free slot, preferring the calling core's, or -1 if all are leased. Mutex held. */
+static int find_free_slot(void) {
+#ifdef ESP_PLATFORM
+    int preferred = (int)xPortGetCoreID() % MICRO_OPUS_PSEUDOSTACK_POOL;
+#else
+    int preferred = 0;
+#endif
+    for (int i = 0; i < MICRO_OPUS_PSEUDOSTACK_POOL; ++i) {
+        int slot = (preferred + i) % MICRO_OPUS_PSEUDOSTACK_POOL;
+        if (!pool_leased[slot]) {
+            return slot;
+        }
+    }
+    return -1;
+}
+
+/* Outermost lease of the calling thread; waits for a free slot, or gives up if !wait */
+static int take_slot(int wait) {
+    pthread_mutex_lock(&pool_mutex);
+    int slot;
+    while ((slot = find_free_slot()) < 0) {
+        if (!wait) {
+            pthread_mutex_unlock(&pool_mutex);
+            return OPUS_ALLOC_FAIL;
+        }
+        pthread_cond_wait(&pool_released, &pool_mutex);
+    }
+    if (pool_buffers[slot] == NULL) {
+        /* Allocated on first use and kept for the life of the program */
+        pool_buffers[slot] = (char*)opus_alloc_scratch(GLOBAL_STACK_SIZE);
+        if (pool_buffers[slot] == NULL) {
+            pthread_mutex_unlock(&pool_mutex);
+            return OPUS_ALLOC_FAIL;
+        }
+    }
+    pool_leased[slot] = 1;
+    ++pool_in_use;
+    pthread_mutex_unlock(&pool_mutex);
+
+    lease_depth = 1;
+    lease_slot = slot;
+    saved_scratch_ptr = scratch_ptr;
+    saved_global_stack = global_stack;
+    scratch_ptr = pool_buffers[slot];
+    global_stack = pool_buffers[slot];
+    return OPUS_OK;
+}
+
+int opus_pseudostack_lease(void) {
+    if (lease_depth > 0) {
+        ++lease_depth;
+        return OPUS_OK;
+    }
+    return take_slot(1);
+}
+
+int opus_pseudostack_try_lease(void) {
+    if (lease_depth > 0) {
+        ++lease_depth;
+        return OPUS_OK;
+    }
+    return take_slot(0);
+}
+
+void opus_pseudostack_release(void) {
+    if (lease_depth == 0) {
+        return;
+    }
+    if (--lease_depth > 0) {
+        return;
+    }
+
+    scratch_ptr = saved_scratch_ptr;
+    global_stack = saved_global_stack;
+
+    pthread_mutex_lock(&pool_mutex);
+    pool_leased[lease_slot] = 0;
+    --pool_in_use;
+    pthread_cond_signal(&pool_released);
+    pthread_mutex_unlock(&pool_mutex);
+    lease_slot = -1;
+}
+
+size_t opus_pseudostack_pool_size(void) {
+    return (size_t)MICRO_OPUS_PSEUDOSTACK_POOL;
+}
+
+size_t opus_pseudostack_pool_in_use(void) {
+    pthread_mutex_lock(&pool_mutex);
+    size_t in_use = pool_in_use;
+    pthread_mutex_unlock(&pool_mutex);
+    return in_use;
+}
@@ -0,0 +1,56 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+/* Pseudostack high-water mark (MICRO_OPUS_PSEUDOSTACK_TRACKING)
+ *
+ * Storage for the mark that RESTORE_STACK in stack_alloc.h updates, and the public query functions
+ * from micro_opus/pseudostack.h. Thread-local in THREADSAFE_PSEUDOSTACK mode to match the
+ * pseudostack itself.
+ */
+#include "micro_opus/pseudostack.h"
+
+#include "arch.h" /* For GLOBAL_STACK_SIZE */
+#include "opus_types.h"
+
+#if defined(THREADSAFE_PSEUDOSTACK)
+_Thread_local opus_int32 pseudostack_high_water = 0;
+#elif defined(NONTHREADSAFE_PSEUDOSTACK)
+opus_int32 pseudostack_high_water = 0;
+#else
+#error "Pseudostack tracking requires THREADSAFE_PSEUDOSTACK or NONTHREADSAFE_PSEUDOSTACK"
+#endif
+
+size_t opus_pseudostack_size(void) {
+    return (size_t)GLOBAL_STACK_SIZE;
+}
+
+size_t opus_pseudostack_high_water(void) {
+    return (size_t)pseudostack_high_water;
+}
+
+void opus_pseudostack_reset_high_water(void) {
+    pseudostack_high_water = 0;
+}
@@ -0,0 +1,69 @@
+/***********************************************************************
+Copyright (C) 2026 Xiph.Org Foundation and contributors.
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+
+#ifndef SILK_MACROS_LX7_H
+#define SILK_MACROS_LX7_H
+
+/* 32x16 multiplies behind the short-term LPC and LTP synthesis loops in silk_decode_core() (and
+   the rest of SILK, which is integer code in both the fixed and floating point builds). The
+   generic macros split the 32-bit operand into two 16x16 products; MULSH returns the high word
+   of the full 32x32 product in one instruction. With the 16-bit operand moved into the upper
+   half-word the result is floor(a * b / 65536), bit-exact with the generic macros. */
+
+#undef silk_SMULWB
+static OPUS_INLINE opus_int32 silk_SMULWB_lx7(opus_int32 a, opus_int32 b) {
+    opus_int32 res;
+    __asm__("slli %0, %2, 16\n\t"
+            "mulsh %0, %1, %0\n\t"
+            : "=&r"(res)
+            : "r"(a), "r"(b));
+    return res;
+}
+#define silk_SMULWB(a, b) (silk_SMULWB_lx7(a, b))
+
+#undef silk_SMLAWB
+static OPUS_INLINE opus_int32 silk_SMLAWB_lx7(opus_int32 acc, opus_int32 a, opus_int32 b) {
+    return (opus_int32)((opus_uint32)acc + (opus_uint32)silk_SMULWB_lx7(a, b));
+}
+#define silk_SMLAWB(a, b, c) (silk_SMLAWB_lx7(a, b, c))
+
+#undef silk_SMULWT
+static OPUS_INLINE opus_int32 silk_SMULWT_lx7(opus_int32 a, opus_int32 b) {
+    opus_int32 res;
+    __asm__("mulsh %0, %1, %2\n\t" : "=r"(res) : "r"(a), "r"(b & (opus_int32)0xFFFF0000));
+    return res;
+}
+#define silk_SMULWT(a, b) (silk_SMULWT_lx7(a, b))
+
+#undef silk_SMLAWT
+static OPUS_INLINE opus_int32 silk_SMLAWT_lx7(opus_int32 acc, opus_int32 a, opus_int32 b) {
+    return (opus_int32)((opus_uint32)acc + (opus_uint32)silk_SMULWT_lx7(a, b));
+}
+#define silk_SMLAWT(a, b, c) (silk_SMLAWT_lx7(a, b, c))
+
+#endif /* SILK_MACROS_LX7_H */
@@ -0,0 +1,162 @@
+/***********************************************************************
+Copyright (C) 2026 Xiph.Org Foundation and contributors.
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions
+are met:
+- Redistributions of source code must retain the above copyright notice,
+this list of conditions and the following disclaimer.
+- Redistributions in binary form must reproduce the above copyright
+notice, this list of conditions and the following disclaimer in the
+documentation and/or other materials provided with the distribution.
+- Neither the name of Internet Society, IETF or IETF Trust, nor the
+names of specific contributors, may be used to endorse or promote
+products derived from this software without specific prior written
+permission.
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER OR CONTRIBUTORS BE
+LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+POSSIBILITY OF SUCH DAMAGE.
+***********************************************************************/
+
+#ifndef SILK_RESAMPLER_LX7_H
+#define SILK_RESAMPLER_LX7_H
+
+/* Included from both resampler_private_IIR_FIR.c and resampler_private_down_FIR.c. Each file only
+   uses its own interpolator; the other is an unused static inline. */
+
+/* acc + (a * (c >> 16)) >> 16, with c already shifted into the upper half-word. Bit-exact with
+   silk_SMLAWB() on the unshifted 16-bit coefficient, since MULSH floors the same way. */
+static OPUS_INLINE opus_int32 silk_SMLAWB_preshifted_lx7(opus_int32 acc, opus_int32 a,
+                                                          opus_int32 c_Q16) {
+    opus_int32 res;
+    __asm__("mulsh %0, %1, %2\n\t" : "=r"(res) : "r"(a), "r"(c_Q16));
+    return silk_ADD32(acc, res);
+}
+
+/* 8-tap fractional interpolation for the 2x-upsampled signal. All products are 16x16, so the
+   whole inner product runs on the MAC16 accumulator instead of eight multiplies and adds. */
+#define OVERRIDE_silk_resampler_private_IIR_FIR_INTERPOL
+static OPUS_INLINE opus_int16* silk_resampler_private_IIR_FIR_INTERPOL(
+    opus_int16* out, opus_int16* buf, opus_int32 max_index_Q16, opus_int32 index_increment_Q16) {
+    opus_int32 index_Q16, res_Q15;
+    opus_int32 s, c;
+
+    for (index_Q16 = 0; index_Q16 < max_index_Q16; index_Q16 += index_increment_Q16) {
+        const opus_int32 table_index = silk_SMULWB(index_Q16 & 0xFFFF, 12);
+        const opus_int16* buf_ptr = &buf[index_Q16 >> 16];
+        const opus_int16* c0 = silk_resampler_frac_FIR_12[table_index];
+        const opus_int16* c1 = silk_resampler_frac_FIR_12[11 - table_index];
+
+        __asm__ volatile(
+            "l16si      %[s], %[b], 0           \n"
+            "l16si      %[c], %[c0], 0          \n"
+            "mul.aa.ll  %[s], %[c]              \n"
+            "l16si      %[s], %[b], 2           \n"
+            "l16si      %[c], %[c0], 2          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+            "l16si      %[s], %[b], 4           \n"
+            "l16si      %[c], %[c0], 4          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+            "l16si      %[s], %[b], 6           \n"
+            "l16si      %[c], %[c0], 6          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+
+            // Second half uses the mirrored phase, coefficients in reverse order
+            "l16si      %[s], %[b], 8           \n"
+            "l16si      %[c], %[c1], 6          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+            "l16si      %[s], %[b], 10          \n"
+            "l16si      %[c], %[c1], 4          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+            "l16si      %[s], %[b], 12          \n"
+            "l16si      %[c], %[c1], 2          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+            "l16si      %[s], %[b], 14          \n"
+            "l16si      %[c], %[c1], 0          \n"
+            "mula.aa.ll %[s], %[c]              \n"
+
+            "rsr        %[res], acclo           \n"
+            : [res] "=r"(res_Q15), [s] "=&r"(s), [c] "=&r"(c)
+            : [b] "r"(buf_ptr), [c0] "r"(c0), [c1] "r"(c1)
+            : "memory");
+
+        *out++ = (opus_int16)silk_SAT16(silk_RSHIFT_ROUND(res_Q15, 15));
+    }
+    return out;
+}
+
+/* Polyphase FIR for the downsamplers. The symmetric orders use the same coefficients for every
+   output sample, so they are shifted into MULSH form once per call rather than once per tap. */
+#define OVERRIDE_silk_resampler_private_down_FIR_INTERPOL
+static OPUS_INLINE opus_int16* silk_resampler_private_down_FIR_INTERPOL(
+    opus_int16* out, opus_int32* buf, const opus_int16* FIR_Coefs, opus_int FIR_Order,
+    opus_int FIR_Fracs, opus_int32 max_index_Q16, opus_int32 index_increment_Q16) {
+    opus_int32 index_Q16, res_Q6;
+    opus_int32* buf_ptr;
+    opus_int32 interpol_ind;
+    const opus_int16* interpol_ptr;
+    opus_int32 coefs_Q16[RESAMPLER_DOWN_ORDER_FIR2 / 2];
+    int k;
+
+    switch (FIR_Order) {
+        case RESAMPLER_DOWN_ORDER_FIR0:
+            for (index_Q16 = 0; index_Q16 < max_index_Q16; index_Q16 += index_increment_Q16) {
+                /* Integer part gives pointer to buffered input */
+                buf_ptr = buf + silk_RSHIFT(index_Q16, 16);
+
+                /* Fractional part gives interpolation coefficients */
+                interpol_ind = silk_SMULWB(index_Q16 & 0xFFFF, FIR_Fracs);
+
+                /* Inner product */
+                interpol_ptr = &FIR_Coefs[RESAMPLER_DOWN_ORDER_FIR0 / 2 * interpol_ind];
+                res_Q6 = 0;
+                for (k = 0; k < RESAMPLER_DOWN_ORDER_FIR0 / 2; k++) {
+                    res_Q6 = silk_SMLAWB_preshifted_lx7(res_Q6, buf_ptr[k],
+                                                        silk_LSHIFT((opus_int32)interpol_ptr[k], 16));
+                }
+                interpol_ptr =
+                    &FIR_Coefs[RESAMPLER_DOWN_ORDER_FIR0 / 2 * (FIR_Fracs - 1 - interpol_ind)];
+                for (k = 0; k < RESAMPLER_DOWN_ORDER_FIR0 / 2; k++) {
+                    res_Q6 = silk_SMLAWB_preshifted_lx7(res_Q6,
+                                                        buf_ptr[RESAMPLER_DOWN_ORDER_FIR0 - 1 - k],
+                                                        silk_LSHIFT((opus_int32)interpol_ptr[k], 16));
+                }
+
+                /* Scale down, saturate and store in output array */
+                *out++ = (opus_int16)silk_SAT16(silk_RSHIFT_ROUND(res_Q6, 6));
+            }
+            break;
+        case RESAMPLER_DOWN_ORDER_FIR1:
+        case RESAMPLER_DOWN_ORDER_FIR2:
+            for (k = 0; k < FIR_Order / 2; k++) {
+                coefs_Q16[k] = silk_LSHIFT((opus_int32)FIR_Coefs[k], 16);
+            }
+            for (index_Q16 = 0; index_Q16 < max_index_Q16; index_Q16 += index_increment_Q16) {
+                /* Integer part gives pointer to buffered input */
+                buf_ptr = buf + silk_RSHIFT(index_Q16, 16);
+
+                /* Inner product over the folded symmetric filter */
+                res_Q6 = 0;
+                for (k = 0; k < FIR_Order / 2; k++) {
+                    res_Q6 = silk_SMLAWB_preshifted_lx7(
+                        res_Q6, silk_ADD32(buf_ptr[k], buf_ptr[FIR_Order - 1 - k]), coefs_Q16[k]);
+                }
+
+                /* Scale down, saturate and store in output array */
+                *out++ = (opus_int16)silk_SAT16(silk_RSHIFT_ROUND(res_Q6, 6));
+            }
+            break;
+        default:
+            celt_assert(0);
+    }
+    return out;
+}
+
+#endif /* SILK_RESAMPLER_LX7_H */
@@ -0,0 +1,97 @@
+/* Copyright (c) 2026 Kevin Ahrendt */
+/*
+   Redistribution and use in source and binary forms, with or without
+   modification, are permitted provided that the following conditions
+   are met:
+
+   - Redistributions of source code must retain the above copyright
+   notice, this list of conditions and the following disclaimer.
+
+   - Redistributions in binary form must reproduce the above copyright
+   notice, this list of conditions and the following disclaimer in the
+   documentation and/or other materials provided with the distribution.
+
+   THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+   ``AS IS'' AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+   LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+   A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT OWNER
+   OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL,
+   EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,
+   PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR
+   PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+   LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING
+   NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE OF THIS
+   SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#ifndef SILK_TIMING_H
+#define SILK_TIMING_H
+
+/* SILK decoder stage timing (CONFIG_OPUS_ENABLE_SILK_TIMING)
+ *
+ * Splits silk_decode_frame() into consecutive stages like celt_timing.h does for CELT, and times a
+ * few sections outside it (NLSF-to-LPC, resampling, the CELT high band of hybrid packets) with the
+ * SECTION macros. Everything is charged to the silk group of the bound stats (profile_timing.h).
+ */
+#ifdef CONFIG_OPUS_ENABLE_SILK_TIMING
+
+#include "profile_timing.h"
+
+/* Declare the frame and stage marks at the top of the frame */
+#define SILK_TIMING_START()                                    \
+    profile_ticks_t _silk_timing_start = profile_timing_now(); \
+    profile_ticks_t _silk_timing_stage_start = _silk_timing_start
+
+/* Charge the time since the last mark to a stage and start the next one */
+#define SILK_TIMING_STAGE(counter)                                                     \
+    do {                                                                               \
+        profile_ticks_t _silk_timing_now = profile_timing_now();                       \
+        PROFILE_TIMING_ADD(silk.counter, _silk_timing_now - _silk_timing_stage_start); \
+        _silk_timing_stage_start = _silk_timing_now;                                   \
+    } while (0)
+
+/* Charge the last stage and the whole frame */
+#define SILK_TIMING_END(counter)                                                       \
+    do {                                                                               \
+        profile_ticks_t _silk_timing_now = profile_timing_now();                       \
+        PROFILE_TIMING_ADD(silk.counter, _silk_timing_now - _silk_timing_stage_start); \
+        PROFILE_TIMING_ADD(silk.total, _silk_timing_now - _silk_timing_start);         \
+        PROFILE_TIMING_ADD(silk.frames, 1);                                            \
+    } while (0)
+
+/* Time a standalone section; the name only has to be unique within the enclosing block */
+#define SILK_TIMING_SECTION_START(name) \
+    profile_ticks_t _silk_timing_section_##name = profile_timing_now()
+
+#define SILK_TIMING_SECTION_END(name, counter)                                                \
+    do {                                                                                      \
+        PROFILE_TIMING_ADD(silk.counter, profile_timing_now() - _silk_timing_section_##name); \
+    } while (0)
+
+/* Count an event in one of the silk group's counters */
+#define SILK_TIMING_COUNT(counter) PROFILE_TIMING_ADD(silk.counter, 1)
+
+#else /* CONFIG_OPUS_ENABLE_SILK_TIMING */
+
+/* No-op macros when timing is disabled */
+#define SILK_TIMING_START() \
+    do {                    \
+    } while (0)
+#define SILK_TIMING_STAGE(counter) \
+    do {                           \
+    } while (0)
+#define SILK_TIMING_END(counter) \
+    do {                         \
+    } while (0)
+#define SILK_TIMING_SECTION_START(name) \
+    do {                                \
+    } while (0)
+#define SILK_TIMING_SECTION_END(name, counter) \
+    do {                                       \
+    } while (0)
+#define SILK_TIMING_COUNT(counter) \
+    do {                           \
+    } while (0)
+
+#endif /* CONFIG_OPUS_ENABLE_SILK_TIMING */
+
+#endif /* SILK_TIMING_H */
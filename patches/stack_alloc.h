@@ -169,9 +169,15 @@ extern char* global_stack_top;
                 : CELT_FATAL("pseudostack overflow")),          \
      (stack) += (size) * (sizeof(type) / (sizeof(char))),       \
      (type*)((stack) - (size) * (sizeof(type) / (sizeof(char)))))
-#if 0 /* Set this to 1 to instrument pseudostack usage */
-#define RESTORE_STACK                                                       \
-    (printf("%ld %s:%d\n", global_stack - scratch_ptr, __FILE__, __LINE__), \
+#ifdef MICRO_OPUS_PSEUDOSTACK_TRACKING
+/* Record the high-water mark for opus_pseudostack_high_water() (pseudostack_usage.c). Every
+   function that allocates restores its frame on the way out, so sampling the top here catches
+   each function's deepest point. */
+extern opus_int32 pseudostack_high_water;
+#define RESTORE_STACK                                                                 \
+    ((global_stack - scratch_ptr > pseudostack_high_water                             \
+          ? (void)(pseudostack_high_water = (opus_int32)(global_stack - scratch_ptr)) \
+          : (void)0),                                                                 \
      global_stack = _saved_stack)
 #else
 #define RESTORE_STACK (global_stack = _saved_stack)
@@ -264,9 +270,13 @@ static _Thread_local char* global_stack_top = NULL;
                 : CELT_FATAL("pseudostack overflow")),          \
      (stack) += (size) * (sizeof(type) / (sizeof(char))),       \
      (type*)((stack) - (size) * (sizeof(type) / (sizeof(char)))))
-#if 0 /* Set this to 1 to instrument pseudostack usage */
-#define RESTORE_STACK                                                       \
-    (printf("%ld %s:%d\n", global_stack - scratch_ptr, __FILE__, __LINE__), \
+#ifdef MICRO_OPUS_PSEUDOSTACK_TRACKING
+/* High-water mark of this thread's pseudostack, see the NONTHREADSAFE_PSEUDOSTACK block above */
+extern _Thread_local opus_int32 pseudostack_high_water;
+#define RESTORE_STACK                                                                 \
+    ((global_stack - scratch_ptr > pseudostack_high_water                             \
+          ? (void)(pseudostack_high_water = (opus_int32)(global_stack - scratch_ptr)) \
+          : (void)0),                                                                 \
      global_stack = _saved_stack)
 #else
 #define RESTORE_STACK (global_stack = _saved_stack)
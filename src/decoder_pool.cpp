@@ -0,0 +1,228 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Decoder State Pool
+ * Implementation of DecoderPool class
+ */
+
+#include "micro_opus/decoder_pool.h"
+
+#include "opus.h"
+#include "opus_multistream.h"
+
+#include <cstring>
+
+namespace micro_opus {
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+DecoderPool::DecoderPool(size_t capacity)
+    : entries_(std::make_unique<Entry[]>(capacity > 0 ? capacity : 1)),
+      capacity_(capacity > 0 ? capacity : 1) {}
+
+DecoderPool::~DecoderPool() {
+    this->clear();
+}
+
+// ============================================================================
+// Public API
+// ============================================================================
+
+bool DecoderPool::preload(uint32_t sample_rate, uint8_t channels) {
+    int error = 0;
+    OpusDecoder* decoder = opus_decoder_create(static_cast<opus_int32>(sample_rate),
+                                               static_cast<int>(channels), &error);
+    if (decoder == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->put(make_key(sample_rate, channels), decoder, nullptr);
+    return true;
+}
+
+bool DecoderPool::preload_multistream(uint32_t sample_rate, uint8_t channels,
+                                      uint8_t stream_count, uint8_t coupled_count,
+                                      const uint8_t* mapping) {
+    Key key;
+    if (!make_multistream_key(sample_rate, channels, stream_count, coupled_count, mapping, key)) {
+        return false;
+    }
+    int error = 0;
+    OpusMSDecoder* decoder = opus_multistream_decoder_create(
+        static_cast<opus_int32>(sample_rate), channels, stream_count, coupled_count, mapping,
+        &error);
+    if (decoder == nullptr) {
+        return false;
+    }
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->put(key, nullptr, decoder);
+    return true;
+}
+
+void DecoderPool::clear() {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    for (size_t i = 0; i < this->idle_count_; ++i) {
+        destroy(this->entries_[i]);
+    }
+    this->idle_count_ = 0;
+}
+
+size_t DecoderPool::idle_count() const {
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    return this->idle_count_;
+}
+
+// ============================================================================
+// Decoder Interface
+// ============================================================================
+
+OpusDecoder* DecoderPool::acquire(uint32_t sample_rate, uint8_t channels, int& error) {
+    error = OPUS_OK;
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        Entry entry;
+        if (this->take(make_key(sample_rate, channels), entry)) {
+            return entry.decoder;
+        }
+    }
+    // Miss: create outside the lock, the state joins the pool when it is released
+    return opus_decoder_create(static_cast<opus_int32>(sample_rate), static_cast<int>(channels),
+                               &error);
+}
+
+OpusMSDecoder* DecoderPool::acquire_multistream(uint32_t sample_rate, uint8_t channels,
+                                                uint8_t stream_count, uint8_t coupled_count,
+                                                const uint8_t* mapping, int& error) {
+    error = OPUS_OK;
+    Key key;
+    if (make_multistream_key(sample_rate, channels, stream_count, coupled_count, mapping, key)) {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        Entry entry;
+        if (this->take(key, entry)) {
+            return entry.ms_decoder;
+        }
+    }
+    return opus_multistream_decoder_create(static_cast<opus_int32>(sample_rate), channels,
+                                           stream_count, coupled_count, mapping, &error);
+}
+
+void DecoderPool::release(OpusDecoder* decoder, uint32_t sample_rate, uint8_t channels) {
+    if (decoder == nullptr) {
+        return;
+    }
+    // OPUS_RESET_STATE keeps the gain, so clear it too; decoders apply their own on acquire
+    opus_decoder_ctl(decoder, OPUS_RESET_STATE);
+    opus_decoder_ctl(decoder, OPUS_SET_GAIN(0));
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->put(make_key(sample_rate, channels), decoder, nullptr);
+}
+
+void DecoderPool::release_multistream(OpusMSDecoder* decoder, uint32_t sample_rate,
+                                      uint8_t channels, uint8_t stream_count,
+                                      uint8_t coupled_count, const uint8_t* mapping) {
+    if (decoder == nullptr) {
+        return;
+    }
+    Key key;
+    if (!make_multistream_key(sample_rate, channels, stream_count, coupled_count, mapping, key)) {
+        opus_multistream_decoder_destroy(decoder);
+        return;
+    }
+    opus_multistream_decoder_ctl(decoder, OPUS_RESET_STATE);
+    opus_multistream_decoder_ctl(decoder, OPUS_SET_GAIN(0));
+
+    std::lock_guard<std::mutex> lock(this->mutex_);
+    this->put(key, nullptr, decoder);
+}
+
+// ============================================================================
+// Internals
+// ============================================================================
+
+bool DecoderPool::Key::operator==(const Key& other) const {
+    return this->sample_rate == other.sample_rate && this->channels == other.channels &&
+           this->stream_count == other.stream_count &&
+           this->coupled_count == other.coupled_count &&
+           std::memcmp(this->mapping, other.mapping, sizeof(this->mapping)) == 0;
+}
+
+DecoderPool::Key DecoderPool::make_key(uint32_t sample_rate, uint8_t channels) {
+    Key key{};
+    key.sample_rate = sample_rate;
+    key.channels = channels;
+    return key;
+}
+
+bool DecoderPool::make_multistream_key(uint32_t sample_rate, uint8_t channels,
+                                       uint8_t stream_count, uint8_t coupled_count,
+                                       const uint8_t* mapping, Key& key) {
+    if (channels > MAX_MAPPING_CHANNELS || stream_count == 0 || mapping == nullptr) {
+        return false;
+    }
+    key = make_key(sample_rate, channels);
+    key.stream_count = stream_count;
+    key.coupled_count = coupled_count;
+    std::memcpy(key.mapping, mapping, channels);
+    return true;
+}
+
+bool DecoderPool::take(const Key& key, Entry& entry) {
+    for (size_t i = 0; i < this->idle_count_; ++i) {
+        if (this->entries_[i].key == key) {
+            entry = this->entries_[i];
+            this->entries_[i] = this->entries_[--this->idle_count_];
+            return true;
+        }
+    }
+    return false;
+}
+
+void DecoderPool::put(const Key& key, OpusDecoder* decoder, OpusMSDecoder* ms_decoder) {
+    size_t slot = this->idle_count_;
+    if (slot == this->capacity_) {
+        // Full: replace the state that has been idle longest
+        slot = 0;
+        for (size_t i = 1; i < this->capacity_; ++i) {
+            if (this->release_sequence_ - this->entries_[i].returned >
+                this->release_sequence_ - this->entries_[slot].returned) {
+                slot = i;
+            }
+        }
+        destroy(this->entries_[slot]);
+    } else {
+        ++this->idle_count_;
+    }
+
+    Entry& entry = this->entries_[slot];
+    entry.key = key;
+    entry.decoder = decoder;
+    entry.ms_decoder = ms_decoder;
+    entry.returned = this->release_sequence_++;
+}
+
+void DecoderPool::destroy(Entry& entry) {
+    if (entry.decoder != nullptr) {
+        opus_decoder_destroy(entry.decoder);
+    }
+    if (entry.ms_decoder != nullptr) {
+        opus_multistream_decoder_destroy(entry.ms_decoder);
+    }
+    entry.decoder = nullptr;
+    entry.ms_decoder = nullptr;
+}
+
+}  // namespace micro_opus
@@ -0,0 +1,81 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Buffer allocation for the Ogg decoders
+ *
+ * On ESP-IDF these follow the OPUS_OGG_DECODER_* memory preference from Kconfig (PSRAM preferred
+ * by default). On host they are plain malloc/realloc/free.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#ifdef ESP_PLATFORM
+#include "esp_heap_caps.h"
+#else
+#include <cstdlib>
+#endif
+
+namespace micro_opus {
+
+inline void* ogg_decoder_malloc(size_t size) {
+#if !defined(ESP_PLATFORM)
+    return malloc(size);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_PSRAM)
+    return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_INTERNAL)
+    return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+                                   MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PSRAM_ONLY)
+    return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_INTERNAL_ONLY)
+    return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    // Default: prefer PSRAM with fallback to internal RAM
+    return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                   MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+}
+
+inline void* ogg_decoder_realloc(void* ptr, size_t size) {
+#if !defined(ESP_PLATFORM)
+    return realloc(ptr, size);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_PSRAM)
+    return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_INTERNAL)
+    return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
+                                    MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_PSRAM_ONLY)
+    return heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+#elif defined(CONFIG_OPUS_OGG_DECODER_INTERNAL_ONLY)
+    return heap_caps_realloc(ptr, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#else
+    // Default: prefer PSRAM with fallback to internal RAM
+    return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
+                                    MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+#endif
+}
+
+inline void ogg_decoder_free(void* ptr) {
+#ifdef ESP_PLATFORM
+    heap_caps_free(ptr);
+#else
+    free(ptr);
+#endif
+}
+
+}  // namespace micro_opus
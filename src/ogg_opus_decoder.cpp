@@ -18,10 +18,16 @@
 
 #include "micro_opus/ogg_opus_decoder.h"
 
+#include "micro_opus/decoder_pool.h"
+#include "micro_opus/ogg_opus_reader.h"
 #include "micro_opus/opus_packet_decoder.h"
+#include "ogg_decoder_alloc.h"
 #include "opus.h"
 #include "opus_header.h"
 #include "opus_multistream.h"
+#include "parallel_multistream_decoder.h"
+#include "profile_scope.h"
+#include "pseudostack_lease.h"
 #include <micro_ogg/ogg_demuxer.h>
 
 #ifdef ESP_PLATFORM
@@ -60,6 +66,10 @@ constexpr uint32_t OPUS_SAMPLE_RATE_48K = 48000;  // Native Opus rate
 const size_t MIN_OPUS_PACKET_SIZE = 1024;   // Initial buffer allocation
 const size_t MAX_OPUS_PACKET_SIZE = 61440;  // Maximum per RFC 7845
 
+// RFC 3533 Section 6: Ogg page header layout
+constexpr size_t OGG_PAGE_HEADER_SIZE = 27;  // Up to and including the segment count
+constexpr size_t OGG_PAGE_SEGMENT_COUNT_OFFSET = 26;
+
 // RFC 7845 Section 5.2: Maximum OpusTags size
 // "OpusTags MUST NOT exceed 125,829,120 octets (120 MB)"
 // This prevents memory exhaustion attacks
@@ -86,33 +96,30 @@ OggOpusResult map_packet_decoder_result(OpusPacketResult result) {
             return OGG_OPUS_DECODE_ERROR;
     }
 }
+
+// Silence handling for the mono/stereo packet decoder under set_skip_silence() and
+// set_write_silent_channels(). Report mode writes nothing for a skipped packet, leaving every
+// channel untouched.
+OpusSilenceMode packet_silence_mode(bool skip_silence, bool write_silent_channels) {
+    if (!skip_silence) {
+        return OPUS_SILENCE_DECODE;
+    }
+    return write_silent_channels ? OPUS_SILENCE_ZERO_FILL : OPUS_SILENCE_REPORT;
+}
 }  // namespace
 
-OggOpusResult OggOpusDecoder::process_packet(const micro_ogg::OggPacket& packet, uint8_t* output,
-                                             size_t output_size, size_t& samples_decoded) {
-    // Extract packet data
-    const uint8_t* packet_data = packet.data;
-    size_t packet_len = packet.length;
-    int64_t granule_pos = packet.granule_position;
-    bool is_bos = packet.is_bos;
-    bool is_eos = packet.is_eos;
-    bool is_last_on_page = packet.is_last_on_page;
-
-    // Dispatch to state handler
+OggOpusResult OggOpusDecoder::process_header_packet(const micro_ogg::OggPacket& packet) {
     switch (state_) {
         case STATE_EXPECT_OPUS_HEAD:
-            samples_decoded = 0;
-            return handle_opus_head_packet(packet_data, packet_len, granule_pos, is_bos,
-                                           is_last_on_page);
+            return handle_opus_head_packet(packet.data, packet.length, packet.granule_position,
+                                           packet.is_bos, packet.is_last_on_page);
 
         case STATE_EXPECT_OPUS_TAGS:
         case STATE_STREAMING_OPUS_TAGS:
-            // OpusTags is handled via streaming in decode(), not here
-            return OGG_OPUS_INPUT_INVALID;
-
+            // OpusTags is handled via streaming in demux_packet(), not here
         case STATE_DECODING:
-            return handle_audio_packet(packet_data, packet_len, granule_pos, is_eos,
-                                       is_last_on_page, output, output_size, samples_decoded);
+            // Audio packets are returned by demux_packet() for handle_audio_packet()
+            return OGG_OPUS_INPUT_INVALID;
     }
 
     // Unreachable with valid enum, but satisfy compiler
@@ -160,19 +167,53 @@ OggOpusResult OggOpusDecoder::create_opus_decoder(uint8_t output_channels) {
     int error = 0;
     if (opus_head_->channel_mapping == 0) {
         // Mono/stereo: delegate decoding to the raw-packet decoder. Construction never allocates or
-        // fails; the libopus state is created lazily on the first decode(), so an allocation
-        // failure surfaces on the first audio packet rather than here.
+        // fails; the libopus state is created (or taken from the pool) lazily on the first
+        // decode(), so an allocation failure surfaces on the first audio packet rather than here.
         packet_decoder_ = std::make_unique<OpusPacketDecoder>(sample_rate_, output_channels);
+        packet_decoder_->set_decoder_pool(decoder_pool_);
         packet_decoder_->set_output_gain(opus_head_->output_gain);
+        packet_decoder_->set_silence_mode(
+            packet_silence_mode(skip_silence_, write_silent_channels_));
+    } else if (multistream_workers_ > 1 || skip_silence_) {
+        // Silence is skipped per elementary stream, which needs the per-stream decoder even with
+        // a single worker
+        // The worker tasks outlive the stream; only the per-stream states are rebuilt
+        if (!parallel_ms_decoder_ ||
+            parallel_ms_decoder_->get_requested_workers() != multistream_workers_) {
+            parallel_ms_decoder_ =
+                std::make_unique<ParallelMultistreamDecoder>(multistream_workers_);
+        }
+        error = parallel_ms_decoder_->init(static_cast<int32_t>(sample_rate_), output_channels,
+                                           opus_head_->stream_count, opus_head_->coupled_count,
+                                           opus_head_->channel_mapping_table);
+        if (error != OPUS_OK) {
+            return OGG_OPUS_ALLOCATION_FAILED;
+        }
+        parallel_ms_decoder_->set_skip_silence(skip_silence_);
+        parallel_ms_decoder_->set_write_silent_channels(write_silent_channels_);
+
+        if (opus_head_->output_gain != 0) {
+            parallel_ms_decoder_->set_gain(opus_head_->output_gain);
+        }
     } else {
-        opus_ms_decoder_ = opus_multistream_decoder_create(
-            static_cast<opus_int32>(sample_rate_), output_channels, opus_head_->stream_count,
-            opus_head_->coupled_count, opus_head_->channel_mapping_table, &error);
+        // Back to serial decoding: stop any worker tasks from an earlier stream
+        parallel_ms_decoder_.reset();
+
+        if (decoder_pool_) {
+            opus_ms_decoder_ = decoder_pool_->acquire_multistream(
+                sample_rate_, output_channels, opus_head_->stream_count, opus_head_->coupled_count,
+                opus_head_->channel_mapping_table, error);
+        } else {
+            opus_ms_decoder_ = opus_multistream_decoder_create(
+                static_cast<opus_int32>(sample_rate_), output_channels, opus_head_->stream_count,
+                opus_head_->coupled_count, opus_head_->channel_mapping_table, &error);
+        }
 
         if (error != OPUS_OK || !opus_ms_decoder_) {
             return OGG_OPUS_ALLOCATION_FAILED;
         }
 
+        // Pooled states come back at unity gain, like new ones
         if (opus_head_->output_gain != 0) {
             opus_multistream_decoder_ctl(opus_ms_decoder_,
                                          OPUS_SET_GAIN((opus_int32)opus_head_->output_gain));
@@ -181,6 +222,26 @@ OggOpusResult OggOpusDecoder::create_opus_decoder(uint8_t output_channels) {
     return OGG_OPUS_OK;
 }
 
+void OggOpusDecoder::destroy_opus_decoder() {
+    // The packet decoder returns its own state to the pool
+    packet_decoder_.reset();
+
+    if (opus_ms_decoder_) {
+        if (decoder_pool_) {
+            decoder_pool_->release_multistream(opus_ms_decoder_, sample_rate_, output_channels_,
+                                               opus_head_->stream_count, opus_head_->coupled_count,
+                                               opus_head_->channel_mapping_table);
+        } else {
+            opus_multistream_decoder_destroy(opus_ms_decoder_);
+        }
+        opus_ms_decoder_ = nullptr;
+    }
+
+    if (parallel_ms_decoder_) {
+        parallel_ms_decoder_->clear();
+    }
+}
+
 OggOpusResult OggOpusDecoder::handle_opus_head_packet(const uint8_t* packet_data, size_t packet_len,
                                                       int64_t granule_pos, bool is_bos,
                                                       bool is_last_on_page) {
@@ -219,6 +280,18 @@ OggOpusResult OggOpusDecoder::handle_opus_head_packet(const uint8_t* packet_data
 
     // Determine output channel count: use configured value or file's channel count
     output_channels_ = (channels_ != 0) ? channels_ : opus_head_->channel_count;
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+    // Fixed-format builds decode to one format only. Without a configured count, libopus mixes the
+    // file's channels to it. Multistream streams are refused too, so the only decoder ever created
+    // is a plain OpusDecoder of the fixed format.
+    if (channels_ == 0) {
+        output_channels_ = MICRO_OPUS_FIXED_CHANNELS;
+    }
+    if (output_channels_ != MICRO_OPUS_FIXED_CHANNELS ||
+        sample_rate_ != MICRO_OPUS_FIXED_SAMPLE_RATE || opus_head_->channel_mapping != 0) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+#endif
 
     // Create Opus decoder
     OggOpusResult decoder_result = create_opus_decoder(output_channels_);
@@ -347,11 +420,6 @@ OggOpusResult OggOpusDecoder::handle_audio_packet(const uint8_t* packet_data, si
                                                   int64_t granule_pos, bool is_eos,
                                                   bool is_last_on_page, uint8_t* output,
                                                   size_t output_size, size_t& samples_decoded) {
-    // RFC 7845 Section 3: Mark EOS seen
-    if (is_eos) {
-        eos_seen_ = true;
-    }
-
     // RFC 7845 Section 4.1: MUST treat zero-octet audio data packet as malformed
     if (packet_len == 0) {
         return OGG_OPUS_INPUT_INVALID;
@@ -368,7 +436,7 @@ OggOpusResult OggOpusDecoder::handle_audio_packet(const uint8_t* packet_data, si
 
     if (nb_samples > 0) {
         size_t required_samples = static_cast<size_t>(nb_samples);
-        last_required_buffer_bytes_ = required_samples * output_channels_ * sizeof(int16_t);
+        last_required_buffer_bytes_ = required_samples * bytes_per_frame();
 
         // Check if output buffer is large enough
         if (output_size < last_required_buffer_bytes_) {
@@ -377,19 +445,37 @@ OggOpusResult OggOpusDecoder::handle_audio_packet(const uint8_t* packet_data, si
     }
 
     // Decode the packet into the caller's buffer. Mono/stereo go through the raw-packet decoder;
-    // multistream (channel mapping family 1) uses libopus's multistream API directly. The
-    // buffer-size check above means the raw-packet decoder never reports OUTPUT_BUFFER_TOO_SMALL.
+    // multistream (channel mapping family 1) uses libopus's multistream API directly, or the
+    // parallel decoder with set_multistream_workers(). The buffer-size check above means the
+    // raw-packet decoder never reports OUTPUT_BUFFER_TOO_SMALL.
     size_t decoded_samples_size = 0;
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    // Held across the packet decoder's own lease, so the multistream path is covered too
+    PseudostackLease pseudostack_lease;
+    if (!pseudostack_lease.ok()) {
+        return OGG_OPUS_ALLOCATION_FAILED;
+    }
+#endif
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    // Scoped to the rest of the packet, so pre-skip and end trimming are included in decode_total
+    ProfileScope profile_scope(profile_stats_);
+#endif
     if (packet_decoder_) {
         size_t bytes_written = 0;
         OpusPacketResult packet_result =
             packet_decoder_->decode(packet_data, packet_len, output, output_size, bytes_written);
-        if (packet_result != OPUS_PACKET_DECODER_SUCCESS) {
+        if (packet_result == OPUS_PACKET_DECODER_SILENCE) {
+            // Skipped with set_write_silent_channels(false): the samples count, the PCM is unset
+            decoded_samples_size = packet_decoder_->get_silent_samples();
+        } else if (packet_result != OPUS_PACKET_DECODER_SUCCESS) {
             return map_packet_decoder_result(packet_result);
+        } else {
+            decoded_samples_size = bytes_written / bytes_per_frame();
         }
-        decoded_samples_size = bytes_written / (output_channels_ * sizeof(int16_t));
+        silent_channel_mask_ =
+            packet_decoder_->is_last_packet_skipped() ? (1U << output_channels_) - 1 : 0;
     } else if (opus_ms_decoder_) {
-        size_t max_samples = output_size / (output_channels_ * sizeof(int16_t));
+        size_t max_samples = output_size / bytes_per_frame();
         int max_frame_size = (int)std::min(max_samples, (size_t)INT_MAX);
         int decoded_samples_int = opus_multistream_decode(
             opus_ms_decoder_, packet_data, (opus_int32)packet_len,
@@ -398,6 +484,17 @@ OggOpusResult OggOpusDecoder::handle_audio_packet(const uint8_t* packet_data, si
             return OGG_OPUS_DECODE_ERROR;
         }
         decoded_samples_size = (size_t)decoded_samples_int;
+        silent_channel_mask_ = 0;
+    } else if (parallel_ms_decoder_ && parallel_ms_decoder_->is_initialized()) {
+        size_t max_samples = output_size / bytes_per_frame();
+        int max_frame_size = (int)std::min(max_samples, (size_t)INT_MAX);
+        int decoded_samples_int = parallel_ms_decoder_->decode(
+            packet_data, (int32_t)packet_len, reinterpret_cast<int16_t*>(output), max_frame_size);
+        if (decoded_samples_int < 0) {
+            return OGG_OPUS_DECODE_ERROR;
+        }
+        decoded_samples_size = (size_t)decoded_samples_int;
+        silent_channel_mask_ = parallel_ms_decoder_->get_silent_channel_mask();
     } else {
         // Unreachable in STATE_DECODING: create_opus_decoder() always sets one backend.
         return OGG_OPUS_NOT_INITIALIZED;
@@ -513,30 +610,23 @@ OggOpusDecoder::OggOpusDecoder(bool enable_crc, uint32_t sample_rate, uint8_t ch
 }
 
 OggOpusDecoder::~OggOpusDecoder() {
-    if (opus_ms_decoder_) {
-        opus_multistream_decoder_destroy(opus_ms_decoder_);
-        opus_ms_decoder_ = nullptr;
-    }
+    destroy_opus_decoder();
+    ogg_decoder_free(pending_packet_);
 
-    // packet_decoder_, ogg_demuxer_, and opus_head_ are automatically cleaned up by unique_ptr
+    // ogg_demuxer_ and opus_head_ are automatically cleaned up by unique_ptr
 }
 
 void OggOpusDecoder::reset() {
-    // Drop the mono/stereo backend; a new one is built on the next OpusHead with that stream's
-    // channel count and gain.
-    packet_decoder_.reset();
-
-    if (opus_ms_decoder_) {
-        opus_multistream_decoder_destroy(opus_ms_decoder_);
-        opus_ms_decoder_ = nullptr;
-    }
+    // Drop the decode backend (returning its state to the pool, if any); a new one is built on the
+    // next OpusHead with that stream's channel count and gain.
+    destroy_opus_decoder();
 
     if (ogg_demuxer_) {
         ogg_demuxer_->reset();
     }
 
-    // Reset opus_head_ smart pointer
-    opus_head_.reset();
+    // opus_head_ keeps its allocation and is overwritten by the next OpusHead; until then the
+    // getters ignore it because state_ is not STATE_DECODING.
 
     state_ = STATE_EXPECT_OPUS_HEAD;
     // Note: sample_rate_ and channels_ are NOT reset - they are configuration values
@@ -547,6 +637,9 @@ void OggOpusDecoder::reset() {
     prev_page_granule_position_ = 0;
     samples_on_current_page_ = 0;
     last_required_buffer_bytes_ = 0;
+    reader_page_remaining_ = 0;
+    pending_packet_len_ = 0;  // The buffer is kept for the next stream
+    silent_channel_mask_ = 0;
     has_seen_opus_head_ = false;
     has_seen_opus_tags_ = false;
     opus_tags_magic_len_ = 0;
@@ -556,6 +649,37 @@ void OggOpusDecoder::reset() {
     eos_seen_ = false;
 }
 
+void OggOpusDecoder::set_decoder_pool(DecoderPool* pool) {
+    decoder_pool_ = pool;
+}
+
+void OggOpusDecoder::set_multistream_workers(uint8_t workers) {
+    multistream_workers_ = workers;
+}
+
+void OggOpusDecoder::set_skip_silence(bool enable) {
+    skip_silence_ = enable;
+    if (packet_decoder_) {
+        packet_decoder_->set_silence_mode(
+            packet_silence_mode(skip_silence_, write_silent_channels_));
+    }
+    if (parallel_ms_decoder_) {
+        parallel_ms_decoder_->set_skip_silence(enable);
+    }
+}
+
+void OggOpusDecoder::set_write_silent_channels(bool enable) {
+    write_silent_channels_ = enable;
+}
+
+bool OggOpusDecoder::is_last_packet_silent() const {
+    return packet_decoder_ && packet_decoder_->is_last_packet_silent();
+}
+
+uint64_t OggOpusDecoder::get_silent_channel_mask() const {
+    return silent_channel_mask_;
+}
+
 uint32_t OggOpusDecoder::get_sample_rate() const {
     return (state_ == STATE_DECODING) ? sample_rate_ : 0;
 }
@@ -586,6 +710,22 @@ size_t OggOpusDecoder::get_required_output_buffer_size() const {
     return last_required_buffer_bytes_;
 }
 
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+OpusProfileStats OggOpusDecoder::get_profile_stats() const {
+    OpusProfileStats stats = profile_stats_;
+    profile_timing_finish_snapshot(&stats);
+    return stats;
+}
+
+void OggOpusDecoder::reset_profile_stats() {
+    profile_timing_reset(&profile_stats_);
+}
+
+void OggOpusDecoder::set_profile_deadline_us(uint32_t deadline_us) {
+    profile_stats_.latency.deadline = profile_timing_us_to_ticks(deadline_us);
+}
+#endif  // MICRO_OPUS_ENABLE_PROFILING
+
 #ifdef MICRO_OGG_DEMUXER_DEBUG
 void OggOpusDecoder::get_demuxer_debug_state(int& state, bool& assembling, bool& skipping,
                                              size_t& packet_size, size_t& body_consumed,
@@ -627,6 +767,192 @@ OggOpusResult OggOpusDecoder::decode(const uint8_t* input, size_t input_len, uin
         }
     }
 
+    bytes_consumed = 0;
+    samples_decoded = 0;
+
+    // A packet held back by decode_many() comes before anything still in the input
+    if (pending_packet_len_ > 0) {
+        return decode_pending_packet(output, output_size, samples_decoded);
+    }
+
+    micro_ogg::OggPacket packet{};
+    bool has_audio_packet = false;
+    OggOpusResult result = demux_packet(input, input_len, bytes_consumed, packet, has_audio_packet);
+    if (result != OGG_OPUS_OK || !has_audio_packet) {
+        return result;
+    }
+
+    return handle_audio_packet(packet.data, packet.length, packet.granule_position, packet.is_eos,
+                               packet.is_last_on_page, output, output_size, samples_decoded);
+}
+
+OggOpusResult OggOpusDecoder::decode_many(const uint8_t* input, size_t input_len,
+                                          uint8_t* output, size_t output_size,
+                                          size_t& bytes_consumed, size_t& samples_decoded,
+                                          size_t& packets_decoded, size_t* packet_samples,
+                                          size_t max_packets) {
+    bytes_consumed = 0;
+    samples_decoded = 0;
+    packets_decoded = 0;
+
+    if (!input || (packet_samples != nullptr && max_packets == 0)) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+    if (state_ == STATE_DECODING) {
+        if (!output) {
+            return OGG_OPUS_INPUT_INVALID;
+        }
+        if (output_size == 0) {
+            return OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL;
+        }
+    }
+
+    while (max_packets == 0 || packets_decoded < max_packets) {
+        micro_ogg::OggPacket packet{};
+        const bool from_pending = (pending_packet_len_ > 0);
+
+        if (!from_pending) {
+            // RFC 7845 Section 3: nothing may follow the end-of-stream packet
+            if (eos_seen_) {
+                break;
+            }
+
+            size_t consumed = 0;
+            bool has_audio_packet = false;
+            OggOpusResult result = demux_packet(input + bytes_consumed, input_len - bytes_consumed,
+                                                consumed, packet, has_audio_packet);
+            bytes_consumed += consumed;
+            if (result != OGG_OPUS_OK) {
+                return result;
+            }
+            if (!has_audio_packet) {
+                if (consumed == 0) {
+                    break;  // Need more input
+                }
+                continue;  // Header packet or skipped data
+            }
+        }
+
+        // Headers may have completed during this call: the output is only checked from here
+        const size_t used = samples_decoded * bytes_per_frame();
+        uint8_t* packet_output = (output != nullptr) ? output + used : nullptr;
+        const size_t packet_output_size = (output != nullptr) ? output_size - used : 0;
+
+        size_t packet_samples_decoded = 0;
+        OggOpusResult result =
+            from_pending
+                ? decode_pending_packet(packet_output, packet_output_size, packet_samples_decoded)
+                : handle_audio_packet(packet.data, packet.length, packet.granule_position,
+                                      packet.is_eos, packet.is_last_on_page, packet_output,
+                                      packet_output_size, packet_samples_decoded);
+
+        if (result == OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL) {
+            // handle_audio_packet() rejects a packet that does not fit before touching any
+            // state, so it can be decoded later exactly as if it were new
+            if (!from_pending) {
+                OggOpusResult hold_result = hold_pending_packet(packet);
+                if (hold_result != OGG_OPUS_OK) {
+                    return hold_result;
+                }
+            }
+            return (packets_decoded > 0) ? OGG_OPUS_OK : OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL;
+        }
+        if (result != OGG_OPUS_OK) {
+            return result;
+        }
+
+        if (packet_samples != nullptr) {
+            packet_samples[packets_decoded] = packet_samples_decoded;
+        }
+        ++packets_decoded;
+        samples_decoded += packet_samples_decoded;
+    }
+
+    return OGG_OPUS_OK;
+}
+
+OggOpusResult OggOpusDecoder::hold_pending_packet(const micro_ogg::OggPacket& packet) {
+    if (packet.length > pending_packet_capacity_) {
+        void* grown = ogg_decoder_realloc(pending_packet_, packet.length);
+        if (!grown) {
+            return OGG_OPUS_ALLOCATION_FAILED;
+        }
+        pending_packet_ = static_cast<uint8_t*>(grown);
+        pending_packet_capacity_ = packet.length;
+    }
+
+    std::memcpy(pending_packet_, packet.data, packet.length);
+    pending_packet_len_ = packet.length;
+    pending_granule_position_ = packet.granule_position;
+    pending_is_eos_ = packet.is_eos;
+    pending_is_last_on_page_ = packet.is_last_on_page;
+    return OGG_OPUS_OK;
+}
+
+OggOpusResult OggOpusDecoder::decode_pending_packet(uint8_t* output, size_t output_size,
+                                                    size_t& samples_decoded) {
+    OggOpusResult result = handle_audio_packet(
+        pending_packet_, pending_packet_len_, pending_granule_position_, pending_is_eos_,
+        pending_is_last_on_page_, output, output_size, samples_decoded);
+    if (result != OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL) {
+        pending_packet_len_ = 0;
+    }
+    return result;
+}
+
+OggOpusResult OggOpusDecoder::decode(OggOpusReader& reader, uint8_t* output, size_t output_size,
+                                     size_t& samples_decoded) {
+    samples_decoded = 0;
+
+    while (true) {
+        size_t available = 0;
+
+        if (reader_page_remaining_ == 0) {
+            // At a page boundary: size the next page from its header and lacing table
+            const uint8_t* header = reader.peek(OGG_PAGE_HEADER_SIZE, available);
+            if (available < OGG_PAGE_HEADER_SIZE) {
+                return OGG_OPUS_OK;
+            }
+            if (std::memcmp(header, "OggS", 4) != 0) {
+                // Not a page: hand the bytes to the demuxer, which reports the error
+                reader_page_remaining_ = OGG_PAGE_HEADER_SIZE;
+            } else {
+                const size_t header_size =
+                    OGG_PAGE_HEADER_SIZE + header[OGG_PAGE_SEGMENT_COUNT_OFFSET];
+                const uint8_t* lacing = reader.peek(header_size, available);
+                if (available < header_size) {
+                    return OGG_OPUS_OK;
+                }
+                size_t page_size = header_size;
+                for (size_t i = OGG_PAGE_HEADER_SIZE; i < header_size; ++i) {
+                    page_size += lacing[i];
+                }
+                reader_page_remaining_ = page_size;
+            }
+        }
+
+        // The rest of the page; if the reader returns less, the demuxer buffers the partial page
+        const uint8_t* data = reader.peek(reader_page_remaining_, available);
+        if (available == 0) {
+            return OGG_OPUS_OK;
+        }
+
+        size_t consumed = 0;
+        OggOpusResult result = decode(data, std::min(available, reader_page_remaining_), output,
+                                      output_size, consumed, samples_decoded);
+        reader.skip(consumed);
+        reader_page_remaining_ -= consumed;
+
+        if (result != OGG_OPUS_OK || samples_decoded > 0 || consumed == 0) {
+            return result;
+        }
+    }
+}
+
+OggOpusResult OggOpusDecoder::demux_packet(const uint8_t* input, size_t input_len,
+                                           size_t& bytes_consumed,
+                                           micro_ogg::OggPacket& audio_packet,
+                                           bool& has_audio_packet) {
     // RFC 7845 Section 3: Enforce end of stream validation
     // "There MUST NOT be any more pages in an Opus logical bitstream after a page marked 'end of
     // stream'." This is a codec-specific requirement (Opus), not a container requirement (Ogg
@@ -646,56 +972,14 @@ OggOpusResult OggOpusDecoder::decode(const uint8_t* input, size_t input_len, uin
 
 #ifdef ESP_PLATFORM
         // Use preference-aware allocators on ESP32 (configurable via Kconfig)
-        struct AllocFns {
-            static void* alloc_fn(size_t size) {
-#if defined(CONFIG_OPUS_OGG_DECODER_PREFER_PSRAM)
-                return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
-                                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_INTERNAL)
-                return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
-                                               MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_PSRAM_ONLY)
-                return heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_INTERNAL_ONLY)
-                return heap_caps_malloc(size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#else
-                // Default: prefer PSRAM with fallback to internal RAM
-                return heap_caps_malloc_prefer(size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
-                                               MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#endif
-            }
-            static void* realloc_fn(void* ptr, size_t size) {
-#if defined(CONFIG_OPUS_OGG_DECODER_PREFER_PSRAM)
-                return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
-                                                MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_PREFER_INTERNAL)
-                return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT,
-                                                MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_PSRAM_ONLY)
-                return heap_caps_realloc(ptr, size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
-#elif defined(CONFIG_OPUS_OGG_DECODER_INTERNAL_ONLY)
-                return heap_caps_realloc(ptr, size, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#else
-                // Default: prefer PSRAM with fallback to internal RAM
-                return heap_caps_realloc_prefer(ptr, size, 2, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT,
-                                                MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
-#endif
-            }
-            static void free_fn(void* ptr) {
-                heap_caps_free(ptr);
-            }
-        };
-        ogg_config.alloc = AllocFns::alloc_fn;
-        ogg_config.realloc = AllocFns::realloc_fn;
-        ogg_config.free = AllocFns::free_fn;
+        ogg_config.alloc = ogg_decoder_malloc;
+        ogg_config.realloc = ogg_decoder_realloc;
+        ogg_config.free = ogg_decoder_free;
 #endif
 
         ogg_demuxer_ = std::make_unique<micro_ogg::OggDemuxer>(ogg_config);
     }
 
-    bytes_consumed = 0;
-    samples_decoded = 0;
-
     // Stream through OpusTags using get_next_data() to avoid buffering
     if (state_ == STATE_EXPECT_OPUS_TAGS || state_ == STATE_STREAMING_OPUS_TAGS) {
         return stream_opus_tags(input, input_len, bytes_consumed);
@@ -715,10 +999,18 @@ OggOpusResult OggOpusDecoder::decode(const uint8_t* input, size_t input_len, uin
     }
 
     if (parse_state.result == micro_ogg::OGG_OK) {
-        // We have a complete packet - process it
-        OggOpusResult result =
-            process_packet(parse_state.packet, output, output_size, samples_decoded);
-        return result;
+        if (state_ != STATE_DECODING) {
+            return process_header_packet(parse_state.packet);
+        }
+
+        // RFC 7845 Section 3: Mark EOS seen
+        if (parse_state.packet.is_eos) {
+            eos_seen_ = true;
+        }
+
+        audio_packet = parse_state.packet;
+        has_audio_packet = true;
+        return OGG_OPUS_OK;
     }
 
     // Demuxer encountered error
@@ -0,0 +1,73 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "micro_opus/ogg_opus_reader.h"
+
+#include "ogg_decoder_alloc.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace micro_opus {
+
+OggOpusBufferedReader::OggOpusBufferedReader(size_t max_buffer_size)
+    : max_buffer_size_(std::max<size_t>(max_buffer_size, 1)) {}
+
+OggOpusBufferedReader::~OggOpusBufferedReader() {
+    ogg_decoder_free(this->buffer_);
+}
+
+const uint8_t* OggOpusBufferedReader::peek(size_t bytes, size_t& available) {
+    const size_t wanted = std::min(bytes, this->max_buffer_size_);
+
+    if (this->end_ - this->start_ < wanted) {
+        // Move the unconsumed tail to the front so the wanted bytes end up contiguous
+        if (this->start_ > 0) {
+            std::memmove(this->buffer_, this->buffer_ + this->start_, this->end_ - this->start_);
+            this->end_ -= this->start_;
+            this->start_ = 0;
+        }
+
+        if (this->capacity_ < wanted) {
+            void* grown = ogg_decoder_realloc(this->buffer_, wanted);
+            if (grown != nullptr) {
+                this->buffer_ = static_cast<uint8_t*>(grown);
+                this->capacity_ = wanted;
+            }
+            // On failure, carry on with the old buffer: the decoder buffers partial pages itself
+        }
+
+        const size_t target = std::min(wanted, this->capacity_);
+        while (this->end_ < target) {
+            const size_t got = this->read(this->buffer_ + this->end_, target - this->end_);
+            if (got == 0) {
+                break;
+            }
+            this->end_ += got;
+        }
+    }
+
+    available = this->end_ - this->start_;
+    return (available > 0) ? this->buffer_ + this->start_ : nullptr;
+}
+
+void OggOpusBufferedReader::skip(size_t bytes) {
+    this->start_ += std::min(bytes, this->end_ - this->start_);
+    if (this->start_ == this->end_) {
+        this->start_ = 0;
+        this->end_ = 0;
+    }
+}
+
+}  // namespace micro_opus
@@ -18,10 +18,16 @@
 
 #include "micro_opus/opus_packet_decoder.h"
 
+#include "celt_only_decoder.h"
+#include "micro_opus/decoder_pool.h"
+#include "micro_opus/opus_packet_info.h"
 #include "opus.h"
+#include "profile_scope.h"
+#include "pseudostack_lease.h"
 
 #include <algorithm>
 #include <climits>
+#include <cstring>
 
 namespace micro_opus {
 
@@ -29,23 +35,37 @@ namespace micro_opus {
 // Lifecycle
 // ============================================================================
 
-OpusPacketDecoder::OpusPacketDecoder(uint32_t sample_rate, uint8_t channels) {
+OpusPacketDecoder::OpusPacketDecoder(uint32_t sample_rate, uint8_t channels,
+                                     OpusStreamModes stream_modes)
+    : stream_modes_(stream_modes) {
     this->pcm_format_.sample_rate_ = sample_rate;
     this->pcm_format_.num_channels_ = channels;
 }
 
 OpusPacketDecoder::~OpusPacketDecoder() {
-    if (this->opus_decoder_ != nullptr) {
+    if (this->celt_decoder_ != nullptr) {
+        micro_opus_celt_decoder_destroy(this->celt_decoder_);
+        this->celt_decoder_ = nullptr;
+    }
+    if (this->opus_decoder_ == nullptr) {
+        return;
+    }
+    if (this->decoder_pool_ != nullptr) {
+        this->decoder_pool_->release(this->opus_decoder_, this->pcm_format_.sample_rate(),
+                                     static_cast<uint8_t>(this->pcm_format_.num_channels()));
+    } else {
         opus_decoder_destroy(this->opus_decoder_);
-        this->opus_decoder_ = nullptr;
     }
+    this->opus_decoder_ = nullptr;
 }
 
 void OpusPacketDecoder::reset() {
-    if (this->opus_decoder_ != nullptr) {
-        opus_decoder_ctl(this->opus_decoder_, OPUS_RESET_STATE);
-    }
+    this->reset_decoder_state();
     this->required_output_bytes_ = 0;
+    this->last_frame_samples_ = 0;
+    this->silence_run_samples_ = 0;
+    this->last_packet_silent_ = false;
+    this->silence_skipping_ = false;
 }
 
 // ============================================================================
@@ -58,6 +78,9 @@ void OpusPacketDecoder::set_output_gain(int16_t output_gain) {
     if (this->opus_decoder_ != nullptr) {
         opus_decoder_ctl(this->opus_decoder_, OPUS_SET_GAIN(static_cast<opus_int32>(output_gain)));
     }
+    if (this->celt_decoder_ != nullptr) {
+        micro_opus_celt_decoder_set_gain(this->celt_decoder_, output_gain);
+    }
 }
 
 // ============================================================================
@@ -77,33 +100,60 @@ OpusPacketResult OpusPacketDecoder::decode(const uint8_t* input, size_t input_le
         return init_result;
     }
 
-    const size_t bytes_per_frame = this->pcm_format_.num_channels() * sizeof(int16_t);
+    if (this->silence_mode_ != OPUS_SILENCE_DECODE ||
+        this->stream_modes_ == OPUS_STREAM_CELT_ONLY) {
+        // Silence detection and the CELT-only decoder need the frame table; the parse also gives
+        // the packet's duration
+        OpusPacketInfo info;
+        if (parse_opus_packet_info(input, input_len, info) == OPUS_PACKET_INFO_OK) {
+            return this->decode(info, output, output_size_bytes, bytes_written);
+        }
+    }
+    this->last_packet_silent_ = false;
 
     // An invalid packet makes opus_packet_get_nb_samples() return < 0; skip the up-front size
     // check then and let opus_decode() report the specific failure.
     int nb_samples =
         opus_packet_get_nb_samples(input, static_cast<opus_int32>(input_len),
-                                   static_cast<opus_int32>(this->pcm_format_.sample_rate()));
-    if (nb_samples > 0) {
-        this->required_output_bytes_ = static_cast<size_t>(nb_samples) * bytes_per_frame;
-        if (output_size_bytes < this->required_output_bytes_) {
-            return OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL;
-        }
+                                   static_cast<opus_int32>(this->output_sample_rate()));
+    return this->decode_sized(input, input_len, nb_samples, nullptr, output, output_size_bytes,
+                              bytes_written);
+}
+
+OpusPacketResult OpusPacketDecoder::decode(const OpusPacketInfo& info, uint8_t* output,
+                                           size_t output_size_bytes, size_t& bytes_written) {
+    bytes_written = 0;
+
+    if (info.packet == nullptr || info.packet_len == 0 || output == nullptr) {
+        return OPUS_PACKET_DECODER_ERROR_INPUT_INVALID;
     }
 
-    int max_frame_size = static_cast<int>(
-        std::min(output_size_bytes / bytes_per_frame, static_cast<size_t>(INT_MAX)));
+    // Rejects an unsupported sample rate before get_samples() uses it
+    OpusPacketResult init_result = this->ensure_decoder();
+    if (init_result < 0) {
+        return init_result;
+    }
 
-    int decoded = opus_decode(this->opus_decoder_, input, static_cast<opus_int32>(input_len),
-                              reinterpret_cast<int16_t*>(output), max_frame_size, 0);
-    if (decoded < 0) {
-        return (decoded == OPUS_BUFFER_TOO_SMALL)
-                   ? OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL
-                   : OPUS_PACKET_DECODER_ERROR_DECODE_FAILED;
+    // The duration is already known from the caller's parse; no TOC query needed
+    const uint32_t sample_rate = this->output_sample_rate();
+    const size_t nb_samples = info.get_samples(sample_rate);
+    constexpr uint32_t SILENCE_SETTLE_FRAMES_PER_SECOND = 50;  // 20 ms
+
+    this->last_packet_silent_ = (this->silence_mode_ != OPUS_SILENCE_DECODE) && info.is_silent();
+    if (this->last_packet_silent_ &&
+        this->silence_run_samples_ >= sample_rate / SILENCE_SETTLE_FRAMES_PER_SECOND) {
+        return this->skip_silence(nb_samples, output, output_size_bytes, bytes_written);
     }
 
-    bytes_written = static_cast<size_t>(decoded) * bytes_per_frame;
-    return OPUS_PACKET_DECODER_SUCCESS;
+    const size_t silence_run_samples = this->silence_run_samples_;
+    OpusPacketResult result =
+        this->decode_sized(info.packet, info.packet_len, static_cast<int>(nb_samples), &info,
+                           output, output_size_bytes, bytes_written);
+    if (result == OPUS_PACKET_DECODER_SUCCESS && this->last_packet_silent_) {
+        // Let libopus fade out the audio before the silence; skip once it has had 20 ms
+        this->silence_run_samples_ = silence_run_samples + nb_samples;
+    }
+    return result;
 }
 
 OpusPacketResult OpusPacketDecoder::conceal_loss(uint8_t* output, size_t output_size_bytes,
@@ -119,39 +169,315 @@ OpusPacketResult OpusPacketDecoder::conceal_loss(uint8_t* output, size_t output_
         return init_result;
     }
 
-    const size_t bytes_per_frame = this->pcm_format_.num_channels() * sizeof(int16_t);
+    const size_t bytes_per_frame = this->bytes_per_frame();
 
     this->required_output_bytes_ = frame_size_samples * bytes_per_frame;
     if (output_size_bytes < this->required_output_bytes_) {
         return OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL;
     }
 
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    PseudostackLease pseudostack_lease;
+    if (!pseudostack_lease.ok()) {
+        return OPUS_PACKET_DECODER_ERROR_ALLOCATION_FAILED;
+    }
+#endif
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    ProfileScope profile_scope(this->profile_stats_);
+#endif
     // A null packet asks libopus to synthesize one frame of concealment audio from recent history.
-    int decoded = opus_decode(this->opus_decoder_, nullptr, 0, reinterpret_cast<int16_t*>(output),
-                              static_cast<int>(frame_size_samples), 0);
+    int decoded = this->run_decoder(nullptr, 0, nullptr, reinterpret_cast<int16_t*>(output),
+                                    static_cast<int>(frame_size_samples));
     if (decoded < 0) {
         return (decoded == OPUS_BUFFER_TOO_SMALL)
                    ? OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL
                    : OPUS_PACKET_DECODER_ERROR_DECODE_FAILED;
     }
 
+    this->last_frame_samples_ = static_cast<size_t>(decoded);
+    this->silence_run_samples_ = 0;
+    this->silence_skipping_ = false;
     bytes_written = static_cast<size_t>(decoded) * bytes_per_frame;
     return OPUS_PACKET_DECODER_SUCCESS;
 }
 
+OpusPacketResult OpusPacketDecoder::decode_batch(const OpusPacketSpan* packets,
+                                                 size_t packet_count, uint8_t* output,
+                                                 size_t output_size_bytes, size_t& packets_decoded,
+                                                 size_t& bytes_written, size_t* packet_samples) {
+    packets_decoded = 0;
+    bytes_written = 0;
+
+    if (packets == nullptr || packet_count == 0 || output == nullptr) {
+        return OPUS_PACKET_DECODER_ERROR_INPUT_INVALID;
+    }
+
+    OpusPacketResult init_result = this->ensure_decoder();
+    if (init_result < 0) {
+        return init_result;
+    }
+
+    const size_t bytes_per_frame = this->bytes_per_frame();
+    constexpr uint32_t DEFAULT_CONCEAL_FRAMES_PER_SECOND = 50;  // 20 ms
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    // One lease for the whole batch rather than one per packet
+    PseudostackLease pseudostack_lease;
+    if (!pseudostack_lease.ok()) {
+        return OPUS_PACKET_DECODER_ERROR_ALLOCATION_FAILED;
+    }
+#endif
+
+    OpusPacketResult result = OPUS_PACKET_DECODER_SUCCESS;
+    for (; packets_decoded < packet_count; ++packets_decoded) {
+        const OpusPacketSpan& packet = packets[packets_decoded];
+        const size_t capacity = this->bytes_to_frames(output_size_bytes - bytes_written);
+        int16_t* pcm = reinterpret_cast<int16_t*>(output + bytes_written);
+        int decoded = 0;
+
+        if (packet.lost) {
+            const size_t conceal_samples =
+                (this->last_frame_samples_ > 0)
+                    ? this->last_frame_samples_
+                    : this->output_sample_rate() / DEFAULT_CONCEAL_FRAMES_PER_SECOND;
+            if (capacity < conceal_samples) {
+                this->required_output_bytes_ = conceal_samples * bytes_per_frame;
+                result = OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL;
+                break;
+            }
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+            ProfileScope profile_scope(this->profile_stats_);
+#endif
+            decoded =
+                this->run_decoder(nullptr, 0, nullptr, pcm, static_cast<int>(conceal_samples));
+        } else {
+            if (packet.data == nullptr || packet.length == 0) {
+                result = OPUS_PACKET_DECODER_ERROR_INPUT_INVALID;
+                break;
+            }
+            // libopus parses the TOC and rejects a packet longer than the capacity before
+            // touching its state, so no separate opus_packet_get_nb_samples() query is needed
+            if (capacity == 0) {
+                // Float builds would reject a zero frame size as OPUS_BAD_ARG
+                decoded = OPUS_BUFFER_TOO_SMALL;
+            } else {
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+                ProfileScope profile_scope(this->profile_stats_);
+#endif
+                const int max_frame_size =
+                    static_cast<int>(std::min(capacity, static_cast<size_t>(INT_MAX)));
+                decoded = this->run_decoder(packet.data, packet.length, nullptr, pcm,
+                                            max_frame_size);
+            }
+            if (decoded == OPUS_BUFFER_TOO_SMALL) {
+                // Only now work out the size this packet needs, for get_required_output_bytes()
+                const int nb_samples = opus_packet_get_nb_samples(
+                    packet.data, static_cast<opus_int32>(packet.length),
+                    static_cast<opus_int32>(this->output_sample_rate()));
+                if (nb_samples > 0) {
+                    this->required_output_bytes_ =
+                        static_cast<size_t>(nb_samples) * bytes_per_frame;
+                }
+            }
+        }
+
+        if (decoded < 0) {
+            result = (decoded == OPUS_BUFFER_TOO_SMALL)
+                         ? OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL
+                         : OPUS_PACKET_DECODER_ERROR_DECODE_FAILED;
+            break;
+        }
+
+        this->last_frame_samples_ = static_cast<size_t>(decoded);
+        this->silence_run_samples_ = 0;
+        this->silence_skipping_ = false;
+        this->required_output_bytes_ = static_cast<size_t>(decoded) * bytes_per_frame;
+        bytes_written += this->required_output_bytes_;
+        if (packet_samples != nullptr) {
+            packet_samples[packets_decoded] = static_cast<size_t>(decoded);
+        }
+    }
+
+    // Running out of output after some packets is the expected way for a batch to end early
+    if (result == OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL && packets_decoded > 0) {
+        return OPUS_PACKET_DECODER_SUCCESS;
+    }
+    return result;
+}
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+// ============================================================================
+// Profiling
+// ============================================================================
+
+OpusProfileStats OpusPacketDecoder::get_profile_stats() const {
+    OpusProfileStats stats = this->profile_stats_;
+    profile_timing_finish_snapshot(&stats);
+    return stats;
+}
+
+void OpusPacketDecoder::reset_profile_stats() {
+    profile_timing_reset(&this->profile_stats_);
+}
+
+void OpusPacketDecoder::set_profile_deadline_us(uint32_t deadline_us) {
+    this->profile_stats_.latency.deadline = profile_timing_us_to_ticks(deadline_us);
+}
+#endif  // MICRO_OPUS_ENABLE_PROFILING
+
 // ============================================================================
 // Decode Pipeline
 // ============================================================================
 
-OpusPacketResult OpusPacketDecoder::ensure_decoder() {
+OpusPacketResult OpusPacketDecoder::decode_sized(const uint8_t* input, size_t input_len,
+                                                 int nb_samples, const OpusPacketInfo* info,
+                                                 uint8_t* output, size_t output_size_bytes,
+                                                 size_t& bytes_written) {
+    const size_t bytes_per_frame = this->bytes_per_frame();
+
+    if (nb_samples > 0) {
+        this->required_output_bytes_ = static_cast<size_t>(nb_samples) * bytes_per_frame;
+        if (output_size_bytes < this->required_output_bytes_) {
+            return OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL;
+        }
+    }
+
+    int max_frame_size = static_cast<int>(
+        std::min(this->bytes_to_frames(output_size_bytes), static_cast<size_t>(INT_MAX)));
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    PseudostackLease pseudostack_lease;
+    if (!pseudostack_lease.ok()) {
+        return OPUS_PACKET_DECODER_ERROR_ALLOCATION_FAILED;
+    }
+#endif
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    ProfileScope profile_scope(this->profile_stats_);
+#endif
+    int decoded = this->run_decoder(input, input_len, info, reinterpret_cast<int16_t*>(output),
+                                    max_frame_size);
+    if (decoded < 0) {
+        return (decoded == OPUS_BUFFER_TOO_SMALL)
+                   ? OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL
+                   : OPUS_PACKET_DECODER_ERROR_DECODE_FAILED;
+    }
+
+    this->last_frame_samples_ = static_cast<size_t>(decoded);
+    this->silence_run_samples_ = 0;
+    this->silence_skipping_ = false;
+    bytes_written = static_cast<size_t>(decoded) * bytes_per_frame;
+    return OPUS_PACKET_DECODER_SUCCESS;
+}
+
+OpusPacketResult OpusPacketDecoder::skip_silence(size_t nb_samples, uint8_t* output,
+                                                 size_t output_size_bytes, size_t& bytes_written) {
+    const size_t bytes_per_frame = this->bytes_per_frame();
+
+    this->required_output_bytes_ = nb_samples * bytes_per_frame;
+    if (this->silence_mode_ == OPUS_SILENCE_ZERO_FILL &&
+        output_size_bytes < this->required_output_bytes_) {
+        return OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL;
+    }
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+    ProfileScope profile_scope(this->profile_stats_);
+#endif
+    if (!this->silence_skipping_) {
+        // The output is digital silence from here on; start the next audio from matching state
+        this->reset_decoder_state();
+        this->silence_skipping_ = true;
+    }
+    this->last_frame_samples_ = nb_samples;
+
+    if (this->silence_mode_ == OPUS_SILENCE_REPORT) {
+        return OPUS_PACKET_DECODER_SILENCE;
+    }
+    std::memset(output, 0, this->required_output_bytes_);
+    bytes_written = this->required_output_bytes_;
+    return OPUS_PACKET_DECODER_SUCCESS;
+}
+
+int OpusPacketDecoder::run_decoder(const uint8_t* input, size_t input_len,
+                                   const OpusPacketInfo* info, int16_t* pcm, int max_samples) {
+    if (this->celt_decoder_ == nullptr) {
+        return opus_decode(this->opus_decoder_, input, static_cast<opus_int32>(input_len), pcm,
+                           max_samples, 0);
+    }
+    if (input == nullptr) {
+        return micro_opus_celt_conceal(this->celt_decoder_, pcm, max_samples);
+    }
+    if (info != nullptr) {
+        return this->run_celt_decoder(*info, pcm, max_samples);
+    }
+    OpusPacketInfo parsed;
+    if (parse_opus_packet_info(input, input_len, parsed) != OPUS_PACKET_INFO_OK) {
+        return OPUS_INVALID_PACKET;
+    }
+    return this->run_celt_decoder(parsed, pcm, max_samples);
+}
+
+int OpusPacketDecoder::run_celt_decoder(const OpusPacketInfo& info, int16_t* pcm,
+                                        int max_samples) {
+    if (info.mode != OPUS_PACKET_MODE_CELT) {
+        return OPUS_INVALID_PACKET;
+    }
+    const uint32_t sample_rate = this->output_sample_rate();
+    if (static_cast<int64_t>(info.get_samples(sample_rate)) > max_samples) {
+        return OPUS_BUFFER_TOO_SMALL;
+    }
+
+    // Each frame as opus_decode_frame() hands it to CELT, minus the SILK and transition paths
+    const int frame_samples = static_cast<int>(info.frame_samples / (48000 / sample_rate));
+    return micro_opus_celt_decode_packet(this->celt_decoder_, info.frames, info.frame_sizes,
+                                         info.frame_count, info.bandwidth, info.stereo ? 2 : 1,
+                                         pcm, frame_samples);
+}
+
+void OpusPacketDecoder::reset_decoder_state() {
     if (this->opus_decoder_ != nullptr) {
+        opus_decoder_ctl(this->opus_decoder_, OPUS_RESET_STATE);
+    }
+    if (this->celt_decoder_ != nullptr) {
+        micro_opus_celt_decoder_reset(this->celt_decoder_);
+    }
+}
+
+OpusPacketResult OpusPacketDecoder::ensure_decoder() {
+    if (this->opus_decoder_ != nullptr || this->celt_decoder_ != nullptr) {
         return OPUS_PACKET_DECODER_SUCCESS;
     }
 
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+    // The staged CELT decoder and bytes_per_frame() only handle the build's output format
+    if (this->pcm_format_.sample_rate() != MICRO_OPUS_FIXED_SAMPLE_RATE ||
+        this->pcm_format_.num_channels() != MICRO_OPUS_FIXED_CHANNELS) {
+        return OPUS_PACKET_DECODER_ERROR_INPUT_INVALID;
+    }
+#endif
+
     int error = 0;
-    this->opus_decoder_ =
-        opus_decoder_create(static_cast<opus_int32>(this->pcm_format_.sample_rate()),
-                            static_cast<int>(this->pcm_format_.num_channels()), &error);
+    if (this->stream_modes_ == OPUS_STREAM_CELT_ONLY) {
+        // Bare CELT state; pools only hold full libopus states
+        this->celt_decoder_ = micro_opus_celt_decoder_create(
+            static_cast<opus_int32>(this->pcm_format_.sample_rate()),
+            static_cast<int>(this->pcm_format_.num_channels()), &error);
+        if (this->celt_decoder_ == nullptr) {
+            return (error == OPUS_BAD_ARG) ? OPUS_PACKET_DECODER_ERROR_INPUT_INVALID
+                                           : OPUS_PACKET_DECODER_ERROR_ALLOCATION_FAILED;
+        }
+        micro_opus_celt_decoder_set_gain(this->celt_decoder_, this->output_gain_);
+        return OPUS_PACKET_DECODER_SUCCESS;
+    }
+
+    if (this->decoder_pool_ != nullptr) {
+        this->opus_decoder_ = this->decoder_pool_->acquire(
+            this->pcm_format_.sample_rate(),
+            static_cast<uint8_t>(this->pcm_format_.num_channels()), error);
+    } else {
+        this->opus_decoder_ =
+            opus_decoder_create(static_cast<opus_int32>(this->pcm_format_.sample_rate()),
+                                static_cast<int>(this->pcm_format_.num_channels()), &error);
+    }
     if (this->opus_decoder_ == nullptr) {
         // OPUS_BAD_ARG means an unsupported sample rate or channel count was given to the
         // constructor; anything else (e.g. OPUS_ALLOC_FAIL) is an out-of-memory condition.
@@ -160,7 +486,8 @@ OpusPacketResult OpusPacketDecoder::ensure_decoder() {
     }
 
     // Apply any gain set before allocation (e.g. a forwarded OpusHead output_gain).
-    // Unity gain (0) is the libopus default, so skip the ctl.
+    // Unity gain (0) is the libopus default, and pooled states are returned at unity, so skip the
+    // ctl.
     if (this->output_gain_ != 0) {
         opus_decoder_ctl(this->opus_decoder_,
                          OPUS_SET_GAIN(static_cast<opus_int32>(this->output_gain_)));
@@ -0,0 +1,231 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Opus Packet Inspection
+ * Implements RFC 6716 Section 3 TOC and frame-length parsing, mirroring libopus's
+ * opus_packet_parse_impl() for non-self-delimited packets
+ */
+
+#include "micro_opus/opus_packet_info.h"
+
+namespace micro_opus {
+
+namespace {
+
+// RFC 6716 Section 3.2.1: a frame holds at most 1275 bytes
+constexpr int32_t MAX_FRAME_BYTES = 1275;
+
+// RFC 6716 Section 3.2.5: a packet holds at most 120 ms of audio
+constexpr uint32_t MAX_PACKET_SAMPLES_48K = 5760;
+
+// RFC 6716 Section 3.2.1: a frame length is one byte below 252, else two bytes
+int32_t parse_frame_size(const uint8_t* data, int32_t len, int32_t& size) {
+    if (len < 1) {
+        return -1;
+    }
+    if (data[0] < 252) {
+        size = data[0];
+        return 1;
+    }
+    if (len < 2) {
+        return -1;
+    }
+    size = 4 * data[1] + data[0];
+    return 2;
+}
+
+// The first symbol the CELT decoder reads from a CELT-only frame is its silence flag, coded with
+// probability 1/2^15 (celt_decode_with_ec()). Replays ec_dec_init() and ec_dec_bit_logp(15).
+bool celt_silence_flag(const uint8_t* frame, size_t size) {
+    constexpr uint32_t EC_CODE_TOP = 1U << 31;
+    constexpr uint32_t EC_CODE_BOT = 1U << 23;
+    constexpr uint32_t EC_CODE_EXTRA = 7;
+    constexpr uint32_t SILENCE_LOGP = 15;
+
+    size_t offset = 0;
+    auto read_byte = [frame, size, &offset]() -> uint32_t {
+        return (offset < size) ? frame[offset++] : 0U;
+    };
+
+    uint32_t rng = 1U << EC_CODE_EXTRA;
+    uint32_t rem = read_byte();
+    uint32_t val = rng - 1 - (rem >> (8 - EC_CODE_EXTRA));
+    while (rng <= EC_CODE_BOT) {
+        rng <<= 8;
+        uint32_t sym = rem;
+        rem = read_byte();
+        sym = (sym << 8 | rem) >> (8 - EC_CODE_EXTRA);
+        val = ((val << 8) + (0xFFU & ~sym)) & (EC_CODE_TOP - 1);
+    }
+    return val < (rng >> SILENCE_LOGP);
+}
+
+}  // namespace
+
+OpusPacketInfoResult parse_opus_packet_info(const uint8_t* packet, size_t packet_len,
+                                            OpusPacketInfo& info) {
+    if (packet == nullptr || packet_len == 0) {
+        return OPUS_PACKET_INFO_EMPTY;
+    }
+    if (packet_len > static_cast<size_t>(INT32_MAX)) {
+        return OPUS_PACKET_INFO_INVALID;
+    }
+
+    // RFC 6716 Section 3.1: config (5 bits), stereo flag, frame count code (2 bits)
+    const uint8_t toc = packet[0];
+    info.packet = packet;
+    info.packet_len = packet_len;
+    info.config = static_cast<uint8_t>(toc >> 3);
+    info.stereo = (toc & 0x04) != 0;
+    info.padding_len = 0;
+    info.silent_frames = 0;
+
+    if (info.config < 12) {
+        static constexpr uint16_t SILK_FRAME_SAMPLES[4] = {480, 960, 1920, 2880};
+        info.mode = OPUS_PACKET_MODE_SILK;
+        info.bandwidth = static_cast<OpusPacketBandwidth>(info.config >> 2);
+        info.frame_samples = SILK_FRAME_SAMPLES[info.config & 0x3];
+    } else if (info.config < 16) {
+        info.mode = OPUS_PACKET_MODE_HYBRID;
+        info.bandwidth = (info.config < 14) ? OPUS_PACKET_BANDWIDTH_SUPERWIDEBAND
+                                            : OPUS_PACKET_BANDWIDTH_FULLBAND;
+        info.frame_samples = (info.config & 0x1) ? 960 : 480;
+    } else {
+        static constexpr uint16_t CELT_FRAME_SAMPLES[4] = {120, 240, 480, 960};
+        // CELT has no mediumband: configs 16-19 are narrowband, then wide, superwide, full
+        const uint8_t band = static_cast<uint8_t>((info.config - 16) >> 2);
+        info.mode = OPUS_PACKET_MODE_CELT;
+        info.bandwidth = static_cast<OpusPacketBandwidth>((band == 0) ? 0 : band + 1);
+        info.frame_samples = CELT_FRAME_SAMPLES[info.config & 0x3];
+    }
+
+    const uint8_t* data = packet + 1;
+    int32_t len = static_cast<int32_t>(packet_len) - 1;
+    int32_t last_size = len;
+    int32_t sizes[OpusPacketInfo::MAX_FRAMES];
+    uint32_t count = 0;
+
+    // RFC 6716 Section 3.2: frame-length coding
+    switch (toc & 0x3) {
+        case 0:  // One frame
+            count = 1;
+            break;
+
+        case 1:  // Two frames of equal size
+            count = 2;
+            if (len & 0x1) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+            last_size = len / 2;
+            sizes[0] = last_size;
+            break;
+
+        case 2: {  // Two frames, the first size coded explicitly
+            count = 2;
+            const int32_t bytes = parse_frame_size(data, len, sizes[0]);
+            if (bytes < 0) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+            len -= bytes;
+            if (sizes[0] > len) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+            data += bytes;
+            last_size = len - sizes[0];
+            break;
+        }
+
+        default: {  // Code 3: an arbitrary number of frames
+            if (len < 1) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+            const uint8_t frame_count_byte = *data++;
+            len--;
+            count = frame_count_byte & 0x3F;
+            if (count == 0 || info.frame_samples * count > MAX_PACKET_SAMPLES_48K) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+
+            if (frame_count_byte & 0x40) {
+                // Padding length: each 255 adds 254 and continues
+                uint8_t p = 0;
+                do {
+                    if (len <= 0) {
+                        return OPUS_PACKET_INFO_INVALID;
+                    }
+                    p = *data++;
+                    len--;
+                    const int32_t padding = (p == 255) ? 254 : p;
+                    len -= padding;
+                    info.padding_len += static_cast<uint32_t>(padding);
+                } while (p == 255);
+            }
+            if (len < 0) {
+                return OPUS_PACKET_INFO_INVALID;
+            }
+
+            if (frame_count_byte & 0x80) {  // VBR: all sizes but the last coded explicitly
+                last_size = len;
+                for (uint32_t i = 0; i + 1 < count; ++i) {
+                    const int32_t bytes = parse_frame_size(data, len, sizes[i]);
+                    if (bytes < 0) {
+                        return OPUS_PACKET_INFO_INVALID;
+                    }
+                    len -= bytes;
+                    if (sizes[i] > len) {
+                        return OPUS_PACKET_INFO_INVALID;
+                    }
+                    data += bytes;
+                    last_size -= bytes + sizes[i];
+                }
+                if (last_size < 0) {
+                    return OPUS_PACKET_INFO_INVALID;
+                }
+            } else {  // CBR: equal sizes
+                last_size = len / static_cast<int32_t>(count);
+                if (last_size * static_cast<int32_t>(count) != len) {
+                    return OPUS_PACKET_INFO_INVALID;
+                }
+                for (uint32_t i = 0; i + 1 < count; ++i) {
+                    sizes[i] = last_size;
+                }
+            }
+            break;
+        }
+    }
+
+    if (last_size > MAX_FRAME_BYTES) {
+        return OPUS_PACKET_INFO_INVALID;
+    }
+    sizes[count - 1] = last_size;
+
+    info.frame_count = static_cast<uint8_t>(count);
+    for (uint32_t i = 0; i < count; ++i) {
+        const size_t size = static_cast<size_t>(sizes[i]);
+        info.frames[i] = data;
+        info.frame_sizes[i] = static_cast<uint16_t>(size);
+
+        // A frame of at most one byte is decoded as lost: DTX, concealed or comfort noise
+        const bool silent = (size <= 1) || (info.mode == OPUS_PACKET_MODE_CELT &&
+                                            celt_silence_flag(data, size));
+        if (silent) {
+            info.silent_frames |= uint64_t{1} << i;
+        }
+        data += size;
+    }
+
+    return OPUS_PACKET_INFO_OK;
+}
+
+}  // namespace micro_opus
@@ -0,0 +1,516 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Parallel Multistream Decoder
+ * Implementation of ParallelMultistreamDecoder class
+ */
+
+#include "parallel_multistream_decoder.h"
+
+#include "micro_opus/opus_packet_info.h"
+#include "ogg_decoder_alloc.h"
+#include "opus.h"
+#include "pseudostack_lease.h"
+#include "worker_thread.h"
+
+#include <cstring>
+
+namespace micro_opus {
+
+namespace {
+// RFC 6716 Section 3.2.5: the longest packet holds 120 ms of audio
+constexpr int32_t MAX_PACKET_DURATION_MS = 120;
+
+// Silence a stream decodes normally, letting its previous audio fade out, before it is skipped
+constexpr int32_t SILENCE_SETTLE_FRAMES_PER_SECOND = 50;  // 20 ms
+
+// Channels get_silent_channel_mask() can flag
+constexpr int MAX_MASK_CHANNELS = 64;
+
+// Worker task stack: libopus decodes from the pseudostack, or from the task stack with alloca
+#ifdef USE_ALLOCA
+constexpr size_t WORKER_STACK_SIZE = 16384;
+#else
+constexpr size_t WORKER_STACK_SIZE = 8192;
+#endif
+
+// RFC 6716 Section 3.2.1: a frame length is one byte below 252, otherwise two.
+// Returns the bytes read, or -1 if the data ends first.
+int parse_size(const unsigned char* data, int32_t len, int32_t& size) {
+    if (len < 1) {
+        return -1;
+    }
+    if (data[0] < 252) {
+        size = data[0];
+        return 1;
+    }
+    if (len < 2) {
+        return -1;
+    }
+    size = 4 * data[1] + data[0];
+    return 2;
+}
+
+// Copy the self-delimited packet at the start of data (RFC 6716 Appendix B) to out in standard
+// framing, which only drops the extra length field. Sets out_len and returns the bytes the
+// self-delimited packet took up, or OPUS_INVALID_PACKET. out needs room for len bytes.
+int32_t unframe_self_delimited(const unsigned char* data, int32_t len, unsigned char* out,
+                               int32_t& out_len) {
+    const unsigned char* const data_start = data;
+    unsigned char* const out_start = out;
+
+    if (len < 1) {
+        return OPUS_INVALID_PACKET;
+    }
+    const unsigned char toc = *data++;
+    --len;
+    *out++ = toc;
+
+    int count = 1;
+    bool cbr = true;
+    int32_t sized_bytes = 0;  // Frames whose length is coded ahead of the last one
+    int32_t padding = 0;
+
+    switch (toc & 0x3) {
+        case 0:
+            break;
+        case 1:
+            count = 2;
+            break;
+        case 2: {
+            count = 2;
+            cbr = false;
+            int bytes = parse_size(data, len, sized_bytes);
+            if (bytes < 0) {
+                return OPUS_INVALID_PACKET;
+            }
+            std::memcpy(out, data, bytes);
+            out += bytes;
+            data += bytes;
+            len -= bytes;
+            break;
+        }
+        default: {
+            if (len < 1) {
+                return OPUS_INVALID_PACKET;
+            }
+            const unsigned char frame_count_byte = *data++;
+            --len;
+            *out++ = frame_count_byte;
+
+            count = frame_count_byte & 0x3F;
+            if (count == 0) {
+                return OPUS_INVALID_PACKET;
+            }
+            if (frame_count_byte & 0x40) {
+                unsigned char padding_byte;
+                do {
+                    if (len <= 0) {
+                        return OPUS_INVALID_PACKET;
+                    }
+                    padding_byte = *data++;
+                    --len;
+                    *out++ = padding_byte;
+                    int32_t chunk = (padding_byte == 255) ? 254 : padding_byte;
+                    len -= chunk;
+                    padding += chunk;
+                } while (padding_byte == 255);
+            }
+            if (len < 0) {
+                return OPUS_INVALID_PACKET;
+            }
+
+            cbr = !(frame_count_byte & 0x80);
+            if (!cbr) {
+                for (int i = 0; i < count - 1; ++i) {
+                    int32_t size = 0;
+                    int bytes = parse_size(data, len, size);
+                    if (bytes < 0) {
+                        return OPUS_INVALID_PACKET;
+                    }
+                    std::memcpy(out, data, bytes);
+                    out += bytes;
+                    data += bytes;
+                    len -= bytes;
+                    sized_bytes += size;
+                }
+            }
+            break;
+        }
+    }
+
+    // The self-delimiting length: the last frame's, or every frame's for CBR. Dropped from out.
+    int32_t last_size = 0;
+    int bytes = parse_size(data, len, last_size);
+    if (bytes < 0) {
+        return OPUS_INVALID_PACKET;
+    }
+    data += bytes;
+    len -= bytes;
+
+    int32_t frame_bytes = cbr ? last_size * count : sized_bytes + last_size;
+    if (frame_bytes > len) {
+        return OPUS_INVALID_PACKET;
+    }
+
+    // Frames, then any padding (already excluded from len)
+    std::memcpy(out, data, static_cast<size_t>(frame_bytes + padding));
+    out += frame_bytes + padding;
+    data += frame_bytes + padding;
+
+    out_len = static_cast<int32_t>(out - out_start);
+    return static_cast<int32_t>(data - data_start);
+}
+}  // namespace
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+ParallelMultistreamDecoder::ParallelMultistreamDecoder(uint8_t workers)
+    : requested_workers_(workers), workers_(workers > 0 ? workers : 1) {
+#ifdef NONTHREADSAFE_PSEUDOSTACK
+    // One global pseudostack: libopus must only ever run on one thread
+    this->workers_ = 1;
+#endif
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    // One pooled pseudostack per worker at most; helpers beyond the free ones fall back to private
+    // pseudostacks (decode_share()), so more workers would only add memory
+    if (this->workers_ > MICRO_OPUS_PSEUDOSTACK_POOL) {
+        this->workers_ = MICRO_OPUS_PSEUDOSTACK_POOL;
+    }
+#endif
+}
+
+ParallelMultistreamDecoder::~ParallelMultistreamDecoder() {
+    this->stop_workers();
+    this->clear();
+    ogg_decoder_free(this->scratch_);
+}
+
+int ParallelMultistreamDecoder::init(int32_t sample_rate, int channels, int streams,
+                                     int coupled_streams, const unsigned char* mapping) {
+    this->clear();
+
+    // Same layout rules as opus_multistream_decoder_create()
+    if (channels < 1 || channels > 255 || streams < 1 || coupled_streams < 0 ||
+        coupled_streams > streams || streams + coupled_streams > 255 || mapping == nullptr) {
+        return OPUS_BAD_ARG;
+    }
+    for (int c = 0; c < channels; ++c) {
+        if (mapping[c] != 255 && mapping[c] >= streams + coupled_streams) {
+            return OPUS_BAD_ARG;
+        }
+    }
+
+    this->streams_ = std::make_unique<Stream[]>(static_cast<size_t>(streams));
+    this->stream_count_ = static_cast<uint8_t>(streams);
+    this->coupled_count_ = static_cast<uint8_t>(coupled_streams);
+    this->channels_ = static_cast<uint8_t>(channels);
+    this->sample_rate_ = sample_rate;
+    this->max_frame_samples_ = sample_rate / 1000 * MAX_PACKET_DURATION_MS;
+    std::memcpy(this->mapping_, mapping, static_cast<size_t>(channels));
+
+    for (int s = 0; s < streams; ++s) {
+        Stream& stream = this->streams_[s];
+        stream.channels = (s < coupled_streams) ? 2 : 1;
+
+        int error = OPUS_OK;
+        stream.decoder = opus_decoder_create(sample_rate, stream.channels, &error);
+        if (error != OPUS_OK || stream.decoder == nullptr) {
+            this->clear();
+            return (error != OPUS_OK) ? error : OPUS_ALLOC_FAIL;
+        }
+
+        size_t pcm_bytes =
+            static_cast<size_t>(this->max_frame_samples_) * stream.channels * sizeof(int16_t);
+        stream.pcm = static_cast<int16_t*>(ogg_decoder_malloc(pcm_bytes));
+        if (stream.pcm == nullptr) {
+            this->clear();
+            return OPUS_ALLOC_FAIL;
+        }
+    }
+
+    // Worker 0 is the caller; the rest start on the following cores and stay for later streams
+    if (this->workers_ > 1 && !this->threads_) {
+        this->threads_ = std::make_unique<std::thread[]>(this->workers_ - 1);
+        size_t priority = current_task_priority();
+        for (uint8_t w = 1; w < this->workers_; ++w) {
+            this->threads_[w - 1] =
+                start_worker_thread("opus_ms", worker_core_from_current(w), WORKER_STACK_SIZE,
+                                    priority, [this, w] { this->worker_loop(w); });
+        }
+        this->threads_started_ = this->workers_ - 1;
+    }
+
+    return OPUS_OK;
+}
+
+void ParallelMultistreamDecoder::clear() {
+    if (this->streams_) {
+        for (uint8_t s = 0; s < this->stream_count_; ++s) {
+            Stream& stream = this->streams_[s];
+            if (stream.decoder != nullptr) {
+                opus_decoder_destroy(stream.decoder);
+            }
+            ogg_decoder_free(stream.pcm);
+        }
+        this->streams_.reset();
+    }
+    this->stream_count_ = 0;
+}
+
+void ParallelMultistreamDecoder::set_gain(int32_t gain) {
+    for (uint8_t s = 0; s < this->stream_count_; ++s) {
+        opus_decoder_ctl(this->streams_[s].decoder, OPUS_SET_GAIN(gain));
+    }
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+int ParallelMultistreamDecoder::decode(const unsigned char* data, int32_t len, int16_t* pcm,
+                                       int frame_size) {
+    if (!this->is_initialized()) {
+        return OPUS_INVALID_STATE;
+    }
+    if (data == nullptr || len <= 0) {
+        return OPUS_BAD_ARG;
+    }
+
+    int result = this->split_packet(data, len);
+    if (result < 0) {
+        return result;
+    }
+
+    // Every stream must cover the same duration (opus_multistream_packet_validate())
+    int samples = 0;
+    for (uint8_t s = 0; s < this->stream_count_; ++s) {
+        Stream& stream = this->streams_[s];
+        int stream_samples = 0;
+        stream.silent = false;
+        if (this->skip_silence_) {
+            // The parse gives the duration too; a packet it rejects libopus would reject as well
+            OpusPacketInfo info;
+            if (parse_opus_packet_info(stream.packet, static_cast<size_t>(stream.packet_len),
+                                       info) != OPUS_PACKET_INFO_OK) {
+                return OPUS_INVALID_PACKET;
+            }
+            stream_samples = static_cast<int>(info.get_samples(
+                static_cast<uint32_t>(this->sample_rate_)));
+            stream.silent = info.is_silent();
+        } else {
+            stream_samples =
+                opus_packet_get_nb_samples(stream.packet, stream.packet_len, this->sample_rate_);
+        }
+        if (stream_samples <= 0) {
+            return (stream_samples < 0) ? stream_samples : OPUS_INVALID_PACKET;
+        }
+        if (s > 0 && stream_samples != samples) {
+            return OPUS_INVALID_PACKET;
+        }
+        samples = stream_samples;
+    }
+    if (samples > frame_size) {
+        return OPUS_BUFFER_TOO_SMALL;
+    }
+
+    this->packet_samples_ = samples;
+    const int settle_samples = this->sample_rate_ / SILENCE_SETTLE_FRAMES_PER_SECOND;
+    for (uint8_t s = 0; s < this->stream_count_; ++s) {
+        Stream& stream = this->streams_[s];
+        stream.skip = stream.silent && stream.silence_run_samples >= settle_samples;
+    }
+
+    if (this->threads_started_ > 0) {
+        {
+            std::lock_guard<std::mutex> lock(this->mutex_);
+            ++this->generation_;
+            this->pending_ = this->threads_started_;
+        }
+        this->start_cond_.notify_all();
+    }
+
+    this->decode_share(0);
+
+    if (this->threads_started_ > 0) {
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->done_cond_.wait(lock, [this] { return this->pending_ == 0; });
+    }
+
+    for (uint8_t s = 0; s < this->stream_count_; ++s) {
+        Stream& stream = this->streams_[s];
+        if (stream.result < 0) {
+            return stream.result;
+        }
+        if (!stream.silent) {
+            stream.silence_run_samples = 0;
+        } else if (!stream.skip) {
+            stream.silence_run_samples += samples;
+        }
+    }
+
+    // Channel mapping: coupled streams feed mapping values 0..2*coupled-1 (left, right), mono
+    // streams the values after that, 255 is silence
+    const int stride = this->channels_;
+    this->silent_channel_mask_ = 0;
+    for (int c = 0; c < stride; ++c) {
+        const unsigned char map = this->mapping_[c];
+        int16_t* out = pcm + c;
+
+        const Stream* stream = nullptr;
+        const int16_t* in = nullptr;
+        int in_stride = 1;
+        if (map == 255) {
+            // No stream
+        } else if (map < 2 * this->coupled_count_) {
+            stream = &this->streams_[map / 2];
+            in = stream->pcm + (map & 1);
+            in_stride = 2;
+        } else {
+            stream = &this->streams_[map - this->coupled_count_];
+            in = stream->pcm;
+        }
+
+        if (stream == nullptr || stream->skip) {
+            const bool flagged = c < MAX_MASK_CHANNELS;
+            if (flagged) {
+                this->silent_channel_mask_ |= uint64_t{1} << c;
+            }
+            if (this->write_silent_channels_ || !flagged) {
+                for (int i = 0; i < samples; ++i) {
+                    out[i * stride] = 0;
+                }
+            }
+            continue;
+        }
+
+        for (int i = 0; i < samples; ++i) {
+            out[i * stride] = in[i * in_stride];
+        }
+    }
+
+    return samples;
+}
+
+int ParallelMultistreamDecoder::split_packet(const unsigned char* data, int32_t len) {
+    // Rewritten packets are shorter than the self-delimited originals, so len bytes suffice
+    if (static_cast<size_t>(len) > this->scratch_capacity_) {
+        void* grown = ogg_decoder_realloc(this->scratch_, static_cast<size_t>(len));
+        if (grown == nullptr) {
+            return OPUS_ALLOC_FAIL;
+        }
+        this->scratch_ = static_cast<unsigned char*>(grown);
+        this->scratch_capacity_ = static_cast<size_t>(len);
+    }
+
+    unsigned char* out = this->scratch_;
+    int32_t offset = 0;
+    const uint8_t last = this->stream_count_ - 1;
+    for (uint8_t s = 0; s < last; ++s) {
+        int32_t out_len = 0;
+        int32_t used = unframe_self_delimited(data + offset, len - offset, out, out_len);
+        if (used < 0) {
+            return used;
+        }
+        this->streams_[s].packet = out;
+        this->streams_[s].packet_len = out_len;
+        out += out_len;
+        offset += used;
+    }
+
+    // The last stream uses standard framing and takes the rest of the packet
+    if (len - offset <= 0) {
+        return OPUS_INVALID_PACKET;
+    }
+    this->streams_[last].packet = data + offset;
+    this->streams_[last].packet_len = len - offset;
+    return OPUS_OK;
+}
+
+void ParallelMultistreamDecoder::decode_share(uint8_t worker) {
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    // On the calling thread this nests in the caller's lease. Helpers must not wait for a pooled
+    // pseudostack: the caller holds its lease until they finish, so with other decoders holding
+    // the rest every helper would wait forever. A helper that finds none free decodes on its
+    // private pseudostack instead.
+    PseudostackLease pseudostack_lease(worker != 0);
+#endif
+    for (int s = worker; s < this->stream_count_; s += this->workers_) {
+        Stream& stream = this->streams_[s];
+        if (stream.skip) {
+            if (!stream.skipping) {
+                // The stream's output is digital silence from here on; resume from matching state
+                opus_decoder_ctl(stream.decoder, OPUS_RESET_STATE);
+                stream.skipping = true;
+            }
+            stream.result = this->packet_samples_;
+            continue;
+        }
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+        if (worker == 0 && !pseudostack_lease.ok()) {
+            stream.result = OPUS_ALLOC_FAIL;
+            continue;
+        }
+#endif
+        stream.result = opus_decode(stream.decoder, stream.packet, stream.packet_len, stream.pcm,
+                                    this->max_frame_samples_, 0 /* No FEC */);
+        stream.skipping = false;
+    }
+}
+
+// ============================================================================
+// Workers
+// ============================================================================
+
+void ParallelMultistreamDecoder::worker_loop(uint8_t worker) {
+    uint32_t seen = 0;
+    for (;;) {
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->start_cond_.wait(
+                lock, [this, seen] { return this->stop_ || this->generation_ != seen; });
+            if (this->stop_) {
+                return;
+            }
+            seen = this->generation_;
+        }
+
+        this->decode_share(worker);
+
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        if (--this->pending_ == 0) {
+            this->done_cond_.notify_one();
+        }
+    }
+}
+
+void ParallelMultistreamDecoder::stop_workers() {
+    if (this->threads_started_ == 0) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stop_ = true;
+    }
+    this->start_cond_.notify_all();
+    for (uint8_t i = 0; i < this->threads_started_; ++i) {
+        this->threads_[i].join();
+    }
+    this->threads_started_ = 0;
+    this->threads_.reset();
+}
+
+}  // namespace micro_opus
@@ -0,0 +1,162 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Parallel Multistream Decoder
+ * Drop-in for opus_multistream_decode() that decodes the elementary streams on several workers
+ */
+
+#ifndef PARALLEL_MULTISTREAM_DECODER_H
+#define PARALLEL_MULTISTREAM_DECODER_H
+
+#include <cstddef>
+#include <cstdint>
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <thread>
+
+struct OpusDecoder;
+
+namespace micro_opus {
+
+/**
+ * @brief Multistream decoder that spreads the elementary streams over worker threads
+ *
+ * A multistream packet is the elementary streams' packets back to back, every one but the last in
+ * self-delimiting framing (RFC 6716 Appendix B). The streams are independent until the channel
+ * mapping, so this class splits the packet, decodes stream s on worker s % workers with its own
+ * OpusDecoder (stereo for coupled streams, mono otherwise), and then applies the mapping to the
+ * interleaved output. The calling thread is worker 0; the others are threads started by init(),
+ * pinned to successive cores on ESP-IDF.
+ *
+ * The output matches opus_multistream_decode() sample for sample: each stream is decoded by the
+ * same libopus decoder, only on a different thread.
+ *
+ * Each worker needs a pseudostack of its own, so this needs THREADSAFE_PSEUDOSTACK (or
+ * USE_ALLOCA); NONTHREADSAFE_PSEUDOSTACK builds decode every stream on the calling thread. With
+ * the shared pool (MICRO_OPUS_PSEUDOSTACK_POOL), the calling thread decodes under its caller's
+ * lease and each helper takes a free pooled pseudostack for its share of every packet without
+ * waiting for one. A helper that finds none free (other decoders hold them) decodes on its own
+ * private pseudostack, since waiting would block on the caller, which waits on the helpers. The
+ * worker count is capped at the pool size.
+ */
+class ParallelMultistreamDecoder {
+public:
+    explicit ParallelMultistreamDecoder(uint8_t workers);
+    ~ParallelMultistreamDecoder();
+
+    ParallelMultistreamDecoder(const ParallelMultistreamDecoder&) = delete;
+    ParallelMultistreamDecoder& operator=(const ParallelMultistreamDecoder&) = delete;
+
+    // Create the stream decoders for a layout (replacing any previous one) and start the workers.
+    // Arguments as for opus_multistream_decoder_create(); returns an OPUS_* error code.
+    int init(int32_t sample_rate, int channels, int streams, int coupled_streams,
+             const unsigned char* mapping);
+
+    // Drop the stream decoders; the workers and the scratch buffer are kept for the next init()
+    void clear();
+
+    bool is_initialized() const {
+        return this->stream_count_ > 0;
+    }
+
+    // Worker count given to the constructor, before any build-specific limit
+    uint8_t get_requested_workers() const {
+        return this->requested_workers_;
+    }
+
+    // OPUS_SET_GAIN on every stream
+    void set_gain(int32_t gain);
+
+    // Like opus_multistream_decode() without FEC: samples per channel, or an OPUS_* error
+    int decode(const unsigned char* data, int32_t len, int16_t* pcm, int frame_size);
+
+    // Skip opus_decode() for a stream whose packet is silent (DTX or CELT silence) once 20 ms of
+    // its silence has been decoded, as OpusPacketDecoder's OPUS_SILENCE_ZERO_FILL does. Its
+    // channels are then digital silence; the output is no longer bit-exact with libopus.
+    void set_skip_silence(bool enable) {
+        this->skip_silence_ = enable;
+    }
+
+    // With false, decode() leaves the channels in get_silent_channel_mask() untouched in pcm
+    // instead of writing zeros to them
+    void set_write_silent_channels(bool enable) {
+        this->write_silent_channels_ = enable;
+    }
+
+    // Bit c set: output channel c of the last decode() is digital silence, from an unmapped
+    // channel (mapping 255) or a skipped stream. Channels from 64 on are never flagged.
+    uint64_t get_silent_channel_mask() const {
+        return this->silent_channel_mask_;
+    }
+
+private:
+    struct Stream {
+        OpusDecoder* decoder{nullptr};
+        const unsigned char* packet{nullptr};  // Standard framing, ready for opus_decode()
+        int32_t packet_len{0};
+        int16_t* pcm{nullptr};
+        int result{0};
+        int silence_run_samples{0};  // Consecutive silent samples decoded before skipping
+        uint8_t channels{1};
+        bool silent{false};    // The current packet is silent
+        bool skip{false};      // The current packet is skipped instead of decoded
+        bool skipping{false};  // The decoder state was reset for the current silent run
+    };
+
+    // Split the packet into per-stream packets (self-delimited ones rewritten into scratch_)
+    int split_packet(const unsigned char* data, int32_t len);
+
+    // Decode the streams assigned to a worker
+    void decode_share(uint8_t worker);
+
+    void worker_loop(uint8_t worker);
+    void stop_workers();
+
+    std::unique_ptr<Stream[]> streams_;
+    unsigned char mapping_[255]{};
+
+    // Rewritten self-delimited packets, grown to the largest multistream packet seen
+    unsigned char* scratch_{nullptr};
+    size_t scratch_capacity_{0};
+
+    std::unique_ptr<std::thread[]> threads_;
+
+    // Worker hand-off: bumping generation_ starts a packet, pending_ counts workers still on it
+    std::mutex mutex_;
+    std::condition_variable start_cond_;
+    std::condition_variable done_cond_;
+    uint32_t generation_{0};
+    uint8_t pending_{0};
+    bool stop_{false};
+
+    uint64_t silent_channel_mask_{0};
+
+    int32_t sample_rate_{0};
+    int max_frame_samples_{0};  // Per-stream PCM buffer length, in samples per channel
+    int packet_samples_{0};     // Samples per channel of the packet being decoded
+    const uint8_t requested_workers_;
+    uint8_t workers_;
+    uint8_t threads_started_{0};
+    uint8_t channels_{0};
+    uint8_t stream_count_{0};
+    uint8_t coupled_count_{0};
+    bool skip_silence_{false};
+    bool write_silent_channels_{true};
+};
+
+}  // namespace micro_opus
+
+#endif  // PARALLEL_MULTISTREAM_DECODER_H
@@ -0,0 +1,330 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Pipelined Ogg Opus Decoder
+ * Implementation of PipelinedOggOpusDecoder class
+ */
+
+#include "micro_opus/pipelined_ogg_opus_decoder.h"
+
+#include "ogg_decoder_alloc.h"
+#include "worker_thread.h"
+#include <micro_ogg/ogg_demuxer.h>
+
+#include <cstring>
+
+namespace micro_opus {
+
+namespace {
+// RFC 6716 Section 3.2.5: the longest packet holds 120 ms of audio
+constexpr uint32_t MAX_PACKET_DURATION_MS = 120;
+
+// Default decode task stack: libopus decodes from the pseudostack, or from the task stack with
+// alloca. Chosen here because USE_ALLOCA is only defined for the component's own sources.
+#ifdef USE_ALLOCA
+constexpr size_t DECODE_TASK_STACK_SIZE = 16384;
+#else
+constexpr size_t DECODE_TASK_STACK_SIZE = 8192;
+#endif
+}  // namespace
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+PipelinedOggOpusDecoder::PipelinedOggOpusDecoder(bool enable_crc, uint32_t sample_rate,
+                                                 uint8_t channels, size_t queue_depth)
+    : decoder_(enable_crc, sample_rate, channels),
+      queue_depth_(queue_depth > 0 ? queue_depth : 1),
+      task_stack_size_(DECODE_TASK_STACK_SIZE) {}
+
+PipelinedOggOpusDecoder::~PipelinedOggOpusDecoder() {
+    this->stop_pipeline();
+    this->free_slots();
+}
+
+void PipelinedOggOpusDecoder::reset() {
+    // The decode task may still be on a packet; let it finish before the decoder state goes
+    if (this->filled_.load(std::memory_order_relaxed) != this->drained_) {
+        std::unique_lock<std::mutex> lock(this->mutex_);
+        this->cond_.wait(lock, [this] {
+            return this->decoded_.load(std::memory_order_acquire) ==
+                   this->filled_.load(std::memory_order_relaxed);
+        });
+    }
+
+    // Drop the queued frames. The counters only ever grow, so the decode task, which is waiting
+    // for filled_ to move past decoded_, needs no reset.
+    this->drained_ = this->filled_.load(std::memory_order_relaxed);
+    this->last_required_buffer_bytes_ = 0;
+    this->decoder_.reset();
+}
+
+void PipelinedOggOpusDecoder::set_decode_task(int core_id, size_t stack_size, size_t priority) {
+    this->task_core_id_ = core_id;
+    this->task_stack_size_ = stack_size;
+    this->task_priority_ = priority;
+}
+
+void PipelinedOggOpusDecoder::set_decoder_pool(DecoderPool* pool) {
+    this->decoder_.set_decoder_pool(pool);
+}
+
+// ============================================================================
+// Decoding (calling task)
+// ============================================================================
+
+OggOpusResult PipelinedOggOpusDecoder::decode(const uint8_t* input, size_t input_len,
+                                              uint8_t* output, size_t output_size,
+                                              size_t& bytes_consumed, size_t& samples_decoded) {
+    if (!input) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+
+    bytes_consumed = 0;
+    samples_decoded = 0;
+
+    // Decoded audio goes out before more input is taken. With the ring full, or at the end of the
+    // input, wait for the decode task instead of returning empty-handed.
+    size_t in_flight = this->filled_.load(std::memory_order_relaxed) - this->drained_;
+    if (in_flight > 0 && (this->decoded_.load(std::memory_order_acquire) != this->drained_ ||
+                          in_flight == this->queue_depth_ || input_len == 0)) {
+        return this->take_frame(output, output_size, samples_decoded);
+    }
+
+    // Nothing queued and no input: the end of the stream, or the caller polling for audio
+    if (input_len == 0) {
+        return OGG_OPUS_OK;
+    }
+
+    // Headers are parsed by now, so the output format is known; set up before consuming the first
+    // audio packet so an allocation failure leaves the input untouched
+    if (this->decoder_.is_initialized()) {
+        OggOpusResult result = this->prepare_pipeline();
+        if (result != OGG_OPUS_OK) {
+            return result;
+        }
+    }
+
+    micro_ogg::OggPacket packet{};
+    bool has_audio_packet = false;
+    OggOpusResult result =
+        this->decoder_.demux_packet(input, input_len, bytes_consumed, packet, has_audio_packet);
+    if (result != OGG_OPUS_OK || !has_audio_packet) {
+        return result;
+    }
+
+    return this->queue_packet(packet);
+}
+
+OggOpusResult PipelinedOggOpusDecoder::prepare_pipeline() {
+    size_t max_samples = this->decoder_.get_sample_rate() / 1000 * MAX_PACKET_DURATION_MS;
+    size_t pcm_bytes = max_samples * this->decoder_.get_channels() * sizeof(int16_t);
+
+    if (!this->slots_) {
+        this->slots_ = std::make_unique<Slot[]>(this->queue_depth_);
+    }
+
+    // Only grows at the start of a stream (more channels than the last one), with nothing queued
+    if (pcm_bytes > this->pcm_capacity_) {
+        for (size_t i = 0; i < this->queue_depth_; ++i) {
+            ogg_decoder_free(this->slots_[i].pcm);
+            this->slots_[i].pcm = nullptr;
+        }
+        this->pcm_capacity_ = 0;
+
+        for (size_t i = 0; i < this->queue_depth_; ++i) {
+            this->slots_[i].pcm = static_cast<uint8_t*>(ogg_decoder_malloc(pcm_bytes));
+            if (!this->slots_[i].pcm) {
+                return OGG_OPUS_ALLOCATION_FAILED;
+            }
+        }
+        this->pcm_capacity_ = pcm_bytes;
+    }
+
+    if (!this->decode_thread_.joinable()) {
+        int core_id = (this->task_core_id_ == DECODE_CORE_OTHER) ? worker_core_from_current(1)
+                                                                 : this->task_core_id_;
+        this->decode_thread_ =
+            start_worker_thread("opus_decode", core_id, this->task_stack_size_,
+                                this->task_priority_, [this] { this->decode_loop(); });
+    }
+
+    return OGG_OPUS_OK;
+}
+
+OggOpusResult PipelinedOggOpusDecoder::queue_packet(const micro_ogg::OggPacket& packet) {
+    size_t index = this->filled_.load(std::memory_order_relaxed);
+    Slot& slot = this->slots_[index % this->queue_depth_];
+
+    // The demuxer may point into its own buffer or the caller's input, neither of which outlives
+    // this call. Slot buffers grow to the largest packet seen (at most 61,440 bytes, RFC 7845).
+    if (packet.length > slot.packet_capacity) {
+        void* grown = ogg_decoder_realloc(slot.packet, packet.length);
+        if (!grown) {
+            return OGG_OPUS_ALLOCATION_FAILED;
+        }
+        slot.packet = static_cast<uint8_t*>(grown);
+        slot.packet_capacity = packet.length;
+    }
+    if (packet.length > 0) {
+        std::memcpy(slot.packet, packet.data, packet.length);
+    }
+    slot.packet_len = packet.length;
+    slot.granule_position = packet.granule_position;
+    slot.is_eos = packet.is_eos;
+    slot.is_last_on_page = packet.is_last_on_page;
+
+    this->filled_.store(index + 1, std::memory_order_release);
+    this->notify();
+    return OGG_OPUS_OK;
+}
+
+OggOpusResult PipelinedOggOpusDecoder::take_frame(uint8_t* output, size_t output_size,
+                                                  size_t& samples_decoded) {
+    if (this->decoded_.load(std::memory_order_acquire) == this->drained_) {
+        this->wait_for_frame();
+    }
+
+    Slot& slot = this->slots_[this->drained_ % this->queue_depth_];
+    if (slot.result != OGG_OPUS_OK) {
+        ++this->drained_;
+        return slot.result;
+    }
+
+    size_t frame_bytes = slot.samples * this->decoder_.get_channels() * sizeof(int16_t);
+    this->last_required_buffer_bytes_ = frame_bytes;
+
+    // The frame stays queued, so the caller can retry with a valid or larger buffer
+    if (!output) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+    if (output_size == 0 || output_size < frame_bytes) {
+        return OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL;
+    }
+
+    if (frame_bytes > 0) {
+        std::memcpy(output, slot.pcm, frame_bytes);
+    }
+    samples_decoded = slot.samples;
+    ++this->drained_;
+    return OGG_OPUS_OK;
+}
+
+void PipelinedOggOpusDecoder::wait_for_frame() {
+    std::unique_lock<std::mutex> lock(this->mutex_);
+    this->cond_.wait(lock, [this] {
+        return this->decoded_.load(std::memory_order_acquire) != this->drained_;
+    });
+}
+
+// ============================================================================
+// Decoding (decode task)
+// ============================================================================
+
+void PipelinedOggOpusDecoder::decode_loop() {
+    for (;;) {
+        size_t index = this->decoded_.load(std::memory_order_relaxed);
+        {
+            std::unique_lock<std::mutex> lock(this->mutex_);
+            this->cond_.wait(lock, [this, index] {
+                return this->stop_ || this->filled_.load(std::memory_order_acquire) != index;
+            });
+            if (this->stop_) {
+                return;
+            }
+        }
+
+        Slot& slot = this->slots_[index % this->queue_depth_];
+        slot.samples = 0;
+        slot.result = this->decoder_.handle_audio_packet(
+            slot.packet, slot.packet_len, slot.granule_position, slot.is_eos, slot.is_last_on_page,
+            slot.pcm, this->pcm_capacity_, slot.samples);
+
+        this->decoded_.store(index + 1, std::memory_order_release);
+        this->notify();
+    }
+}
+
+void PipelinedOggOpusDecoder::notify() {
+    // Taking the mutex orders the counter update before a waiter's predicate check, so the wakeup
+    // cannot fall between that check and the wait
+    { std::lock_guard<std::mutex> lock(this->mutex_); }
+    this->cond_.notify_all();
+}
+
+void PipelinedOggOpusDecoder::stop_pipeline() {
+    if (!this->decode_thread_.joinable()) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(this->mutex_);
+        this->stop_ = true;
+    }
+    this->cond_.notify_all();
+    this->decode_thread_.join();
+}
+
+void PipelinedOggOpusDecoder::free_slots() {
+    if (!this->slots_) {
+        return;
+    }
+    for (size_t i = 0; i < this->queue_depth_; ++i) {
+        ogg_decoder_free(this->slots_[i].packet);
+        ogg_decoder_free(this->slots_[i].pcm);
+    }
+    this->slots_.reset();
+}
+
+// ============================================================================
+// Stream info
+// ============================================================================
+
+uint32_t PipelinedOggOpusDecoder::get_sample_rate() const {
+    return this->decoder_.get_sample_rate();
+}
+
+uint8_t PipelinedOggOpusDecoder::get_channels() const {
+    return this->decoder_.get_channels();
+}
+
+uint8_t PipelinedOggOpusDecoder::get_bit_depth() const {
+    return this->decoder_.get_bit_depth();
+}
+
+uint8_t PipelinedOggOpusDecoder::get_bytes_per_sample() const {
+    return this->decoder_.get_bytes_per_sample();
+}
+
+uint16_t PipelinedOggOpusDecoder::get_pre_skip() const {
+    return this->decoder_.get_pre_skip();
+}
+
+int16_t PipelinedOggOpusDecoder::get_output_gain() const {
+    return this->decoder_.get_output_gain();
+}
+
+size_t PipelinedOggOpusDecoder::get_required_output_buffer_size() const {
+    return this->last_required_buffer_bytes_;
+}
+
+bool PipelinedOggOpusDecoder::is_initialized() const {
+    return this->decoder_.is_initialized();
+}
+
+size_t PipelinedOggOpusDecoder::get_packets_in_flight() const {
+    return this->filled_.load(std::memory_order_relaxed) - this->drained_;
+}
+
+}  // namespace micro_opus
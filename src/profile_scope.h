@@ -0,0 +1,65 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Profiling scope for the decoder wrappers (MICRO_OPUS_ENABLE_PROFILING builds only)
+ *
+ * Binds a decoder's OpusProfileStats to the calling thread for the lifetime of the scope, so the
+ * stage instrumentation inside libopus records into that decoder, and charges the scope's own
+ * duration to decode_total/decode_calls and the latency histogram.
+ *
+ * Only the outermost scope on a thread binds. OggOpusDecoder wraps its OpusPacketDecoder, whose
+ * own scope then finds the Ogg decoder's stats already bound and leaves them in place, so each
+ * decode is counted once, against the object the caller queries.
+ */
+
+#pragma once
+
+#ifdef MICRO_OPUS_ENABLE_PROFILING
+
+#include "micro_opus/profile_stats.h"
+#include "profile_timing.h"
+
+namespace micro_opus {
+
+class ProfileScope {
+public:
+    explicit ProfileScope(OpusProfileStats& stats)
+        : stats_(profile_timing_current() == nullptr ? &stats : nullptr),
+          start_(profile_timing_now()) {
+        if (this->stats_ != nullptr) {
+            profile_timing_bind(this->stats_);
+        }
+    }
+
+    ~ProfileScope() {
+        if (this->stats_ != nullptr) {
+            profile_timing_record_call(this->stats_, profile_timing_now() - this->start_);
+            profile_timing_bind(nullptr);
+        }
+    }
+
+    ProfileScope(const ProfileScope&) = delete;
+    ProfileScope& operator=(const ProfileScope&) = delete;
+
+private:
+    // Stats bound by this scope, or nullptr if an outer scope already owns the thread
+    OpusProfileStats* stats_;
+
+    // Timer value at construction
+    profile_ticks_t start_;
+};
+
+}  // namespace micro_opus
+
+#endif  // MICRO_OPUS_ENABLE_PROFILING
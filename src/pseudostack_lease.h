@@ -0,0 +1,60 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Pseudostack lease for the decoder wrappers (MICRO_OPUS_PSEUDOSTACK_POOL builds only)
+ *
+ * Holds one of the pooled pseudostacks for the lifetime of the scope, so a libopus call made
+ * inside it uses the pool instead of a per-thread buffer. Nested leases (OggOpusDecoder wrapping
+ * OpusPacketDecoder) only count the nesting, so the outer scope keeps the buffer.
+ *
+ * A lease that must not wait (try_only) gives up when every pooled pseudostack is taken; libopus
+ * then runs on the thread's private pseudostack instead.
+ *
+ * Construct it before any ProfileScope, so time spent waiting for a free pseudostack is not
+ * charged to decode latency.
+ */
+
+#pragma once
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+
+#include "micro_opus/pseudostack.h"
+#include "opus_defines.h"
+
+namespace micro_opus {
+
+class PseudostackLease {
+public:
+    explicit PseudostackLease(bool try_only = false)
+        : leased_((try_only ? opus_pseudostack_try_lease() : opus_pseudostack_lease()) == OPUS_OK) {}
+
+    ~PseudostackLease() {
+        if (this->leased_) {
+            opus_pseudostack_release();
+        }
+    }
+
+    PseudostackLease(const PseudostackLease&) = delete;
+    PseudostackLease& operator=(const PseudostackLease&) = delete;
+
+    // False if the pooled buffer could not be allocated, or none was free for a try_only lease
+    bool ok() const { return this->leased_; }
+
+private:
+    bool leased_;
+};
+
+}  // namespace micro_opus
+
+#endif  // MICRO_OPUS_PSEUDOSTACK_POOL
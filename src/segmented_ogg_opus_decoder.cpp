@@ -0,0 +1,423 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Segmented Ogg Opus Decoder
+ * Implementation of SegmentedOggOpusDecoder class
+ */
+
+#include "micro_opus/segmented_ogg_opus_decoder.h"
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "opus.h"
+#include "opus_header.h"
+#include "opus_multistream.h"
+#include "pseudostack_lease.h"
+#include "worker_thread.h"
+#include <micro_ogg/ogg_demuxer.h>
+
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <thread>
+
+namespace micro_opus {
+
+namespace {
+// RFC 3533: Invalid/unknown granule position (-1 in two's complement)
+constexpr uint64_t INVALID_GRANULE_POSITION = 0xFFFFFFFFFFFFFFFFULL;
+
+// RFC 7845 Section 3: audio data packets SHOULD NOT exceed 61,440 octets
+constexpr size_t MAX_OPUS_PACKET_SIZE = 61440;
+
+// RFC 6716 Section 3.2.5: the longest packet holds 120 ms of audio
+constexpr uint32_t MAX_PACKET_DURATION_MS = 120;
+
+// Segment thread stack: libopus decodes from the pseudostack, or from the task stack with alloca
+#ifdef USE_ALLOCA
+constexpr size_t SEGMENT_STACK_SIZE = 16384;
+#else
+constexpr size_t SEGMENT_STACK_SIZE = 8192;
+#endif
+
+bool is_valid_sample_rate(uint32_t sample_rate) {
+    return sample_rate == 8000 || sample_rate == 12000 || sample_rate == 16000 ||
+           sample_rate == 24000 || sample_rate == 48000;
+}
+}  // namespace
+
+// ============================================================================
+// Lifecycle
+// ============================================================================
+
+SegmentedOggOpusDecoder::SegmentedOggOpusDecoder(uint8_t threads, bool enable_crc,
+                                                 uint32_t sample_rate, uint8_t channels)
+    : decoder_(enable_crc, sample_rate, channels), threads_(threads > 0 ? threads : 1) {
+#ifdef NONTHREADSAFE_PSEUDOSTACK
+    // One global pseudostack: libopus must only ever run on one thread
+    this->threads_ = 1;
+#endif
+}
+
+SegmentedOggOpusDecoder::~SegmentedOggOpusDecoder() = default;
+
+void SegmentedOggOpusDecoder::set_pre_roll_ms(uint32_t pre_roll_ms) {
+    this->pre_roll_ms_ = pre_roll_ms;
+}
+
+// ============================================================================
+// Indexing
+// ============================================================================
+
+OggOpusResult SegmentedOggOpusDecoder::open(const uint8_t* input, size_t input_len) {
+    this->opened_ = false;
+    this->decoder_.reset();
+    this->packet_data_.clear();
+    this->packets_.clear();
+    this->segments_.clear();
+    this->skip_samples_ = 0;
+    this->total_samples_ = 0;
+
+    if (input == nullptr) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+    const uint32_t sample_rate = this->decoder_.sample_rate_;
+    if (!is_valid_sample_rate(sample_rate)) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+
+    // Page-level end trimming state, tracked exactly as OggOpusDecoder::handle_audio_packet()
+    // does, so the trimmed length matches the serial decode
+    uint64_t untrimmed_samples = 0;
+    uint64_t samples_on_page = 0;
+    int64_t prev_page_granule = 0;
+    uint64_t end_trim = 0;
+    bool next_starts_page = true;
+
+    size_t pos = 0;
+    while (pos < input_len && !this->decoder_.eos_seen_) {
+        const OggOpusDecoder::State state_before = this->decoder_.state_;
+        size_t consumed = 0;
+        micro_ogg::OggPacket packet{};
+        bool has_audio_packet = false;
+        OggOpusResult result = this->decoder_.demux_packet(input + pos, input_len - pos, consumed,
+                                                           packet, has_audio_packet);
+        if (result != OGG_OPUS_OK) {
+            return result;
+        }
+        pos += consumed;
+
+        if (!has_audio_packet) {
+            if (consumed == 0 && this->decoder_.state_ == state_before) {
+                break;  // Only an incomplete page is left
+            }
+            continue;
+        }
+
+        // RFC 7845 Section 4.1 / Section 3: zero-octet and oversized packets are malformed
+        if (packet.length == 0 || packet.length > MAX_OPUS_PACKET_SIZE) {
+            return OGG_OPUS_INPUT_INVALID;
+        }
+
+        int nb_samples = opus_packet_get_nb_samples(packet.data, (opus_int32)packet.length,
+                                                    (opus_int32)sample_rate);
+        if (nb_samples <= 0) {
+            return OGG_OPUS_DECODE_ERROR;
+        }
+        const uint64_t samples = static_cast<uint64_t>(nb_samples);
+
+        this->decoder_.update_page_tracking(packet.is_last_on_page);
+        result = this->decoder_.validate_granule_position(packet.granule_position,
+                                                          static_cast<size_t>(samples),
+                                                          packet.is_eos, packet.is_last_on_page);
+        if (result != OGG_OPUS_OK) {
+            return result;
+        }
+
+        // The demuxer may hand out a pointer into its own buffer, reused by the next call
+        PacketEntry entry{};
+        entry.offset = this->packet_data_.size();
+        entry.length = packet.length;
+        entry.start_sample = untrimmed_samples;
+        entry.samples = static_cast<uint32_t>(samples);
+        entry.starts_page = next_starts_page;
+        this->packet_data_.insert(this->packet_data_.end(), packet.data,
+                                  packet.data + packet.length);
+        this->packets_.push_back(entry);
+
+        untrimmed_samples += samples;
+        samples_on_page += samples;
+        next_starts_page = packet.is_last_on_page;
+
+        if (packet.is_last_on_page) {
+            const int64_t granule_pos = packet.granule_position;
+            const bool valid_granule =
+                granule_pos > 0 && (uint64_t)granule_pos != INVALID_GRANULE_POSITION;
+
+            // RFC 7845 Section 4: the EOS page's granule position trims its last packet
+            if (packet.is_eos && valid_granule && prev_page_granule > 0) {
+                int64_t expected_at_48k = granule_pos - prev_page_granule;
+                if (expected_at_48k >= 0) {
+                    uint64_t expected_samples =
+                        ((uint64_t)expected_at_48k * sample_rate) / OPUS_DEFAULT_SAMPLE_RATE;
+                    if (samples_on_page > expected_samples) {
+                        end_trim = std::min(samples_on_page - expected_samples, samples);
+                    }
+                }
+            }
+
+            if (valid_granule) {
+                prev_page_granule = granule_pos;
+            }
+            samples_on_page = 0;
+        }
+    }
+
+    if (this->decoder_.state_ != OggOpusDecoder::STATE_DECODING) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+
+    // The segments create their own decoder states; drop the one made for the OpusHead
+    this->decoder_.destroy_opus_decoder();
+
+    // RFC 7845 Section 4.2: pre-skip comes off the front of the (end-trimmed) audio
+    const uint64_t kept_samples = untrimmed_samples - end_trim;
+    const uint64_t pre_skip_samples =
+        ((uint64_t)this->decoder_.opus_head_->pre_skip * sample_rate) / OPUS_DEFAULT_SAMPLE_RATE;
+    this->skip_samples_ = std::min(pre_skip_samples, kept_samples);
+    this->total_samples_ = static_cast<size_t>(kept_samples - this->skip_samples_);
+
+    this->opened_ = true;
+    return OGG_OPUS_OK;
+}
+
+// ============================================================================
+// Decoding
+// ============================================================================
+
+void SegmentedOggOpusDecoder::plan_segments() {
+    this->segments_.clear();
+    if (this->packets_.empty()) {
+        return;
+    }
+
+    const size_t packet_count = this->packets_.size();
+    const PacketEntry& last = this->packets_[packet_count - 1];
+    const uint64_t untrimmed_samples = last.start_sample + last.samples;
+    const uint64_t pre_roll_samples =
+        (uint64_t)this->pre_roll_ms_ * this->decoder_.sample_rate_ / 1000;
+
+    size_t first = 0;
+    for (uint8_t k = 1; k <= this->threads_ && first < packet_count; ++k) {
+        // End at the first page boundary past an even share of the audio
+        size_t end = packet_count;
+        if (k < this->threads_) {
+            const uint64_t target = untrimmed_samples * k / this->threads_;
+            end = first + 1;
+            while (end < packet_count) {
+                const PacketEntry& packet = this->packets_[end];
+                if (packet.starts_page && packet.start_sample >= target) {
+                    break;
+                }
+                ++end;
+            }
+        }
+
+        // Back up by whole packets until the pre-roll is covered (or the stream starts)
+        size_t pre_roll_first = first;
+        uint64_t pre_rolled = 0;
+        while (pre_roll_first > 0 && pre_rolled < pre_roll_samples) {
+            --pre_roll_first;
+            pre_rolled += this->packets_[pre_roll_first].samples;
+        }
+
+        this->segments_.push_back(Segment{pre_roll_first, first, end, OGG_OPUS_OK});
+        first = end;
+    }
+}
+
+OggOpusResult SegmentedOggOpusDecoder::decode(uint8_t* output, size_t output_size,
+                                              size_t& samples_decoded) {
+    samples_decoded = 0;
+
+    if (!this->opened_) {
+        return OGG_OPUS_NOT_INITIALIZED;
+    }
+    if (output == nullptr) {
+        return OGG_OPUS_INPUT_INVALID;
+    }
+    if (output_size < this->get_required_output_buffer_size()) {
+        return OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL;
+    }
+
+    this->plan_segments();
+    if (this->segments_.empty()) {
+        return OGG_OPUS_OK;
+    }
+
+    // Segments 1.. each get a thread on the following cores; the caller decodes segment 0
+    std::unique_ptr<std::thread[]> threads;
+    const size_t helper_count = this->segments_.size() - 1;
+    if (helper_count > 0) {
+        threads = std::make_unique<std::thread[]>(helper_count);
+        size_t priority = current_task_priority();
+        for (size_t s = 1; s <= helper_count; ++s) {
+            threads[s - 1] = start_worker_thread(
+                "opus_seg", worker_core_from_current(static_cast<int>(s)), SEGMENT_STACK_SIZE,
+                priority, [this, s, output] {
+                    this->segments_[s].result = this->decode_segment(this->segments_[s], output);
+                });
+        }
+    }
+    this->segments_[0].result = this->decode_segment(this->segments_[0], output);
+    for (size_t t = 0; t < helper_count; ++t) {
+        threads[t].join();
+    }
+
+    for (const Segment& segment : this->segments_) {
+        if (segment.result != OGG_OPUS_OK) {
+            return segment.result;
+        }
+    }
+
+    samples_decoded = this->total_samples_;
+    return OGG_OPUS_OK;
+}
+
+OggOpusResult SegmentedOggOpusDecoder::decode_segment(const Segment& segment,
+                                                      uint8_t* output) const {
+    const OpusHead& head = *this->decoder_.opus_head_;
+    const uint32_t sample_rate = this->decoder_.sample_rate_;
+    const uint8_t channels = this->decoder_.output_channels_;
+    const size_t frame_bytes = channels * sizeof(int16_t);
+
+    // Same backends as OggOpusDecoder::create_opus_decoder(), one per segment
+    std::unique_ptr<OpusPacketDecoder> packet_decoder;
+    std::unique_ptr<OpusMSDecoder, void (*)(OpusMSDecoder*)> ms_decoder(
+        nullptr, opus_multistream_decoder_destroy);
+    if (head.channel_mapping == 0) {
+        packet_decoder = std::make_unique<OpusPacketDecoder>(sample_rate, channels);
+        packet_decoder->set_output_gain(head.output_gain);
+    } else {
+        int error = 0;
+        ms_decoder.reset(opus_multistream_decoder_create(
+            static_cast<opus_int32>(sample_rate), channels, head.stream_count, head.coupled_count,
+            head.channel_mapping_table, &error));
+        if (error != OPUS_OK || !ms_decoder) {
+            return OGG_OPUS_ALLOCATION_FAILED;
+        }
+        if (head.output_gain != 0) {
+            opus_multistream_decoder_ctl(ms_decoder.get(),
+                                         OPUS_SET_GAIN((opus_int32)head.output_gain));
+        }
+    }
+
+    // Pre-roll audio and packets cut by pre-skip or end trimming go through here
+    const size_t scratch_bytes = sample_rate / 1000 * MAX_PACKET_DURATION_MS * frame_bytes;
+    std::unique_ptr<uint8_t[]> scratch(new uint8_t[scratch_bytes]);
+
+    const uint64_t out_begin = this->skip_samples_;
+    const uint64_t out_end = this->skip_samples_ + this->total_samples_;
+
+    for (size_t i = segment.pre_roll_first; i < segment.end; ++i) {
+        const PacketEntry& packet = this->packets_[i];
+        const uint64_t packet_end = packet.start_sample + packet.samples;
+        const bool in_segment = (i >= segment.first);
+
+        // A packet kept whole is decoded straight into its place in the output
+        const bool direct = in_segment && packet.start_sample >= out_begin && packet_end <= out_end;
+        uint8_t* dest = scratch.get();
+        size_t dest_size = scratch_bytes;
+        if (direct) {
+            dest = output + static_cast<size_t>(packet.start_sample - out_begin) * frame_bytes;
+            dest_size = packet.samples * frame_bytes;
+        }
+
+        const uint8_t* data = this->packet_data_.data() + packet.offset;
+        size_t decoded_samples = 0;
+        if (packet_decoder) {
+            size_t bytes_written = 0;
+            if (packet_decoder->decode(data, packet.length, dest, dest_size, bytes_written) !=
+                OPUS_PACKET_DECODER_SUCCESS) {
+                return OGG_OPUS_DECODE_ERROR;
+            }
+            decoded_samples = bytes_written / frame_bytes;
+        } else {
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+            PseudostackLease pseudostack_lease;
+            if (!pseudostack_lease.ok()) {
+                return OGG_OPUS_ALLOCATION_FAILED;
+            }
+#endif
+            int decoded = opus_multistream_decode(
+                ms_decoder.get(), data, (opus_int32)packet.length, reinterpret_cast<int16_t*>(dest),
+                static_cast<int>(dest_size / frame_bytes), 0 /* No FEC */);
+            if (decoded < 0) {
+                return OGG_OPUS_DECODE_ERROR;
+            }
+            decoded_samples = static_cast<size_t>(decoded);
+        }
+
+        // The index placed every later packet assuming this length
+        if (decoded_samples != packet.samples) {
+            return OGG_OPUS_DECODE_ERROR;
+        }
+
+        if (in_segment && !direct) {
+            const uint64_t from = std::max(packet.start_sample, out_begin);
+            const uint64_t to = std::min(packet_end, out_end);
+            if (from < to) {
+                const size_t skipped = static_cast<size_t>(from - packet.start_sample);
+                std::memcpy(output + static_cast<size_t>(from - out_begin) * frame_bytes,
+                            scratch.get() + skipped * frame_bytes,
+                            static_cast<size_t>(to - from) * frame_bytes);
+            }
+        }
+    }
+
+    return OGG_OPUS_OK;
+}
+
+// ============================================================================
+// Stream information
+// ============================================================================
+
+size_t SegmentedOggOpusDecoder::get_total_samples() const {
+    return this->opened_ ? this->total_samples_ : 0;
+}
+
+size_t SegmentedOggOpusDecoder::get_required_output_buffer_size() const {
+    return this->get_total_samples() * this->get_channels() * sizeof(int16_t);
+}
+
+uint32_t SegmentedOggOpusDecoder::get_sample_rate() const {
+    return this->opened_ ? this->decoder_.get_sample_rate() : 0;
+}
+
+uint8_t SegmentedOggOpusDecoder::get_channels() const {
+    return this->opened_ ? this->decoder_.get_channels() : 0;
+}
+
+uint16_t SegmentedOggOpusDecoder::get_pre_skip() const {
+    return this->opened_ ? this->decoder_.get_pre_skip() : 0;
+}
+
+size_t SegmentedOggOpusDecoder::get_packet_count() const {
+    return this->opened_ ? this->packets_.size() : 0;
+}
+
+size_t SegmentedOggOpusDecoder::get_segment_count() const {
+    return this->segments_.size();
+}
+
+}  // namespace micro_opus
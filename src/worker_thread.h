@@ -0,0 +1,88 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+/* Worker threads for the decoder wrappers
+ *
+ * A std::thread everywhere; on ESP-IDF its FreeRTOS task takes the name, core, stack size and
+ * priority given here (through esp_pthread_set_cfg(), which applies to threads the calling thread
+ * creates next; the caller's own setting is restored afterwards). Host builds ignore the task
+ * settings.
+ */
+
+#pragma once
+
+#include <stddef.h>
+
+#include <thread>
+#include <utility>
+
+#ifdef ESP_PLATFORM
+#include "esp_pthread.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#endif
+
+namespace micro_opus {
+
+// Core offset cores away from the calling task's, wrapping around (ESP-IDF only; -1 on host)
+inline int worker_core_from_current(int offset) {
+#ifdef ESP_PLATFORM
+    return (static_cast<int>(xPortGetCoreID()) + offset) % portNUM_PROCESSORS;
+#else
+    (void)offset;
+    return -1;
+#endif
+}
+
+// Priority of the calling task, for workers that should run alongside it (0 on host)
+inline size_t current_task_priority() {
+#ifdef ESP_PLATFORM
+    return static_cast<size_t>(uxTaskPriorityGet(nullptr));
+#else
+    return 0;
+#endif
+}
+
+template <typename Fn>
+std::thread start_worker_thread(const char* name, int core_id, size_t stack_size, size_t priority,
+                                Fn&& fn) {
+#ifdef ESP_PLATFORM
+    // Put back whatever the caller had configured for its own threads afterwards
+    esp_pthread_cfg_t saved_cfg;
+    const bool has_saved_cfg = esp_pthread_get_cfg(&saved_cfg) == ESP_OK;
+
+    esp_pthread_cfg_t cfg = esp_pthread_get_default_config();
+    cfg.thread_name = name;
+    cfg.pin_to_core = core_id;
+    cfg.stack_size = stack_size;
+    cfg.prio = priority;
+    esp_pthread_set_cfg(&cfg);
+    std::thread thread(std::forward<Fn>(fn));
+    if (has_saved_cfg) {
+        esp_pthread_set_cfg(&saved_cfg);
+    } else {
+        cfg = esp_pthread_get_default_config();
+        esp_pthread_set_cfg(&cfg);
+    }
+    return thread;
+#else
+    (void)name;
+    (void)core_id;
+    (void)stack_size;
+    (void)priority;
+    return std::thread(std::forward<Fn>(fn));
+#endif
+}
+
+}  // namespace micro_opus
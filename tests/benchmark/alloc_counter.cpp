@@ -0,0 +1,98 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+#include "alloc_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<size_t> g_allocations{0};
+
+}  // namespace
+
+namespace micro_opus_bench {
+
+size_t allocation_count() {
+    return g_allocations.load(std::memory_order_relaxed);
+}
+
+bool malloc_tracked() {
+#ifdef BENCH_WRAP_MALLOC
+    return true;
+#else
+    return false;
+#endif
+}
+
+}  // namespace micro_opus_bench
+
+#ifdef BENCH_WRAP_MALLOC
+// Linked with -Wl,--wrap=malloc,... so every malloc/calloc/realloc call in the executable's objects
+// (including the static micro_opus library) lands here first.
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_calloc(size_t count, size_t size);
+void* __real_realloc(void* ptr, size_t size);
+
+void* __wrap_malloc(size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __real_malloc(size);
+}
+
+void* __wrap_calloc(size_t count, size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __real_calloc(count, size);
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+    return __real_realloc(ptr, size);
+}
+}
+#endif  // BENCH_WRAP_MALLOC
+
+// operator new goes through malloc, which already counts when it is wrapped
+void* operator new(size_t size) {
+#ifndef BENCH_WRAP_MALLOC
+    g_allocations.fetch_add(1, std::memory_order_relaxed);
+#endif
+    void* ptr = std::malloc(size == 0 ? 1 : size);
+    if (ptr == nullptr) {
+        throw std::bad_alloc();
+    }
+    return ptr;
+}
+
+void* operator new[](size_t size) {
+    return ::operator new(size);
+}
+
+void operator delete(void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
+
+void operator delete[](void* ptr, size_t /*size*/) noexcept {
+    std::free(ptr);
+}
@@ -0,0 +1,34 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Heap allocation counter for the host benchmarks. Replaces the global operator new/delete, and on
+// toolchains that support it (GNU ld, see tests/CMakeLists.txt) also wraps malloc/calloc/realloc so
+// the C allocations inside libopus and the wrappers are counted too.
+
+#ifndef MICRO_OPUS_TESTS_ALLOC_COUNTER_H
+#define MICRO_OPUS_TESTS_ALLOC_COUNTER_H
+
+#include <cstddef>
+
+namespace micro_opus_bench {
+
+// Allocations made by the process so far. Take the difference around the code being measured.
+size_t allocation_count();
+
+// True when malloc-family calls are counted, false when only operator new is
+bool malloc_tracked();
+
+}  // namespace micro_opus_bench
+
+#endif  // MICRO_OPUS_TESTS_ALLOC_COUNTER_H
@@ -0,0 +1,478 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host decode benchmark
+//
+// Generates a reproducible Ogg Opus corpus in memory (deterministic test signal, libopus encoder
+// with fixed settings) that covers SILK, hybrid and CELT packets at every frame size they support,
+// in mono, stereo and 5.1 multistream layouts, then times OggOpusDecoder over every stream at every
+// output rate. Reports the real-time factor, nanoseconds per output sample and heap allocation
+// counts per stream, and optionally writes the results as JSON so CI can track them over time.
+//
+// A fixed-format build (OPUS_FIXED_SAMPLE_RATE/OPUS_FIXED_CHANNELS) decodes every mono and stereo
+// stream to its one format and skips the multistream layouts.
+//
+// Usage: decode_benchmark [--seconds N] [--iterations N] [--filter SUBSTRING] [--json FILE]
+
+#include "alloc_counter.h"
+#include "micro_opus/ogg_opus_decoder.h"
+#include "ogg_mux.h"
+#include "opus.h"
+#include "opus_multistream.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+using micro_opus_test::make_ogg_page;
+using micro_opus_test::make_opus_head_family0;
+using micro_opus_test::make_opus_head_family1;
+using micro_opus_test::make_opus_tags;
+using micro_opus_test::OGG_FLAG_BOS;
+using micro_opus_test::OGG_FLAG_EOS;
+
+constexpr uint32_t SERIAL_NUMBER = 0x4d4f4442;  // "MODB"
+constexpr uint32_t ENCODE_SAMPLE_RATE = 48000;
+constexpr int ENCODE_COMPLEXITY = 10;
+constexpr size_t MAX_PACKET_SIZE = 4000 * 8;  // Generous for 8 streams at 120 ms
+
+// Forces the encoder's coding mode. Private libopus request (src/opus_private.h), used by
+// opus_demo and the upstream tests for the same purpose; the request numbers are stable.
+constexpr int OPUS_SET_FORCE_MODE_REQUEST = 11002;
+constexpr int MODE_SILK_ONLY = 1000;
+constexpr int MODE_HYBRID = 1001;
+constexpr int MODE_CELT_ONLY = 1002;
+
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+const uint32_t OUTPUT_SAMPLE_RATES[] = {MICRO_OPUS_FIXED_SAMPLE_RATE};
+constexpr uint8_t FIXED_CHANNELS = MICRO_OPUS_FIXED_CHANNELS;
+#else
+const uint32_t OUTPUT_SAMPLE_RATES[] = {8000, 12000, 16000, 24000, 48000};
+constexpr uint8_t FIXED_CHANNELS = 0;  // Generic build: the stream's own channel count
+#endif
+
+struct CodingMode {
+    const char* name;
+    int force_mode;
+    opus_int32 bandwidth;
+    opus_int32 bitrate_per_channel;
+    std::vector<int> frame_sizes;  // In 48 kHz samples
+};
+
+// SILK and hybrid support 10-60 ms frames; CELT also supports 2.5 and 5 ms
+const std::vector<CodingMode>& coding_modes() {
+    static const std::vector<CodingMode> modes = {
+        {"silk", MODE_SILK_ONLY, OPUS_BANDWIDTH_WIDEBAND, 20000, {480, 960, 1920, 2880}},
+        {"hybrid", MODE_HYBRID, OPUS_BANDWIDTH_FULLBAND, 32000, {480, 960, 1920, 2880}},
+        {"celt", MODE_CELT_ONLY, OPUS_BANDWIDTH_FULLBAND, 64000, {120, 240, 480, 960, 1920, 2880}},
+    };
+    return modes;
+}
+
+struct ChannelLayout {
+    const char* name;
+    uint8_t channels;
+    uint8_t streams;
+    uint8_t coupled_streams;
+    uint8_t mapping_family;
+    std::vector<uint8_t> mapping;
+};
+
+const std::vector<ChannelLayout>& channel_layouts() {
+    static const std::vector<ChannelLayout> layouts = {
+        {"mono", 1, 1, 0, 0, {0}},
+        {"stereo", 2, 1, 1, 0, {0, 1}},
+        // Vorbis channel order (L, C, R, RL, RR, LFE): L/R and RL/RR coupled, C and LFE mono
+        {"5.1", 6, 4, 2, 1, {0, 4, 1, 2, 3, 5}},
+    };
+    return layouts;
+}
+
+struct CorpusStream {
+    std::string name;
+    const CodingMode* mode;
+    const ChannelLayout* layout;
+    int frame_size;
+    std::vector<uint8_t> ogg;
+    size_t packets;
+    size_t audio_bytes;
+    size_t mode_mismatches;  // Packets whose TOC is not in the requested mode
+};
+
+struct BenchmarkResult {
+    const CorpusStream* stream;
+    uint32_t sample_rate;
+    double seconds;           // Fastest iteration
+    size_t samples;           // Per channel, after pre-skip
+    uint8_t channels;
+    size_t allocations;       // Whole run, decoder construction to teardown
+    size_t steady_state_allocations;  // After the first decoded audio
+    bool ok;
+};
+
+struct Options {
+    double seconds = 4.0;
+    int iterations = 3;
+    const char* filter = nullptr;
+    const char* json_path = nullptr;
+};
+
+// Deterministic test signal: a few harmonics with slow vibrato under a syllable-rate envelope, plus
+// low-level noise from a fixed-seed LCG. Each channel gets its own pitch so multistream encodes do
+// not collapse into identical streams.
+std::vector<int16_t> generate_signal(uint8_t channels, size_t samples) {
+    std::vector<int16_t> pcm(samples * channels);
+    uint32_t noise_state = 0x12345678;
+    const double two_pi = 6.283185307179586;
+
+    for (uint8_t ch = 0; ch < channels; ++ch) {
+        const double base_hz = 110.0 * (1.0 + 0.25 * ch);
+        double phase = 0.0;
+        for (size_t i = 0; i < samples; ++i) {
+            const double t = static_cast<double>(i) / ENCODE_SAMPLE_RATE;
+            const double hz = base_hz * (1.0 + 0.02 * std::sin(two_pi * 5.0 * t));
+            phase += two_pi * hz / ENCODE_SAMPLE_RATE;
+            const double envelope = 0.55 + 0.45 * std::sin(two_pi * 3.0 * t + ch);
+
+            double value = 0.0;
+            for (int harmonic = 1; harmonic <= 6; ++harmonic) {
+                value += std::sin(phase * harmonic) / harmonic;
+            }
+            noise_state = noise_state * 1664525U + 1013904223U;
+            const double noise = (static_cast<int32_t>(noise_state) >> 16) / 32768.0;
+
+            value = (0.35 * value * envelope + 0.02 * noise) * 32767.0;
+            value = std::max(-32768.0, std::min(32767.0, value));
+            pcm[i * channels + ch] = static_cast<int16_t>(value);
+        }
+    }
+    return pcm;
+}
+
+// Coding mode of a packet's first frame, from its TOC configuration number (RFC 6716 3.1)
+int packet_mode(const uint8_t* packet) {
+    const int config = packet[0] >> 3;
+    if (config < 12) {
+        return MODE_SILK_ONLY;
+    }
+    return config < 16 ? MODE_HYBRID : MODE_CELT_ONLY;
+}
+
+// Encode one corpus stream. Returns false if libopus rejects the configuration.
+bool encode_stream(const CodingMode& mode, const ChannelLayout& layout, int frame_size,
+                   const std::vector<int16_t>& pcm, size_t total_samples, CorpusStream& stream) {
+    int err = 0;
+    OpusMSEncoder* enc = opus_multistream_encoder_create(
+        ENCODE_SAMPLE_RATE, layout.channels, layout.streams, layout.coupled_streams,
+        layout.mapping.data(), OPUS_APPLICATION_AUDIO, &err);
+    if (enc == nullptr || err != OPUS_OK) {
+        return false;
+    }
+
+    opus_multistream_encoder_ctl(enc, OPUS_SET_BITRATE(mode.bitrate_per_channel * layout.channels));
+    opus_multistream_encoder_ctl(enc, OPUS_SET_VBR(0));
+    for (int s = 0; s < layout.streams; ++s) {
+        OpusEncoder* stream_enc = nullptr;
+        opus_multistream_encoder_ctl(enc, OPUS_MULTISTREAM_GET_ENCODER_STATE(s, &stream_enc));
+        opus_encoder_ctl(stream_enc, OPUS_SET_COMPLEXITY(ENCODE_COMPLEXITY));
+        opus_encoder_ctl(stream_enc, OPUS_SET_BANDWIDTH(mode.bandwidth));
+        opus_encoder_ctl(stream_enc, OPUS_SET_FORCE_MODE_REQUEST, mode.force_mode);
+    }
+
+    opus_int32 lookahead = 0;
+    opus_multistream_encoder_ctl(enc, OPUS_GET_LOOKAHEAD(&lookahead));
+
+    std::vector<uint8_t>& ogg = stream.ogg;
+    auto append = [&ogg](const std::vector<uint8_t>& page) {
+        ogg.insert(ogg.end(), page.begin(), page.end());
+    };
+    if (layout.mapping_family == 0) {
+        append(make_ogg_page(OGG_FLAG_BOS, 0, SERIAL_NUMBER, 0,
+                             make_opus_head_family0(layout.channels,
+                                                    static_cast<uint16_t>(lookahead))));
+    } else {
+        append(make_ogg_page(OGG_FLAG_BOS, 0, SERIAL_NUMBER, 0,
+                             make_opus_head_family1(layout.channels, layout.streams,
+                                                    layout.coupled_streams, layout.mapping,
+                                                    static_cast<uint16_t>(lookahead))));
+    }
+    append(make_ogg_page(0x00, 0, SERIAL_NUMBER, 1, make_opus_tags()));
+
+    const size_t frames = total_samples / static_cast<size_t>(frame_size);
+    std::vector<uint8_t> packet(MAX_PACKET_SIZE);
+    stream.packets = 0;
+    stream.audio_bytes = 0;
+    stream.mode_mismatches = 0;
+    for (size_t f = 0; f < frames; ++f) {
+        const int bytes = opus_multistream_encode(
+            enc, pcm.data() + f * frame_size * layout.channels, frame_size, packet.data(),
+            static_cast<opus_int32>(packet.size()));
+        if (bytes <= 0) {
+            opus_multistream_encoder_destroy(enc);
+            return false;
+        }
+        // Only the first stream's TOC is checked; the encoder settings are identical for all
+        if (packet_mode(packet.data()) != mode.force_mode) {
+            ++stream.mode_mismatches;
+        }
+
+        const uint8_t flags = (f + 1 == frames) ? OGG_FLAG_EOS : 0x00;
+        const uint64_t granule = static_cast<uint64_t>(f + 1) * static_cast<uint64_t>(frame_size);
+        append(make_ogg_page(flags, granule, SERIAL_NUMBER, static_cast<uint32_t>(f + 2),
+                             std::vector<uint8_t>(packet.begin(), packet.begin() + bytes)));
+        ++stream.packets;
+        stream.audio_bytes += static_cast<size_t>(bytes);
+    }
+
+    opus_multistream_encoder_destroy(enc);
+    return true;
+}
+
+std::vector<CorpusStream> build_corpus(const Options& options) {
+    const size_t total_samples = static_cast<size_t>(options.seconds * ENCODE_SAMPLE_RATE);
+    std::vector<CorpusStream> corpus;
+
+    for (const ChannelLayout& layout : channel_layouts()) {
+        if (FIXED_CHANNELS != 0 && layout.mapping_family != 0) {
+            continue;  // Fixed-format builds refuse multistream decoders
+        }
+        const std::vector<int16_t> pcm = generate_signal(layout.channels, total_samples);
+        for (const CodingMode& mode : coding_modes()) {
+            for (int frame_size : mode.frame_sizes) {
+                char name[64];
+                std::snprintf(name, sizeof(name), "%s_%gms_%s", mode.name,
+                              frame_size * 1000.0 / ENCODE_SAMPLE_RATE, layout.name);
+                if (options.filter != nullptr && std::strstr(name, options.filter) == nullptr) {
+                    continue;
+                }
+
+                CorpusStream stream;
+                stream.name = name;
+                stream.mode = &mode;
+                stream.layout = &layout;
+                stream.frame_size = frame_size;
+                if (!encode_stream(mode, layout, frame_size, pcm, total_samples, stream)) {
+                    std::fprintf(stderr, "WARNING: failed to encode %s, skipping\n", name);
+                    continue;
+                }
+                if (stream.mode_mismatches > 0) {
+                    std::fprintf(stderr, "WARNING: %s: %zu of %zu packets not in %s mode\n", name,
+                                 stream.mode_mismatches, stream.packets, mode.name);
+                }
+                corpus.push_back(std::move(stream));
+            }
+        }
+    }
+    return corpus;
+}
+
+// Decode a whole stream once. The output buffer is sized up front for the largest packet so the
+// harness itself does not allocate inside the measured region.
+BenchmarkResult decode_stream(const CorpusStream& stream, uint32_t sample_rate) {
+    BenchmarkResult result{&stream, sample_rate, 0.0, 0, 0, 0, 0, false};
+
+    const size_t max_samples = static_cast<size_t>(sample_rate) * 120 / 1000;
+    const uint8_t output_channels =
+        (FIXED_CHANNELS != 0) ? FIXED_CHANNELS : stream.layout->channels;
+    std::vector<int16_t> pcm(max_samples * output_channels);
+
+    const size_t allocations_before = micro_opus_bench::allocation_count();
+    size_t first_audio_allocations = 0;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        micro_opus::OggOpusDecoder decoder(false, sample_rate, 0);
+        size_t offset = 0;
+        while (offset < stream.ogg.size()) {
+            size_t consumed = 0;
+            size_t samples = 0;
+            const micro_opus::OggOpusResult status = decoder.decode(
+                stream.ogg.data() + offset, stream.ogg.size() - offset,
+                reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t), consumed,
+                samples);
+            if (status != micro_opus::OGG_OPUS_OK || (consumed == 0 && samples == 0)) {
+                std::fprintf(stderr, "ERROR: %s @ %u Hz: decode failed with code %d\n",
+                             stream.name.c_str(), sample_rate, status);
+                return result;
+            }
+            offset += consumed;
+            if (samples > 0 && result.samples == 0) {
+                first_audio_allocations = micro_opus_bench::allocation_count();
+            }
+            result.samples += samples;
+        }
+        result.channels = decoder.get_channels();
+    }
+    result.seconds =
+        std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    const size_t allocations_after = micro_opus_bench::allocation_count();
+    result.allocations = allocations_after - allocations_before;
+    if (first_audio_allocations != 0) {
+        // Teardown frees but does not allocate, so anything past the first output is steady state
+        result.steady_state_allocations = allocations_after - first_audio_allocations;
+    }
+    result.ok = result.samples > 0;
+    return result;
+}
+
+double real_time_factor(const BenchmarkResult& result) {
+    const double audio_seconds = static_cast<double>(result.samples) / result.sample_rate;
+    return audio_seconds > 0.0 ? result.seconds / audio_seconds : 0.0;
+}
+
+double ns_per_sample(const BenchmarkResult& result) {
+    const double samples = static_cast<double>(result.samples) * result.channels;
+    return samples > 0.0 ? result.seconds * 1e9 / samples : 0.0;
+}
+
+double bitrate_kbps(const CorpusStream& stream) {
+    const double audio_seconds =
+        static_cast<double>(stream.packets) * stream.frame_size / ENCODE_SAMPLE_RATE;
+    return audio_seconds > 0.0 ? stream.audio_bytes * 8.0 / audio_seconds / 1000.0 : 0.0;
+}
+
+bool write_json(const char* path, const Options& options,
+                const std::vector<BenchmarkResult>& results) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "ERROR: cannot open %s for writing\n", path);
+        return false;
+    }
+
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"benchmark\": \"decode\",\n");
+    std::fprintf(file, "  \"opus_version\": \"%s\",\n", opus_get_version_string());
+    std::fprintf(file, "  \"audio_seconds\": %g,\n", options.seconds);
+    std::fprintf(file, "  \"iterations\": %d,\n", options.iterations);
+    std::fprintf(file, "  \"encode_complexity\": %d,\n", ENCODE_COMPLEXITY);
+    std::fprintf(file, "  \"fixed_output_format\": %s,\n", FIXED_CHANNELS != 0 ? "true" : "false");
+    std::fprintf(file, "  \"malloc_tracked\": %s,\n",
+                 micro_opus_bench::malloc_tracked() ? "true" : "false");
+    std::fprintf(file, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& r = results[i];
+        const CorpusStream& s = *r.stream;
+        std::fprintf(file,
+                     "    {\"name\": \"%s\", \"mode\": \"%s\", \"frame_ms\": %g, "
+                     "\"layout\": \"%s\", \"channels\": %u, \"streams\": %u, "
+                     "\"sample_rate\": %u, \"packets\": %zu, \"bitrate_kbps\": %.2f, "
+                     "\"mode_mismatches\": %zu, \"ok\": %s, \"decode_seconds\": %.6f, "
+                     "\"rtf\": %.6f, \"ns_per_sample\": %.3f, \"allocations\": %zu, "
+                     "\"steady_state_allocations\": %zu}%s\n",
+                     s.name.c_str(), s.mode->name, s.frame_size * 1000.0 / ENCODE_SAMPLE_RATE,
+                     s.layout->name, s.layout->channels, s.layout->streams, r.sample_rate,
+                     s.packets, bitrate_kbps(s), s.mode_mismatches, r.ok ? "true" : "false",
+                     r.seconds, real_time_factor(r), ns_per_sample(r), r.allocations,
+                     r.steady_state_allocations, i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+
+void print_usage(const char* program) {
+    std::printf("Usage: %s [--seconds N] [--iterations N] [--filter SUBSTRING] [--json FILE]\n\n",
+                program);
+    std::printf("  --seconds N       Audio per corpus stream (default 4)\n");
+    std::printf("  --iterations N    Passes per stream and rate, fastest is kept (default 3)\n");
+    std::printf("  --filter STRING   Only streams whose name contains STRING, e.g. celt_ or 5.1\n");
+    std::printf("  --json FILE       Also write the results as JSON\n");
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--seconds") == 0 && has_value) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && has_value) {
+            options.iterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--filter") == 0 && has_value) {
+            options.filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && has_value) {
+            options.json_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    // At least one 60 ms packet per stream
+    return options.seconds >= 0.06 && options.iterations >= 1;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    std::printf("micro-opus decode benchmark (%s)\n", opus_get_version_string());
+    std::printf("Corpus: %g s per stream, best of %d iteration(s), allocations %s\n",
+                options.seconds, options.iterations,
+                micro_opus_bench::malloc_tracked() ? "include malloc" : "count operator new only");
+    if (FIXED_CHANNELS != 0) {
+        std::printf("Output format: fixed at %u Hz, %u channel(s) (OPUS_FIXED_OUTPUT_FORMAT)\n\n",
+                    OUTPUT_SAMPLE_RATES[0], FIXED_CHANNELS);
+    } else {
+        std::printf("Output format: any (generic decoder)\n\n");
+    }
+
+    const std::vector<CorpusStream> corpus = build_corpus(options);
+    if (corpus.empty()) {
+        std::printf("ERROR: no corpus streams to decode\n");
+        return 1;
+    }
+
+    std::printf("%-24s %6s %7s %10s %10s %8s %8s\n", "Stream", "Rate", "kbps", "RTF", "ns/sample",
+                "Allocs", "Steady");
+    std::vector<BenchmarkResult> results;
+    bool all_ok = true;
+    for (const CorpusStream& stream : corpus) {
+        for (uint32_t rate : OUTPUT_SAMPLE_RATES) {
+            BenchmarkResult best{};
+            for (int i = 0; i < options.iterations; ++i) {
+                const BenchmarkResult run = decode_stream(stream, rate);
+                if (i == 0 || !run.ok || run.seconds < best.seconds) {
+                    best = run;
+                }
+                if (!run.ok) {
+                    break;
+                }
+            }
+            all_ok = all_ok && best.ok;
+            std::printf("%-24s %6u %7.1f %10.5f %10.2f %8zu %8zu%s\n", stream.name.c_str(), rate,
+                        bitrate_kbps(stream), real_time_factor(best), ns_per_sample(best),
+                        best.allocations, best.steady_state_allocations, best.ok ? "" : "  FAILED");
+            results.push_back(best);
+        }
+    }
+
+    if (options.json_path != nullptr) {
+        if (!write_json(options.json_path, options, results)) {
+            return 1;
+        }
+        std::printf("\nResults written to %s\n", options.json_path);
+    }
+
+    return all_ok ? 0 : 1;
+}
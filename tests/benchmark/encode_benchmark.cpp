@@ -0,0 +1,481 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Host encode benchmark
+//
+// Host port of examples/encode_benchmark: the same two 30-second clips and the same complexity x
+// application x bitrate matrix, run on a workstation so encoder settings can be explored before
+// flashing a device. Each clip is decoded once up front; only the opus_encode() calls are timed.
+// For every configuration it reports per-frame encode time, throughput, the actual output bitrate
+// against the target, the coding modes chosen, and the peak pseudostack use of the encoder.
+// Results can be written as CSV and/or JSON.
+//
+// Unlike the device benchmark, configurations are never skipped for running slower than real time.
+//
+// Usage: encode_benchmark [--audio speech|music] [--seconds N] [--iterations N]
+//                         [--csv FILE] [--json FILE]
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "opus.h"
+#include "test_audio_music.h"
+#include "test_audio_speech.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cctype>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#if defined(__GLIBC__) && \
+    (defined(BENCH_PSEUDOSTACK_THREADSAFE) || defined(BENCH_PSEUDOSTACK_GLOBAL))
+#include <malloc.h>
+#define BENCH_HAVE_PSEUDOSTACK_PROBE 1
+
+// Base of the calling thread's pseudostack, defined by the library (thread_local_stack.c for
+// THREADSAFE_PSEUDOSTACK, celt.c for NONTHREADSAFE_PSEUDOSTACK). Allocations grow upward from it.
+#ifdef BENCH_PSEUDOSTACK_THREADSAFE
+extern "C" thread_local char* scratch_ptr;
+#else
+extern "C" char* scratch_ptr;
+#endif
+#endif
+
+namespace {
+
+struct AudioConfig {
+    const char* name;
+    const char* preferred_codec;  // What the encoder is expected to pick for this material
+    const uint8_t* data;
+    size_t size;
+    uint8_t channels;
+    uint32_t sample_rate;  // Decode and encode rate
+};
+
+const AudioConfig AUDIO_CONFIGS[] = {
+    {"SPEECH", "SILK", test_opus_speech_data, test_opus_speech_data_size, 1, 16000},
+    {"MUSIC", "CELT", test_opus_music_data, test_opus_music_data_size, 2, 48000},
+};
+
+struct EncoderConfig {
+    int complexity;
+    int application;
+    int target_bitrate;
+    const char* mode_name;
+};
+
+// Same matrix as the device benchmark: complexity x application x bitrate, in that nesting order
+const int COMPLEXITIES[] = {0, 2, 5, 8, 10};
+const int SPEECH_BITRATES[] = {10000, 16000, 24000, 32000};
+const int MUSIC_BITRATES[] = {64000, 96000, 128000, 192000};
+
+std::vector<EncoderConfig> encoder_configs(const AudioConfig& audio) {
+    std::vector<EncoderConfig> configs;
+    const bool speech = audio.channels == 1;
+    const int applications[] = {OPUS_APPLICATION_VOIP, OPUS_APPLICATION_AUDIO};
+    for (int application : applications) {
+        if (!speech && application == OPUS_APPLICATION_VOIP) {
+            continue;  // Music runs in AUDIO mode only
+        }
+        const char* mode_name = application == OPUS_APPLICATION_VOIP ? "VOIP" : "AUDIO";
+        for (int complexity : COMPLEXITIES) {
+            for (int bitrate : speech ? SPEECH_BITRATES : MUSIC_BITRATES) {
+                configs.push_back({complexity, application, bitrate, mode_name});
+            }
+        }
+    }
+    return configs;
+}
+
+struct Options {
+    const char* audio = nullptr;  // Restrict to one clip, case-insensitive
+    double seconds = 0.0;         // 0 encodes the whole clip
+    int iterations = 1;
+    const char* csv_path = nullptr;
+    const char* json_path = nullptr;
+};
+
+// Per-frame encode times in microseconds
+struct FrameStats {
+    double min_us = 0.0;
+    double max_us = 0.0;
+    double sum_us = 0.0;
+    double sum_sq_us = 0.0;
+    size_t count = 0;
+
+    void add(double us) {
+        if (count == 0 || us < min_us) {
+            min_us = us;
+        }
+        max_us = std::max(max_us, us);
+        sum_us += us;
+        sum_sq_us += us * us;
+        ++count;
+    }
+
+    double average() const { return count > 0 ? sum_us / count : 0.0; }
+
+    double stddev() const {
+        if (count == 0) {
+            return 0.0;
+        }
+        const double avg = average();
+        const double variance = sum_sq_us / count - avg * avg;
+        return std::sqrt(variance > 0.0 ? variance : 0.0);
+    }
+};
+
+struct EncodeResult {
+    const AudioConfig* audio;
+    EncoderConfig config;
+    FrameStats frames;
+    double encode_seconds = 0.0;
+    double audio_seconds = 0.0;
+    size_t bytes = 0;
+    size_t silk_frames = 0;
+    size_t hybrid_frames = 0;
+    size_t celt_frames = 0;
+    long pseudostack_peak = -1;  // Bytes, -1 if it could not be measured
+    bool ok = false;
+
+    double actual_bitrate() const {
+        return audio_seconds > 0.0 ? bytes * 8.0 / audio_seconds : 0.0;
+    }
+
+    double bitrate_error_percent() const {
+        return (actual_bitrate() - config.target_bitrate) * 100.0 / config.target_bitrate;
+    }
+
+    double rtf() const { return audio_seconds > 0.0 ? encode_seconds / audio_seconds : 0.0; }
+};
+
+#ifdef BENCH_HAVE_PSEUDOSTACK_PROBE
+constexpr uint8_t PSEUDOSTACK_PAINT = 0xA5;
+
+// Fill the calling thread's whole pseudostack with a known byte. Between codec calls the
+// pseudostack is empty, so nothing live is overwritten. Returns the painted size, 0 if the
+// pseudostack has not been allocated yet.
+size_t paint_pseudostack() {
+    if (scratch_ptr == nullptr) {
+        return 0;
+    }
+    const size_t size = malloc_usable_size(scratch_ptr);
+    std::memset(scratch_ptr, PSEUDOSTACK_PAINT, size);
+    return size;
+}
+
+// Bytes from the pseudostack base up to the highest byte that no longer holds the paint
+long pseudostack_high_water(size_t painted) {
+    size_t top = painted;
+    while (top > 0 && static_cast<uint8_t>(scratch_ptr[top - 1]) == PSEUDOSTACK_PAINT) {
+        --top;
+    }
+    return static_cast<long>(top);
+}
+#endif
+
+// Coding mode counters from the TOC configuration number (RFC 6716 3.1)
+void count_mode(const uint8_t* packet, EncodeResult& result) {
+    const int config = packet[0] >> 3;
+    if (config < 12) {
+        ++result.silk_frames;
+    } else if (config < 16) {
+        ++result.hybrid_frames;
+    } else {
+        ++result.celt_frames;
+    }
+}
+
+// Decode a whole clip to interleaved PCM at the clip's configured rate and channel count
+bool decode_clip(const AudioConfig& audio, std::vector<int16_t>& pcm) {
+    micro_opus::OggOpusDecoder decoder(false, audio.sample_rate, audio.channels);
+    std::vector<int16_t> buffer(static_cast<size_t>(audio.sample_rate) * 120 / 1000 *
+                                audio.channels);
+    size_t offset = 0;
+    while (offset < audio.size) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        const micro_opus::OggOpusResult result =
+            decoder.decode(audio.data + offset, audio.size - offset,
+                           reinterpret_cast<uint8_t*>(buffer.data()),
+                           buffer.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK || (consumed == 0 && samples == 0)) {
+            std::fprintf(stderr, "ERROR: decoding %s failed with code %d\n", audio.name, result);
+            return false;
+        }
+        offset += consumed;
+        pcm.insert(pcm.end(), buffer.begin(), buffer.begin() + samples * audio.channels);
+    }
+    return !pcm.empty();
+}
+
+// Encode the clip once with one configuration in 20 ms frames, timing only opus_encode()
+EncodeResult run_encode(const AudioConfig& audio, const EncoderConfig& config,
+                        const std::vector<int16_t>& pcm) {
+    EncodeResult result;
+    result.audio = &audio;
+    result.config = config;
+
+    int err = 0;
+    OpusEncoder* encoder =
+        opus_encoder_create(static_cast<opus_int32>(audio.sample_rate), audio.channels,
+                            config.application, &err);
+    if (encoder == nullptr || err != OPUS_OK) {
+        std::fprintf(stderr, "ERROR: failed to create encoder: %s\n", opus_strerror(err));
+        return result;
+    }
+    opus_encoder_ctl(encoder, OPUS_SET_COMPLEXITY(config.complexity));
+    opus_encoder_ctl(encoder, OPUS_SET_BITRATE(config.target_bitrate));
+
+    const size_t frame_size = audio.sample_rate / 50;
+    const size_t frames = pcm.size() / audio.channels / frame_size;
+    std::vector<uint8_t> packet(4000);  // Recommended maximum Opus packet size
+
+#ifdef BENCH_HAVE_PSEUDOSTACK_PROBE
+    const size_t painted = paint_pseudostack();
+#endif
+
+    result.ok = true;
+    for (size_t f = 0; f < frames; ++f) {
+        const auto start = std::chrono::steady_clock::now();
+        const opus_int32 bytes =
+            opus_encode(encoder, pcm.data() + f * frame_size * audio.channels,
+                        static_cast<int>(frame_size), packet.data(),
+                        static_cast<opus_int32>(packet.size()));
+        const double us = std::chrono::duration<double, std::micro>(
+                              std::chrono::steady_clock::now() - start)
+                              .count();
+        if (bytes < 0) {
+            std::fprintf(stderr, "ERROR: encode failed: %s\n", opus_strerror(bytes));
+            result.ok = false;
+            break;
+        }
+        result.frames.add(us);
+        result.bytes += static_cast<size_t>(bytes);
+        count_mode(packet.data(), result);
+    }
+
+#ifdef BENCH_HAVE_PSEUDOSTACK_PROBE
+    if (painted > 0) {
+        result.pseudostack_peak = pseudostack_high_water(painted);
+    }
+#endif
+
+    opus_encoder_destroy(encoder);
+    result.encode_seconds = result.frames.sum_us / 1e6;
+    result.audio_seconds =
+        static_cast<double>(result.frames.count * frame_size) / audio.sample_rate;
+    return result;
+}
+
+const char* application_json(const EncodeResult& r) {
+    return r.config.application == OPUS_APPLICATION_VOIP ? "voip" : "audio";
+}
+
+bool write_csv(const char* path, const std::vector<EncodeResult>& results) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "ERROR: cannot open %s for writing\n", path);
+        return false;
+    }
+    std::fprintf(file,
+                 "audio,application,complexity,target_bps,actual_bps,bitrate_error_pct,frames,"
+                 "encode_s,rtf,frame_min_us,frame_max_us,frame_avg_us,frame_sd_us,silk_frames,"
+                 "hybrid_frames,celt_frames,pseudostack_peak_bytes,ok\n");
+    for (const EncodeResult& r : results) {
+        std::fprintf(file, "%s,%s,%d,%d,%.0f,%.2f,%zu,%.6f,%.6f,%.2f,%.2f,%.2f,%.2f,%zu,%zu,%zu,",
+                     r.audio->name, application_json(r), r.config.complexity,
+                     r.config.target_bitrate, r.actual_bitrate(), r.bitrate_error_percent(),
+                     r.frames.count, r.encode_seconds, r.rtf(), r.frames.min_us, r.frames.max_us,
+                     r.frames.average(), r.frames.stddev(), r.silk_frames, r.hybrid_frames,
+                     r.celt_frames);
+        if (r.pseudostack_peak >= 0) {
+            std::fprintf(file, "%ld", r.pseudostack_peak);
+        }
+        std::fprintf(file, ",%d\n", r.ok ? 1 : 0);
+    }
+    std::fclose(file);
+    return true;
+}
+
+bool write_json(const char* path, const Options& options,
+                const std::vector<EncodeResult>& results) {
+    FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        std::fprintf(stderr, "ERROR: cannot open %s for writing\n", path);
+        return false;
+    }
+    std::fprintf(file, "{\n");
+    std::fprintf(file, "  \"benchmark\": \"encode\",\n");
+    std::fprintf(file, "  \"opus_version\": \"%s\",\n", opus_get_version_string());
+    std::fprintf(file, "  \"iterations\": %d,\n", options.iterations);
+    std::fprintf(file, "  \"frame_ms\": 20,\n");
+    std::fprintf(file, "  \"results\": [\n");
+    for (size_t i = 0; i < results.size(); ++i) {
+        const EncodeResult& r = results[i];
+        char peak[32] = "null";
+        if (r.pseudostack_peak >= 0) {
+            std::snprintf(peak, sizeof(peak), "%ld", r.pseudostack_peak);
+        }
+        std::fprintf(file,
+                     "    {\"audio\": \"%s\", \"sample_rate\": %u, \"channels\": %u, "
+                     "\"application\": \"%s\", \"complexity\": %d, \"target_bps\": %d, "
+                     "\"actual_bps\": %.0f, \"bitrate_error_pct\": %.2f, \"frames\": %zu, "
+                     "\"audio_seconds\": %.3f, \"encode_seconds\": %.6f, \"rtf\": %.6f, "
+                     "\"frame_us\": {\"min\": %.2f, \"max\": %.2f, \"avg\": %.2f, \"sd\": %.2f}, "
+                     "\"modes\": {\"silk\": %zu, \"hybrid\": %zu, \"celt\": %zu}, "
+                     "\"pseudostack_peak_bytes\": %s, \"ok\": %s}%s\n",
+                     r.audio->name, r.audio->sample_rate, r.audio->channels, application_json(r),
+                     r.config.complexity, r.config.target_bitrate, r.actual_bitrate(),
+                     r.bitrate_error_percent(), r.frames.count, r.audio_seconds, r.encode_seconds,
+                     r.rtf(), r.frames.min_us, r.frames.max_us, r.frames.average(),
+                     r.frames.stddev(), r.silk_frames, r.hybrid_frames, r.celt_frames, peak,
+                     r.ok ? "true" : "false", i + 1 < results.size() ? "," : "");
+    }
+    std::fprintf(file, "  ]\n}\n");
+    std::fclose(file);
+    return true;
+}
+
+void print_usage(const char* program) {
+    std::printf("Usage: %s [--audio speech|music] [--seconds N] [--iterations N] [--csv FILE] "
+                "[--json FILE]\n\n",
+                program);
+    std::printf("  --audio NAME      Only run one clip\n");
+    std::printf("  --seconds N       Only encode the first N seconds of each clip (default all)\n");
+    std::printf("  --iterations N    Passes per configuration, fastest is kept (default 1)\n");
+    std::printf("  --csv FILE        Write the results as CSV\n");
+    std::printf("  --json FILE       Write the results as JSON\n");
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--audio") == 0 && has_value) {
+            options.audio = argv[++i];
+        } else if (std::strcmp(argv[i], "--seconds") == 0 && has_value) {
+            options.seconds = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--iterations") == 0 && has_value) {
+            options.iterations = std::atoi(argv[++i]);
+        } else if (std::strcmp(argv[i], "--csv") == 0 && has_value) {
+            options.csv_path = argv[++i];
+        } else if (std::strcmp(argv[i], "--json") == 0 && has_value) {
+            options.json_path = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return false;
+        }
+    }
+    return options.seconds >= 0.0 && options.iterations >= 1;
+}
+
+bool matches_audio(const AudioConfig& audio, const char* filter) {
+    if (filter == nullptr) {
+        return true;
+    }
+    for (size_t i = 0;; ++i) {
+        const char a = audio.name[i];
+        const char b = filter[i];
+        if (a == '\0' || b == '\0') {
+            return a == b;
+        }
+        if (a != std::toupper(static_cast<unsigned char>(b))) {
+            return false;
+        }
+    }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        return 2;
+    }
+
+    std::printf("micro-opus encode benchmark (%s)\n", opus_get_version_string());
+#ifdef BENCH_HAVE_PSEUDOSTACK_PROBE
+    std::printf("Pseudostack peak measured by painting the calling thread's pseudostack\n\n");
+#else
+    std::printf("Pseudostack peak not measured (needs a pseudostack mode and glibc)\n\n");
+#endif
+
+    std::vector<EncodeResult> results;
+    bool all_ok = true;
+    for (const AudioConfig& audio : AUDIO_CONFIGS) {
+        if (!matches_audio(audio, options.audio)) {
+            continue;
+        }
+
+        std::vector<int16_t> pcm;
+        if (!decode_clip(audio, pcm)) {
+            return 1;
+        }
+        if (options.seconds > 0.0) {
+            const size_t limit =
+                static_cast<size_t>(options.seconds * audio.sample_rate) * audio.channels;
+            pcm.resize(std::min(pcm.size(), limit));
+        }
+
+        std::printf("=== %s (%s): %u Hz, %u channel(s), %.1f s ===\n", audio.name,
+                    audio.preferred_codec, audio.sample_rate, audio.channels,
+                    static_cast<double>(pcm.size()) / audio.channels / audio.sample_rate);
+        std::printf("%-6s %3s %7s %9s %8s %8s %8s %8s %8s %9s %s\n", "App", "Cx", "Target",
+                    "Actual", "Err%", "RTF", "avg us", "max us", "PStack", "S/H/C", "");
+
+        for (const EncoderConfig& config : encoder_configs(audio)) {
+            EncodeResult best;
+            for (int i = 0; i < options.iterations; ++i) {
+                EncodeResult run = run_encode(audio, config, pcm);
+                if (i == 0 || !run.ok || run.encode_seconds < best.encode_seconds) {
+                    // Peak pseudostack does not depend on timing; keep the largest seen
+                    const long peak = std::max(run.pseudostack_peak, best.pseudostack_peak);
+                    best = run;
+                    best.pseudostack_peak = peak;
+                }
+                if (!run.ok) {
+                    break;
+                }
+            }
+            all_ok = all_ok && best.ok;
+
+            char modes[32];
+            std::snprintf(modes, sizeof(modes), "%zu/%zu/%zu", best.silk_frames,
+                          best.hybrid_frames, best.celt_frames);
+            std::printf("%-6s %3d %7d %9.0f %+8.1f %8.4f %8.1f %8.1f %8ld %9s %s\n",
+                        config.mode_name, config.complexity, config.target_bitrate,
+                        best.actual_bitrate(), best.bitrate_error_percent(), best.rtf(),
+                        best.frames.average(), best.frames.max_us, best.pseudostack_peak, modes,
+                        best.ok ? "" : "FAILED");
+            results.push_back(best);
+        }
+        std::printf("\n");
+    }
+
+    if (results.empty()) {
+        std::printf("ERROR: no clip matches --audio %s\n", options.audio);
+        return 2;
+    }
+    if (options.csv_path != nullptr && !write_csv(options.csv_path, results)) {
+        return 1;
+    }
+    if (options.json_path != nullptr && !write_json(options.json_path, options, results)) {
+        return 1;
+    }
+    return all_ok ? 0 : 1;
+}
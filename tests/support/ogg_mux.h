@@ -13,8 +13,8 @@
 // limitations under the License.
 
 // Header-only Ogg/Opus muxing helpers for host tests. Builds valid Ogg pages, OpusHead, and
-// OpusTags so tests can synthesize an Opus stream in memory. Used by test_silent_channels and
-// test_chunked.
+// OpusTags so tests can synthesize an Opus stream in memory. Used by test_silent_channels,
+// test_chunked and tone_stream.h.
 
 #ifndef MICRO_OPUS_TESTS_OGG_MUX_H
 #define MICRO_OPUS_TESTS_OGG_MUX_H
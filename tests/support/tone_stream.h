@@ -0,0 +1,200 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Header-only test stream helpers for host tests. ToneEncoder encodes one sine tone per channel
+// into Opus packets (single stream or multistream), and build_ogg_stream() muxes packets one per
+// page behind an OpusHead and OpusTags with ogg_mux.h.
+
+#ifndef MICRO_OPUS_TESTS_TONE_STREAM_H
+#define MICRO_OPUS_TESTS_TONE_STREAM_H
+
+#include "ogg_mux.h"
+#include "opus.h"
+#include "opus_multistream.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace micro_opus_test {
+
+// A sine tone on one channel. An amplitude of 0 gives digital silence, a negative one an inverted
+// copy of the same tone.
+struct Tone {
+    double frequency;
+    double amplitude;
+};
+
+// Encoder configuration. streams > 0 selects the multistream encoder with the identity mapping;
+// otherwise channels must be 1 or 2.
+struct EncoderSettings {
+    uint32_t sample_rate{48000};
+    int channels{2};
+    int application{OPUS_APPLICATION_AUDIO};
+    opus_int32 bitrate{96000};
+    int streams{0};
+    int coupled_streams{0};
+    size_t max_packet_bytes{4000};
+};
+
+// Write frames samples per channel of the tones (channel c plays tones[c]) into interleaved pcm,
+// continuing from sample position so consecutive calls produce a continuous signal.
+inline void fill_tones(std::vector<int16_t>& pcm, const std::vector<Tone>& tones, int frames,
+                       uint64_t position, uint32_t sample_rate) {
+    const size_t channels = tones.size();
+    const double two_pi = 2.0 * 3.14159265358979323846;
+    pcm.resize(static_cast<size_t>(frames) * channels);
+    for (int i = 0; i < frames; ++i) {
+        const double t = static_cast<double>(position + static_cast<uint64_t>(i)) / sample_rate;
+        for (size_t c = 0; c < channels; ++c) {
+            pcm[static_cast<size_t>(i) * channels + c] = static_cast<int16_t>(
+                std::lround(std::sin(two_pi * tones[c].frequency * t) * tones[c].amplitude));
+        }
+    }
+}
+
+// Opus encoder fed from a tone per channel. tones may be edited between encode() calls (e.g. to
+// mute a channel); ctl() forwards encoder requests such as OPUS_SET_DTX(1).
+class ToneEncoder {
+public:
+    ToneEncoder(const EncoderSettings& settings, const std::vector<Tone>& initial_tones)
+        : tones(initial_tones), settings_(settings) {
+        int error = OPUS_OK;
+        if (settings.streams > 0) {
+            std::vector<unsigned char> mapping(static_cast<size_t>(settings.channels));
+            for (size_t c = 0; c < mapping.size(); ++c) {
+                mapping[c] = static_cast<unsigned char>(c);
+            }
+            this->ms_encoder_ = opus_multistream_encoder_create(
+                static_cast<opus_int32>(settings.sample_rate), settings.channels, settings.streams,
+                settings.coupled_streams, mapping.data(), settings.application, &error);
+        } else {
+            this->encoder_ =
+                opus_encoder_create(static_cast<opus_int32>(settings.sample_rate),
+                                    settings.channels, settings.application, &error);
+        }
+        if (!this->ok() || error != OPUS_OK) {
+            std::printf("  FAIL: could not create encoder (%d)\n", error);
+            return;
+        }
+        this->ctl(OPUS_SET_BITRATE(settings.bitrate));
+    }
+
+    ~ToneEncoder() {
+        opus_encoder_destroy(this->encoder_);
+        opus_multistream_encoder_destroy(this->ms_encoder_);
+    }
+
+    ToneEncoder(const ToneEncoder&) = delete;
+    ToneEncoder& operator=(const ToneEncoder&) = delete;
+
+    bool ok() const {
+        return this->encoder_ != nullptr || this->ms_encoder_ != nullptr;
+    }
+
+    template <typename... Args>
+    int ctl(int request, Args... args) {
+        if (this->ms_encoder_ != nullptr) {
+            return opus_multistream_encoder_ctl(this->ms_encoder_, request, args...);
+        }
+        return opus_encoder_ctl(this->encoder_, request, args...);
+    }
+
+    // Encode the next frames samples per channel of the tones into one packet. Returns an empty
+    // packet (after printing) on error.
+    std::vector<uint8_t> encode(int frames) {
+        if (!this->ok()) {
+            return {};
+        }
+        fill_tones(this->pcm_, this->tones, frames, this->position_, this->settings_.sample_rate);
+        this->position_ += static_cast<uint64_t>(frames);
+
+        std::vector<uint8_t> packet(this->settings_.max_packet_bytes);
+        const opus_int32 capacity = static_cast<opus_int32>(packet.size());
+        const int bytes = (this->ms_encoder_ != nullptr)
+                              ? opus_multistream_encode(this->ms_encoder_, this->pcm_.data(),
+                                                        frames, packet.data(), capacity)
+                              : opus_encode(this->encoder_, this->pcm_.data(), frames,
+                                            packet.data(), capacity);
+        if (bytes < 0) {
+            std::printf("  FAIL: opus_encode returned %d\n", bytes);
+            return {};
+        }
+        packet.resize(static_cast<size_t>(bytes));
+        return packet;
+    }
+
+    std::vector<Tone> tones;
+
+private:
+    EncoderSettings settings_;
+    OpusEncoder* encoder_{nullptr};
+    OpusMSEncoder* ms_encoder_{nullptr};
+    std::vector<int16_t> pcm_;
+    uint64_t position_{0};
+};
+
+// Encode num_packets packets of the tones, cycling through frame_sizes (samples per channel).
+// Returns an empty vector on any error.
+inline std::vector<std::vector<uint8_t>> encode_tone_packets(const EncoderSettings& settings,
+                                                             const std::vector<Tone>& tones,
+                                                             int num_packets,
+                                                             const std::vector<int>& frame_sizes) {
+    ToneEncoder encoder(settings, tones);
+    std::vector<std::vector<uint8_t>> packets;
+    for (int p = 0; p < num_packets; ++p) {
+        std::vector<uint8_t> packet =
+            encoder.encode(frame_sizes[static_cast<size_t>(p) % frame_sizes.size()]);
+        if (packet.empty()) {
+            return {};
+        }
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+// Mux packets one per page behind opus_head and an OpusTags page. Granule positions accumulate
+// each packet's duration at 48 kHz; the last page carries EOS and its granule is cut by end_trim
+// samples. page_ends, if given, receives the end offset of every page.
+inline std::vector<uint8_t> build_ogg_stream(const std::vector<uint8_t>& opus_head,
+                                             const std::vector<std::vector<uint8_t>>& packets,
+                                             uint32_t serial, uint64_t end_trim = 0,
+                                             std::vector<size_t>* page_ends = nullptr) {
+    std::vector<uint8_t> stream;
+    auto append = [&stream, page_ends](const std::vector<uint8_t>& page) {
+        stream.insert(stream.end(), page.begin(), page.end());
+        if (page_ends != nullptr) {
+            page_ends->push_back(stream.size());
+        }
+    };
+    append(make_ogg_page(OGG_FLAG_BOS, 0, serial, 0, opus_head));
+    append(make_ogg_page(0x00, 0, serial, 1, make_opus_tags()));
+
+    uint64_t granule = 0;
+    for (size_t p = 0; p < packets.size(); ++p) {
+        const int samples = opus_packet_get_nb_samples(
+            packets[p].data(), static_cast<opus_int32>(packets[p].size()), 48000);
+        granule += (samples > 0) ? static_cast<uint64_t>(samples) : 0;
+        const bool last = (p + 1 == packets.size());
+        append(make_ogg_page(last ? OGG_FLAG_EOS : 0x00, last ? granule - end_trim : granule,
+                             serial, static_cast<uint32_t>(2 + p), packets[p]));
+    }
+    return stream;
+}
+
+}  // namespace micro_opus_test
+
+#endif  // MICRO_OPUS_TESTS_TONE_STREAM_H
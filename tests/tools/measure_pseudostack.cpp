@@ -0,0 +1,212 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Measure the pseudostack a decode-only configuration needs.
+//
+// Decodes every RFC 8251 conformance vector (opus_demo ".bit" framing, see
+// tests/conformance/decode_vectors.cpp) with OpusPacketDecoder at the given output rate and channel
+// count, followed by a few concealed frames, and reports the pseudostack high-water mark of each.
+// The vectors cover SILK, hybrid and CELT at every bandwidth and frame size, so their maximum is a
+// safe CONFIG_OPUS_PSEUDOSTACK_SIZE for a device that only decodes with the same settings.
+// Encoding needs considerably more; measure that with tests/benchmark/encode_benchmark.
+//
+// Needs the library built with -DOPUS_PSEUDOSTACK_TRACKING=ON. Exits 77 when no vectors are found.
+//
+// Usage: measure_pseudostack [--rate HZ] [--channels 1|2] [--margin PERCENT] <dir | file.bit>...
+
+#ifndef MICRO_OPUS_PSEUDOSTACK_TRACKING
+#error "This tool requires the library to be built with OPUS_PSEUDOSTACK_TRACKING"
+#endif
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "micro_opus/pseudostack.h"
+
+#include <dirent.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t MAX_PACKET_BYTES = 61440;  // Largest possible Opus packet, see decode_vectors
+constexpr int CONCEALED_FRAMES = 3;           // PLC frames appended after each vector
+constexpr size_t MIN_PSEUDOSTACK_SIZE = 16384;  // Lower bound of CONFIG_OPUS_PSEUDOSTACK_SIZE
+
+struct Options {
+    uint32_t sample_rate = 48000;
+    uint8_t channels = 2;
+    int margin_percent = 10;
+    std::vector<std::string> inputs;
+};
+
+uint32_t read_be32(const uint8_t* p) {
+    return (static_cast<uint32_t>(p[0]) << 24) | (static_cast<uint32_t>(p[1]) << 16) |
+           (static_cast<uint32_t>(p[2]) << 8) | static_cast<uint32_t>(p[3]);
+}
+
+// Expand directories to the testvector*.bit files they contain, sorted by name
+std::vector<std::string> collect_vectors(const std::vector<std::string>& inputs) {
+    std::vector<std::string> files;
+    for (const std::string& input : inputs) {
+        DIR* dir = opendir(input.c_str());
+        if (dir == nullptr) {
+            files.push_back(input);
+            continue;
+        }
+        std::vector<std::string> found;
+        while (const dirent* entry = readdir(dir)) {
+            const std::string name = entry->d_name;
+            if (name.compare(0, 10, "testvector") == 0 && name.size() > 4 &&
+                name.compare(name.size() - 4, 4, ".bit") == 0) {
+                found.push_back(input + "/" + name);
+            }
+        }
+        closedir(dir);
+        std::sort(found.begin(), found.end());
+        files.insert(files.end(), found.begin(), found.end());
+    }
+    return files;
+}
+
+// Decode one vector with a fresh decoder. Returns false on a read or decode error.
+bool measure_vector(const std::string& path, const Options& options, size_t& packets,
+                    size_t& high_water) {
+    FILE* fin = std::fopen(path.c_str(), "rb");
+    if (fin == nullptr) {
+        std::fprintf(stderr, "Cannot open '%s'\n", path.c_str());
+        return false;
+    }
+
+    micro_opus::OpusPacketDecoder decoder(options.sample_rate, options.channels);
+    std::vector<uint8_t> out(decoder.get_pcm_format().max_output_bytes());
+    std::vector<uint8_t> packet;
+    bool ok = true;
+    packets = 0;
+
+    opus_pseudostack_reset_high_water();
+    for (;;) {
+        uint8_t header[8];
+        const size_t got = std::fread(header, 1, sizeof(header), fin);
+        if (got == 0) {
+            break;
+        }
+        const uint32_t len = got == sizeof(header) ? read_be32(header) : 0;
+        if (len == 0 || len > MAX_PACKET_BYTES) {
+            std::fprintf(stderr, "%s: bad packet header at packet %zu\n", path.c_str(), packets);
+            ok = false;
+            break;
+        }
+        packet.resize(len);
+        if (std::fread(packet.data(), 1, len, fin) != len) {
+            std::fprintf(stderr, "%s: truncated packet %zu\n", path.c_str(), packets);
+            ok = false;
+            break;
+        }
+
+        size_t bytes_written = 0;
+        if (decoder.decode(packet.data(), packet.size(), out.data(), out.size(), bytes_written) !=
+            micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+            std::fprintf(stderr, "%s: decode failed on packet %zu\n", path.c_str(), packets);
+            ok = false;
+            break;
+        }
+        ++packets;
+    }
+    std::fclose(fin);
+
+    // Packet loss concealment takes its own path through the decoder
+    const size_t frame_size = options.sample_rate / 50;
+    for (int i = 0; ok && i < CONCEALED_FRAMES; ++i) {
+        size_t bytes_written = 0;
+        ok = decoder.conceal_loss(out.data(), out.size(), frame_size, bytes_written) ==
+             micro_opus::OPUS_PACKET_DECODER_SUCCESS;
+    }
+
+    high_water = opus_pseudostack_high_water();
+    return ok;
+}
+
+bool parse_options(int argc, char** argv, Options& options) {
+    for (int i = 1; i < argc; ++i) {
+        const bool has_value = i + 1 < argc;
+        if (std::strcmp(argv[i], "--rate") == 0 && has_value) {
+            options.sample_rate = static_cast<uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--channels") == 0 && has_value) {
+            options.channels = static_cast<uint8_t>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--margin") == 0 && has_value) {
+            options.margin_percent = std::atoi(argv[++i]);
+        } else if (argv[i][0] == '-') {
+            return false;
+        } else {
+            options.inputs.push_back(argv[i]);
+        }
+    }
+    const uint32_t rate = options.sample_rate;
+    const bool valid_rate =
+        rate == 8000 || rate == 12000 || rate == 16000 || rate == 24000 || rate == 48000;
+    return valid_rate && (options.channels == 1 || options.channels == 2) &&
+           options.margin_percent >= 0 && !options.inputs.empty();
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    Options options;
+    if (!parse_options(argc, argv, options)) {
+        std::fprintf(stderr,
+                     "Usage: %s [--rate HZ] [--channels 1|2] [--margin PERCENT] "
+                     "<dir | file.bit>...\n",
+                     argv[0]);
+        return 2;
+    }
+
+    const std::vector<std::string> vectors = collect_vectors(options.inputs);
+    if (vectors.empty()) {
+        std::printf("No test vectors found. Run tests/fetch_vectors.sh to download them.\n");
+        return 77;
+    }
+
+    std::printf("Decode-only pseudostack use: %u Hz, %u channel(s), pseudostack %zu bytes\n\n",
+                options.sample_rate, options.channels, opus_pseudostack_size());
+
+    size_t peak = 0;
+    for (const std::string& path : vectors) {
+        size_t packets = 0;
+        size_t high_water = 0;
+        if (!measure_vector(path, options, packets, high_water)) {
+            return 1;
+        }
+        const size_t slash = path.find_last_of('/');
+        std::printf("  %-24s %6zu packets %8zu bytes\n",
+                    path.substr(slash == std::string::npos ? 0 : slash + 1).c_str(), packets,
+                    high_water);
+        peak = std::max(peak, high_water);
+    }
+
+    // Margin on top of the measured peak, rounded up to whole KiB
+    size_t suggested = peak + peak * static_cast<size_t>(options.margin_percent) / 100;
+    suggested = std::max((suggested + 1023) / 1024 * 1024, MIN_PSEUDOSTACK_SIZE);
+
+    std::printf("\nPeak: %zu bytes (%.1f%% of the configured %zu)\n", peak,
+                100.0 * static_cast<double>(peak) / static_cast<double>(opus_pseudostack_size()),
+                opus_pseudostack_size());
+    std::printf("Suggested CONFIG_OPUS_PSEUDOSTACK_SIZE with %d%% margin: %zu\n",
+                options.margin_percent, suggested);
+    return peak <= opus_pseudostack_size() ? 0 : 1;
+}
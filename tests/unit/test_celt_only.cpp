@@ -0,0 +1,255 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// OPUS_STREAM_CELT_ONLY: a restricted-lowdelay stream of 2.5-20 ms packets (with mono-coded
+// packets, multi-frame packets, a DTX frame and lost packets) must decode bit-exactly with the
+// default decoder, at 48 and 16 kHz and with an output gain, through decode(), conceal_loss() and
+// decode_batch(). SILK packets must be rejected without breaking the stream.
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "opus.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t ENCODE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int NUM_PACKETS = 60;
+constexpr size_t MAX_PACKET_SAMPLES = 960;  // 20 ms at 48 kHz
+constexpr int16_t OUTPUT_GAIN = 3 * 256;    // 3 dB in Q7.8
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// One entry of the test stream: a packet, or a loss of the given duration at 48 kHz
+struct StreamEntry {
+    std::vector<uint8_t> packet;
+    int lost_samples;
+};
+
+// Restricted-lowdelay stereo packets cycling through 2.5, 5, 10 and 20 ms, with every seventh
+// packet coded as mono, a four-frame packet, a DTX frame and two losses
+std::vector<StreamEntry> encode_stream() {
+    micro_opus_test::EncoderSettings settings;
+    settings.application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+    settings.max_packet_bytes = 1500;
+    micro_opus_test::ToneEncoder encoder(settings, {{440.0, 9000.0}, {660.0, 7000.0}});
+    if (!encoder.ok()) {
+        return {};
+    }
+
+    const int frame_sizes[] = {120, 240, 480, 960};
+    std::vector<StreamEntry> stream;
+
+    for (int p = 0; p < NUM_PACKETS; ++p) {
+        encoder.ctl(OPUS_SET_FORCE_CHANNELS(p % 7 == 3 ? 1 : OPUS_AUTO));
+        stream.push_back({encoder.encode(frame_sizes[p % 4]), 0});
+    }
+
+    // Four 2.5 ms frames in one code 3 packet
+    encoder.ctl(OPUS_SET_FORCE_CHANNELS(OPUS_AUTO));
+    OpusRepacketizer* repacketizer = opus_repacketizer_create();
+    std::vector<std::vector<uint8_t>> frames;
+    for (int f = 0; f < 4; ++f) {
+        frames.push_back(encoder.encode(120));
+        opus_repacketizer_cat(repacketizer, frames.back().data(),
+                              static_cast<opus_int32>(frames.back().size()));
+    }
+    std::vector<uint8_t> combined(1500 * 4);
+    const opus_int32 combined_bytes = opus_repacketizer_out(
+        repacketizer, combined.data(), static_cast<opus_int32>(combined.size()));
+    opus_repacketizer_destroy(repacketizer);
+    combined.resize(combined_bytes > 0 ? static_cast<size_t>(combined_bytes) : 0);
+    stream.push_back({combined, 0});
+
+    // A DTX frame (TOC byte only, concealed), losses, then more audio
+    stream.push_back({{static_cast<uint8_t>(stream.back().packet[0] & 0xFC)}, 0});
+    stream.push_back({{}, 240});
+    stream.push_back({encoder.encode(480), 0});
+    stream.push_back({{}, 360});
+    stream.push_back({encoder.encode(960), 0});
+    return stream;
+}
+
+// Decode the stream entry by entry; false on the first failure
+bool decode_stream(micro_opus::OpusPacketDecoder& decoder, const std::vector<StreamEntry>& stream,
+                   std::vector<int16_t>& out) {
+    const size_t rate_divisor = ENCODE_RATE / decoder.get_pcm_format().sample_rate();
+    std::vector<int16_t> pcm(decoder.get_pcm_format().max_output_bytes() / sizeof(int16_t));
+    for (const StreamEntry& entry : stream) {
+        size_t bytes_written = 0;
+        micro_opus::OpusPacketResult result;
+        if (entry.packet.empty()) {
+            result = decoder.conceal_loss(reinterpret_cast<uint8_t*>(pcm.data()),
+                                          pcm.size() * sizeof(int16_t),
+                                          static_cast<size_t>(entry.lost_samples) / rate_divisor,
+                                          bytes_written);
+        } else {
+            result = decoder.decode(entry.packet.data(), entry.packet.size(),
+                                    reinterpret_cast<uint8_t*>(pcm.data()),
+                                    pcm.size() * sizeof(int16_t), bytes_written);
+        }
+        if (result != micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+            std::printf("  FAIL: decode returned %d\n", static_cast<int>(result));
+            return false;
+        }
+        out.insert(out.end(), pcm.begin(),
+                   pcm.begin() + static_cast<long>(bytes_written / sizeof(int16_t)));
+    }
+    return true;
+}
+
+void test_bit_exact(const std::vector<StreamEntry>& stream, uint32_t sample_rate, int16_t gain) {
+    std::printf("Test: CELT-only decode matches the default decoder (%u Hz, gain %d)\n",
+                static_cast<unsigned>(sample_rate), static_cast<int>(gain));
+    micro_opus::OpusPacketDecoder reference(sample_rate, CHANNELS);
+    micro_opus::OpusPacketDecoder celt_only(sample_rate, CHANNELS,
+                                            micro_opus::OPUS_STREAM_CELT_ONLY);
+    reference.set_output_gain(gain);
+    celt_only.set_output_gain(gain);
+
+    std::vector<int16_t> expected;
+    std::vector<int16_t> actual;
+    check(decode_stream(reference, stream, expected), "reference decode succeeds");
+    check(decode_stream(celt_only, stream, actual), "CELT-only decode succeeds");
+    check(!expected.empty() && actual == expected, "bit-exact output");
+
+    // After reset() both start over identically, including concealment before any packet
+    reference.reset();
+    celt_only.reset();
+    expected.clear();
+    actual.clear();
+    const std::vector<StreamEntry> restart = {{{}, 480}, stream[1], stream[2]};
+    check(decode_stream(reference, restart, expected) && decode_stream(celt_only, restart, actual),
+          "decode after reset() succeeds");
+    check(actual == expected, "bit-exact after reset()");
+}
+
+void test_batch(const std::vector<StreamEntry>& stream) {
+    std::printf("Test: CELT-only decode_batch()\n");
+    std::vector<micro_opus::OpusPacketSpan> spans;
+    size_t total_samples = 0;
+    for (const StreamEntry& entry : stream) {
+        micro_opus::OpusPacketSpan span;
+        span.data = entry.packet.data();
+        span.length = entry.packet.size();
+        span.lost = entry.packet.empty();
+        spans.push_back(span);
+        total_samples += MAX_PACKET_SAMPLES;
+    }
+
+    std::vector<int16_t> expected(total_samples * CHANNELS);
+    std::vector<int16_t> actual(total_samples * CHANNELS);
+    size_t expected_packets = 0;
+    size_t expected_bytes = 0;
+    size_t actual_packets = 0;
+    size_t actual_bytes = 0;
+    micro_opus::OpusPacketDecoder reference(ENCODE_RATE, CHANNELS);
+    micro_opus::OpusPacketDecoder celt_only(ENCODE_RATE, CHANNELS,
+                                            micro_opus::OPUS_STREAM_CELT_ONLY);
+    check(reference.decode_batch(spans.data(), spans.size(),
+                                 reinterpret_cast<uint8_t*>(expected.data()),
+                                 expected.size() * sizeof(int16_t), expected_packets,
+                                 expected_bytes) == micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+          "reference batch succeeds");
+    check(celt_only.decode_batch(spans.data(), spans.size(),
+                                 reinterpret_cast<uint8_t*>(actual.data()),
+                                 actual.size() * sizeof(int16_t), actual_packets,
+                                 actual_bytes) == micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+          "CELT-only batch succeeds");
+    check(actual_packets == spans.size() && actual_packets == expected_packets,
+          "every packet decoded");
+    check(actual_bytes == expected_bytes && actual == expected, "bit-exact batch output");
+
+    // A packet that does not fit reports its size, as with the default decoder
+    size_t packets_decoded = 0;
+    size_t bytes_written = 0;
+    const micro_opus::OpusPacketSpan last = spans.back();
+    celt_only.reset();
+    check(celt_only.decode_batch(&last, 1, reinterpret_cast<uint8_t*>(actual.data()), 16,
+                                 packets_decoded, bytes_written) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL,
+          "a packet larger than the output is rejected");
+    check(celt_only.get_required_output_bytes() == MAX_PACKET_SAMPLES * CHANNELS * sizeof(int16_t),
+          "required output size reported");
+}
+
+void test_rejects_silk(const std::vector<StreamEntry>& stream) {
+    std::printf("Test: CELT-only decoder rejects SILK packets\n");
+    micro_opus_test::EncoderSettings settings;
+    settings.sample_rate = 16000;
+    settings.channels = 1;
+    settings.application = OPUS_APPLICATION_VOIP;
+    settings.bitrate = 12000;
+    settings.max_packet_bytes = 400;
+    micro_opus_test::ToneEncoder encoder(settings, {{250.0, 4000.0}});
+    const std::vector<uint8_t> silk = encoder.encode(320);
+    check(!silk.empty() && (silk[0] >> 3) < 12, "VOIP encoder produced a SILK packet");
+
+    micro_opus::OpusPacketDecoder celt_only(ENCODE_RATE, CHANNELS,
+                                            micro_opus::OPUS_STREAM_CELT_ONLY);
+    check(celt_only.get_stream_modes() == micro_opus::OPUS_STREAM_CELT_ONLY, "modes reported");
+    std::vector<int16_t> out(MAX_PACKET_SAMPLES * CHANNELS);
+    size_t bytes_written = 1;
+    check(celt_only.decode(silk.data(), silk.size(), reinterpret_cast<uint8_t*>(out.data()),
+                           out.size() * sizeof(int16_t),
+                           bytes_written) == micro_opus::OPUS_PACKET_DECODER_ERROR_DECODE_FAILED,
+          "SILK packet fails to decode");
+    check(bytes_written == 0, "nothing written for the rejected packet");
+    check(celt_only.decode(stream[0].packet.data(), stream[0].packet.size(),
+                           reinterpret_cast<uint8_t*>(out.data()), out.size() * sizeof(int16_t),
+                           bytes_written) == micro_opus::OPUS_PACKET_DECODER_SUCCESS &&
+              bytes_written > 0,
+          "CELT packets still decode afterwards");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("CELT-only decoder test\n");
+
+    const std::vector<StreamEntry> stream = encode_stream();
+    bool encoded = stream.size() == NUM_PACKETS + 6;
+    for (const StreamEntry& entry : stream) {
+        encoded = encoded && (!entry.packet.empty() || entry.lost_samples > 0);
+    }
+    check(encoded, "encoded the test stream");
+    if (!encoded) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    test_bit_exact(stream, 48000, 0);
+    test_bit_exact(stream, 16000, 0);
+    test_bit_exact(stream, 48000, OUTPUT_GAIN);
+    test_batch(stream);
+    test_rejects_silk(stream);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
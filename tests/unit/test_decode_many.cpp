@@ -0,0 +1,241 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// OggOpusDecoder::decode_many(): a stream of 2.5 ms CELT packets decoded several packets per call
+// must match decode() exactly, whether the input arrives whole or in chunks, the output holds a
+// few packets, max_packets caps the batch, or the output is too small for even one packet. A
+// packet that does not fit is held for the next call, never lost.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 120;  // 2.5 ms @ 48 kHz, per channel
+constexpr uint16_t PRE_SKIP = 312;
+constexpr int NUM_PACKETS = 200;  // 0.5 s of audio
+constexpr uint32_t SERIAL = 0xD0D0;
+constexpr size_t FRAME_BYTES = static_cast<size_t>(FRAME_SAMPLES) * CHANNELS * sizeof(int16_t);
+constexpr size_t MAX_PACKETS_PER_CALL = 512;
+constexpr size_t MAX_ITERATIONS = 100000;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode NUM_PACKETS 2.5 ms stereo frames, one per page
+std::vector<uint8_t> make_test_stream() {
+    micro_opus_test::EncoderSettings settings;
+    settings.application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+    settings.bitrate = 128000;
+    const auto packets = micro_opus_test::encode_tone_packets(
+        settings, {{440.0, 8000.0}, {550.0, 6000.0}}, NUM_PACKETS, {FRAME_SAMPLES});
+    if (packets.empty()) {
+        return {};
+    }
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family0(CHANNELS, PRE_SKIP), packets, SERIAL);
+}
+
+// Reference: one packet per decode() call
+bool decode_single(const std::vector<uint8_t>& stream, std::vector<int16_t>& out) {
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + static_cast<long>(samples * CHANNELS));
+    }
+    return true;
+}
+
+struct BatchStats {
+    size_t calls{0};
+    size_t packets{0};
+    size_t max_packets_per_call{0};
+    size_t too_small{0};
+    bool boundaries_consistent{true};
+};
+
+// decode_many() over input_chunk-byte chunks into an output_bytes buffer, until the input is used
+// up and no packet is held. After OUTPUT_BUFFER_TOO_SMALL, the held packet is fetched with
+// decode() into a full-size buffer.
+bool decode_batched(const std::vector<uint8_t>& stream, size_t input_chunk, size_t output_bytes,
+                    size_t max_packets, std::vector<int16_t>& out, BatchStats& stats) {
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(std::max<size_t>(output_bytes / sizeof(int16_t), 1));
+    std::vector<int16_t> retry_pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    std::vector<size_t> packet_samples(MAX_PACKETS_PER_CALL);
+    size_t pos = 0;
+
+    for (size_t i = 0; i < MAX_ITERATIONS; ++i) {
+        const size_t len = std::min(input_chunk, stream.size() - pos);
+        size_t consumed = 0;
+        size_t samples = 0;
+        size_t packets = 0;
+        micro_opus::OggOpusResult result = decoder.decode_many(
+            stream.data() + pos, len, reinterpret_cast<uint8_t*>(pcm.data()), output_bytes,
+            consumed, samples, packets, packet_samples.data(),
+            (max_packets == 0) ? packet_samples.size() : max_packets);
+        pos += consumed;
+        ++stats.calls;
+
+        if (result == micro_opus::OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL) {
+            ++stats.too_small;
+            size_t retry_consumed = 0;
+            result = decoder.decode(stream.data() + pos, stream.size() - pos,
+                                    reinterpret_cast<uint8_t*>(retry_pcm.data()),
+                                    retry_pcm.size() * sizeof(int16_t), retry_consumed, samples);
+            if (result != micro_opus::OGG_OPUS_OK || retry_consumed != 0) {
+                std::printf("  FAIL: held packet retry (%d)\n", static_cast<int>(result));
+                return false;
+            }
+            out.insert(out.end(), retry_pcm.begin(),
+                       retry_pcm.begin() + static_cast<long>(samples * CHANNELS));
+            continue;
+        }
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: decode_many error %d\n", static_cast<int>(result));
+            return false;
+        }
+
+        size_t boundary_sum = 0;
+        for (size_t p = 0; p < packets; ++p) {
+            boundary_sum += packet_samples[p];
+        }
+        stats.boundaries_consistent = stats.boundaries_consistent && (boundary_sum == samples);
+        stats.packets += packets;
+        stats.max_packets_per_call = std::max(stats.max_packets_per_call, packets);
+        out.insert(out.end(), pcm.begin(), pcm.begin() + static_cast<long>(samples * CHANNELS));
+
+        // Done once the input is used up and no held packet remains
+        if (pos == stream.size() && packets == 0) {
+            return true;
+        }
+    }
+    std::printf("  FAIL: batched decode did not finish\n");
+    return false;
+}
+
+void test_whole_stream(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: whole stream, output for every packet\n");
+    std::vector<int16_t> out;
+    BatchStats stats;
+    check(decode_batched(stream, stream.size(), FRAME_BYTES * NUM_PACKETS, 0, out, stats),
+          "batched decode completes");
+    check(out == expected, "PCM identical to one packet per decode()");
+    check(stats.packets == static_cast<size_t>(NUM_PACKETS), "every packet reported");
+    check(stats.max_packets_per_call == static_cast<size_t>(NUM_PACKETS),
+          "every packet decoded in one call");
+    check(stats.boundaries_consistent, "packet_samples add up to samples_decoded");
+}
+
+void test_partial_output(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: output for 3.5 packets, input in 500-byte chunks\n");
+    std::vector<int16_t> out;
+    BatchStats stats;
+    check(decode_batched(stream, 500, FRAME_BYTES * 7 / 2, 0, out, stats),
+          "batched decode completes");
+    check(out == expected, "PCM identical (held packets are not lost)");
+    check(stats.packets == static_cast<size_t>(NUM_PACKETS), "every packet reported");
+    check(stats.max_packets_per_call == 3, "at most three packets per call");
+    check(stats.too_small == 0, "never too small for the first packet");
+    check(stats.boundaries_consistent, "packet_samples add up to samples_decoded");
+}
+
+void test_max_packets(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: max_packets caps each call\n");
+    std::vector<int16_t> out;
+    BatchStats stats;
+    check(decode_batched(stream, stream.size(), FRAME_BYTES * NUM_PACKETS, 2, out, stats),
+          "batched decode completes");
+    check(out == expected, "PCM identical to one packet per decode()");
+    check(stats.max_packets_per_call == 2, "at most two packets per call");
+    check(stats.boundaries_consistent, "packet_samples add up to samples_decoded");
+}
+
+void test_too_small(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: output below one packet holds the packet for decode()\n");
+    std::vector<int16_t> out;
+    BatchStats stats;
+    check(decode_batched(stream, stream.size(), FRAME_BYTES / 2, 0, out, stats),
+          "batched decode completes");
+    check(out == expected, "PCM identical to one packet per decode()");
+    check(stats.too_small == static_cast<size_t>(NUM_PACKETS), "every packet reported too small");
+}
+
+void test_invalid_arguments(const std::vector<uint8_t>& stream) {
+    std::printf("Test: packet_samples without max_packets\n");
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    size_t packet_samples[4];
+    size_t consumed = 1;
+    size_t samples = 1;
+    size_t packets = 1;
+    check(decoder.decode_many(stream.data(), stream.size(), reinterpret_cast<uint8_t*>(pcm.data()),
+                              pcm.size() * sizeof(int16_t), consumed, samples, packets,
+                              packet_samples, 0) == micro_opus::OGG_OPUS_INPUT_INVALID,
+          "INPUT_INVALID");
+    check(consumed == 0 && samples == 0 && packets == 0, "outputs cleared");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("OggOpusDecoder decode_many() test\n");
+
+    const std::vector<uint8_t> stream = make_test_stream();
+    check(!stream.empty(), "built a non-empty Ogg stream");
+    if (stream.empty()) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    std::vector<int16_t> expected;
+    check(decode_single(stream, expected), "reference decode completes");
+    check(!expected.empty(), "reference decode produced audio");
+
+    test_whole_stream(stream, expected);
+    test_partial_output(stream, expected);
+    test_max_packets(stream, expected);
+    test_too_small(stream, expected);
+    test_invalid_arguments(stream);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
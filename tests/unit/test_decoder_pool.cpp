@@ -0,0 +1,193 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// DecoderPool: states go back to the pool when a decoder is destroyed or reset, come out again
+// for the same format only, stay within capacity, and decode exactly like freshly created states
+// (no history or gain carried over from the previous stream). Covers OpusPacketDecoder and both
+// OggOpusDecoder backends (mono/stereo and multistream).
+
+#include "micro_opus/decoder_pool.h"
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/opus_packet_decoder.h"
+#include "opus.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz, per channel
+constexpr int NUM_PACKETS = 15;
+constexpr uint32_t SERIAL = 0xB00C;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Decode raw packets with the given decoder and return the concatenated PCM
+std::vector<int16_t> decode_packets(micro_opus::OpusPacketDecoder& decoder,
+                                    const std::vector<std::vector<uint8_t>>& packets) {
+    std::vector<int16_t> out(decoder.get_pcm_format().max_output_bytes() / sizeof(int16_t));
+    std::vector<int16_t> pcm;
+    for (const auto& packet : packets) {
+        size_t bytes_written = 0;
+        auto result = decoder.decode(packet.data(), packet.size(),
+                                     reinterpret_cast<uint8_t*>(out.data()),
+                                     out.size() * sizeof(int16_t), bytes_written);
+        check(result == micro_opus::OPUS_PACKET_DECODER_SUCCESS, "packet decodes");
+        pcm.insert(pcm.end(), out.begin(),
+                   out.begin() + static_cast<std::ptrdiff_t>(bytes_written / sizeof(int16_t)));
+    }
+    return pcm;
+}
+
+// Decode a whole Ogg stream with the given decoder and return the PCM
+std::vector<int16_t> decode_ogg(micro_opus::OggOpusDecoder& decoder,
+                                const std::vector<uint8_t>& stream) {
+    std::vector<int16_t> out(static_cast<size_t>(FRAME_SAMPLES) * 6 * 8);
+    std::vector<int16_t> pcm;
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        auto result = decoder.decode(stream.data() + pos, stream.size() - pos,
+                                     reinterpret_cast<uint8_t*>(out.data()),
+                                     out.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            check(false, "Ogg stream decodes");
+            break;
+        }
+        pos += consumed;
+        pcm.insert(pcm.end(), out.begin(),
+                   out.begin() + static_cast<std::ptrdiff_t>(samples * decoder.get_channels()));
+        if (consumed == 0 && samples == 0) {
+            break;
+        }
+    }
+    return pcm;
+}
+
+// Same stream through a decoder with no pool, for comparison
+std::vector<int16_t> decode_ogg_fresh(const std::vector<uint8_t>& stream) {
+    micro_opus::OggOpusDecoder decoder;
+    return decode_ogg(decoder, stream);
+}
+
+}  // namespace
+
+int main() {
+    std::printf("DecoderPool test\n");
+
+    const micro_opus_test::EncoderSettings settings;
+    const auto packets_a = micro_opus_test::encode_tone_packets(
+        settings, {{440.0, 12000.0}, {440.0, 12000.0}}, NUM_PACKETS, {FRAME_SAMPLES});
+    const auto packets_b = micro_opus_test::encode_tone_packets(
+        settings, {{1000.0, 12000.0}, {1000.0, 12000.0}}, NUM_PACKETS, {FRAME_SAMPLES});
+    if (packets_a.empty() || packets_b.empty()) {
+        return 1;
+    }
+
+    // --- OpusPacketDecoder takes a preloaded state and returns it on destruction ---
+    {
+        micro_opus::DecoderPool pool(2);
+        check(pool.capacity() == 2, "capacity as constructed");
+        check(pool.preload(SAMPLE_RATE, 2), "preload 48 kHz stereo");
+        check(pool.idle_count() == 1, "preloaded state is idle");
+        {
+            micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, 2);
+            decoder.set_decoder_pool(&pool);
+            decode_packets(decoder, packets_a);
+            check(pool.idle_count() == 0, "decoder took the preloaded state");
+        }
+        check(pool.idle_count() == 1, "destroyed decoder returned its state");
+
+        // --- A different format does not take it ---
+        {
+            micro_opus::OpusPacketDecoder decoder(16000, 1);
+            decoder.set_decoder_pool(&pool);
+            decode_packets(decoder, packets_a);
+            check(pool.idle_count() == 1, "16 kHz mono left the 48 kHz stereo state alone");
+        }
+        check(pool.idle_count() == 2, "16 kHz mono state joined the pool");
+
+        // --- Capacity bounds the idle set ---
+        {
+            micro_opus::OpusPacketDecoder decoder(8000, 1);
+            decoder.set_decoder_pool(&pool);
+            decode_packets(decoder, packets_a);
+        }
+        check(pool.idle_count() == 2, "full pool evicted a state");
+
+        pool.clear();
+        check(pool.idle_count() == 0, "clear() empties the pool");
+    }
+
+    // --- A reused state carries no history or gain from the previous stream ---
+    {
+        micro_opus::DecoderPool pool(1);
+        {
+            micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, 2);
+            decoder.set_decoder_pool(&pool);
+            decoder.set_output_gain(6 * 256);  // +6 dB
+            decode_packets(decoder, packets_a);
+        }
+        micro_opus::OpusPacketDecoder pooled(SAMPLE_RATE, 2);
+        pooled.set_decoder_pool(&pool);
+        const auto reused = decode_packets(pooled, packets_b);
+        check(pool.idle_count() == 0, "second decoder reused the state");
+
+        micro_opus::OpusPacketDecoder fresh(SAMPLE_RATE, 2);
+        check(reused == decode_packets(fresh, packets_b), "reused state decodes like a new one");
+    }
+
+    // --- OggOpusDecoder returns its state on reset(), for both backends ---
+    {
+        const auto stereo_stream = micro_opus_test::build_ogg_stream(
+            micro_opus_test::make_opus_head_family0(2), packets_a, SERIAL);
+        // Three output channels (L, R, silent) from one coupled stream: the multistream backend
+        const auto multistream_stream = micro_opus_test::build_ogg_stream(
+            micro_opus_test::make_opus_head_family1(3, 1, 1, {0, 1, 255}), packets_b, SERIAL);
+        const auto stereo_reference = decode_ogg_fresh(stereo_stream);
+        const auto multistream_reference = decode_ogg_fresh(multistream_stream);
+        check(!stereo_reference.empty() && !multistream_reference.empty(), "reference decodes");
+
+        micro_opus::DecoderPool pool(2);
+        micro_opus::OggOpusDecoder decoder;
+        decoder.set_decoder_pool(&pool);
+        for (int round = 0; round < 2; ++round) {
+            check(decode_ogg(decoder, stereo_stream) == stereo_reference,
+                  "pooled stereo stream matches");
+            decoder.reset();
+            check(decode_ogg(decoder, multistream_stream) == multistream_reference,
+                  "pooled multistream stream matches");
+            decoder.reset();
+            check(pool.idle_count() == 2, "both states back in the pool after reset");
+        }
+    }
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
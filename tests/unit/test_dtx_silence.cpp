@@ -0,0 +1,234 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Silence fast path: a DTX voice stream (tone, a long pause, tone) decoded with
+// OPUS_SILENCE_ZERO_FILL and OPUS_SILENCE_REPORT must match the normal decode up to the pause,
+// then skip libopus for the silent packets after the first 20 ms, and keep every packet's
+// duration. OggOpusDecoder::set_skip_silence() must keep the stream's sample count unchanged.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/opus_packet_decoder.h"
+#include "micro_opus/opus_packet_info.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 1;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz
+constexpr size_t FRAME_BYTES = static_cast<size_t>(FRAME_SAMPLES) * CHANNELS * sizeof(int16_t);
+constexpr int TONE_PACKETS = 25;
+constexpr int PAUSE_PACKETS = 60;
+constexpr uint32_t SERIAL = 0xD7D7;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode tone, pause, tone with DTX on; silent[i] receives whether packet i parses as silent
+std::vector<std::vector<uint8_t>> encode_dtx_stream(std::vector<bool>& silent) {
+    micro_opus_test::EncoderSettings settings;
+    settings.channels = CHANNELS;
+    settings.application = OPUS_APPLICATION_VOIP;
+    settings.bitrate = 16000;
+    micro_opus_test::ToneEncoder encoder(settings, {{330.0, 9000.0}});
+    encoder.ctl(OPUS_SET_DTX(1));
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (int p = 0; p < 2 * TONE_PACKETS + PAUSE_PACKETS; ++p) {
+        const bool pause = p >= TONE_PACKETS && p < TONE_PACKETS + PAUSE_PACKETS;
+        encoder.tones[0].amplitude = pause ? 0.0 : 9000.0;
+        std::vector<uint8_t> packet = encoder.encode(FRAME_SAMPLES);
+        if (packet.empty()) {
+            break;
+        }
+
+        micro_opus::OpusPacketInfo info;
+        silent.push_back(micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                             micro_opus::OPUS_PACKET_INFO_OK &&
+                         info.is_silent());
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+bool all_zero(const std::vector<int16_t>& pcm, size_t samples) {
+    for (size_t i = 0; i < samples; ++i) {
+        if (pcm[i] != 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_packet_decoder(const std::vector<std::vector<uint8_t>>& packets,
+                         const std::vector<bool>& silent) {
+    std::printf("Test: OpusPacketDecoder zero-fill and report modes\n");
+    micro_opus::OpusPacketDecoder reference(SAMPLE_RATE, CHANNELS);
+    micro_opus::OpusPacketDecoder zero_fill(SAMPLE_RATE, CHANNELS);
+    micro_opus::OpusPacketDecoder report(SAMPLE_RATE, CHANNELS);
+    zero_fill.set_silence_mode(micro_opus::OPUS_SILENCE_ZERO_FILL);
+    report.set_silence_mode(micro_opus::OPUS_SILENCE_REPORT);
+
+    std::vector<int16_t> expected(FRAME_SAMPLES);
+    std::vector<int16_t> filled(FRAME_SAMPLES);
+    std::vector<int16_t> reported(FRAME_SAMPLES);
+    bool skipping_seen = false;
+    bool identical_before_skip = true;
+    bool report_matches = true;
+    bool durations_kept = true;
+    bool silence_flagged = true;
+    int skipped = 0;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        const auto& packet = packets[i];
+        auto decode = [&packet](micro_opus::OpusPacketDecoder& decoder, std::vector<int16_t>& pcm,
+                                size_t& bytes) {
+            return decoder.decode(packet.data(), packet.size(),
+                                  reinterpret_cast<uint8_t*>(pcm.data()), FRAME_BYTES, bytes);
+        };
+        size_t expected_bytes = 0;
+        size_t filled_bytes = 0;
+        size_t reported_bytes = 0;
+        check(decode(reference, expected, expected_bytes) ==
+                      micro_opus::OPUS_PACKET_DECODER_SUCCESS &&
+                  decode(zero_fill, filled, filled_bytes) ==
+                      micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+              "reference and zero-fill decodes succeed");
+        const micro_opus::OpusPacketResult report_result = decode(report, reported, reported_bytes);
+        check(report_result >= 0, "report decode succeeds");
+
+        durations_kept = durations_kept && filled_bytes == expected_bytes;
+        silence_flagged = silence_flagged && zero_fill.is_last_packet_silent() == silent[i];
+
+        if (report_result == micro_opus::OPUS_PACKET_DECODER_SILENCE) {
+            // Skipped: report gives the duration only, zero-fill gives zeros for it
+            ++skipped;
+            skipping_seen = true;
+            check(silent[i], "only silent packets are skipped");
+            check(reported_bytes == 0, "report mode writes nothing");
+            durations_kept = durations_kept &&
+                             report.get_silent_samples() * CHANNELS * sizeof(int16_t) ==
+                                 expected_bytes;
+            report_matches = report_matches && all_zero(filled, filled_bytes / sizeof(int16_t));
+        } else {
+            report_matches = report_matches && reported_bytes == filled_bytes && reported == filled;
+        }
+        if (!skipping_seen) {
+            identical_before_skip = identical_before_skip && filled == expected;
+        }
+    }
+
+    int silent_packets = 0;
+    for (bool s : silent) {
+        silent_packets += s ? 1 : 0;
+    }
+    std::printf("  %d of %zu packets silent, %d skipped\n", silent_packets, packets.size(),
+                skipped);
+    check(silent_packets >= PAUSE_PACKETS / 2, "the DTX encoder produced silent packets");
+    check(skipped > 0 && skipped < silent_packets, "skipping starts after the first 20 ms");
+    check(identical_before_skip, "bit-exact with the normal decode until skipping starts");
+    check(report_matches, "report mode matches zero-fill apart from the skipped packets");
+    check(durations_kept, "every packet keeps its duration");
+    check(silence_flagged, "is_last_packet_silent() follows the packets");
+
+    // A skipped packet in report mode needs no output space
+    report.reset();
+    size_t bytes_written = 0;
+    const uint8_t dtx[] = {packets[0][0]};
+    for (int i = 0; i < 3; ++i) {
+        report.decode(dtx, sizeof(dtx), reinterpret_cast<uint8_t*>(reported.data()), FRAME_BYTES,
+                      bytes_written);
+    }
+    check(report.decode(dtx, sizeof(dtx), reinterpret_cast<uint8_t*>(reported.data()), 2,
+                        bytes_written) == micro_opus::OPUS_PACKET_DECODER_SILENCE,
+          "report mode ignores the output size for skipped packets");
+}
+
+void test_ogg_decoder(const std::vector<std::vector<uint8_t>>& packets) {
+    std::printf("Test: OggOpusDecoder::set_skip_silence()\n");
+    const std::vector<uint8_t> stream = micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family0(CHANNELS), packets, SERIAL);
+
+    size_t totals[2] = {0, 0};
+    int silent_reports = 0;
+    for (int skip = 0; skip < 2; ++skip) {
+        micro_opus::OggOpusDecoder decoder;
+        decoder.set_skip_silence(skip == 1);
+        std::vector<int16_t> pcm(FRAME_SAMPLES);
+        bool previous_silent = false;
+        size_t pos = 0;
+        while (pos < stream.size()) {
+            size_t consumed = 0;
+            size_t samples = 0;
+            const micro_opus::OggOpusResult result =
+                decoder.decode(stream.data() + pos, stream.size() - pos,
+                               reinterpret_cast<uint8_t*>(pcm.data()), FRAME_BYTES, consumed,
+                               samples);
+            if (result != micro_opus::OGG_OPUS_OK) {
+                check(false, "Ogg decode succeeds");
+                break;
+            }
+            pos += consumed;
+            totals[skip] += samples;
+            if (samples == 0) {
+                continue;
+            }
+            const bool packet_silent = decoder.is_last_packet_silent();
+            if (packet_silent) {
+                // With 20 ms packets, every silent packet after the first of a run is skipped
+                ++silent_reports;
+                check(skip == 1, "silence only tracked with set_skip_silence()");
+                check(!previous_silent || all_zero(pcm, samples * CHANNELS),
+                      "skipped packets decode to zeros");
+            }
+            previous_silent = packet_silent;
+        }
+    }
+    check(totals[0] > 0 && totals[0] == totals[1], "same sample count with and without skipping");
+    check(silent_reports > 0, "silent packets reported");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("DTX and silence fast path test\n");
+
+    std::vector<bool> silent;
+    const auto packets = encode_dtx_stream(silent);
+    check(packets.size() == 2 * TONE_PACKETS + PAUSE_PACKETS, "encoded every packet");
+    if (packets.empty()) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    test_packet_decoder(packets, silent);
+    test_ogg_decoder(packets);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,208 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// OpusPacketDecoderT: the compile-time sizes must match the runtime PcmFormat, and
+// decode_frames() / conceal_frames() must produce the same PCM as OpusPacketDecoder's byte API for
+// 48 kHz stereo, 16 kHz mono and CELT-only configurations, reporting sizes in samples per channel.
+// A fixed-format build (OPUS_FIXED_SAMPLE_RATE/OPUS_FIXED_CHANNELS) checks its one format instead,
+// and that decoders of any other format are refused.
+
+#include "micro_opus/opus_packet_decoder_t.h"
+#include "micro_opus/opus_packet_info.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr int NUM_PACKETS = 24;
+constexpr int LOST_PACKET = 9;  // Concealed instead of decoded
+
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+using BuildFormat =
+    micro_opus::OpusPacketDecoderT<MICRO_OPUS_FIXED_SAMPLE_RATE, MICRO_OPUS_FIXED_CHANNELS>;
+using CeltBuildFormat =
+    micro_opus::OpusPacketDecoderT<MICRO_OPUS_FIXED_SAMPLE_RATE, MICRO_OPUS_FIXED_CHANNELS,
+                                   micro_opus::OPUS_STREAM_CELT_ONLY>;
+
+static_assert(BuildFormat::BYTES_PER_FRAME == MICRO_OPUS_FIXED_CHANNELS * 2, "frame size");
+static_assert(sizeof(BuildFormat::PcmBuffer) == BuildFormat::MAX_OUTPUT_BYTES, "holds 120 ms");
+#else
+using Stereo48k = micro_opus::OpusPacketDecoderT<48000, 2>;
+using Mono16k = micro_opus::OpusPacketDecoderT<16000, 1>;
+using CeltStereo24k = micro_opus::OpusPacketDecoderT<24000, 2, micro_opus::OPUS_STREAM_CELT_ONLY>;
+
+static_assert(Stereo48k::BYTES_PER_FRAME == 4, "stereo frame is 4 bytes");
+static_assert(Stereo48k::MAX_PACKET_FRAMES == 5760, "120 ms at 48 kHz");
+static_assert(Mono16k::MAX_OUTPUT_SAMPLES == 1920, "120 ms of mono at 16 kHz");
+static_assert(sizeof(Mono16k::PcmBuffer) == Mono16k::MAX_OUTPUT_BYTES, "buffer holds 120 ms");
+#endif
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Stereo packets of 10, 20 and 40 ms (CELT-only streams use restricted low delay)
+std::vector<std::vector<uint8_t>> encode_stream(int application) {
+    micro_opus_test::EncoderSettings settings;
+    settings.application = application;
+    settings.bitrate = 64000;
+    return micro_opus_test::encode_tone_packets(settings, {{330.0, 8000.0}, {550.0, 6000.0}},
+                                                NUM_PACKETS, {480, 960, 1920});
+}
+
+template <typename FixedDecoder>
+void test_matches_runtime(const std::vector<std::vector<uint8_t>>& packets, const char* name) {
+    std::printf("Test: %s matches OpusPacketDecoder\n", name);
+    FixedDecoder fixed;
+    micro_opus::OpusPacketDecoder reference(FixedDecoder::SAMPLE_RATE, FixedDecoder::CHANNELS,
+                                            fixed.get_stream_modes());
+
+    const micro_opus::PcmFormat& format = fixed.get_pcm_format();
+    check(format.sample_rate() == FixedDecoder::SAMPLE_RATE &&
+              format.num_channels() == FixedDecoder::CHANNELS,
+          "runtime format matches the template arguments");
+    check(format.max_output_bytes() == FixedDecoder::MAX_OUTPUT_BYTES,
+          "MAX_OUTPUT_BYTES matches max_output_bytes()");
+
+    typename FixedDecoder::PcmBuffer actual{};
+    std::vector<int16_t> expected(FixedDecoder::MAX_OUTPUT_SAMPLES);
+    const size_t expected_capacity = expected.size() * sizeof(int16_t);
+    size_t last_frames = 0;
+    bool all_match = true;
+    for (int p = 0; p < NUM_PACKETS; ++p) {
+        const std::vector<uint8_t>& packet = packets[static_cast<size_t>(p)];
+        size_t frames = 0;
+        size_t bytes_written = 0;
+        micro_opus::OpusPacketResult fixed_result;
+        micro_opus::OpusPacketResult reference_result;
+        if (p == LOST_PACKET) {
+            fixed_result = fixed.conceal_frames(actual.data(), FixedDecoder::MAX_PACKET_FRAMES,
+                                                last_frames, frames);
+            reference_result =
+                reference.conceal_loss(reinterpret_cast<uint8_t*>(expected.data()),
+                                       expected_capacity, last_frames, bytes_written);
+        } else if (p % 2 == 0) {
+            fixed_result = fixed.decode_frames(packet.data(), packet.size(), actual.data(),
+                                               FixedDecoder::MAX_PACKET_FRAMES, frames);
+            reference_result = reference.decode(packet.data(), packet.size(),
+                                                reinterpret_cast<uint8_t*>(expected.data()),
+                                                expected_capacity, bytes_written);
+        } else {
+            micro_opus::OpusPacketInfo info;
+            check(micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                      micro_opus::OPUS_PACKET_INFO_OK,
+                  "packet parses");
+            fixed_result = fixed.decode_frames(info, actual.data(),
+                                               FixedDecoder::MAX_PACKET_FRAMES, frames);
+            reference_result = reference.decode(info, reinterpret_cast<uint8_t*>(expected.data()),
+                                                expected_capacity, bytes_written);
+        }
+        if (fixed_result != micro_opus::OPUS_PACKET_DECODER_SUCCESS ||
+            reference_result != micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+            std::printf("  FAIL: packet %d returned %d (reference %d)\n", p,
+                        static_cast<int>(fixed_result), static_cast<int>(reference_result));
+            ++g_failures;
+            return;
+        }
+        all_match = all_match && frames > 0 &&
+                    frames * FixedDecoder::BYTES_PER_FRAME == bytes_written &&
+                    std::equal(expected.begin(),
+                               expected.begin() + static_cast<long>(bytes_written / 2),
+                               actual.begin());
+        last_frames = frames;
+    }
+    check(all_match, "same samples and frame counts for every packet");
+
+    // A buffer too small for the packet reports the error and no frames
+    size_t frames = 1;
+    check(fixed.decode_frames(packets[2].data(), packets[2].size(), actual.data(), 8, frames) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL,
+          "short buffer rejected");
+    check(frames == 0, "no frames reported for the rejected packet");
+    check(fixed.get_required_output_bytes() ==
+              FixedDecoder::SAMPLE_RATE / 25 * FixedDecoder::BYTES_PER_FRAME,
+          "required size of the 40 ms packet reported in bytes");
+}
+
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+// Every other output format must fail to initialize
+void test_other_formats_refused(const std::vector<uint8_t>& packet) {
+    std::printf("Test: formats other than the build's are refused\n");
+    const uint32_t other_rate = (MICRO_OPUS_FIXED_SAMPLE_RATE == 48000) ? 16000 : 48000;
+    const uint8_t other_channels = (MICRO_OPUS_FIXED_CHANNELS == 2) ? 1 : 2;
+    const struct {
+        uint32_t sample_rate;
+        uint8_t channels;
+        micro_opus::OpusStreamModes modes;
+    } formats[] = {
+        {other_rate, MICRO_OPUS_FIXED_CHANNELS, micro_opus::OPUS_STREAM_ANY_MODE},
+        {MICRO_OPUS_FIXED_SAMPLE_RATE, other_channels, micro_opus::OPUS_STREAM_ANY_MODE},
+        {MICRO_OPUS_FIXED_SAMPLE_RATE, other_channels, micro_opus::OPUS_STREAM_CELT_ONLY},
+    };
+    std::vector<uint8_t> pcm(2 * 5760 * sizeof(int16_t));
+    for (const auto& format : formats) {
+        micro_opus::OpusPacketDecoder decoder(format.sample_rate, format.channels, format.modes);
+        size_t bytes_written = 1;
+        check(decoder.decode(packet.data(), packet.size(), pcm.data(), pcm.size(),
+                             bytes_written) == micro_opus::OPUS_PACKET_DECODER_ERROR_INPUT_INVALID,
+              "other format rejected as INPUT_INVALID");
+        check(bytes_written == 0, "nothing written for the other format");
+    }
+}
+#endif
+
+}  // namespace
+
+int main() {
+    std::printf("Fixed-format decoder test\n");
+
+    const std::vector<std::vector<uint8_t>> audio = encode_stream(OPUS_APPLICATION_AUDIO);
+    const std::vector<std::vector<uint8_t>> lowdelay =
+        encode_stream(OPUS_APPLICATION_RESTRICTED_LOWDELAY);
+    bool encoded = audio.size() == NUM_PACKETS && lowdelay.size() == NUM_PACKETS;
+    for (size_t p = 0; encoded && p < NUM_PACKETS; ++p) {
+        encoded = !audio[p].empty() && !lowdelay[p].empty();
+    }
+    check(encoded, "encoded the test streams");
+    if (!encoded) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+#ifdef MICRO_OPUS_FIXED_SAMPLE_RATE
+    test_matches_runtime<BuildFormat>(audio, "OpusPacketDecoderT<fixed format>");
+    test_matches_runtime<CeltBuildFormat>(lowdelay, "OpusPacketDecoderT<fixed format, CELT_ONLY>");
+    test_other_formats_refused(audio[0]);
+#else
+    test_matches_runtime<Stereo48k>(audio, "OpusPacketDecoderT<48000, 2>");
+    test_matches_runtime<Mono16k>(audio, "OpusPacketDecoderT<16000, 1>");
+    test_matches_runtime<CeltStereo24k>(lowdelay, "OpusPacketDecoderT<24000, 2, CELT_ONLY>");
+#endif
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,237 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// OpusPacketDecoder::decode_batch(): a burst of mixed 10/20 ms packets with lost entries must
+// decode to exactly what decode() and conceal_loss() produce one packet at a time, in one call or
+// resubmitted in pieces when the output fills up. Also covers the per-packet sample counts, the
+// concealment duration before any packet, and the error paths.
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int NUM_PACKETS = 30;
+constexpr size_t MAX_FRAME_SAMPLES = 960;  // 20 ms at 48 kHz
+constexpr size_t LOST[] = {5, 6, 17};
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+bool is_lost(size_t index) {
+    for (size_t lost : LOST) {
+        if (lost == index) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Encode NUM_PACKETS stereo packets alternating 10 and 20 ms
+std::vector<std::vector<uint8_t>> encode_packets() {
+    return micro_opus_test::encode_tone_packets(micro_opus_test::EncoderSettings{},
+                                                {{440.0, 12000.0}, {440.0, 6000.0}}, NUM_PACKETS,
+                                                {480, 960});
+}
+
+std::vector<micro_opus::OpusPacketSpan> make_spans(
+    const std::vector<std::vector<uint8_t>>& packets) {
+    std::vector<micro_opus::OpusPacketSpan> spans(packets.size());
+    for (size_t i = 0; i < packets.size(); ++i) {
+        spans[i].data = packets[i].data();
+        spans[i].length = packets[i].size();
+        spans[i].lost = is_lost(i);
+    }
+    return spans;
+}
+
+// Reference: decode() per packet, conceal_loss() with the previous packet's duration when lost
+bool decode_one_by_one(const std::vector<std::vector<uint8_t>>& packets, std::vector<int16_t>& out,
+                       std::vector<size_t>& packet_samples) {
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    size_t previous_samples = MAX_FRAME_SAMPLES;
+    for (size_t i = 0; i < packets.size(); ++i) {
+        size_t bytes_written = 0;
+        micro_opus::OpusPacketResult result =
+            is_lost(i) ? decoder.conceal_loss(reinterpret_cast<uint8_t*>(pcm.data()),
+                                              pcm.size() * sizeof(int16_t), previous_samples,
+                                              bytes_written)
+                       : decoder.decode(packets[i].data(), packets[i].size(),
+                                        reinterpret_cast<uint8_t*>(pcm.data()),
+                                        pcm.size() * sizeof(int16_t), bytes_written);
+        if (result != micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+            std::printf("  FAIL: reference decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        const size_t values = bytes_written / sizeof(int16_t);
+        previous_samples = values / CHANNELS;
+        packet_samples.push_back(previous_samples);
+        out.insert(out.end(), pcm.begin(), pcm.begin() + static_cast<long>(values));
+    }
+    return true;
+}
+
+// decode_batch() into an output_bytes buffer, resubmitting the rest after each call
+bool decode_batched(const std::vector<micro_opus::OpusPacketSpan>& spans, size_t output_bytes,
+                    std::vector<int16_t>& out, std::vector<size_t>& packet_samples,
+                    size_t& calls) {
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<int16_t> pcm(output_bytes / sizeof(int16_t));
+    std::vector<size_t> batch_samples(spans.size());
+    size_t next = 0;
+    calls = 0;
+    while (next < spans.size()) {
+        size_t packets_decoded = 0;
+        size_t bytes_written = 0;
+        micro_opus::OpusPacketResult result = decoder.decode_batch(
+            spans.data() + next, spans.size() - next, reinterpret_cast<uint8_t*>(pcm.data()),
+            output_bytes, packets_decoded, bytes_written, batch_samples.data());
+        ++calls;
+        if (result != micro_opus::OPUS_PACKET_DECODER_SUCCESS || packets_decoded == 0) {
+            std::printf("  FAIL: decode_batch error %d\n", static_cast<int>(result));
+            return false;
+        }
+        out.insert(out.end(), pcm.begin(),
+                   pcm.begin() + static_cast<long>(bytes_written / sizeof(int16_t)));
+        packet_samples.insert(packet_samples.end(), batch_samples.begin(),
+                              batch_samples.begin() + static_cast<long>(packets_decoded));
+        next += packets_decoded;
+    }
+    return true;
+}
+
+void test_one_call(const std::vector<micro_opus::OpusPacketSpan>& spans,
+                   const std::vector<int16_t>& expected,
+                   const std::vector<size_t>& expected_samples) {
+    std::printf("Test: whole burst in one call\n");
+    std::vector<int16_t> out;
+    std::vector<size_t> packet_samples;
+    size_t calls = 0;
+    check(decode_batched(spans, MAX_FRAME_SAMPLES * CHANNELS * sizeof(int16_t) * NUM_PACKETS, out,
+                         packet_samples, calls),
+          "batch decode completes");
+    check(calls == 1, "one call");
+    check(out == expected, "PCM identical to decode()/conceal_loss() per packet");
+    check(packet_samples == expected_samples, "per-packet sample counts match");
+}
+
+void test_resubmit(const std::vector<micro_opus::OpusPacketSpan>& spans,
+                   const std::vector<int16_t>& expected,
+                   const std::vector<size_t>& expected_samples) {
+    std::printf("Test: output for 50 ms, rest resubmitted\n");
+    std::vector<int16_t> out;
+    std::vector<size_t> packet_samples;
+    size_t calls = 0;
+    check(decode_batched(spans, 2400 * CHANNELS * sizeof(int16_t), out, packet_samples, calls),
+          "batch decode completes");
+    check(calls > 1, "stopped when the output filled up");
+    check(out == expected, "PCM identical to decode()/conceal_loss() per packet");
+    check(packet_samples == expected_samples, "per-packet sample counts match");
+}
+
+void test_conceal_first(const std::vector<micro_opus::OpusPacketSpan>& spans) {
+    std::printf("Test: lost packet before any other conceals 20 ms\n");
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS * 2);
+    micro_opus::OpusPacketSpan burst[2] = {spans[0], spans[0]};
+    burst[0].lost = true;
+    size_t packet_samples[2] = {};
+    size_t packets_decoded = 0;
+    size_t bytes_written = 0;
+    check(decoder.decode_batch(burst, 2, reinterpret_cast<uint8_t*>(pcm.data()),
+                               pcm.size() * sizeof(int16_t), packets_decoded, bytes_written,
+                               packet_samples) == micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+          "decode_batch succeeds");
+    check(packets_decoded == 2, "both packets decoded");
+    check(packet_samples[0] == MAX_FRAME_SAMPLES, "concealed 20 ms");
+    check(packet_samples[1] == 480, "then the 10 ms packet");
+    check(bytes_written == (MAX_FRAME_SAMPLES + 480) * CHANNELS * sizeof(int16_t),
+          "bytes_written covers both");
+}
+
+void test_errors(const std::vector<micro_opus::OpusPacketSpan>& spans) {
+    std::printf("Test: error paths\n");
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS * 4);
+    size_t packets_decoded = 1;
+    size_t bytes_written = 1;
+
+    check(decoder.decode_batch(nullptr, 1, reinterpret_cast<uint8_t*>(pcm.data()),
+                               pcm.size() * sizeof(int16_t), packets_decoded, bytes_written) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_INPUT_INVALID,
+          "null packet array is INPUT_INVALID");
+    check(packets_decoded == 0 && bytes_written == 0, "outputs cleared");
+
+    check(decoder.decode_batch(spans.data(), spans.size(), reinterpret_cast<uint8_t*>(pcm.data()),
+                               100, packets_decoded, bytes_written) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL,
+          "output below the first packet is OUTPUT_BUFFER_TOO_SMALL");
+    check(decoder.get_required_output_bytes() == 480 * CHANNELS * sizeof(int16_t),
+          "required size of the first packet reported");
+
+    // An empty packet not marked lost stops the batch there
+    std::vector<micro_opus::OpusPacketSpan> broken(spans.begin(), spans.begin() + 4);
+    broken[2].data = nullptr;
+    broken[2].length = 0;
+    check(decoder.decode_batch(broken.data(), broken.size(),
+                               reinterpret_cast<uint8_t*>(pcm.data()),
+                               pcm.size() * sizeof(int16_t), packets_decoded, bytes_written) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_INPUT_INVALID,
+          "empty packet is INPUT_INVALID");
+    check(packets_decoded == 2, "packets before it still reported");
+    check(bytes_written == (480 + 960) * CHANNELS * sizeof(int16_t), "and their bytes");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("OpusPacketDecoder decode_batch() test\n");
+
+    const std::vector<std::vector<uint8_t>> packets = encode_packets();
+    check(packets.size() == static_cast<size_t>(NUM_PACKETS), "encoded every packet");
+    if (packets.size() != static_cast<size_t>(NUM_PACKETS)) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+    const std::vector<micro_opus::OpusPacketSpan> spans = make_spans(packets);
+
+    std::vector<int16_t> expected;
+    std::vector<size_t> expected_samples;
+    check(decode_one_by_one(packets, expected, expected_samples), "reference decode completes");
+
+    test_one_call(spans, expected, expected_samples);
+    test_resubmit(spans, expected, expected_samples);
+    test_conceal_first(spans);
+    test_errors(spans);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
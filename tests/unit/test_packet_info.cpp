@@ -0,0 +1,379 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// parse_opus_packet_info(): every TOC configuration, every frame-count code and a few thousand
+// random packets must agree with libopus's own packet queries (opus_packet_parse() and friends),
+// including which packets are rejected. Also covers DTX and CELT silence detection, and checks
+// that OpusPacketDecoder::decode(info, ...) matches decode(packet, len, ...).
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "micro_opus/opus_packet_info.h"
+#include "opus.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz
+constexpr int NUM_PACKETS = 10;
+constexpr int NUM_RANDOM_PACKETS = 5000;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Whether info describes the packet exactly as libopus parses it
+bool matches_libopus(const std::vector<uint8_t>& packet, const micro_opus::OpusPacketInfo& info) {
+    const opus_int32 len = static_cast<opus_int32>(packet.size());
+    const unsigned char* frames[48];
+    opus_int16 sizes[48];
+    const int count = opus_packet_parse(packet.data(), len, nullptr, frames, sizes, nullptr);
+    if (count != info.frame_count) {
+        return false;
+    }
+    for (int i = 0; i < count; ++i) {
+        if (frames[i] != info.frames[i] || sizes[i] != info.frame_sizes[i]) {
+            return false;
+        }
+    }
+    return info.bandwidth ==
+               opus_packet_get_bandwidth(packet.data()) - OPUS_BANDWIDTH_NARROWBAND &&
+           info.frame_samples == opus_packet_get_samples_per_frame(packet.data(), 48000) &&
+           static_cast<int>(info.get_samples()) ==
+               opus_packet_get_nb_samples(packet.data(), len, 48000) &&
+           static_cast<int>(info.get_samples(16000)) ==
+               opus_packet_get_nb_samples(packet.data(), len, 16000) &&
+           (info.stereo ? 2 : 1) == opus_packet_get_nb_channels(packet.data());
+}
+
+// Encode NUM_PACKETS 20 ms frames of a stereo tone (or silence) with the given settings
+std::vector<std::vector<uint8_t>> encode_packets(int application, int bandwidth, int bitrate,
+                                                 bool silent) {
+    micro_opus_test::EncoderSettings settings;
+    settings.application = application;
+    settings.bitrate = bitrate;
+    const double amplitude = silent ? 0.0 : 8000.0;
+    micro_opus_test::ToneEncoder encoder(settings, {{440.0, amplitude}, {440.0, amplitude / 2}});
+    encoder.ctl(OPUS_SET_BANDWIDTH(bandwidth));
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (int p = 0; p < NUM_PACKETS; ++p) {
+        std::vector<uint8_t> packet = encoder.encode(FRAME_SAMPLES);
+        if (packet.empty()) {
+            break;
+        }
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+void test_all_configs() {
+    std::printf("Test: all 32 TOC configurations, mono and stereo\n");
+    for (int config = 0; config < 32; ++config) {
+        for (int stereo = 0; stereo < 2; ++stereo) {
+            std::vector<uint8_t> packet(11, 0x55);
+            packet[0] = static_cast<uint8_t>(config << 3 | stereo << 2);
+            micro_opus::OpusPacketInfo info;
+            const bool ok = micro_opus::parse_opus_packet_info(packet.data(), packet.size(),
+                                                               info) ==
+                            micro_opus::OPUS_PACKET_INFO_OK;
+            check(ok, "single-frame packet parses");
+            check(ok && matches_libopus(packet, info), "matches libopus");
+            const micro_opus::OpusPacketMode expected_mode =
+                (config < 12)   ? micro_opus::OPUS_PACKET_MODE_SILK
+                : (config < 16) ? micro_opus::OPUS_PACKET_MODE_HYBRID
+                                : micro_opus::OPUS_PACKET_MODE_CELT;
+            check(info.mode == expected_mode, "mode follows the configuration range");
+            check(info.config == config, "configuration number reported");
+        }
+    }
+}
+
+void test_frame_codes() {
+    std::printf("Test: frame-count codes 0-3, explicit lengths and padding\n");
+    struct Case {
+        const char* name;
+        std::vector<uint8_t> packet;
+        uint8_t frame_count;
+        uint32_t padding_len;
+    };
+    std::vector<Case> cases;
+    // Code 1: two 5-byte frames
+    cases.push_back({"code 1", {0xF9, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}, 2, 0});
+    // Code 2: first frame 3 bytes (1-byte length), second frame the rest
+    cases.push_back({"code 2 short length", {0xFA, 3, 1, 2, 3, 4, 5}, 2, 0});
+    // Code 2: first frame 300 bytes (2-byte length: 252 + 4 * 12)
+    {
+        std::vector<uint8_t> packet = {0xFA, 252, 12};
+        packet.resize(3 + 300 + 20, 0x33);
+        cases.push_back({"code 2 long length", packet, 2, 0});
+    }
+    // Code 3 CBR: 4 frames of 2 bytes
+    cases.push_back({"code 3 CBR", {0xFB, 0x04, 1, 2, 3, 4, 5, 6, 7, 8}, 4, 0});
+    // Code 3 VBR: 3 frames, lengths 1 and 0 coded, the last takes the rest
+    cases.push_back({"code 3 VBR", {0xFB, 0x83, 1, 0, 9, 7, 7}, 3, 0});
+    // Code 3 CBR with 3 padding bytes
+    cases.push_back({"code 3 padding", {0xFB, 0x42, 3, 1, 2, 3, 4, 0, 0, 0}, 2, 3});
+    // Code 3 VBR with a 255 padding chain: 254 + 2 bytes
+    {
+        std::vector<uint8_t> packet = {0xFB, 0xC2, 255, 2, 1, 1, 2, 2};
+        packet.resize(packet.size() + 256, 0);
+        cases.push_back({"code 3 padding chain", packet, 2, 256});
+    }
+
+    for (const Case& c : cases) {
+        micro_opus::OpusPacketInfo info;
+        const bool ok = micro_opus::parse_opus_packet_info(c.packet.data(), c.packet.size(),
+                                                           info) == micro_opus::OPUS_PACKET_INFO_OK;
+        std::printf("  %s\n", c.name);
+        check(ok, "packet parses");
+        check(ok && matches_libopus(c.packet, info), "matches libopus");
+        check(info.frame_count == c.frame_count, "frame count");
+        check(info.padding_len == c.padding_len, "padding length");
+    }
+}
+
+void test_invalid() {
+    std::printf("Test: malformed packets are rejected\n");
+    micro_opus::OpusPacketInfo info;
+    const uint8_t odd_code1[] = {0xF9, 1, 2, 3};
+    const uint8_t short_code2[] = {0xFA, 10, 1, 2};
+    const uint8_t zero_frames[] = {0xFB, 0x00, 1};
+    const uint8_t too_long[] = {0x1B, 0x03, 1, 2, 3};  // 3 x 60 ms SILK frames = 180 ms
+    const uint8_t cbr_uneven[] = {0xFB, 0x02, 1, 2, 3};
+    const uint8_t padding_overrun[] = {0xFB, 0x41, 10, 1};
+    std::vector<uint8_t> oversized_frame(1 + 1276, 0);
+    oversized_frame[0] = 0xF8;
+
+    check(micro_opus::parse_opus_packet_info(nullptr, 5, info) ==
+              micro_opus::OPUS_PACKET_INFO_EMPTY,
+          "nullptr reports EMPTY");
+    check(micro_opus::parse_opus_packet_info(odd_code1, 0, info) ==
+              micro_opus::OPUS_PACKET_INFO_EMPTY,
+          "zero length reports EMPTY");
+    check(micro_opus::parse_opus_packet_info(odd_code1, sizeof(odd_code1), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "code 1 with an odd payload");
+    check(micro_opus::parse_opus_packet_info(short_code2, sizeof(short_code2), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "code 2 length past the end");
+    check(micro_opus::parse_opus_packet_info(zero_frames, sizeof(zero_frames), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "code 3 with zero frames");
+    check(micro_opus::parse_opus_packet_info(too_long, sizeof(too_long), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "more than 120 ms");
+    check(micro_opus::parse_opus_packet_info(cbr_uneven, sizeof(cbr_uneven), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "CBR payload not divisible by the frame count");
+    check(micro_opus::parse_opus_packet_info(padding_overrun, sizeof(padding_overrun), info) ==
+              micro_opus::OPUS_PACKET_INFO_INVALID,
+          "padding past the end");
+    check(micro_opus::parse_opus_packet_info(oversized_frame.data(), oversized_frame.size(),
+                                             info) == micro_opus::OPUS_PACKET_INFO_INVALID,
+          "frame over 1275 bytes");
+}
+
+void test_random_packets() {
+    std::printf("Test: %d random packets accepted and rejected exactly as libopus does\n",
+                NUM_RANDOM_PACKETS);
+    uint32_t seed = 0x12345678;
+    auto next = [&seed]() {
+        seed = seed * 1664525U + 1013904223U;
+        return static_cast<uint8_t>(seed >> 24);
+    };
+
+    int mismatches = 0;
+    int accepted = 0;
+    for (int n = 0; n < NUM_RANDOM_PACKETS; ++n) {
+        std::vector<uint8_t> packet(1 + (next() % 64));
+        for (uint8_t& byte : packet) {
+            byte = next();
+        }
+        // Bias toward code 3 packets with few frames, which otherwise mostly fail the 120 ms limit
+        if (n % 2 == 0 && packet.size() > 1) {
+            packet[0] |= 0x03;
+            packet[1] = static_cast<uint8_t>((packet[1] & 0xC0) | (1 + packet[1] % 4));
+        }
+
+        micro_opus::OpusPacketInfo info;
+        const bool ok = micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                        micro_opus::OPUS_PACKET_INFO_OK;
+        opus_int16 sizes[48];
+        const bool libopus_ok = opus_packet_parse(packet.data(),
+                                                  static_cast<opus_int32>(packet.size()), nullptr,
+                                                  nullptr, sizes, nullptr) > 0;
+        if (ok != libopus_ok || (ok && !matches_libopus(packet, info))) {
+            ++mismatches;
+        }
+        accepted += ok ? 1 : 0;
+    }
+    check(mismatches == 0, "no disagreement with libopus");
+    check(accepted > NUM_RANDOM_PACKETS / 10, "a useful share of the random packets were valid");
+}
+
+void test_encoded(const char* name, int application, int bandwidth, int bitrate,
+                  micro_opus::OpusPacketMode expected_mode) {
+    std::printf("Test: encoded %s packets\n", name);
+    const auto packets = encode_packets(application, bandwidth, bitrate, false);
+    check(packets.size() == NUM_PACKETS, "encoded every packet");
+    for (const auto& packet : packets) {
+        micro_opus::OpusPacketInfo info;
+        const bool ok = micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                        micro_opus::OPUS_PACKET_INFO_OK;
+        check(ok, "encoder output parses");
+        check(ok && matches_libopus(packet, info), "matches libopus");
+        check(info.mode == expected_mode, "expected coding mode");
+        check(info.get_samples() == FRAME_SAMPLES, "20 ms per packet");
+        check(!info.is_silent(), "tone is not silent");
+    }
+}
+
+void test_silence() {
+    std::printf("Test: DTX frames and CELT silence\n");
+    micro_opus::OpusPacketInfo info;
+
+    // A bare TOC byte: one empty (DTX) 20 ms CELT frame
+    const uint8_t dtx[] = {0xF8};
+    check(micro_opus::parse_opus_packet_info(dtx, sizeof(dtx), info) ==
+              micro_opus::OPUS_PACKET_INFO_OK,
+          "DTX packet parses");
+    check(info.is_silent(), "DTX packet is silent");
+    check(info.frame_sizes[0] == 0, "DTX frame is empty");
+
+    // Code 3 VBR: an empty frame, then a 4-byte frame
+    const uint8_t mixed[] = {0x7B, 0x82, 0, 0xFF, 0xFF, 0xFF, 0xFF};
+    check(micro_opus::parse_opus_packet_info(mixed, sizeof(mixed), info) ==
+              micro_opus::OPUS_PACKET_INFO_OK,
+          "mixed packet parses");
+    check(info.is_frame_silent(0) && !info.is_frame_silent(1), "only the empty frame is silent");
+    check(!info.is_silent(), "a packet with audio is not silent");
+
+    // CELT frames whose range-coded silence flag (probability 1/2^15) is set and clear
+    const uint8_t flagged[] = {0xF8, 0xFF, 0xFF, 0xFF, 0x10};
+    const uint8_t unflagged[] = {0xF8, 0x7F, 0xFF, 0xFF, 0x10};
+    check(micro_opus::parse_opus_packet_info(flagged, sizeof(flagged), info) ==
+                  micro_opus::OPUS_PACKET_INFO_OK &&
+              info.is_silent(),
+          "CELT frame with the silence flag is silent");
+    check(micro_opus::parse_opus_packet_info(unflagged, sizeof(unflagged), info) ==
+                  micro_opus::OPUS_PACKET_INFO_OK &&
+              !info.is_silent(),
+          "CELT frame without the silence flag is not silent");
+
+    // Digital silence through the CELT-only encoder sets each frame's silence flag
+    const auto packets = encode_packets(OPUS_APPLICATION_RESTRICTED_LOWDELAY,
+                                        OPUS_BANDWIDTH_FULLBAND, 64000, true);
+    check(packets.size() == NUM_PACKETS, "encoded every packet");
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    for (const auto& packet : packets) {
+        const bool ok = micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                        micro_opus::OPUS_PACKET_INFO_OK;
+        check(ok && info.mode == micro_opus::OPUS_PACKET_MODE_CELT, "CELT packet parses");
+        check(info.is_silent(), "silent input gives a silent packet");
+
+        size_t bytes_written = 0;
+        check(decoder.decode(info, reinterpret_cast<uint8_t*>(pcm.data()),
+                             pcm.size() * sizeof(int16_t),
+                             bytes_written) == micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+              "silent packet decodes");
+        bool all_zero = true;
+        for (int16_t sample : pcm) {
+            all_zero = all_zero && sample == 0;
+        }
+        check(all_zero, "silent packet decodes to zeros");
+    }
+}
+
+void test_decode_from_info() {
+    std::printf("Test: decode(info) matches decode(packet), at 48 and 16 kHz\n");
+    const auto packets =
+        encode_packets(OPUS_APPLICATION_AUDIO, OPUS_BANDWIDTH_FULLBAND, 96000, false);
+    for (uint32_t rate : {48000U, 16000U}) {
+        micro_opus::OpusPacketDecoder by_pointer(rate, CHANNELS);
+        micro_opus::OpusPacketDecoder by_info(rate, CHANNELS);
+        const size_t packet_bytes = rate / 50 * CHANNELS * sizeof(int16_t);
+        std::vector<uint8_t> expected(packet_bytes);
+        std::vector<uint8_t> actual(packet_bytes);
+        for (const auto& packet : packets) {
+            micro_opus::OpusPacketInfo info;
+            check(micro_opus::parse_opus_packet_info(packet.data(), packet.size(), info) ==
+                      micro_opus::OPUS_PACKET_INFO_OK,
+                  "packet parses");
+
+            // One byte short: refused up front, and the required size is reported
+            size_t bytes_written = 1;
+            check(by_info.decode(info, actual.data(), packet_bytes - 1, bytes_written) ==
+                      micro_opus::OPUS_PACKET_DECODER_ERROR_OUTPUT_BUFFER_TOO_SMALL,
+                  "short buffer reports TOO_SMALL");
+            check(bytes_written == 0, "nothing written on TOO_SMALL");
+            check(by_info.get_required_output_bytes() == packet_bytes, "required size reported");
+
+            size_t expected_bytes = 0;
+            size_t actual_bytes = 0;
+            check(by_pointer.decode(packet.data(), packet.size(), expected.data(),
+                                    expected.size(),
+                                    expected_bytes) == micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+                  "decode(packet) succeeds");
+            check(by_info.decode(info, actual.data(), actual.size(), actual_bytes) ==
+                      micro_opus::OPUS_PACKET_DECODER_SUCCESS,
+                  "decode(info) succeeds");
+            check(actual_bytes == expected_bytes && actual == expected, "identical PCM");
+        }
+    }
+
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    micro_opus::OpusPacketInfo empty{};
+    std::vector<uint8_t> out(64);
+    size_t bytes_written = 0;
+    check(decoder.decode(empty, out.data(), out.size(), bytes_written) ==
+              micro_opus::OPUS_PACKET_DECODER_ERROR_INPUT_INVALID,
+          "unparsed info reports INPUT_INVALID");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("Opus packet inspection test\n");
+
+    test_all_configs();
+    test_frame_codes();
+    test_invalid();
+    test_random_packets();
+    test_encoded("SILK narrowband", OPUS_APPLICATION_VOIP, OPUS_BANDWIDTH_NARROWBAND, 12000,
+                 micro_opus::OPUS_PACKET_MODE_SILK);
+    test_encoded("CELT-only", OPUS_APPLICATION_RESTRICTED_LOWDELAY, OPUS_BANDWIDTH_FULLBAND, 96000,
+                 micro_opus::OPUS_PACKET_MODE_CELT);
+    test_silence();
+    test_decode_from_info();
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
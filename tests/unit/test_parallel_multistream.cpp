@@ -0,0 +1,237 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// OggOpusDecoder::set_multistream_workers(): a channel mapping family 1 stream (one coupled and two
+// mono elementary streams behind five output channels, one of them silent) with mixed 20/60 ms
+// packets decodes to exactly the PCM of the serial libopus multistream decode, for several worker
+// counts and across reset(). Also checks that a corrupt multistream packet is still rejected, that
+// two such decoders can run at once, and in pseudostack pool builds that worker counts at or above
+// the pool size neither deadlock nor leak leases.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/pseudostack.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+namespace {
+
+constexpr int ENCODED_CHANNELS = 4;  // L, R (coupled), two mono streams
+constexpr int STREAMS = 3;
+constexpr int COUPLED_STREAMS = 1;
+constexpr uint8_t OUTPUT_CHANNELS = 5;  // The encoded four plus a silent channel
+constexpr int NUM_PACKETS = 24;
+constexpr uint32_t SERIAL = 0x4D53;
+constexpr size_t MAX_FRAME_SAMPLES = 5760;  // 120 ms at 48 kHz
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode a different tone per channel into NUM_PACKETS multistream packets alternating 20 and
+// 60 ms. Returns the packets, empty on failure.
+std::vector<std::vector<uint8_t>> encode_packets() {
+    micro_opus_test::EncoderSettings settings;
+    settings.channels = ENCODED_CHANNELS;
+    settings.bitrate = 160000;
+    settings.streams = STREAMS;
+    settings.coupled_streams = COUPLED_STREAMS;
+    settings.max_packet_bytes = 8000;
+    return micro_opus_test::encode_tone_packets(
+        settings, {{220.0, 8000.0}, {330.0, 8000.0}, {440.0, 8000.0}, {660.0, 8000.0}},
+        NUM_PACKETS, {960, 2880});
+}
+
+// Mux the packets one per page behind a family 1 OpusHead with channel 3 silent
+std::vector<uint8_t> mux_stream(const std::vector<std::vector<uint8_t>>& packets) {
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family1(OUTPUT_CHANNELS, STREAMS, COUPLED_STREAMS,
+                                                {0, 1, 2, 255, 3}),
+        packets, SERIAL);
+}
+
+bool decode_stream(micro_opus::OggOpusDecoder& decoder, const std::vector<uint8_t>& stream,
+                   std::vector<int16_t>& out) {
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * OUTPUT_CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        if (consumed == 0 && samples == 0) {
+            std::printf("  FAIL: decoder made no progress\n");
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + samples * OUTPUT_CHANNELS);
+    }
+    return true;
+}
+
+void test_matches_serial(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: parallel decode matches the serial multistream decode\n");
+    const uint8_t worker_counts[] = {2, 3, 4};
+    for (uint8_t workers : worker_counts) {
+        micro_opus::OggOpusDecoder decoder;
+        decoder.set_multistream_workers(workers);
+
+        // Twice through the same decoder: the workers and stream states are reused after reset()
+        for (int pass = 0; pass < 2; ++pass) {
+            std::vector<int16_t> out;
+            check(decode_stream(decoder, stream, out), "parallel decode completes");
+            check(out == expected, "PCM identical to the serial decode");
+            if (out != expected) {
+                std::printf("    %u workers, pass %d: %zu vs %zu samples\n", workers, pass,
+                            out.size(), expected.size());
+            }
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+            // Helpers lease per packet; more workers than pooled pseudostacks are capped
+            check(opus_pseudostack_pool_in_use() == 0, "every worker lease returned");
+#endif
+            decoder.reset();
+        }
+    }
+}
+
+#ifdef TEST_CONCURRENT_DECODERS
+// Two decoders with as many workers as the pool has pseudostacks, each calling task holding its
+// lease while it waits for its helpers: a helper that waited for a pooled pseudostack here would
+// never get one. Not in NONTHREADSAFE_PSEUDOSTACK builds, where libopus runs on one task only.
+void test_concurrent_decoders(const std::vector<uint8_t>& stream,
+                              const std::vector<int16_t>& expected) {
+    std::printf("Test: two parallel decoders run at once\n");
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    const uint8_t workers = static_cast<uint8_t>(opus_pseudostack_pool_size());
+#else
+    const uint8_t workers = 2;
+#endif
+    std::vector<int16_t> outputs[2];
+    bool completed[2] = {false, false};
+    std::thread threads[2];
+    for (size_t t = 0; t < 2; ++t) {
+        threads[t] = std::thread([&, t] {
+            micro_opus::OggOpusDecoder decoder;
+            decoder.set_multistream_workers(workers);
+            for (int pass = 0; pass < 4 && decode_stream(decoder, stream, outputs[t]); ++pass) {
+                completed[t] = pass == 3;
+                decoder.reset();
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    for (size_t t = 0; t < 2; ++t) {
+        check(completed[t], "concurrent decode completes");
+        check(outputs[t].size() == 4 * expected.size() &&
+                  std::equal(expected.begin(), expected.end(), outputs[t].begin()),
+              "concurrent decode matches the serial decode");
+    }
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+    check(opus_pseudostack_pool_in_use() == 0, "every concurrent lease returned");
+#endif
+}
+#endif
+
+void test_silent_channel(const std::vector<int16_t>& expected) {
+    std::printf("Test: the unmapped channel is silent and the others are not\n");
+    bool silent = true;
+    bool audible = false;
+    for (size_t i = 0; i < expected.size(); i += OUTPUT_CHANNELS) {
+        silent = silent && expected[i + 3] == 0;
+        audible = audible || expected[i + 4] != 0;
+    }
+    check(silent, "channel 3 (mapping 255) decodes to zeros");
+    check(audible, "channel 4 (last mono stream) carries audio");
+}
+
+void test_corrupt_packet(const std::vector<std::vector<uint8_t>>& packets) {
+    std::printf("Test: a truncated multistream packet is rejected\n");
+    std::vector<std::vector<uint8_t>> damaged = packets;
+    // Cut the second packet inside its first, self-delimited stream
+    damaged[1].resize(3);
+    const std::vector<uint8_t> stream = mux_stream(damaged);
+
+    micro_opus::OggOpusDecoder decoder;
+    decoder.set_multistream_workers(2);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * OUTPUT_CHANNELS);
+    size_t pos = 0;
+    bool rejected = false;
+    while (pos < stream.size() && !rejected) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        rejected = (result == micro_opus::OGG_OPUS_DECODE_ERROR);
+        if (result != micro_opus::OGG_OPUS_OK && !rejected) {
+            std::printf("  FAIL: unexpected result %d\n", static_cast<int>(result));
+            ++g_failures;
+            return;
+        }
+        pos += consumed;
+    }
+    check(rejected, "OGG_OPUS_DECODE_ERROR for the truncated packet");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("Parallel multistream decode test\n");
+
+    const std::vector<std::vector<uint8_t>> packets = encode_packets();
+    check(packets.size() == NUM_PACKETS, "encoded the multistream packets");
+    if (packets.size() != NUM_PACKETS) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+    const std::vector<uint8_t> stream = mux_stream(packets);
+
+    // Reference: the default serial decode through opus_multistream_decode()
+    std::vector<int16_t> expected;
+    {
+        micro_opus::OggOpusDecoder decoder;
+        check(decode_stream(decoder, stream, expected), "serial decode completes");
+        check(!expected.empty(), "serial decode produced audio");
+    }
+
+    test_matches_serial(stream, expected);
+#ifdef TEST_CONCURRENT_DECODERS
+    test_concurrent_decoders(stream, expected);
+#endif
+    test_silent_channel(expected);
+    test_corrupt_packet(packets);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,231 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// PipelinedOggOpusDecoder: decodes a stream with mixed 20/60 ms packets, pre-skip and end trimming
+// to exactly the PCM OggOpusDecoder produces, at several queue depths and input chunk sizes.
+// Also checks that a too-small output buffer keeps the frame queued, and that reset() with packets
+// in flight leaves the decoder ready for a fresh stream. Build with -DENABLE_SANITIZERS=ON (or
+// TSan) to catch races between the two tasks.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/pipelined_ogg_opus_decoder.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int NUM_PACKETS = 40;
+constexpr uint16_t PRE_SKIP = 312;
+constexpr int END_TRIM = 500;  // Samples the final granule position cuts from the last packet
+constexpr uint32_t SERIAL = 0x919E;
+constexpr size_t MAX_FRAME_SAMPLES = 5760;  // 120 ms at 48 kHz
+constexpr size_t MAX_ITERATIONS = 1000000;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode a stereo sine into NUM_PACKETS packets alternating 20 and 60 ms, muxed one per page
+std::vector<uint8_t> make_test_stream() {
+    const auto packets = micro_opus_test::encode_tone_packets(
+        micro_opus_test::EncoderSettings{}, {{440.0, 10000.0}, {440.0, 10000.0}}, NUM_PACKETS,
+        {960, 2880});
+    if (packets.empty()) {
+        return {};
+    }
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family0(CHANNELS, PRE_SKIP), packets, SERIAL, END_TRIM);
+}
+
+// Reference: the serial decoder, fed the whole stream
+bool decode_reference(const std::vector<uint8_t>& stream, std::vector<int16_t>& out) {
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: reference decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + samples * CHANNELS);
+    }
+    return true;
+}
+
+// Feed the stream chunk bytes at a time, then drain the pipeline with empty input
+bool decode_pipelined(micro_opus::PipelinedOggOpusDecoder& decoder,
+                      const std::vector<uint8_t>& stream, size_t chunk, std::vector<int16_t>& out) {
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    const size_t end = stream.size();
+    size_t pos = 0;
+    for (size_t iterations = 0; pos < end || decoder.get_packets_in_flight() > 0; ++iterations) {
+        if (iterations > MAX_ITERATIONS) {
+            std::printf("  FAIL: iteration cap hit (pipeline stalled)\n");
+            return false;
+        }
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, std::min(chunk, end - pos), reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: pipelined decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + samples * CHANNELS);
+    }
+    return true;
+}
+
+void test_matches_serial(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: output matches OggOpusDecoder\n");
+    const size_t depths[] = {1, 2, micro_opus::PipelinedOggOpusDecoder::DEFAULT_QUEUE_DEPTH, 8};
+    const size_t chunks[] = {64, 4096, stream.size()};
+    for (size_t depth : depths) {
+        for (size_t chunk : chunks) {
+            micro_opus::PipelinedOggOpusDecoder decoder(false, SAMPLE_RATE, 0, depth);
+            std::vector<int16_t> out;
+            bool ok = decode_pipelined(decoder, stream, chunk, out);
+            check(ok, "pipelined decode completes");
+            check(out == expected, "PCM identical to the serial decoder");
+            if (out != expected) {
+                std::printf("    depth %zu, chunk %zu: %zu vs %zu samples\n", depth, chunk,
+                            out.size(), expected.size());
+            }
+            check(decoder.get_channels() == CHANNELS, "reports the stream's channel count");
+            check(decoder.get_pre_skip() == PRE_SKIP, "reports the stream's pre-skip");
+        }
+    }
+}
+
+void test_small_output_buffer(const std::vector<uint8_t>& stream,
+                              const std::vector<int16_t>& expected) {
+    std::printf("Test: a too-small output buffer keeps the frame queued\n");
+    micro_opus::PipelinedOggOpusDecoder decoder;
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    std::vector<int16_t> out;
+    size_t pos = 0;
+    bool refused = false;
+    for (size_t iterations = 0; pos < stream.size() || decoder.get_packets_in_flight() > 0;
+         ++iterations) {
+        if (iterations > MAX_ITERATIONS) {
+            check(false, "pipeline stalled");
+            return;
+        }
+        size_t consumed = 0;
+        size_t samples = 0;
+        // Offer two samples' worth of space once, as soon as a frame is ready
+        size_t offered = pcm.size() * sizeof(int16_t);
+        if (!refused && decoder.get_packets_in_flight() > 0) {
+            offered = 4 * sizeof(int16_t);
+        }
+        micro_opus::OggOpusResult result =
+            decoder.decode(stream.data() + pos, std::min<size_t>(512, stream.size() - pos),
+                           reinterpret_cast<uint8_t*>(pcm.data()), offered, consumed, samples);
+        if (result == micro_opus::OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL) {
+            check(!refused, "refused only once");
+            check(decoder.get_required_output_buffer_size() > offered,
+                  "reports the size the frame needs");
+            refused = true;
+            continue;
+        }
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: decode error %d\n", static_cast<int>(result));
+            ++g_failures;
+            return;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + samples * CHANNELS);
+    }
+    check(refused, "the small buffer was refused");
+    check(out == expected, "no audio lost after the refusal");
+}
+
+void test_reset_in_flight(const std::vector<uint8_t>& stream,
+                          const std::vector<int16_t>& expected) {
+    std::printf("Test: reset() with packets in flight\n");
+    micro_opus::PipelinedOggOpusDecoder decoder(false, SAMPLE_RATE, 0, 4);
+
+    // Stop partway: queue up packets without draining them
+    std::vector<uint8_t> partial(stream.begin(), stream.begin() + stream.size() / 2);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    size_t pos = 0;
+    while (pos < partial.size() && decoder.get_packets_in_flight() < 3) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        decoder.decode(partial.data() + pos, partial.size() - pos,
+                       reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t),
+                       consumed, samples);
+        if (consumed == 0 && samples == 0) {
+            break;
+        }
+        pos += consumed;
+    }
+    check(decoder.get_packets_in_flight() > 0, "packets queued before reset");
+
+    decoder.reset();
+    check(decoder.get_packets_in_flight() == 0, "reset() empties the queue");
+    check(!decoder.is_initialized(), "reset() expects a new OpusHead");
+
+    std::vector<int16_t> out;
+    bool ok = decode_pipelined(decoder, stream, 1024, out);
+    check(ok, "decode after reset completes");
+    check(out == expected, "PCM after reset identical to the serial decoder");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("PipelinedOggOpusDecoder test\n");
+
+    const std::vector<uint8_t> stream = make_test_stream();
+    check(!stream.empty(), "built a non-empty Ogg stream");
+    if (stream.empty()) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    std::vector<int16_t> expected;
+    check(decode_reference(stream, expected), "reference decode completes");
+    check(!expected.empty(), "reference decode produced audio");
+
+    test_matches_serial(stream, expected);
+    test_small_output_buffer(stream, expected);
+    test_reset_in_flight(stream, expected);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
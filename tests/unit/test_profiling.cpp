@@ -0,0 +1,199 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Per-decoder profiling API (host build with -DOPUS_ENABLE_PROFILING=ON): decode CELT-only packets
+// with two OpusPacketDecoders and verify each one records only its own calls, the CELT/PVQ stage
+// groups are populated, and reset_profile_stats() clears everything. Also covers the latency
+// histogram and deadline counting. SILK-only packets must fill the silk group instead.
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "opus.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz, per channel
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode num_frames 20 ms stereo sine frames into raw packets; false on encoder errors
+bool encode_packets(int application, opus_int32 bitrate, int num_frames,
+                    std::vector<std::vector<uint8_t>>& packets) {
+    micro_opus_test::EncoderSettings settings;
+    settings.application = application;
+    settings.bitrate = bitrate;
+    packets = micro_opus_test::encode_tone_packets(settings, {{440.0, 12000.0}, {440.0, 12000.0}},
+                                                   num_frames, {FRAME_SAMPLES});
+    return !packets.empty();
+}
+
+size_t decode_all(micro_opus::OpusPacketDecoder& decoder,
+                  const std::vector<std::vector<uint8_t>>& packets, size_t count) {
+    std::vector<int16_t> out(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    size_t decoded = 0;
+    for (size_t i = 0; i < count; ++i) {
+        size_t bytes_written = 0;
+        auto result = decoder.decode(packets[i].data(), packets[i].size(),
+                                     reinterpret_cast<uint8_t*>(out.data()),
+                                     out.size() * sizeof(int16_t), bytes_written);
+        if (result == micro_opus::OPUS_PACKET_DECODER_SUCCESS) {
+            ++decoded;
+        }
+    }
+    return decoded;
+}
+
+}  // namespace
+
+int main() {
+    std::printf("OpusPacketDecoder profiling test\n");
+
+#ifndef MICRO_OPUS_ENABLE_PROFILING
+    std::printf("SKIP: library built without OPUS_ENABLE_PROFILING\n");
+    return 77;
+#else
+    // --- Encode CELT-only packets (RESTRICTED_LOWDELAY never selects SILK or hybrid) ---
+    constexpr int NUM_FRAMES = 10;
+    std::vector<std::vector<uint8_t>> packets;
+    if (!encode_packets(OPUS_APPLICATION_RESTRICTED_LOWDELAY, 64000, NUM_FRAMES, packets)) {
+        return 1;
+    }
+
+    micro_opus::OpusPacketDecoder decoder_a(SAMPLE_RATE, CHANNELS);
+    micro_opus::OpusPacketDecoder decoder_b(SAMPLE_RATE, CHANNELS);
+
+    // --- Fresh decoders start at zero ---
+    {
+        OpusProfileStats stats = decoder_a.get_profile_stats();
+        check(stats.decode_calls == 0, "fresh decoder has no calls");
+        check(stats.decode_total == 0, "fresh decoder has no time");
+        check(stats.tick_rate_hz == 1000000000U, "host tick rate is 1 GHz");
+    }
+
+    // --- Each decoder records only its own calls ---
+    check(decode_all(decoder_a, packets, NUM_FRAMES) == NUM_FRAMES, "decoder A decodes all");
+    check(decode_all(decoder_b, packets, NUM_FRAMES / 2) == NUM_FRAMES / 2,
+          "decoder B decodes half");
+    {
+        OpusProfileStats a = decoder_a.get_profile_stats();
+        OpusProfileStats b = decoder_b.get_profile_stats();
+        check(a.decode_calls == NUM_FRAMES, "decoder A call count");
+        check(b.decode_calls == NUM_FRAMES / 2, "decoder B call count");
+        check(a.decode_total > 0, "decoder A recorded time");
+        check(a.celt.frames == NUM_FRAMES, "decoder A CELT frame count");
+        check(b.celt.frames == NUM_FRAMES / 2, "decoder B CELT frame count");
+        check(a.celt.total > 0 && a.celt.total <= a.decode_total, "CELT total within decode total");
+        check(a.pvq.calls > 0, "PVQ stage recorded");
+    }
+
+    // --- Latency histogram: one sample per call, ordered percentiles ---
+    {
+        OpusProfileStats a = decoder_a.get_profile_stats();
+        uint64_t samples = 0;
+        for (uint32_t count : a.latency.buckets) {
+            samples += count;
+        }
+        check(samples == a.decode_calls, "one histogram sample per call");
+        check(a.latency.min > 0 && a.latency.min <= a.latency.max, "latency min/max");
+        check(a.latency.min <= a.latency.p50 && a.latency.p50 <= a.latency.p99 &&
+                  a.latency.p99 <= a.latency.p999 && a.latency.p999 <= a.latency.max,
+              "latency percentiles ordered");
+        check(opus_profile_latency_percentile(&a.latency, 100.0) == a.latency.max,
+              "p100 is the maximum");
+        check(a.latency.deadline_misses == 0, "no misses without a deadline");
+    }
+
+    // --- Deadline misses: a 1 us deadline is missed by every packet, and survives a reset ---
+    {
+        micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+        decoder.set_profile_deadline_us(1);
+        decode_all(decoder, packets, NUM_FRAMES);
+        OpusProfileStats stats = decoder.get_profile_stats();
+        check(stats.latency.deadline == 1000, "deadline converted to ticks");
+        check(stats.latency.deadline_misses == NUM_FRAMES, "every packet misses a 1 us deadline");
+
+        decoder.reset_profile_stats();
+        stats = decoder.get_profile_stats();
+        check(stats.latency.deadline_misses == 0, "reset clears deadline misses");
+        check(stats.latency.deadline == 1000, "reset keeps the deadline");
+    }
+
+    // --- Concealment counts as a decode call ---
+    {
+        std::vector<int16_t> out(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+        size_t bytes_written = 0;
+        decoder_b.conceal_loss(reinterpret_cast<uint8_t*>(out.data()),
+                               out.size() * sizeof(int16_t), FRAME_SAMPLES, bytes_written);
+        check(decoder_b.get_profile_stats().decode_calls == NUM_FRAMES / 2 + 1,
+              "conceal_loss counted");
+    }
+
+    // --- reset_profile_stats() clears one decoder only ---
+    {
+        decoder_a.reset_profile_stats();
+        OpusProfileStats a = decoder_a.get_profile_stats();
+        check(a.decode_calls == 0 && a.decode_total == 0, "reset clears wrapper counters");
+        check(a.celt.frames == 0 && a.celt.total == 0, "reset clears CELT group");
+        check(a.pvq.calls == 0, "reset clears PVQ group");
+        check(decoder_b.get_profile_stats().decode_calls == NUM_FRAMES / 2 + 1,
+              "reset leaves the other decoder alone");
+    }
+
+    // --- Calling libopus with no decoder bound records nothing ---
+    {
+        int error = 0;
+        OpusDecoder* raw = opus_decoder_create(SAMPLE_RATE, CHANNELS, &error);
+        std::vector<int16_t> out(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+        opus_decode(raw, packets[0].data(), static_cast<opus_int32>(packets[0].size()),
+                    out.data(), FRAME_SAMPLES, 0);
+        opus_decoder_destroy(raw);
+        check(decoder_a.get_profile_stats().celt.frames == 0, "unbound decode not recorded");
+    }
+
+    // --- SILK-only packets (VOIP at a low bitrate) fill the silk group ---
+    {
+        std::vector<std::vector<uint8_t>> silk_packets;
+        if (!encode_packets(OPUS_APPLICATION_VOIP, 12000, NUM_FRAMES, silk_packets)) {
+            return 1;
+        }
+        micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+        check(decode_all(decoder, silk_packets, NUM_FRAMES) == NUM_FRAMES, "SILK packets decode");
+        OpusProfileStats stats = decoder.get_profile_stats();
+        check(stats.silk.frames > 0, "SILK frames recorded");
+        check(stats.silk.synthesis > 0 && stats.silk.total <= stats.decode_total,
+              "SILK total within decode total");
+        check(stats.silk.resample > 0, "SILK resampling recorded");
+    }
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+#endif
+}
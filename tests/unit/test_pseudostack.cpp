@@ -0,0 +1,113 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Pseudostack high-water mark (host build with -DOPUS_PSEUDOSTACK_TRACKING=ON): the mark starts
+// from zero after a reset, rises to a plausible value when packets are decoded, is reproducible
+// for the same input, and in THREADSAFE_PSEUDOSTACK mode is kept per thread.
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "micro_opus/pseudostack.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <vector>
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_TRACKING
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz, per channel
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode num_frames of a stereo sine into raw packets. Returns false (after printing) on errors.
+bool encode_packets(int num_frames, std::vector<std::vector<uint8_t>>& packets) {
+    packets = micro_opus_test::encode_tone_packets(micro_opus_test::EncoderSettings{},
+                                                   {{440.0, 12000.0}, {440.0, 12000.0}},
+                                                   num_frames, {FRAME_SAMPLES});
+    return !packets.empty();
+}
+
+// Decode all packets with a fresh decoder on the calling thread and return its high-water mark
+size_t decode_and_measure(const std::vector<std::vector<uint8_t>>& packets) {
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<uint8_t> out(decoder.get_pcm_format().max_output_bytes());
+    opus_pseudostack_reset_high_water();
+    for (const auto& packet : packets) {
+        size_t bytes_written = 0;
+        auto result =
+            decoder.decode(packet.data(), packet.size(), out.data(), out.size(), bytes_written);
+        check(result == micro_opus::OPUS_PACKET_DECODER_SUCCESS, "packet decodes");
+    }
+    return opus_pseudostack_high_water();
+}
+
+}  // namespace
+#endif  // MICRO_OPUS_PSEUDOSTACK_TRACKING
+
+int main() {
+    std::printf("Pseudostack high-water mark test\n");
+
+#ifndef MICRO_OPUS_PSEUDOSTACK_TRACKING
+    std::printf("SKIP: library built without OPUS_PSEUDOSTACK_TRACKING\n");
+    return 77;
+#else
+    constexpr int NUM_FRAMES = 10;
+    std::vector<std::vector<uint8_t>> packets;
+    if (!encode_packets(NUM_FRAMES, packets)) {
+        return 1;
+    }
+
+    // --- Encoding used the pseudostack, a reset clears the mark ---
+    check(opus_pseudostack_high_water() > 0, "encoding raised the mark");
+    opus_pseudostack_reset_high_water();
+    check(opus_pseudostack_high_water() == 0, "reset clears the mark");
+
+    // --- Decoding raises it to something inside the buffer ---
+    const size_t first = decode_and_measure(packets);
+    std::printf("  decode high-water: %zu of %zu bytes\n", first, opus_pseudostack_size());
+    check(first > 0, "decoding raised the mark");
+    check(first <= opus_pseudostack_size(), "mark fits in the pseudostack");
+
+    // --- Same input, same mark ---
+    check(decode_and_measure(packets) == first, "mark is reproducible");
+
+#ifdef TEST_THREADSAFE_PSEUDOSTACK
+    // --- Another thread's decode only moves that thread's mark ---
+    opus_pseudostack_reset_high_water();
+    size_t other_thread = 0;
+    std::thread worker([&packets, &other_thread]() { other_thread = decode_and_measure(packets); });
+    worker.join();
+    check(other_thread == first, "worker thread measured the same decode");
+    check(opus_pseudostack_high_water() == 0, "worker thread did not touch this thread's mark");
+#endif
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+#endif
+}
@@ -0,0 +1,154 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Shared pseudostack pool (host build with -DOPUS_PSEUDOSTACK_POOL=<n>): leases nest, are counted
+// and returned, and more decoding threads than pooled pseudostacks produce the same PCM as a
+// single thread without ever holding more than the pool size.
+
+#include "micro_opus/opus_packet_decoder.h"
+#include "micro_opus/pseudostack.h"
+#include "tone_stream.h"
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef MICRO_OPUS_PSEUDOSTACK_POOL
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms at 48 kHz, per channel
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode num_frames of a stereo sine into raw packets, each encode under its own lease. Returns
+// false (after printing) on errors.
+bool encode_packets(int num_frames, std::vector<std::vector<uint8_t>>& packets) {
+    micro_opus_test::ToneEncoder encoder(micro_opus_test::EncoderSettings{},
+                                         {{440.0, 12000.0}, {440.0, 12000.0}});
+    for (int f = 0; f < num_frames; ++f) {
+        opus_pseudostack_lease();
+        std::vector<uint8_t> packet = encoder.encode(FRAME_SAMPLES);
+        opus_pseudostack_release();
+        if (packet.empty()) {
+            return false;
+        }
+        packets.push_back(std::move(packet));
+    }
+    return true;
+}
+
+// Decode all packets with a fresh decoder and return the concatenated PCM
+std::vector<uint8_t> decode_all(const std::vector<std::vector<uint8_t>>& packets) {
+    micro_opus::OpusPacketDecoder decoder(SAMPLE_RATE, CHANNELS);
+    std::vector<uint8_t> out(decoder.get_pcm_format().max_output_bytes());
+    std::vector<uint8_t> pcm;
+    for (const auto& packet : packets) {
+        size_t bytes_written = 0;
+        auto result =
+            decoder.decode(packet.data(), packet.size(), out.data(), out.size(), bytes_written);
+        check(result == micro_opus::OPUS_PACKET_DECODER_SUCCESS, "packet decodes");
+        pcm.insert(pcm.end(), out.begin(),
+                   out.begin() + static_cast<std::ptrdiff_t>(bytes_written));
+    }
+    return pcm;
+}
+
+}  // namespace
+#endif  // MICRO_OPUS_PSEUDOSTACK_POOL
+
+int main() {
+    std::printf("Pseudostack pool test\n");
+
+#ifndef MICRO_OPUS_PSEUDOSTACK_POOL
+    std::printf("SKIP: library built without OPUS_PSEUDOSTACK_POOL\n");
+    return 77;
+#else
+    // --- Leases nest on a thread and only the outermost takes a pseudostack ---
+    check(opus_pseudostack_pool_size() == MICRO_OPUS_PSEUDOSTACK_POOL, "pool size matches build");
+    check(opus_pseudostack_pool_in_use() == 0, "pool starts empty");
+    check(opus_pseudostack_lease() == OPUS_OK, "lease succeeds");
+    check(opus_pseudostack_pool_in_use() == 1, "lease takes one pseudostack");
+    check(opus_pseudostack_lease() == OPUS_OK, "nested lease succeeds");
+    check(opus_pseudostack_pool_in_use() == 1, "nested lease takes no second pseudostack");
+    opus_pseudostack_release();
+    check(opus_pseudostack_pool_in_use() == 1, "inner release keeps the pseudostack");
+    opus_pseudostack_release();
+    check(opus_pseudostack_pool_in_use() == 0, "outer release returns it");
+
+    constexpr int NUM_FRAMES = 25;
+    std::vector<std::vector<uint8_t>> packets;
+    if (!encode_packets(NUM_FRAMES, packets)) {
+        return 1;
+    }
+    check(opus_pseudostack_pool_in_use() == 0, "encoding returned its leases");
+
+    const std::vector<uint8_t> reference = decode_all(packets);
+    check(!reference.empty(), "reference decode produced PCM");
+
+    // --- More decoding threads than pseudostacks: same output, never more leases than the pool ---
+    constexpr int NUM_THREADS = MICRO_OPUS_PSEUDOSTACK_POOL + 3;
+    std::atomic<bool> done{false};
+    size_t max_in_use = 0;
+    std::thread monitor([&done, &max_in_use]() {
+        while (!done.load()) {
+            size_t in_use = opus_pseudostack_pool_in_use();
+            if (in_use > max_in_use) {
+                max_in_use = in_use;
+            }
+            std::this_thread::yield();
+        }
+    });
+
+    std::vector<std::vector<uint8_t>> results(NUM_THREADS);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < NUM_THREADS; ++t) {
+        workers.emplace_back([&packets, &results, t]() {
+            for (int repeat = 0; repeat < 4; ++repeat) {
+                results[static_cast<size_t>(t)] = decode_all(packets);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    done.store(true);
+    monitor.join();
+
+    for (const auto& result : results) {
+        check(result == reference, "threaded decode matches the single-threaded reference");
+    }
+    std::printf("  peak leases: %zu of %zu\n", max_in_use, opus_pseudostack_pool_size());
+    check(max_in_use <= opus_pseudostack_pool_size(), "leases never exceed the pool");
+    check(opus_pseudostack_pool_in_use() == 0, "all leases returned");
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+#endif
+}
@@ -0,0 +1,243 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Pull-model decode: OggOpusDecoder::decode(OggOpusReader&, ...) must produce exactly the push
+// decode's PCM from a zero-copy memory reader, a buffered reader fed a few bytes per read(), a
+// buffered reader too small to hold a page, and a source whose data arrives in bursts. Also
+// checks that the decoder never asks for bytes beyond the page it is on.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/ogg_opus_reader.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace {
+
+constexpr uint8_t CHANNELS = 2;
+constexpr int FRAME_SAMPLES = 960;  // 20 ms @ 48 kHz, per channel
+constexpr uint16_t PRE_SKIP = 312;
+constexpr int NUM_PACKETS = 50;
+constexpr uint32_t SERIAL = 0xBEEF;
+constexpr size_t MAX_ITERATIONS = 100000;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode NUM_PACKETS stereo sine frames, one per page; page_ends receives each page's end offset
+std::vector<uint8_t> make_test_stream(std::vector<size_t>& page_ends) {
+    const auto packets = micro_opus_test::encode_tone_packets(
+        micro_opus_test::EncoderSettings{}, {{440.0, 8000.0}, {440.0, -8000.0}}, NUM_PACKETS,
+        {FRAME_SAMPLES});
+    if (packets.empty()) {
+        return {};
+    }
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family0(CHANNELS, PRE_SKIP), packets, SERIAL, 0,
+        &page_ends);
+}
+
+// Reference: the push decoder, fed the whole stream
+bool decode_push(const std::vector<uint8_t>& stream, std::vector<int16_t>& out) {
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: push decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + static_cast<long>(samples * CHANNELS));
+    }
+    return true;
+}
+
+// Pull decode until the reader runs dry; more_data is called each time it does, and returns false
+// once the source is finished
+template <typename MoreData>
+bool decode_pull(micro_opus::OggOpusDecoder& decoder, micro_opus::OggOpusReader& reader,
+                 std::vector<int16_t>& out, MoreData more_data) {
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * CHANNELS);
+    for (size_t i = 0; i < MAX_ITERATIONS; ++i) {
+        size_t samples = 0;
+        micro_opus::OggOpusResult result =
+            decoder.decode(reader, reinterpret_cast<uint8_t*>(pcm.data()),
+                           pcm.size() * sizeof(int16_t), samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: pull decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        if (samples == 0 && !more_data()) {
+            return true;
+        }
+        out.insert(out.end(), pcm.begin(), pcm.begin() + static_cast<long>(samples * CHANNELS));
+    }
+    std::printf("  FAIL: pull decode did not finish\n");
+    return false;
+}
+
+bool no_more_data() {
+    return false;
+}
+
+// Memory reader that checks every request stays within the current page
+class PageCheckingReader : public micro_opus::OggOpusReader {
+public:
+    PageCheckingReader(const std::vector<uint8_t>& stream, const std::vector<size_t>& page_ends)
+        : inner_(stream.data(), stream.size()), page_ends_(page_ends) {}
+
+    const uint8_t* peek(size_t bytes, size_t& available) override {
+        const size_t position = this->inner_.get_position();
+        auto page_end =
+            std::upper_bound(this->page_ends_.begin(), this->page_ends_.end(), position);
+        if (page_end != this->page_ends_.end() && position + bytes > *page_end) {
+            ++this->overreads;
+        }
+        return this->inner_.peek(bytes, available);
+    }
+
+    void skip(size_t bytes) override {
+        this->inner_.skip(bytes);
+    }
+
+    size_t get_position() const {
+        return this->inner_.get_position();
+    }
+
+    int overreads{0};
+
+private:
+    micro_opus::OggOpusMemoryReader inner_;
+    const std::vector<size_t>& page_ends_;
+};
+
+// Buffered reader over a vector: at most max_read bytes per read(), and only up to `arrived`
+class ChunkedSourceReader : public micro_opus::OggOpusBufferedReader {
+public:
+    ChunkedSourceReader(const std::vector<uint8_t>& stream, size_t max_read, size_t buffer_size)
+        : OggOpusBufferedReader(buffer_size), arrived(stream.size()), stream_(stream),
+          max_read_(max_read) {}
+
+    size_t arrived;  // Bytes of the stream the source has received so far
+
+protected:
+    size_t read(uint8_t* dst, size_t len) override {
+        const size_t n = std::min({len, this->max_read_, this->arrived - this->position_});
+        std::memcpy(dst, this->stream_.data() + this->position_, n);
+        this->position_ += n;
+        return n;
+    }
+
+private:
+    const std::vector<uint8_t>& stream_;
+    size_t max_read_;
+    size_t position_{0};
+};
+
+void test_memory_reader(const std::vector<uint8_t>& stream, const std::vector<size_t>& page_ends,
+                        const std::vector<int16_t>& expected) {
+    std::printf("Test: memory reader, requests stay within each page\n");
+    micro_opus::OggOpusDecoder decoder;
+    PageCheckingReader reader(stream, page_ends);
+    std::vector<int16_t> out;
+    check(decode_pull(decoder, reader, out, no_more_data), "pull decode completes");
+    check(out == expected, "PCM identical to the push decode");
+    check(reader.get_position() == stream.size(), "every byte consumed");
+    check(reader.overreads == 0, "no request past the end of the current page");
+}
+
+void test_buffered_reader(const std::vector<uint8_t>& stream,
+                          const std::vector<int16_t>& expected) {
+    std::printf("Test: buffered reader, 7 bytes per read()\n");
+    micro_opus::OggOpusDecoder decoder;
+    ChunkedSourceReader reader(stream, 7, micro_opus::OGG_MAX_PAGE_SIZE);
+    std::vector<int16_t> out;
+    check(decode_pull(decoder, reader, out, no_more_data), "pull decode completes");
+    check(out == expected, "PCM identical to the push decode");
+}
+
+void test_small_buffer(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: buffered reader smaller than a page\n");
+    micro_opus::OggOpusDecoder decoder;
+    ChunkedSourceReader reader(stream, 4096, 100);
+    std::vector<int16_t> out;
+    check(decode_pull(decoder, reader, out, no_more_data), "pull decode completes");
+    check(out == expected, "PCM identical to the push decode");
+}
+
+void test_bursts(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: data arriving in 333-byte bursts, then reset() and a second stream\n");
+    micro_opus::OggOpusDecoder decoder;
+    for (int run = 0; run < 2; ++run) {
+        ChunkedSourceReader reader(stream, 4096, micro_opus::OGG_MAX_PAGE_SIZE);
+        reader.arrived = 0;
+        std::vector<int16_t> out;
+        const bool ok = decode_pull(decoder, reader, out, [&reader, &stream]() {
+            if (reader.arrived == stream.size()) {
+                return false;
+            }
+            reader.arrived = std::min(reader.arrived + 333, stream.size());
+            return true;
+        });
+        check(ok, "pull decode completes");
+        check(out == expected, "PCM identical to the push decode");
+        decoder.reset();
+    }
+}
+
+}  // namespace
+
+int main() {
+    std::printf("OggOpusDecoder pull-model reader test\n");
+
+    std::vector<size_t> page_ends;
+    const std::vector<uint8_t> stream = make_test_stream(page_ends);
+    check(!stream.empty(), "built a non-empty Ogg stream");
+    if (stream.empty()) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    std::vector<int16_t> expected;
+    check(decode_push(stream, expected), "push decode completes");
+    check(!expected.empty(), "push decode produced audio");
+
+    test_memory_reader(stream, page_ends, expected);
+    test_buffered_reader(stream, expected);
+    test_small_buffer(stream, expected);
+    test_bursts(stream, expected);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
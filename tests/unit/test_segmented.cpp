@@ -0,0 +1,215 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// SegmentedOggOpusDecoder: decodes a 4 s stream with mixed 20/60 ms packets, pre-skip and end
+// trimming on 1-8 threads. One thread must match OggOpusDecoder exactly; more threads must give
+// the same length, an identical first segment and a close match after each split. Also covers
+// the error paths (decode before open, small buffer, truncated headers).
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "micro_opus/segmented_ogg_opus_decoder.h"
+#include "tone_stream.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <vector>
+
+namespace {
+
+constexpr uint32_t SAMPLE_RATE = 48000;
+constexpr uint8_t CHANNELS = 2;
+constexpr int NUM_PACKETS = 100;
+constexpr uint16_t PRE_SKIP = 312;
+constexpr int END_TRIM = 500;  // Samples the final granule position cuts from the last packet
+constexpr uint32_t SERIAL = 0x5E6;
+constexpr size_t MAX_FRAME_SAMPLES = 5760;  // 120 ms at 48 kHz
+constexpr double MIN_SNR_DB = 20.0;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// Encode a stereo two-tone signal into NUM_PACKETS packets alternating 20 and 60 ms, muxed one
+// per page
+std::vector<uint8_t> make_test_stream() {
+    const auto packets = micro_opus_test::encode_tone_packets(
+        micro_opus_test::EncoderSettings{}, {{440.0, 8000.0}, {660.0, 6000.0}}, NUM_PACKETS,
+        {960, 2880});
+    if (packets.empty()) {
+        return {};
+    }
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family0(CHANNELS, PRE_SKIP), packets, SERIAL, END_TRIM);
+}
+
+// Reference: the serial decoder, fed the whole stream
+bool decode_reference(const std::vector<uint8_t>& stream, std::vector<int16_t>& out) {
+    micro_opus::OggOpusDecoder decoder;
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: reference decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        out.insert(out.end(), pcm.begin(), pcm.begin() + samples * CHANNELS);
+    }
+    return true;
+}
+
+bool decode_segmented(micro_opus::SegmentedOggOpusDecoder& decoder,
+                      const std::vector<uint8_t>& stream, std::vector<int16_t>& out) {
+    micro_opus::OggOpusResult result = decoder.open(stream.data(), stream.size());
+    if (result != micro_opus::OGG_OPUS_OK) {
+        std::printf("  FAIL: open error %d\n", static_cast<int>(result));
+        return false;
+    }
+    out.assign(decoder.get_required_output_buffer_size() / sizeof(int16_t), 0);
+    size_t samples = 0;
+    result = decoder.decode(reinterpret_cast<uint8_t*>(out.data()), out.size() * sizeof(int16_t),
+                            samples);
+    if (result != micro_opus::OGG_OPUS_OK) {
+        std::printf("  FAIL: segmented decode error %d\n", static_cast<int>(result));
+        return false;
+    }
+    out.resize(samples * CHANNELS);
+    return true;
+}
+
+double snr_db(const std::vector<int16_t>& expected, const std::vector<int16_t>& actual) {
+    double signal = 0.0;
+    double noise = 0.0;
+    for (size_t i = 0; i < expected.size(); ++i) {
+        const double e = expected[i];
+        const double d = e - actual[i];
+        signal += e * e;
+        noise += d * d;
+    }
+    return (noise == 0.0) ? 999.0 : 10.0 * std::log10(signal / noise);
+}
+
+void test_single_thread(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: one thread matches OggOpusDecoder exactly\n");
+    micro_opus::SegmentedOggOpusDecoder decoder(1);
+    std::vector<int16_t> out;
+    check(decode_segmented(decoder, stream, out), "segmented decode completes");
+    check(out == expected, "PCM identical to the serial decoder");
+    check(decoder.get_segment_count() == 1, "one segment");
+    check(decoder.get_packet_count() == static_cast<size_t>(NUM_PACKETS),
+          "indexed every audio packet");
+    check(decoder.get_channels() == CHANNELS, "reports the stream's channel count");
+    check(decoder.get_sample_rate() == SAMPLE_RATE, "reports the output sample rate");
+    check(decoder.get_pre_skip() == PRE_SKIP, "reports the stream's pre-skip");
+}
+
+void test_many_threads(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: several threads stay within tolerance of OggOpusDecoder\n");
+    const uint8_t thread_counts[] = {2, 3, 4, 8};
+    for (uint8_t threads : thread_counts) {
+        micro_opus::SegmentedOggOpusDecoder decoder(threads);
+        std::vector<int16_t> out;
+        check(decode_segmented(decoder, stream, out), "segmented decode completes");
+        check(out.size() == expected.size(), "same length as the serial decode");
+        if (out.size() != expected.size()) {
+            continue;
+        }
+#ifdef TEST_SEGMENTS_PARALLEL
+        check(decoder.get_segment_count() == threads, "one segment per thread");
+#else
+        check(decoder.get_segment_count() == 1, "NONTHREADSAFE_PSEUDOSTACK decodes serially");
+#endif
+
+        // The first segment covers at least 1/threads of the audio and never pre-rolls
+        const size_t first_part = expected.size() / (2 * threads);
+        check(std::equal(expected.begin(), expected.begin() + first_part, out.begin()),
+              "first segment identical to the serial decode");
+
+        const double snr = snr_db(expected, out);
+        check(snr >= MIN_SNR_DB, "SNR against the serial decode");
+        std::printf("    %u threads: %zu segments, SNR %.1f dB\n", static_cast<unsigned>(threads),
+                    decoder.get_segment_count(), snr);
+    }
+}
+
+void test_reopen(const std::vector<uint8_t>& stream, const std::vector<int16_t>& expected) {
+    std::printf("Test: open() replaces the previous file\n");
+    micro_opus::SegmentedOggOpusDecoder decoder(1);
+    std::vector<int16_t> out;
+    check(decode_segmented(decoder, stream, out), "first decode completes");
+    check(decode_segmented(decoder, stream, out), "second decode completes");
+    check(out == expected, "PCM after reopening identical to the serial decoder");
+}
+
+void test_errors(const std::vector<uint8_t>& stream) {
+    std::printf("Test: error paths\n");
+    micro_opus::SegmentedOggOpusDecoder decoder(2);
+    std::vector<int16_t> pcm(MAX_FRAME_SAMPLES * CHANNELS);
+    size_t samples = 1;
+    check(decoder.decode(reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t),
+                         samples) == micro_opus::OGG_OPUS_NOT_INITIALIZED,
+          "decode() before open() is NOT_INITIALIZED");
+    check(samples == 0, "no samples before open()");
+
+    // Only the OpusHead page: the headers never complete
+    check(decoder.open(stream.data(), 40) == micro_opus::OGG_OPUS_INPUT_INVALID,
+          "truncated headers are INPUT_INVALID");
+    check(decoder.get_total_samples() == 0, "no samples after a failed open()");
+
+    check(decoder.open(stream.data(), stream.size()) == micro_opus::OGG_OPUS_OK, "open()");
+    check(decoder.decode(reinterpret_cast<uint8_t*>(pcm.data()), pcm.size() * sizeof(int16_t),
+                         samples) == micro_opus::OGG_OPUS_OUTPUT_BUFFER_TOO_SMALL,
+          "a buffer below the whole file is OUTPUT_BUFFER_TOO_SMALL");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("SegmentedOggOpusDecoder test\n");
+
+    const std::vector<uint8_t> stream = make_test_stream();
+    check(!stream.empty(), "built a non-empty Ogg stream");
+    if (stream.empty()) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+
+    std::vector<int16_t> expected;
+    check(decode_reference(stream, expected), "reference decode completes");
+    check(!expected.empty(), "reference decode produced audio");
+
+    test_single_thread(stream, expected);
+    test_many_threads(stream, expected);
+    test_reopen(stream, expected);
+    test_errors(stream);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}
@@ -0,0 +1,256 @@
+// Copyright 2026 Kevin Ahrendt
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Silent elementary streams in a channel mapping family 1 stream: a coupled stereo stream plays
+// a tone throughout while a mono stream falls silent, and a fourth output channel is unmapped.
+// With OggOpusDecoder::set_skip_silence(), the tone channels must stay bit-exact with the libopus
+// multistream decode, the mono channel must be skipped (all zeros, flagged in
+// get_silent_channel_mask()) once its silence has settled, and the unmapped channel is always
+// flagged. With set_write_silent_channels(false), flagged channels must be left untouched.
+
+#include "micro_opus/ogg_opus_decoder.h"
+#include "tone_stream.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <utility>
+#include <vector>
+
+namespace {
+
+constexpr int ENCODED_CHANNELS = 3;  // L, R (coupled), mono
+constexpr int STREAMS = 2;
+constexpr int COUPLED_STREAMS = 1;
+constexpr uint8_t OUTPUT_CHANNELS = 4;  // The encoded three plus an unmapped channel
+constexpr int FRAME_SAMPLES = 960;      // 20 ms at 48 kHz
+constexpr int TONE_PACKETS = 10;        // Packets before the mono stream falls silent
+constexpr int NUM_PACKETS = 40;
+constexpr uint32_t SERIAL = 0x5157;
+constexpr int16_t SENTINEL = 0x7F7F;
+
+constexpr uint64_t MONO_CHANNEL_BIT = uint64_t{1} << 2;
+constexpr uint64_t UNMAPPED_CHANNEL_BIT = uint64_t{1} << 3;
+
+int g_failures = 0;
+
+void check(bool condition, const char* message) {
+    if (!condition) {
+        std::printf("  FAIL: %s\n", message);
+        ++g_failures;
+    }
+}
+
+// CELT-only multistream packets: tones on the coupled stream, the mono stream silent after
+// TONE_PACKETS (coded with the CELT silence flag)
+std::vector<std::vector<uint8_t>> encode_packets() {
+    micro_opus_test::EncoderSettings settings;
+    settings.channels = ENCODED_CHANNELS;
+    settings.application = OPUS_APPLICATION_RESTRICTED_LOWDELAY;
+    settings.bitrate = 128000;
+    settings.streams = STREAMS;
+    settings.coupled_streams = COUPLED_STREAMS;
+    micro_opus_test::ToneEncoder encoder(settings,
+                                         {{220.0, 8000.0}, {330.0, 8000.0}, {440.0, 8000.0}});
+
+    std::vector<std::vector<uint8_t>> packets;
+    for (int p = 0; p < NUM_PACKETS; ++p) {
+        if (p == TONE_PACKETS) {
+            encoder.tones[2].amplitude = 0.0;
+        }
+        std::vector<uint8_t> packet = encoder.encode(FRAME_SAMPLES);
+        if (packet.empty()) {
+            break;
+        }
+        packets.push_back(std::move(packet));
+    }
+    return packets;
+}
+
+std::vector<uint8_t> mux_stream(const std::vector<std::vector<uint8_t>>& packets) {
+    return micro_opus_test::build_ogg_stream(
+        micro_opus_test::make_opus_head_family1(OUTPUT_CHANNELS, STREAMS, COUPLED_STREAMS,
+                                                {0, 1, 2, 255}),
+        packets, SERIAL);
+}
+
+// One audio packet's output from one decode() call
+struct DecodedPacket {
+    std::vector<int16_t> pcm;
+    uint64_t silent_mask;
+};
+
+// Decode the whole stream, pre-filling the output with SENTINEL before every call
+bool decode_stream(micro_opus::OggOpusDecoder& decoder, const std::vector<uint8_t>& stream,
+                   std::vector<DecodedPacket>& out) {
+    std::vector<int16_t> pcm(static_cast<size_t>(FRAME_SAMPLES) * OUTPUT_CHANNELS);
+    size_t pos = 0;
+    while (pos < stream.size()) {
+        pcm.assign(pcm.size(), SENTINEL);
+        size_t consumed = 0;
+        size_t samples = 0;
+        micro_opus::OggOpusResult result = decoder.decode(
+            stream.data() + pos, stream.size() - pos, reinterpret_cast<uint8_t*>(pcm.data()),
+            pcm.size() * sizeof(int16_t), consumed, samples);
+        if (result != micro_opus::OGG_OPUS_OK) {
+            std::printf("  FAIL: decode error %d\n", static_cast<int>(result));
+            return false;
+        }
+        pos += consumed;
+        if (samples > 0) {
+            out.push_back({std::vector<int16_t>(pcm.begin(),
+                                                pcm.begin() + static_cast<long>(
+                                                                  samples * OUTPUT_CHANNELS)),
+                           decoder.get_silent_channel_mask()});
+        }
+    }
+    return true;
+}
+
+// Whether channel c of the packet's PCM is entirely value
+bool channel_is(const DecodedPacket& packet, int c, int16_t value) {
+    for (size_t i = static_cast<size_t>(c); i < packet.pcm.size(); i += OUTPUT_CHANNELS) {
+        if (packet.pcm[i] != value) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Whether channel c of both packets matches sample for sample
+bool channel_equal(const DecodedPacket& a, const DecodedPacket& b, int c) {
+    if (a.pcm.size() != b.pcm.size()) {
+        return false;
+    }
+    for (size_t i = static_cast<size_t>(c); i < a.pcm.size(); i += OUTPUT_CHANNELS) {
+        if (a.pcm[i] != b.pcm[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void test_skip_silence(const std::vector<uint8_t>& stream,
+                       const std::vector<DecodedPacket>& expected) {
+    std::printf("Test: silent mono stream skipped, tone streams bit-exact\n");
+    micro_opus::OggOpusDecoder decoder;
+    decoder.set_skip_silence(true);
+    std::vector<DecodedPacket> actual;
+    check(decode_stream(decoder, stream, actual), "decode completes");
+    check(actual.size() == expected.size(), "same packet count");
+    if (actual.size() != expected.size()) {
+        return;
+    }
+
+    bool tones_exact = true;
+    bool masks_valid = true;
+    bool skipped_zero = true;
+    bool exact_before_skip = true;
+    bool skipping_seen = false;
+    int skipped = 0;
+    for (size_t p = 0; p < actual.size(); ++p) {
+        const DecodedPacket& packet = actual[p];
+        tones_exact = tones_exact && channel_equal(packet, expected[p], 0) &&
+                      channel_equal(packet, expected[p], 1);
+        masks_valid = masks_valid && (packet.silent_mask & UNMAPPED_CHANNEL_BIT) &&
+                      (packet.silent_mask & ~(MONO_CHANNEL_BIT | UNMAPPED_CHANNEL_BIT)) == 0;
+        skipped_zero = skipped_zero && channel_is(packet, 3, 0);
+        if (packet.silent_mask & MONO_CHANNEL_BIT) {
+            ++skipped;
+            skipping_seen = true;
+            skipped_zero = skipped_zero && channel_is(packet, 2, 0);
+        }
+        if (!skipping_seen) {
+            exact_before_skip = exact_before_skip && channel_equal(packet, expected[p], 2);
+        }
+    }
+    std::printf("  mono stream skipped for %d of %zu packets\n", skipped, actual.size());
+    check(tones_exact, "coupled stream bit-exact with the libopus multistream decode");
+    check(masks_valid, "only the mono and unmapped channels are ever flagged");
+    check(skipped_zero, "flagged channels are zeros");
+    check(exact_before_skip, "mono channel bit-exact until it is skipped");
+    check(skipped >= NUM_PACKETS - TONE_PACKETS - 5, "mono stream skipped once silence settles");
+    check(!(actual[0].silent_mask & MONO_CHANNEL_BIT), "mono channel not flagged while playing");
+}
+
+void test_unwritten_channels(const std::vector<uint8_t>& stream) {
+    std::printf("Test: set_write_silent_channels(false) leaves flagged channels untouched\n");
+    micro_opus::OggOpusDecoder zero_fill;
+    micro_opus::OggOpusDecoder unwritten;
+    zero_fill.set_skip_silence(true);
+    unwritten.set_skip_silence(true);
+    unwritten.set_write_silent_channels(false);
+    std::vector<DecodedPacket> filled;
+    std::vector<DecodedPacket> untouched;
+    check(decode_stream(zero_fill, stream, filled), "zero-fill decode completes");
+    check(decode_stream(unwritten, stream, untouched), "unwritten decode completes");
+    check(filled.size() == untouched.size(), "same packet count");
+    if (filled.size() != untouched.size()) {
+        return;
+    }
+
+    bool masks_equal = true;
+    bool flagged_untouched = true;
+    bool others_equal = true;
+    for (size_t p = 0; p < filled.size(); ++p) {
+        masks_equal = masks_equal && filled[p].silent_mask == untouched[p].silent_mask;
+        for (int c = 0; c < OUTPUT_CHANNELS; ++c) {
+            if (untouched[p].silent_mask & (uint64_t{1} << c)) {
+                flagged_untouched = flagged_untouched && channel_is(untouched[p], c, SENTINEL);
+            } else {
+                others_equal = others_equal && channel_equal(filled[p], untouched[p], c);
+            }
+        }
+    }
+    check(masks_equal, "same silent channels reported");
+    check(flagged_untouched, "flagged channels keep the buffer's previous contents");
+    check(others_equal, "unflagged channels identical to the zero-fill decode");
+}
+
+void test_off_by_default(const std::vector<DecodedPacket>& expected) {
+    std::printf("Test: no channels flagged without set_skip_silence()\n");
+    bool none_flagged = true;
+    for (const DecodedPacket& packet : expected) {
+        none_flagged = none_flagged && packet.silent_mask == 0;
+    }
+    check(none_flagged, "mask stays 0 on the libopus multistream path");
+}
+
+}  // namespace
+
+int main() {
+    std::printf("Silent multistream channel test\n");
+
+    const auto packets = encode_packets();
+    check(packets.size() == NUM_PACKETS, "encoded every packet");
+    if (packets.size() != NUM_PACKETS) {
+        std::printf("FAILED: %d check(s)\n", g_failures);
+        return 1;
+    }
+    const std::vector<uint8_t> stream = mux_stream(packets);
+
+    micro_opus::OggOpusDecoder reference;
+    std::vector<DecodedPacket> expected;
+    check(decode_stream(reference, stream, expected), "reference decode completes");
+
+    test_skip_silence(stream, expected);
+    test_unwritten_channels(stream);
+    test_off_by_default(expected);
+
+    if (g_failures == 0) {
+        std::printf("PASS: all checks passed\n");
+        return 0;
+    }
+    std::printf("FAILED: %d check(s)\n", g_failures);
+    return 1;
+}